@@ -0,0 +1,20 @@
+
+find_path(MYSQL_INCLUDE_DIR NAMES mysql.h PATH_SUFFIXES mysql mariadb)
+
+find_library(MYSQL_LIBRARY NAMES mysqlclient libmysql mariadb libmariadb)
+
+include(FindPackageHandleStandardArgs)
+
+find_package_handle_standard_args(
+    MySQL
+    FOUND_VAR MYSQL_FOUND
+    REQUIRED_VARS MYSQL_LIBRARY MYSQL_INCLUDE_DIR
+)
+
+if (MYSQL_FOUND)
+    add_library(MySQL UNKNOWN IMPORTED)
+    set_target_properties(MySQL PROPERTIES
+        IMPORTED_LOCATION ${MYSQL_LIBRARY}
+        INTERFACE_INCLUDE_DIRECTORIES ${MYSQL_INCLUDE_DIR}
+    )
+endif()
@@ -20,3 +20,8 @@ QList<Function> Action::functions() const
 {
     return mFunctions;
 }
+
+std::function<bool()> Action::condition() const
+{
+    return mCondition;
+}
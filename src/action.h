@@ -53,19 +53,29 @@ public:
         ActionExportTo,
         ActionRunSteps,
         ActionPullSchema,
+        ActionBeginStep,
+        ActionEndStep,
+        ActionCall,
+        ActionWaitFor,
+        ActionExportData,
     };
     Action(Type type = ActionEmpty, const QVariantList& args = QVariantList());
     Action(const QList<Function>& functions) : mType(ActionRunSteps), mFunctions(functions) {
 
+    }
+    Action(Type type, const std::function<bool()>& condition, const QVariantList& args) : mType(type), mArgs(args), mCondition(condition) {
+
     }
     Type type() const;
     QVariantList args() const;
     QVariant arg(int index) const;
     QList<Function> functions() const;
+    std::function<bool()> condition() const;
 
     Type mType;
     QVariantList mArgs;
     QList<Function> mFunctions;
+    std::function<bool()> mCondition;
 };
 
 
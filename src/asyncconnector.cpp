@@ -0,0 +1,182 @@
+#include "asyncconnector.h"
+
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QThread>
+#include <QTimer>
+#include "drivernames.h"
+
+AsyncConnector* AsyncConnector::mInstance = nullptr;
+
+AsyncConnector::AsyncConnector(QObject *parent) : QObject(parent), mCounter(0)
+{
+    mPool.setMaxThreadCount(maxThreads);
+}
+
+AsyncConnector *AsyncConnector::instance()
+{
+    if (!mInstance) {
+        mInstance = new AsyncConnector();
+    }
+    return mInstance;
+}
+
+QString AsyncConnector::connectOptions(const QString &driver, int timeout)
+{
+    if (timeout < 1) {
+        return QString();
+    }
+    if (driver == DRIVER_PSQL) {
+        return QString("connect_timeout=%1").arg(timeout);
+    }
+    if (driver == DRIVER_MYSQL || driver == DRIVER_MARIADB) {
+        return QString("MYSQL_OPT_CONNECT_TIMEOUT=%1").arg(timeout);
+    }
+    if (driver == DRIVER_ODBC) {
+        return QString("SQL_ATTR_LOGIN_TIMEOUT=%1").arg(timeout);
+    }
+    return QString();
+}
+
+static void setParams(QSqlDatabase& db, const ConnectionParams& params, int timeout) {
+    db.setHostName(params.host);
+    db.setUserName(params.user);
+    db.setPassword(params.password);
+    db.setDatabaseName(params.database);
+    if (params.port > -1) {
+        db.setPort(params.port);
+    }
+    db.setConnectOptions(AsyncConnector::connectOptions(params.driver, timeout));
+}
+
+static void closeAndRemove(const QString& name) {
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+void AsyncConnector::run(QSharedPointer<Task> task)
+{
+    const ConnectionParams& params = task->params;
+    bool ok = false;
+    QString error;
+
+    if (task->cancelled.loadAcquire()) {
+        error = "Cancelled";
+    } else {
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase(params.driver, params.connectionName);
+            setParams(db, params, task->timeout);
+            ok = db.open();
+            if (!ok) {
+                error = db.lastError().text();
+            }
+            if (ok && task->cancelled.loadAcquire()) {
+                ok = false;
+                error = "Cancelled";
+            }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+            if (ok && !db.moveToThread(qApp->thread())) {
+                ok = false;
+                error = "Failed to move connection to gui thread";
+            }
+#endif
+        }
+        if (!ok) {
+            closeAndRemove(params.connectionName);
+        }
+    }
+
+    QMetaObject::invokeMethod(mInstance, "onFinished", Qt::QueuedConnection,
+                              Q_ARG(int, task->id), Q_ARG(bool, ok), Q_ARG(QString, error));
+}
+
+void AsyncConnector::connectDatabase(const ConnectionParams &params, int timeout)
+{
+    QSharedPointer<Task> task = QSharedPointer<Task>::create();
+    task->id = ++mCounter;
+    task->params = params;
+    task->timeout = timeout;
+    task->elapsed.start();
+    task->timer = new QTimer(this);
+    task->timer->setSingleShot(true);
+    task->timer->setInterval((qMax(timeout, 1) + graceSecs) * 1000);
+    connect(task->timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+    mTasks[task->id] = task;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    task->timer->start();
+    mPool.start([task](){
+        run(task);
+    });
+#else
+    // connection can only be used in thread that opened it, open it here and report as usual
+    run(task);
+#endif
+}
+
+void AsyncConnector::abandon(QSharedPointer<Task> task, const QString &error)
+{
+    if (task->cancelled.loadAcquire()) {
+        return;
+    }
+    task->cancelled.storeRelease(1);
+    task->timer->stop();
+    emit failed(task->params.connectionName, error);
+}
+
+void AsyncConnector::cancel(const QString &connectionName)
+{
+    for(const QSharedPointer<Task>& task: std::as_const(mTasks)) {
+        if (task->params.connectionName == connectionName) {
+            abandon(task, "Cancelled");
+        }
+    }
+}
+
+bool AsyncConnector::isPending(const QString &connectionName) const
+{
+    for(const QSharedPointer<Task>& task: mTasks) {
+        if (task->params.connectionName == connectionName) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AsyncConnector::onTimeout()
+{
+    QTimer* timer = qobject_cast<QTimer*>(sender());
+    for(const QSharedPointer<Task>& task: std::as_const(mTasks)) {
+        if (task->timer == timer) {
+            abandon(task, QString("Timed out after %1 s").arg(task->elapsed.elapsed() / 1000));
+            return;
+        }
+    }
+}
+
+void AsyncConnector::onFinished(int id, bool ok, QString error)
+{
+    if (!mTasks.contains(id)) {
+        return;
+    }
+    QSharedPointer<Task> task = mTasks.take(id);
+    task->timer->stop();
+    task->timer->deleteLater();
+    const ConnectionParams& params = task->params;
+
+    if (task->cancelled.loadAcquire()) {
+        if (ok) {
+            closeAndRemove(params.connectionName);
+        }
+        return;
+    }
+
+    if (!ok) {
+        emit failed(params.connectionName, error);
+        return;
+    }
+    emit connected(params.connectionName, task->elapsed.elapsed());
+}
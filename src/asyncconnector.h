@@ -0,0 +1,79 @@
+#ifndef ASYNCCONNECTOR_H
+#define ASYNCCONNECTOR_H
+
+#include <QObject>
+#include <QMap>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+class QTimer;
+
+struct ConnectionParams {
+    QString connectionName;
+    QString driver;
+    QString host;
+    QString user;
+    QString password;
+    QString database;
+    int port;
+};
+
+// Opens named connections on worker threads so unreachable host doesn't freeze gui,
+// several connections open in parallel. Timeout is passed to driver as connect option
+// and also enforced by watchdog for drivers that ignore it. Connection opened in worker
+// is moved to gui thread, which needs Qt 6.8: with older versions connection can't change
+// thread and is opened in gui thread, blocking as before (timeout option still applies).
+// connected() and failed() are emitted in gui thread, connection named
+// connectionName exists only after connected().
+
+class AsyncConnector : public QObject
+{
+    Q_OBJECT
+public:
+    static AsyncConnector* instance();
+
+    // timeout in seconds
+    void connectDatabase(const ConnectionParams& params, int timeout);
+
+    // abandons connection attempt, worker cleans up when driver returns
+    void cancel(const QString& connectionName);
+
+    // true until worker returns, even if cancelled
+    bool isPending(const QString& connectionName) const;
+
+    static QString connectOptions(const QString& driver, int timeout);
+
+    static const int maxThreads = 8;
+    static const int graceSecs = 5;
+
+signals:
+    void connected(QString connectionName, qint64 elapsed);
+    void failed(QString connectionName, QString error);
+
+protected slots:
+    void onFinished(int id, bool ok, QString error);
+    void onTimeout();
+
+protected:
+    struct Task {
+        int id;
+        ConnectionParams params;
+        int timeout;
+        QAtomicInt cancelled;
+        QElapsedTimer elapsed;
+        QTimer* timer;
+    };
+
+    explicit AsyncConnector(QObject *parent = nullptr);
+    static AsyncConnector* mInstance;
+
+    static void run(QSharedPointer<Task> task);
+    void abandon(QSharedPointer<Task> task, const QString& error);
+
+    QThreadPool mPool;
+    QMap<int, QSharedPointer<Task>> mTasks;
+    int mCounter;
+};
+
+#endif // ASYNCCONNECTOR_H
@@ -6,6 +6,23 @@
 #include "mainwindow.h"
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QUrl>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QScrollBar>
+#include <QTableView>
+#include <QTextStream>
+#include "asyncconnector.h"
+#include "drivernames.h"
+#include "stepmeter.h"
+#include "sessiontab.h"
+#include "querymodelview.h"
+#include "dataformat.h"
+#include "schema2data.h"
+#include "schema2tablesmodel.h"
+#include "dataimportwidget2.h"
+#include "datacomparewidget.h"
 
 static MainWindow* mainWindow() {
     auto windows = qApp->topLevelWidgets();
@@ -173,3 +190,227 @@ void automate(QWidget *widget)
 #endif
 
 }
+
+static ConnectionParams benchmarkParams(const QString& target) {
+    ConnectionParams params;
+    params.connectionName = "bench";
+    params.port = 0;
+    if (target.startsWith("postgres://") || target.startsWith("postgresql://")) {
+        QUrl url(target);
+        params.driver = DRIVER_PSQL;
+        params.host = url.host();
+        params.user = url.userName();
+        params.password = url.password();
+        params.database = url.path().mid(1);
+        params.port = url.port(5432);
+    } else {
+        params.driver = DRIVER_SQLITE;
+        params.database = QDir(target).absolutePath();
+    }
+    return params;
+}
+
+static QSqlDatabase benchmarkDatabase(const ConnectionParams& params, const QString& connectionName) {
+    QSqlDatabase db = QSqlDatabase::addDatabase(params.driver, connectionName);
+    db.setHostName(params.host);
+    db.setUserName(params.user);
+    db.setPassword(params.password);
+    db.setDatabaseName(params.database);
+    if (params.port > 0) {
+        db.setPort(params.port);
+    }
+    return db;
+}
+
+static bool benchmarkGenerate(const ConnectionParams& params, int rows) {
+    bool ok = true;
+    {
+        QSqlDatabase db = benchmarkDatabase(params, "bench_generate");
+        if (!db.open()) {
+            qDebug() << db.lastError().text();
+            return false;
+        }
+        QSqlQuery q(db);
+        auto exec = [&](const QString& query) {
+            if (ok && !q.exec(query)) {
+                qDebug() << query << q.lastError().text();
+                ok = false;
+            }
+        };
+        // children first
+        for(const QString& table: {"bench_child", "bench_parent", "bench_order_import", "bench_order", "bench_customer"}) {
+            exec(QString("drop table if exists %1").arg(table));
+        }
+        exec("create table bench_customer(id integer primary key, name varchar(64), city varchar(64))");
+        exec("create table bench_order(id integer primary key, customer_id integer, amount double precision, created varchar(32))");
+        exec("create table bench_order_import(id integer, customer_id integer, name varchar(64), amount double precision, created varchar(32))");
+        int customers = qMax(1, rows / 10);
+        db.transaction();
+        if (ok && q.prepare("insert into bench_customer values (?, ?, ?)")) {
+            for(int i=0;ok && i<customers;i++) {
+                q.bindValue(0, i);
+                q.bindValue(1, QString("customer %1").arg(i));
+                q.bindValue(2, QString("city %1").arg(i % 97));
+                if (!q.exec()) {
+                    qDebug() << q.lastError().text();
+                    ok = false;
+                }
+            }
+        }
+        if (ok && q.prepare("insert into bench_order values (?, ?, ?, ?)")) {
+            QDateTime created(QDate(2020, 1, 1), QTime(0, 0));
+            for(int i=0;ok && i<rows;i++) {
+                q.bindValue(0, i);
+                q.bindValue(1, (i * 7919) % customers);
+                q.bindValue(2, (i % 1000) * 1.25);
+                q.bindValue(3, created.addSecs(qint64(i) * 61).toString(Qt::ISODate));
+                if (!q.exec()) {
+                    qDebug() << q.lastError().text();
+                    ok = false;
+                }
+            }
+        }
+        if (ok) {
+            db.commit();
+        } else {
+            db.rollback();
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("bench_generate");
+    return ok;
+}
+
+void benchmark(QWidget *widget, const QString &target, int rows)
+{
+    Automation* automation = Automation::instance(widget);
+    StepMeter* meter = new StepMeter(widget);
+    automation->setStepMeter(meter);
+
+    ConnectionParams params = benchmarkParams(target);
+    QString connectionName = params.connectionName;
+    QString exportPath = QDir::temp().filePath("mugi-query-bench.csv");
+
+    auto currentModel = [=]() -> QSqlQueryModel* {
+        SessionTab* tab = mainWindow()->currentTab();
+        return tab ? tab->currentModel() : nullptr;
+    };
+
+    automation->beginStep("generate");
+    automation->call("generate", [=](){
+        if (!benchmarkGenerate(params, rows)) {
+            meter->setNote("failed");
+        }
+    });
+    automation->endStep();
+
+    automation->beginStep("connect");
+    automation->call("connect", [=](){
+        mainWindow()->connectDatabases({params});
+    });
+    automation->waitFor([=](){
+        SessionTab* tab = mainWindow()->currentTab();
+        return tab && tab->connectionName() == connectionName;
+    }, 30000);
+    automation->endStep();
+
+    automation->beginStep("query");
+    automation->query(connectionName, "select o.id, o.customer_id, c.name, o.amount, o.created "
+                                      "from bench_order o join bench_customer c on c.id = o.customer_id");
+    automation->waitFor([=](){
+        return currentModel() != nullptr;
+    }, 600000);
+    automation->endStep();
+
+    // scroll to bottom the way user does, view fetches next batch when it reaches end
+    automation->beginStep("scroll");
+    automation->waitFor([=](){
+        SessionTab* tab = mainWindow()->currentTab();
+        QSqlQueryModel* model = currentModel();
+        if (!model || !model->canFetchMore()) {
+            return true;
+        }
+        tab->currentView()->tableView()->scrollToBottom();
+        return false;
+    }, 600000);
+    automation->call("rows", [=](){
+        QSqlQueryModel* model = currentModel();
+        meter->setNote(QString("%1 rows").arg(model ? model->rowCount() : 0));
+    });
+    automation->endStep();
+
+    automation->beginStep("export");
+    automation->call("remove", [=](){
+        QFile::remove(exportPath);
+    });
+    automation->exportData(DataFormat::Csv, exportPath);
+    automation->call("size", [=](){
+        meter->setNote(QString("%1 bytes").arg(QFileInfo(exportPath).size()));
+    });
+    automation->endStep();
+
+    automation->beginStep("import");
+    automation->call("import", [=](){
+        Schema2Data* data = Schema2Data::instance(connectionName, mainWindow());
+        data->pull();
+        if (!data->tables()->table("bench_order_import")) {
+            meter->setNote("no table");
+            return;
+        }
+        DataImportWidget2* importWidget = data->showDataImportWidget("bench_order_import");
+        importWidget->openCsv(exportPath);
+        QStringList failedQueries;
+        QStringList errors;
+        int count = importWidget->insertRows(&failedQueries, &errors);
+        meter->setNote(QString("%1 rows %2 errors").arg(count).arg(errors.size()));
+        importWidget->close();
+    });
+    automation->endStep();
+
+    // DataCompareModel::update is quadratic, so compare is limited to 2000 rows
+    automation->beginStep("compare");
+    automation->query(connectionName, "select id, customer_id, amount from bench_order order by id limit 2000;\n"
+                                      "select id, customer_id, amount from bench_order_import order by id limit 2000");
+    automation->waitFor([=](){
+        SessionTab* tab = mainWindow()->currentTab();
+        return tab && tab->tab(1) && tab->tab(1)->model();
+    }, 600000);
+    automation->call("compare", [=](){
+        SessionTab* tab = mainWindow()->currentTab();
+        auto* model1 = qobject_cast<QSqlQueryModel*>(tab->tab(0)->model());
+        auto* model2 = qobject_cast<QSqlQueryModel*>(tab->tab(1)->model());
+        if (!model1 || !model2) {
+            meter->setNote("no models");
+            return;
+        }
+        DataCompareWidget* compareWidget = new DataCompareWidget();
+        compareWidget->setAttribute(Qt::WA_DeleteOnClose);
+        compareWidget->setModels(model1, model2);
+        compareWidget->show();
+    });
+    automation->endStep();
+
+    automation->beginStep("schema");
+    automation->schemaEdit();
+    automation->createTable("bench_parent", {{"id", "integer"}, {"name", "varchar(64)"}});
+    automation->createPrimaryKey("pk_bench_parent", "bench_parent", {"id"});
+    automation->createTable("bench_child", {{"id", "integer"}, {"parent_id", "integer"}});
+    automation->createPrimaryKey("pk_bench_child", "bench_child", {"id"});
+    automation->createRelation("fk_bench_child_parent", "bench_child", {"parent_id"}, "bench_parent", {"id"}, true);
+    automation->pushSchema();
+    automation->endStep();
+
+    QObject::connect(automation, &Automation::finished, widget, [=](){
+        QTextStream(stdout) << meter->toText();
+        QString path = qEnvironmentVariable("MUGI_BENCH_REPORT");
+        if (!path.isEmpty()) {
+            QString error;
+            if (!meter->save(path, error)) {
+                qDebug() << error;
+            }
+        }
+        qApp->exit(0);
+    });
+
+    automation->start();
+}
@@ -22,10 +22,15 @@
 #include "clipboard.h"
 #include <QDateTime>
 #include <QFile>
+#include <QSharedPointer>
 #include "schema2data.h"
 #include "schema2tablesmodel.h"
 #include "schema2tablemodel.h"
 #include "actionrunstepswidget.h"
+#include "savedatadialog.h"
+#include "stepmeter.h"
+#include "comparetablewidget.h"
+#include "sessionmodel.h"
 
 namespace {
 
@@ -74,7 +79,7 @@ Schema2View* Automation::schemaView() {
     return nullptr;
 }
 
-Automation::Automation(QObject *parent) : QObject(parent), mAddDatabaseDialog(0), mDatabaseHistoryDialog(0)
+Automation::Automation(QObject *parent) : QObject(parent), mAddDatabaseDialog(0), mDatabaseHistoryDialog(0), mStepMeter(0)
 {
 
 }
@@ -161,13 +166,16 @@ void Automation::saveQuery(const QString &path)
 
 void Automation::afterDialog(DatabaseConnectDialog *) {
 
+    // connection is opened asynchronously, next action runs when it's ready
+    if (mAction.type() == Action::ActionConnectToDatabaseFromHistory) {
+        next();
+    }
 }
 
 void Automation::afterDialog(DatabaseHistoryDialog *) {
 
     if (mAction.type() == Action::ActionConnectToDatabaseFromHistory) {
         mAddDatabaseDialog->accept();
-        next();
     }
 }
 
@@ -225,6 +233,38 @@ void Automation::runSteps(const QList<Function>& functions) {
     mQueued.append(Action(functions));
 }
 
+void Automation::setStepMeter(StepMeter *meter)
+{
+    mStepMeter = meter;
+}
+
+void Automation::beginStep(const QString &name)
+{
+    mQueued.append(Action(Action::ActionBeginStep, {name}));
+}
+
+void Automation::endStep()
+{
+    mQueued.append(Action(Action::ActionEndStep));
+}
+
+void Automation::call(const QString &name, const std::function<void()> &fn)
+{
+    Action action(Action::ActionCall, {name});
+    action.mFunctions = {Function(name, fn)};
+    mQueued.append(action);
+}
+
+void Automation::waitFor(const std::function<bool()> &condition, int timeout)
+{
+    mQueued.append(Action(Action::ActionWaitFor, condition, {timeout}));
+}
+
+void Automation::exportData(int format, const QString &path)
+{
+    mQueued.append(Action(Action::ActionExportData, {format, path}));
+}
+
 static QVariant toVariant(const QList<QStringList>& values) {
     QVariantList res;
     for(const QStringList& item: values) {
@@ -277,7 +317,11 @@ void Automation::showAlterView(const QString &table)
 void Automation::onStart() {
 
     if (mQueued.isEmpty()) {
+        bool running = mAction.type() != Action::ActionEmpty;
         mAction = Action();
+        if (running) {
+            emit finished();
+        }
         return;
     }
 
@@ -503,6 +547,26 @@ void Automation::onStart() {
 
     } else if (mAction.type() == Action::ActionCompareTable) {
 
+        CompareTableWidget* widget = new CompareTableWidget();
+        widget->setAttribute(Qt::WA_DeleteOnClose);
+        widget->init(mainWindow()->model()->connectionNames());
+        widget->setTables(mAction.arg(0).toString(), mAction.arg(1).toString(),
+                          mAction.arg(2).toString(), mAction.arg(3).toString());
+        widget->show();
+
+        // closing widget cancels diff, automation continues once either way
+        QSharedPointer<bool> done(new bool(false));
+        auto onDone = [=](){
+            if (*done) {
+                return;
+            }
+            *done = true;
+            next();
+        };
+        connect(widget, &CompareTableWidget::finished, this, onDone);
+        connect(widget, &QObject::destroyed, this, onDone);
+        widget->compare();
+
     } else if (mAction.type() == Action::ActionShowAlterView) {
 
         QString tableName = mAction.arg(0).toString();
@@ -577,6 +641,36 @@ void Automation::onStart() {
             next();
         });
 
+    } else if (mAction.type() == Action::ActionBeginStep) {
+
+        if (mStepMeter) {
+            mStepMeter->begin(mAction.arg(0).toString());
+        }
+        next();
+
+    } else if (mAction.type() == Action::ActionEndStep) {
+
+        if (mStepMeter) {
+            mStepMeter->end();
+        }
+        next();
+
+    } else if (mAction.type() == Action::ActionCall) {
+
+        mAction.functions().value(0).fn();
+        next();
+
+    } else if (mAction.type() == Action::ActionWaitFor) {
+
+        mWaitTime.start();
+        onWaitFor();
+
+    } else if (mAction.type() == Action::ActionExportData) {
+
+        mExportDataArgs = mAction.args();
+        mainWindow()->on_dataSave_triggered();
+        next();
+
     }
 
 }
@@ -620,6 +714,18 @@ void Automation::beforeDialog(ExportDialog *dialog)
 
 }
 
+void Automation::beforeDialog(SaveDataDialog *dialog)
+{
+    if (mAction.type() != Action::ActionExportData) {
+        return;
+    }
+    QTimer::singleShot(0,dialog,[=](){
+        auto args = mExportDataArgs;
+        dialog->setFile(DataFormat::Format(args[0].toInt()), args[1].toString());
+        dialog->accept();
+    });
+}
+
 void Automation::beforeDialog(DatabaseHistoryDialog *dialog)
 {
     //qDebug() << "beforeDialog(DatabaseHistoryDialog *dialog)";
@@ -644,6 +750,23 @@ void Automation::onDatabaseHistoryDialog() {
     }
 }
 
+void Automation::onWaitFor()
+{
+    if (mAction.condition()()) {
+        next();
+        return;
+    }
+    if (mWaitTime.elapsed() > mAction.arg(0).toInt()) {
+        qDebug() << "waitFor timeout" << __FILE__ << __LINE__;
+        if (mStepMeter) {
+            mStepMeter->setNote("timeout");
+        }
+        next();
+        return;
+    }
+    QTimer::singleShot(10,this,SLOT(onWaitFor()));
+}
+
 void Automation::onPushSchema() {
     auto* view = schemaView();
     view->onPush();
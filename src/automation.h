@@ -4,11 +4,14 @@
 #include <QObject>
 #include <QQueue>
 #include <QVariantList>
+#include <QElapsedTimer>
 class MainWindow;
 class DatabaseConnectDialog;
 class DatabaseHistoryDialog;
 class Schema2View;
 class ExportDialog;
+class SaveDataDialog;
+class StepMeter;
 #include "action.h"
 
 class Automation : public QObject
@@ -42,6 +45,7 @@ public:
     void beforeDialog(DatabaseHistoryDialog* dialog);
     void beforeDialog(DatabaseConnectDialog *dialog);
     void beforeDialog(ExportDialog *dialog);
+    void beforeDialog(SaveDataDialog *dialog);
 
     void afterDialog(DatabaseConnectDialog *dialog);
     void afterDialog(DatabaseHistoryDialog *dialog);
@@ -80,6 +84,20 @@ public:
     void selectTables(const QStringList &tables);
     void exportTo(int format, bool cropAll, bool itemsAll, bool clipboard, const QString &path);
     void runSteps(const QList<Function> &functions);
+
+    // actions between beginStep and endStep are measured by step meter
+    void setStepMeter(StepMeter* meter);
+    void beginStep(const QString& name);
+    void endStep();
+    void call(const QString& name, const std::function<void()>& fn);
+    // next action starts when condition is true or timeout (ms) is expired
+    void waitFor(const std::function<bool()>& condition, int timeout);
+    // saves current result to file through SaveDataDialog
+    void exportData(int format, const QString& path);
+
+signals:
+    void finished();
+
 public slots:
     void onPullSchema();
     void onPushSchema();
@@ -96,6 +114,10 @@ protected:
     DatabaseHistoryDialog* mDatabaseHistoryDialog;
 
     QVariantList mExportDialogArgs;
+    QVariantList mExportDataArgs;
+
+    StepMeter* mStepMeter;
+    QElapsedTimer mWaitTime;
 
 protected slots:
 
@@ -103,6 +125,7 @@ protected slots:
     void onAddDatabaseDialog();
     void onDatabaseHistoryDialog();
     void onStart();
+    void onWaitFor();
 };
 
 #endif // AUTOMATION_H
@@ -0,0 +1,145 @@
+#include <QTest>
+#include <QStandardPaths>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlQueryModel>
+#include <QTextStream>
+#include <QLocale>
+
+#include "datastreamer.h"
+#include "drivernames.h"
+
+// bench_export -o bench_export.xml,xml to save results
+
+class bench_Export : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void stream_data();
+    void stream();
+    void variantToString_data();
+    void variantToString();
+
+protected:
+    QSqlDatabase mDb;
+    static QVariant value(int row, int column);
+    void createTable(int rows);
+};
+
+void bench_Export::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    mDb = QSqlDatabase::addDatabase(DRIVER_SQLITE, "bench");
+    mDb.setDatabaseName(":memory:");
+    QVERIFY(mDb.open());
+}
+
+QVariant bench_Export::value(int row, int column)
+{
+    switch (column) {
+    case 0: return row;
+    case 1: return QString("name %1 \"quoted\"").arg(row);
+    case 2: return row * 1.5;
+    case 3: return QDateTime(QDate(2000, 1, 1), QTime(0, 0)).addSecs(qint64(row) * 3607);
+    case 4: return QDate(2000, 1, 1).addDays(row % 10000);
+    }
+    return row % 7 == 0 ? QVariant() : QVariant(qint64(row) * 1000003);
+}
+
+void bench_Export::createTable(int rows)
+{
+    QSqlQuery q(mDb);
+    QVERIFY(q.exec("drop table if exists t"));
+    QVERIFY(q.exec("create table t(id int, name text, amount real, created datetime, day date, nullable bigint)"));
+    QVERIFY(mDb.transaction());
+    QVERIFY(q.prepare("insert into t values (?, ?, ?, ?, ?, ?)"));
+    for(int row=0;row<rows;row++) {
+        for(int column=0;column<6;column++) {
+            q.bindValue(column, value(row, column));
+        }
+        QVERIFY(q.exec());
+    }
+    QVERIFY(mDb.commit());
+}
+
+void bench_Export::stream_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<int>("rows");
+    QList<QPair<QString,DataFormat::Format>> formats = {
+        {"csv", DataFormat::Csv},
+        {"json", DataFormat::Json},
+        {"insert", DataFormat::SqlInsert}
+    };
+    for(const auto& format: formats) {
+        for(int rows: {1000, 10000, 100000}) {
+            QTest::addRow("%s %d", qPrintable(format.first), rows) << int(format.second) << rows;
+        }
+    }
+}
+
+void bench_Export::stream()
+{
+    QFETCH(int, format);
+    QFETCH(int, rows);
+    createTable(rows);
+    QSqlQueryModel model;
+    model.setQuery("select * from t", mDb);
+    while (model.canFetchMore()) {
+        model.fetchMore();
+    }
+    QCOMPARE(model.rowCount(), rows);
+    QList<bool> data(model.columnCount(), true);
+    QList<bool> keys(model.columnCount(), false);
+    keys[0] = true;
+    QString error;
+    qsizetype size = 0;
+    QBENCHMARK {
+        QString out;
+        QTextStream stream(&out);
+        bool hasMore;
+        DataStreamer::stream(mDb, stream, &model, DataFormat::Format(format), "t", data, keys,
+                             DataFormat::ActionSave, false, &hasMore, QLocale::c(), error);
+        stream.flush();
+        size = out.size();
+    }
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+    QVERIFY(size > 0);
+}
+
+void bench_Export::variantToString_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<int>("size");
+    for(int size: {1000, 10000, 100000}) {
+        QTest::addRow("csv %d", size) << int(DataFormat::Csv) << size;
+        QTest::addRow("insert %d", size) << int(DataFormat::SqlInsert) << size;
+    }
+}
+
+void bench_Export::variantToString()
+{
+    QFETCH(int, format);
+    QFETCH(int, size);
+    QVariantList values;
+    for(int i=0;i<size;i++) {
+        values.append(value(i / 6, i % 6));
+    }
+    Formats formats(DataFormat::ActionSave);
+    QLocale locale = QLocale::c();
+    QString error;
+    qsizetype length = 0;
+    QBENCHMARK {
+        length = 0;
+        for(const QVariant& value: std::as_const(values)) {
+            length += DataStreamer::variantToString(value, DataFormat::Format(format), formats, locale, error).size();
+        }
+    }
+    QVERIFY(error.isEmpty());
+    QVERIFY(length > 0);
+}
+
+QTEST_MAIN(bench_Export)
+#include "bench_export.moc"
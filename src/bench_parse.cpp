@@ -0,0 +1,194 @@
+#include <QTest>
+#include <QLocale>
+
+#include "sqlparse.h"
+#include "queryparser.h"
+#include "datetime.h"
+#include "sqldatatypes.h"
+
+// bench_parse -o bench_parse.xml,xml to save results
+
+class bench_Parse : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void splitQueries_data();
+    void splitQueries();
+    void aliases_data();
+    void aliases();
+    void dateTimeParse_data();
+    void dateTimeParse();
+    void tryConvert_data();
+    void tryConvert();
+
+protected:
+    static void addSizes(const QList<int>& sizes);
+    static QString queries(int count);
+    static QString joinQuery(int joins);
+    static QStringList dateTimes(int count);
+};
+
+void bench_Parse::addSizes(const QList<int> &sizes)
+{
+    QTest::addColumn<int>("size");
+    for(int size: sizes) {
+        QTest::addRow("%d", size) << size;
+    }
+}
+
+QString bench_Parse::queries(int count)
+{
+    QStringList res;
+    for(int i=0;i<count;i++) {
+        switch (i % 4) {
+        case 0:
+            res.append(QString("select id, name from t%1 where name = 'a;b%1' and id > %1").arg(i));
+            break;
+        case 1:
+            res.append(QString("-- comment; %1\ninsert into t%1(id, name) values (%1, \"x;y\")").arg(i));
+            break;
+        case 2:
+            res.append(QString("/* block; comment */ update t%1 set name = 'it''s' where id = %1").arg(i));
+            break;
+        case 3:
+            res.append(QString("create table t%1(id int primary key, name varchar(255))").arg(i));
+            break;
+        }
+    }
+    return res.join(";\n");
+}
+
+QString bench_Parse::joinQuery(int joins)
+{
+    QString res = "select * from t0 a0";
+    for(int i=1;i<=joins;i++) {
+        res += QString("\njoin t%1 a%1 on a%1.t%2_id = a%2.id").arg(i).arg(i-1);
+    }
+    res += QString("\nwhere a0.id in (select t0_id from s0 b0 join s1 b1 on b1.id = b0.s1_id) limit 10");
+    return res;
+}
+
+QStringList bench_Parse::dateTimes(int count)
+{
+    QStringList res;
+    QDateTime base(QDate(1970, 1, 1), QTime(0, 0));
+    for(int i=0;i<count;i++) {
+        QDateTime dateTime = base.addSecs(qint64(i) * 7919 * 61);
+        switch (i % 4) {
+        case 0:
+            res.append(dateTime.toString("yyyy-MM-ddThh:mm:ss"));
+            break;
+        case 1:
+            res.append(dateTime.toString("yyyy-MM-dd hh:mm:ss.zzz"));
+            break;
+        case 2:
+            res.append(dateTime.toString("dd.MM.yyyy hh:mm"));
+            break;
+        case 3:
+            res.append(dateTime.toString(Qt::RFC2822Date));
+            break;
+        }
+    }
+    return res;
+}
+
+void bench_Parse::splitQueries_data()
+{
+    addSizes({100, 1000, 10000});
+}
+
+void bench_Parse::splitQueries()
+{
+    QFETCH(int, size);
+    QString text = queries(size);
+    QStringList res;
+    QBENCHMARK {
+        res = SqlParse::splitQueries(text);
+    }
+    QVERIFY(res.size() >= size);
+}
+
+void bench_Parse::aliases_data()
+{
+    addSizes({1, 10, 50});
+}
+
+void bench_Parse::aliases()
+{
+    QFETCH(int, size);
+    QString query = joinQuery(size);
+    QMap<QString,QString> res;
+    QBENCHMARK {
+        res = QueryParser::aliases(query);
+    }
+    QVERIFY(!res.isEmpty());
+}
+
+void bench_Parse::dateTimeParse_data()
+{
+    addSizes({100, 1000, 10000});
+}
+
+void bench_Parse::dateTimeParse()
+{
+    QFETCH(int, size);
+    QStringList values = dateTimes(size);
+    int parsed = 0;
+    QBENCHMARK {
+        parsed = 0;
+        for(const QString& value: std::as_const(values)) {
+            QDate date;
+            QTime time;
+            QDateTime dateTime;
+            if (DateTime::parse(DateTime::TypeDateTime, value, date, time, dateTime, 1930, true, false)) {
+                parsed++;
+            }
+        }
+    }
+    QVERIFY(parsed > 0);
+}
+
+void bench_Parse::tryConvert_data()
+{
+    addSizes({100, 1000, 10000});
+}
+
+void bench_Parse::tryConvert()
+{
+    QFETCH(int, size);
+    QList<QPair<QVariant,QMetaType::Type>> values;
+    QStringList dates = dateTimes(size);
+    for(int i=0;i<size;i++) {
+        switch (i % 4) {
+        case 0:
+            values.append({QString::number(i * 31), QMetaType::Int});
+            break;
+        case 1:
+            values.append({QString::number(i * 1.25, 'f', 2), QMetaType::Double});
+            break;
+        case 2:
+            values.append({dates[i].left(10), QMetaType::QDate});
+            break;
+        case 3:
+            values.append({dates[i], QMetaType::QDateTime});
+            break;
+        }
+    }
+    QLocale locale = QLocale::c();
+    int converted = 0;
+    QBENCHMARK {
+        converted = 0;
+        for(const auto& value: std::as_const(values)) {
+            bool ok = false;
+            SqlDataTypes::tryConvert(value.first, value.second, locale, 1930, true, false, &ok);
+            if (ok) {
+                converted++;
+            }
+        }
+    }
+    QVERIFY(converted > 0);
+}
+
+QTEST_MAIN(bench_Parse)
+#include "bench_parse.moc"
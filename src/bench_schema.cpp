@@ -0,0 +1,60 @@
+#include <QTest>
+#include <QGraphicsScene>
+
+#include "schema2arrange.h"
+#include "schema2tablesmodel.h"
+#include "sdata.h"
+
+// bench_schema -o bench_schema.xml,xml to save results
+
+class bench_Schema : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void arrangeTables_data();
+    void arrangeTables();
+};
+
+void bench_Schema::arrangeTables_data()
+{
+    QTest::addColumn<int>("tables");
+    for(int tables: {10, 50, 200}) {
+        QTest::addRow("%d", tables) << tables;
+    }
+}
+
+void bench_Schema::arrangeTables()
+{
+    QFETCH(int, tables);
+    QGraphicsScene scene;
+    Schema2TablesModel model("bench", &scene);
+
+    // each table references one or two of previous tables, like typical star and chain schemas
+    QList<STable> tables_;
+    QList<SRelation> relations;
+    for(int i=0;i<tables;i++) {
+        QString name = QString("t%1").arg(i);
+        QList<SColumn> columns = {SColumn("id", "int"), SColumn("name", "text")};
+        if (i > 0) {
+            int parent = (i * 7) % i;
+            columns.append(SColumn("parent_id", "int"));
+            relations.append(SRelation(QString("fk_%1_parent").arg(i), name, {"parent_id"}, QString("t%1").arg(parent), {"id"}));
+        }
+        if (i > 2 && i % 3 == 0) {
+            columns.append(SColumn("owner_id", "int"));
+            relations.append(SRelation(QString("fk_%1_owner").arg(i), name, {"owner_id"}, QString("t%1").arg(i / 3), {"id"}));
+        }
+        tables_.append(STable(name, columns));
+    }
+    model.merge(getDiff(QList<STable>(), tables_));
+    model.merge(getDiff(QList<SRelation>(), relations));
+    QCOMPARE(model.tableNames().size(), tables);
+
+    QBENCHMARK {
+        ::arrangeTables(GridTriangle, &model, true);
+    }
+}
+
+QTEST_MAIN(bench_Schema)
+#include "bench_schema.moc"
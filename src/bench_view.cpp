@@ -0,0 +1,122 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardItemModel>
+#include <QTextDocument>
+
+#include "highlighter.h"
+#include "tokens.h"
+#include "model/datacomparemodel.h"
+#include "drivernames.h"
+
+// bench_view -o bench_view.xml,xml to save results
+
+class bench_View : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void highlight_data();
+    void highlight();
+    void compare_data();
+    void compare();
+
+protected:
+    static Tokens tokens(int tables);
+    static QString queries(int lines);
+    static QStandardItemModel* model(int rows, int changeEach, QObject* parent);
+};
+
+Tokens bench_View::tokens(int tables)
+{
+    QString name = QString("tables%1").arg(tables);
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, name);
+    db.setDatabaseName(":memory:");
+    if (!db.open()) {
+        return Tokens();
+    }
+    QSqlQuery q(db);
+    for(int i=0;i<tables;i++) {
+        q.exec(QString("create table table_%1(id int, name_%1 text, amount real, created datetime, parent_id int)").arg(i));
+    }
+    return Tokens(db);
+}
+
+QString bench_View::queries(int lines)
+{
+    QStringList res;
+    for(int i=0;i<lines;i++) {
+        switch (i % 3) {
+        case 0:
+            res.append(QString("select t.id, count(*), max(amount) from table_%1 t join table_%2 p on p.id = t.parent_id").arg(i).arg(i + 1));
+            break;
+        case 1:
+            res.append(QString("where name_%1 like 'abc%' and created > '2020-01-01' -- comment %1").arg(i));
+            break;
+        case 2:
+            res.append(QString("group by t.id order by 2 desc limit %1; /* block */").arg(i));
+            break;
+        }
+    }
+    return res.join("\n");
+}
+
+QStandardItemModel *bench_View::model(int rows, int changeEach, QObject* parent)
+{
+    QStandardItemModel* model = new QStandardItemModel(rows, 4, parent);
+    for(int row=0;row<rows;row++) {
+        bool changed = changeEach > 0 && row % changeEach == 0;
+        model->setData(model->index(row, 0), row);
+        model->setData(model->index(row, 1), QString("name %1").arg(row));
+        model->setData(model->index(row, 2), changed ? row * 2.5 : row * 1.5);
+        model->setData(model->index(row, 3), QDate(2000, 1, 1).addDays(row));
+    }
+    return model;
+}
+
+void bench_View::highlight_data()
+{
+    QTest::addColumn<int>("tables");
+    QTest::addColumn<int>("lines");
+    for(int tables: {10, 100, 1000}) {
+        for(int lines: {10, 100, 1000}) {
+            QTest::addRow("tables %d lines %d", tables, lines) << tables << lines;
+        }
+    }
+}
+
+void bench_View::highlight()
+{
+    QFETCH(int, tables);
+    QFETCH(int, lines);
+    QTextDocument document;
+    document.setPlainText(queries(lines));
+    Highlighter highlighter(tokens(tables), &document);
+    QBENCHMARK {
+        highlighter.rehighlight();
+    }
+}
+
+void bench_View::compare_data()
+{
+    QTest::addColumn<int>("rows");
+    for(int rows: {100, 500, 2000}) {
+        QTest::addRow("%d", rows) << rows;
+    }
+}
+
+void bench_View::compare()
+{
+    QFETCH(int, rows);
+    QObject parent;
+    DataCompareModel compareModel;
+    compareModel.setKeyColumns({0});
+    compareModel.setModels(model(rows, 0, &parent), model(rows + rows / 10, 10, &parent));
+    QBENCHMARK {
+        compareModel.update();
+    }
+    QVERIFY(compareModel.rowCount() >= rows);
+}
+
+QTEST_MAIN(bench_View)
+#include "bench_view.moc"
@@ -0,0 +1,69 @@
+#include "bulkinsert.h"
+
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "odbcquery.h"
+#include "nativequery.h"
+
+static QString insertStatement(const QSqlDatabase& db, const QString& table, const QStringList& columns) {
+    QSqlDriver* driver = db.driver();
+    QStringList names;
+    QStringList placeholders;
+    for(const QString& column: columns) {
+        names.append(driver->escapeIdentifier(column, QSqlDriver::FieldName));
+        placeholders.append("?");
+    }
+    return QString("INSERT INTO %1 (%2) VALUES (%3)")
+            .arg(driver->escapeIdentifier(table, QSqlDriver::TableName))
+            .arg(names.join(", "))
+            .arg(placeholders.join(", "));
+}
+
+bool BulkInsert::insert(const QSqlDatabase &db_, const QString &table, const QStringList &columns,
+                        const QList<QVariantList> &rows, QString &error)
+{
+    QSqlDatabase db = db_;
+    if (rows.isEmpty()) {
+        return true;
+    }
+    QString query = insertStatement(db, table, columns);
+    bool transaction = db.transaction();
+
+    bool ok;
+    if (NativeQuery::canCopyIn(db)) {
+        ok = NativeQuery::copyIn(db, table, columns, rows, error);
+    } else if (OdbcQuery::isAvailable(db)) {
+        ok = OdbcQuery::insert(db, query, rows, error);
+    } else {
+        QSqlQuery q(db);
+        ok = q.prepare(query);
+        if (ok) {
+            for(int c=0;c<columns.size();c++) {
+                QVariantList values;
+                values.reserve(rows.size());
+                for(const QVariantList& row: rows) {
+                    values.append(row[c]);
+                }
+                q.addBindValue(values);
+            }
+            ok = q.execBatch();
+        }
+        if (!ok) {
+            error = q.lastError().text();
+        }
+    }
+
+    if (transaction) {
+        if (ok) {
+            ok = db.commit();
+            if (!ok) {
+                error = db.lastError().text();
+            }
+        } else {
+            db.rollback();
+        }
+    }
+    return ok;
+}
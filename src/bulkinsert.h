@@ -0,0 +1,19 @@
+#ifndef BULKINSERT_H
+#define BULKINSERT_H
+
+#include <QStringList>
+#include <QVariantList>
+class QSqlDatabase;
+
+// Inserts rows into table within transaction, ODBC connections use parameter arrays
+// (when built WITH_ODBC), PostgreSQL connections use COPY FROM STDIN (when built WITH_LIBPQ),
+// other connections use prepared query with execBatch
+
+class BulkInsert
+{
+public:
+    static bool insert(const QSqlDatabase& db, const QString& table, const QStringList& columns,
+                       const QList<QVariantList>& rows, QString& error);
+};
+
+#endif // BULKINSERT_H
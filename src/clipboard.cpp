@@ -3,7 +3,6 @@
 #include <QTextStream>
 #include <QItemSelection>
 #include <QLocale>
-#include "rowvaluegetter.h"
 #include "datastreamer.h"
 #include <QClipboard>
 #include <QApplication>
@@ -15,6 +14,7 @@
 #include <QSqlField>
 #include <QDebug>
 #include <algorithm>
+#include "largevaluemodel.h"
 
 void Clipboard::streamHeader(QTextStream& stream, QSqlQueryModel *model, const QString &separator, const QString& end) {
     int columnCount = model->columnCount();
@@ -55,20 +55,22 @@ void Clipboard::streamRange(QTextStream& stream, const QItemSelectionRange &rng,
              << "rng.topLeft().column()" << rng.topLeft().column()
              << "rng.bottomRight().column()" << rng.bottomRight().column();*/
 
+    // line buffer keeps its capacity between rows
+    QString line;
     for(int row = rng.topLeft().row(); row <= rng.bottomRight().row(); row++) {
-        RowValueGetter g(model,row);
-        int column = rng.topLeft().column();
-        stream << DataStreamer::variantToString(g(column++), format, formats, locale, error);
-        if (!error.isEmpty()) {
-            return;
-        }
-        for(;column <= rng.bottomRight().column(); column++) {
-            stream << separator << DataStreamer::variantToString(g(column),format,formats,locale,error);
+        line.resize(0);
+        for(int column = rng.topLeft().column(); column <= rng.bottomRight().column(); column++) {
+            if (column > rng.topLeft().column()) {
+                line.append(separator);
+            }
+            QVariant value = LargeValueModel::fullData(model, model->index(row, column));
+            DataStreamer::appendVariant(line, value, format, formats, locale, error);
             if (!error.isEmpty()) {
                 return;
             }
         }
-        stream << "\n";
+        line.append(QLatin1Char('\n'));
+        stream << line;
     }
 }
 
@@ -143,7 +145,7 @@ QString Clipboard::selectedToString(QAbstractItemModel *model, const QItemSelect
 
     // one range of one index
     if (selection.size() == 1 && selection[0].topLeft() == selection[0].bottomRight()) {
-        QString data = DataStreamer::variantToString(model->data(selection[0].topLeft()),format,formats,locale,error);
+        QString data = DataStreamer::variantToString(LargeValueModel::fullData(model, selection[0].topLeft()),format,formats,locale,error);
         if (!error.isEmpty()) {
             return QString();
         }
@@ -0,0 +1,327 @@
+#include "connectionpool.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadPool>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QDebug>
+#include "drivernames.h"
+
+ConnectionPool* ConnectionPool::mInstance = nullptr;
+
+ConnectionPool::ConnectionPool() : mCounter(0)
+{
+
+}
+
+ConnectionPool *ConnectionPool::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (!mInstance) {
+        mInstance = new ConnectionPool();
+    }
+    return mInstance;
+}
+
+QThreadPool *ConnectionPool::workers()
+{
+    static QThreadPool* pool = [](){
+        QThreadPool* pool = new QThreadPool();
+        pool->setMaxThreadCount(64);
+        // connections leased by worker belong to its thread, keep threads for a while to reuse them,
+        // expired thread closes its connections
+        pool->setExpiryTimeout(threadExpirySecs * 1000);
+        return pool;
+    }();
+    return pool;
+}
+
+void ConnectionPool::startWorker(const std::function<void()> &fn)
+{
+    QThreadPool* pool = workers();
+    if (pool->tryStart(fn)) {
+        return;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    pool->reserveThread();
+    pool->startOnReservedThread(fn);
+#else
+    pool->start(fn);
+#endif
+}
+
+qint64 ConnectionPool::now()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+int ConnectionPool::indexOf(const QString &name) const
+{
+    for(int i=0;i<mEntries.size();i++) {
+        if (mEntries[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void closeAndRemove(const QString& name) {
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+bool ConnectionPool::ping(QSqlDatabase &db)
+{
+    if (!db.isOpen()) {
+        return db.open();
+    }
+    if (db.driverName() == DRIVER_SQLITE) {
+        return true;
+    }
+    QSqlQuery q(db);
+    if (q.exec("select 1")) {
+        return true;
+    }
+    db.close();
+    return db.open();
+}
+
+void ConnectionPool::closeExpired()
+{
+    QThread* thread = QThread::currentThread();
+    qint64 time = now();
+    for(int i=mEntries.size()-1;i>=0;i--) {
+        const Entry& entry = mEntries[i];
+        if (entry.name == entry.connectionName || entry.leased || entry.thread != thread) {
+            continue;
+        }
+        if (entry.stale || time - entry.releasedAt > qint64(closeAfterSecs) * 1000) {
+            QString name = entry.name;
+            mEntries.removeAt(i);
+            closeAndRemove(name);
+        }
+    }
+}
+
+void ConnectionPool::closeThread(QThread *thread)
+{
+    QMutexLocker locker(&mMutex);
+    mWatched.remove(thread);
+    for(int i=mEntries.size()-1;i>=0;i--) {
+        const Entry& entry = mEntries[i];
+        if (entry.name == entry.connectionName || entry.thread != thread) {
+            continue;
+        }
+        QString name = entry.name;
+        mEntries.removeAt(i);
+        closeAndRemove(name);
+    }
+}
+
+QSqlDatabase ConnectionPool::lease(const QString &connectionName, QString &error)
+{
+    QMutexLocker locker(&mMutex);
+    closeExpired();
+
+    if (!QSqlDatabase::contains(connectionName)) {
+        error = QString("Connection %1 not found").arg(connectionName);
+        return QSqlDatabase();
+    }
+
+    QThread* thread = QThread::currentThread();
+
+    int index = indexOf(connectionName);
+    if (index < 0) {
+        // named connection is created in gui thread
+        mEntries.append({connectionName, connectionName, qApp->thread(), false, false, now()});
+        index = mEntries.size() - 1;
+    }
+    if (!mEntries[index].leased && mEntries[index].thread == thread) {
+        mEntries[index].leased = true;
+        return QSqlDatabase::database(connectionName);
+    }
+
+    for(int i=0;i<mEntries.size();i++) {
+        Entry& entry = mEntries[i];
+        if (entry.connectionName != connectionName || entry.name == connectionName
+                || entry.leased || entry.stale || entry.thread != thread) {
+            continue;
+        }
+        QSqlDatabase db = QSqlDatabase::database(entry.name, false);
+        if (!db.isValid()) {
+            // thread that opened it is gone and its address is reused
+            entry.stale = true;
+            continue;
+        }
+        if (now() - entry.releasedAt > qint64(pingAfterSecs) * 1000 && !ping(db)) {
+            entry.stale = true;
+            continue;
+        }
+        entry.leased = true;
+        return db;
+    }
+
+    // opening may take a while, pool is not locked meanwhile
+    QString name = QString("%1#%2").arg(connectionName).arg(++mCounter);
+    mEntries.append({connectionName, name, thread, true, false, now()});
+    if (thread != qApp->thread() && !mWatched.contains(thread)) {
+        mWatched.insert(thread);
+        // finished is emitted in thread itself, where its connections can be closed
+        QObject::connect(thread, &QThread::finished, thread, [thread](){
+            ConnectionPool::instance()->closeThread(thread);
+        }, Qt::DirectConnection);
+    }
+    locker.unlock();
+
+    bool ok;
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(connectionName, name);
+        ok = db.open();
+        if (!ok) {
+            error = db.lastError().text();
+        }
+    }
+
+    locker.relock();
+    if (!ok) {
+        int i = indexOf(name);
+        if (i > -1) {
+            mEntries.removeAt(i);
+        }
+        QSqlDatabase::removeDatabase(name);
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(name, false);
+}
+
+void ConnectionPool::release(const QString &name, bool discard)
+{
+    QMutexLocker locker(&mMutex);
+    int index = indexOf(name);
+    if (index < 0) {
+        return;
+    }
+    Entry& entry = mEntries[index];
+    if (entry.name == entry.connectionName) {
+        if (discard && entry.thread == QThread::currentThread()) {
+            // named connection is kept, session state is reset by reopening it,
+            // closing rolls back open transaction. It stays leased meanwhile
+            locker.unlock();
+            {
+                QSqlDatabase db = QSqlDatabase::database(name, false);
+                db.close();
+                if (!db.open()) {
+                    qDebug() << db.lastError().text() << __FILE__ << __LINE__;
+                }
+            }
+            locker.relock();
+            index = indexOf(name);
+            if (index < 0) {
+                return;
+            }
+        }
+        mEntries[index].leased = false;
+        mEntries[index].releasedAt = now();
+        return;
+    }
+    entry.leased = false;
+    entry.releasedAt = now();
+    if (discard) {
+        entry.stale = true;
+    }
+    int idle = 0;
+    for(const Entry& other: std::as_const(mEntries)) {
+        if (other.connectionName == entry.connectionName && other.name != other.connectionName
+                && !other.leased && other.thread == entry.thread) {
+            idle++;
+        }
+    }
+    if (idle > maxIdle) {
+        entry.stale = true;
+    }
+    closeExpired();
+}
+
+void ConnectionPool::removeConnection(const QString &connectionName)
+{
+    QMutexLocker locker(&mMutex);
+    for(int i=mEntries.size()-1;i>=0;i--) {
+        Entry& entry = mEntries[i];
+        if (entry.connectionName != connectionName) {
+            continue;
+        }
+        if (entry.name == connectionName) {
+            mEntries.removeAt(i);
+            continue;
+        }
+        entry.stale = true;
+    }
+    closeExpired();
+}
+
+int ConnectionPool::leasedCount(const QString &connectionName)
+{
+    QMutexLocker locker(&mMutex);
+    int count = 0;
+    for(const Entry& entry: std::as_const(mEntries)) {
+        if (entry.connectionName == connectionName && entry.leased) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int ConnectionPool::openCount(const QString &connectionName)
+{
+    QMutexLocker locker(&mMutex);
+    int count = 0;
+    for(const Entry& entry: std::as_const(mEntries)) {
+        if (entry.connectionName == connectionName && !entry.stale) {
+            count++;
+        }
+    }
+    return count;
+}
+
+ConnectionLease::ConnectionLease(const QString &connectionName) : mDiscard(false)
+{
+    QSqlDatabase db = ConnectionPool::instance()->lease(connectionName, mError);
+    mName = db.connectionName();
+}
+
+ConnectionLease::~ConnectionLease()
+{
+    if (!mName.isEmpty()) {
+        ConnectionPool::instance()->release(mName, mDiscard);
+    }
+}
+
+QSqlDatabase ConnectionLease::database() const
+{
+    if (mName.isEmpty()) {
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(mName, false);
+}
+
+QString ConnectionLease::error() const
+{
+    return mError;
+}
+
+bool ConnectionLease::isValid() const
+{
+    return !mName.isEmpty();
+}
+
+void ConnectionLease::discard()
+{
+    mDiscard = true;
+}
@@ -0,0 +1,99 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QString>
+#include <QList>
+#include <QSet>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <functional>
+class QThread;
+class QThreadPool;
+
+// Connections cloned from named connection (opened by DatabaseConnectDialog) with
+// the same driver, credentials and options. Each user (session, schema pull, background job)
+// leases its own connection and returns it on release. Released connections are kept open
+// per thread (QSqlDatabase can only be used in thread that opened it), checked with ping
+// when idle for long and closed when idle for too long. Clones of other threads are closed
+// in their thread when it finishes, worker threads expire after threadExpirySecs idle.
+
+class ConnectionPool
+{
+public:
+    static ConnectionPool* instance();
+
+    // named connection itself when it's not leased and caller is in its thread, otherwise idle or new clone
+    QSqlDatabase lease(const QString& connectionName, QString& error);
+
+    // takes name of leased connection, copies of QSqlDatabase should be destroyed by then,
+    // discarded clone is closed instead of being reused, discarded named connection is reopened
+    void release(const QString& name, bool discard = false);
+
+    // closes idle clones, leased clones are closed on release
+    void removeConnection(const QString& connectionName);
+
+    int leasedCount(const QString& connectionName);
+    int openCount(const QString& connectionName);
+
+    // threads shared by background jobs that lease connections (fan out, load test, dump, copy, diff...)
+    static QThreadPool* workers();
+    // runs fn on worker thread right away, even when all threads are busy:
+    // jobs start exactly as many workers as they need and some wait for each other
+    static void startWorker(const std::function<void()>& fn);
+
+    static const int maxIdle = 4;
+    static const int pingAfterSecs = 60;
+    static const int closeAfterSecs = 600;
+    static const int threadExpirySecs = 60;
+
+protected:
+    struct Entry {
+        QString connectionName;
+        QString name;
+        QThread* thread;
+        bool leased;
+        bool stale;
+        qint64 releasedAt;
+    };
+
+    ConnectionPool();
+    static ConnectionPool* mInstance;
+
+    static bool ping(QSqlDatabase& db);
+    static qint64 now();
+    void closeExpired();
+    // called in finishing thread
+    void closeThread(QThread* thread);
+    int indexOf(const QString& name) const;
+
+    QMutex mMutex;
+    QList<Entry> mEntries;
+    QSet<QThread*> mWatched;
+    int mCounter;
+};
+
+// Lease released in destructor
+
+class ConnectionLease
+{
+public:
+    ConnectionLease(const QString& connectionName);
+    ~ConnectionLease();
+
+    QSqlDatabase database() const;
+    QString error() const;
+    bool isValid() const;
+
+    // session state was changed (settings, temporary tables), connection should not be reused
+    void discard();
+
+protected:
+    QString mName;
+    QString mError;
+    bool mDiscard;
+
+private:
+    Q_DISABLE_COPY(ConnectionLease)
+};
+
+#endif // CONNECTIONPOOL_H
@@ -17,7 +17,8 @@ namespace DataFormat
     enum ActionType {
         ActionNone,
         ActionCopy,
-        ActionSave
+        ActionSave,
+        ActionView
     };
 
     void initComboBox(QComboBox* comboBox, bool onlySql = false);
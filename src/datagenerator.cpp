@@ -0,0 +1,564 @@
+#include "datagenerator.h"
+
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QDateTime>
+#include <QUuid>
+#include <QtEndian>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <cmath>
+
+#include "bulkinsert.h"
+#include "connectionpool.h"
+#include "drivernames.h"
+#include "sqldatatypes.h"
+#include "trace.h"
+
+namespace {
+
+struct Plan {
+    QString name;
+    QList<DataGenerator::Column> columns;
+    QStringList columnNames;
+    qint64 rows = 0;
+    // number of first generated row, rows that exist before are not referenced
+    qint64 offset = 0;
+    quint32 seed = 0;
+    // per relation: parent row count and offset, parent key columns and whether child takes parent rows in turn
+    QList<qint64> parentRows;
+    QList<qint64> parentOffsets;
+    QList<QList<DataGenerator::Column>> parentColumns;
+    QList<bool> oneToOne;
+    // relation to the same table
+    QList<bool> self;
+};
+
+int indexOf(const QList<DataGenerator::Column>& columns, const QString& name) {
+    for(int i=0;i<columns.size();i++) {
+        if (columns[i].name.compare(name, Qt::CaseInsensitive) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool isNumber(QMetaType::Type type) {
+    return type == QMetaType::Int || type == QMetaType::LongLong || type == QMetaType::Double;
+}
+
+// row count or largest value of numeric distinct column, whichever is greater
+qint64 existingRows(QSqlDatabase db, const Plan& plan) {
+    QSqlDriver* driver = db.driver();
+    QStringList columns = {"COUNT(*)"};
+    for(const DataGenerator::Column& column: plan.columns) {
+        if (column.unique && column.options.isEmpty() && isNumber(column.type)) {
+            columns.append(QString("MAX(%1)").arg(driver->escapeIdentifier(column.name, QSqlDriver::FieldName)));
+        }
+    }
+    QSqlQuery q(db);
+    if (!q.exec(QString("SELECT %1 FROM %2").arg(columns.join(", "), driver->escapeIdentifier(plan.name, QSqlDriver::TableName)))
+            || !q.next()) {
+        qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+        return 0;
+    }
+    qint64 res = 0;
+    for(int i=0;i<columns.size();i++) {
+        bool ok;
+        qint64 value = q.value(i).toLongLong(&ok);
+        if (!ok) {
+            value = qint64(q.value(i).toDouble());
+        }
+        res = qMax(res, value);
+    }
+    return res;
+}
+
+// serial and identity columns of postgres continue after inserted values
+void syncSequences(QSqlDatabase db, const Plan& plan) {
+    if (db.driverName() != DRIVER_PSQL) {
+        return;
+    }
+    QSqlDriver* driver = db.driver();
+    QString table = driver->escapeIdentifier(plan.name, QSqlDriver::TableName);
+    for(const DataGenerator::Column& column: plan.columns) {
+        if (!column.unique || (column.type != QMetaType::Int && column.type != QMetaType::LongLong)) {
+            continue;
+        }
+        QSqlQuery q(db);
+        q.prepare(QString("SELECT setval(seq, (SELECT MAX(%1) FROM %2)) FROM (SELECT pg_get_serial_sequence(?, ?) AS seq) s "
+                          "WHERE seq IS NOT NULL").arg(driver->escapeIdentifier(column.name, QSqlDriver::FieldName), table));
+        // table name is parsed as identifier, column name is taken literally
+        q.addBindValue(table);
+        q.addBindValue(column.name);
+        if (!q.exec()) {
+            qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+        }
+    }
+}
+
+}
+
+struct DataGenerator::State {
+    QString connectionName;
+    QList<Plan> plans;
+    QAtomicInteger<qint64> nextChunk;
+    QAtomicInt active;
+    QAtomicInt cancelled;
+    QMutex mutex;
+    QStringList errors;
+    DataGenerator* owner = nullptr;
+};
+
+DataGenerator::DataGenerator(const QString &connectionName, QObject *parent)
+    : QObject{parent}, mState(new State()), mConnectionName(connectionName),
+      mConcurrency(1), mTable(0), mRows(0), mFinished(false)
+{
+    mState->connectionName = connectionName;
+    mState->owner = this;
+}
+
+DataGenerator::~DataGenerator()
+{
+    // running workers keep state alive and stop after current chunk
+    mState->cancelled.storeRelease(1);
+    QMutexLocker locker(&mState->mutex);
+    mState->owner = nullptr;
+}
+
+QStringList DataGenerator::order(const QStringList &tables, const QList<SRelation> &relations, QStringList *cyclic)
+{
+    QMap<QString, QStringList> parents;
+    for(const SRelation& relation: relations) {
+        // self reference doesn't affect order
+        if (relation.childTable != relation.parentTable && tables.contains(relation.parentTable)) {
+            parents[relation.childTable].append(relation.parentTable);
+        }
+    }
+    QStringList res;
+    QStringList pending = tables;
+    bool added = true;
+    while (!pending.isEmpty() && added) {
+        added = false;
+        for(int i=0;i<pending.size();) {
+            bool ready = true;
+            for(const QString& parent: parents.value(pending[i])) {
+                if (!res.contains(parent)) {
+                    ready = false;
+                    break;
+                }
+            }
+            if (ready) {
+                res.append(pending.takeAt(i));
+                added = true;
+            } else {
+                i++;
+            }
+        }
+    }
+    if (cyclic) {
+        *cyclic = pending;
+    }
+    res.append(pending);
+    return res;
+}
+
+DataGenerator::Column DataGenerator::column(const SColumn &column, bool unique)
+{
+    Column res;
+    res.name = column.name;
+    res.type = SqlDataTypes::fromDriverType(column.type, &res.size, &res.scale);
+    res.notNull = column.notNull;
+    res.unique = unique;
+
+    QString type = column.type.toLower();
+    if (type.startsWith("enum") || type.startsWith("set")) {
+        res.set = type.startsWith("set");
+        static QRegularExpression rx("'((?:[^']|'')*)'");
+        auto it = rx.globalMatch(column.type);
+        while (it.hasNext()) {
+            res.options.append(it.next().captured(1).replace("''", "'"));
+        }
+        // length applies to words and not to options
+        res.size = 0;
+    }
+
+    switch (res.type) {
+    case QMetaType::Int:
+        if (type.startsWith("tinyint")) {
+            res.maximum = 127;
+        } else if (type.startsWith("smallint") || type == "int2" || type == "year") {
+            res.maximum = type == "year" ? 2100 : 32767;
+        } else {
+            res.maximum = 1000000;
+        }
+        break;
+    case QMetaType::LongLong:
+        res.maximum = 1000000000;
+        break;
+    case QMetaType::Double:
+        // numeric(p,s) fits p - s digits before point
+        res.maximum = res.size > res.scale ? qMin(std::pow(10.0, res.size - res.scale) - 1, 1e6) : 1e6;
+        if (res.size == 0) {
+            res.scale = 2;
+        }
+        break;
+    default:
+        break;
+    }
+    return res;
+}
+
+QVariant DataGenerator::uniqueValue(const Column &column, qint64 row)
+{
+    qint64 n = row + 1;
+    if (column.set && !column.options.isEmpty()) {
+        // options of bits set in row number
+        QStringList res;
+        for(int i=0;i<column.options.size() && i<62;i++) {
+            if (n & (qint64(1) << i)) {
+                res.append(column.options[i]);
+            }
+        }
+        return res.join(",");
+    }
+    if (!column.options.isEmpty()) {
+        return column.options[int(row % column.options.size())];
+    }
+    switch (column.type) {
+    case QMetaType::Bool:
+        return n % 2 == 0;
+    case QMetaType::Int:
+        return int(n);
+    case QMetaType::LongLong:
+        return n;
+    case QMetaType::Double:
+        return double(n);
+    case QMetaType::QDate:
+        return QDate(1970, 1, 1).addDays(n);
+    case QMetaType::QTime:
+        return QTime(0, 0).addMSecs(int(n % 86400000));
+    case QMetaType::QDateTime:
+        return QDateTime(QDate(1970, 1, 1), QTime(0, 0), Qt::UTC).addSecs(n);
+    case QMetaType::QByteArray: {
+        QByteArray res(8, '\0');
+        qToBigEndian<qint64>(n, res.data());
+        return res;
+    }
+    case QMetaType::QUuid: {
+        QByteArray bytes(16, '\0');
+        qToBigEndian<qint64>(n, bytes.data() + 8);
+        return QUuid::fromRfc4122(bytes).toString(QUuid::WithoutBraces);
+    }
+    default:
+        break;
+    }
+    QString res = QString("%1 %2").arg(column.name).arg(n);
+    if (column.size > 0 && res.size() > column.size) {
+        res = QString::number(n, 36);
+    }
+    return res;
+}
+
+qint64 DataGenerator::uniqueCount(const Column &column)
+{
+    if (column.options.isEmpty()) {
+        return -1;
+    }
+    if (column.set) {
+        // nonempty subsets
+        return (qint64(1) << qMin(int(column.options.size()), 62)) - 1;
+    }
+    return column.options.size();
+}
+
+QVariant DataGenerator::randomValue(const Column &column, QRandomGenerator &random)
+{
+    if (!column.options.isEmpty()) {
+        return column.options[random.bounded(int(column.options.size()))];
+    }
+    switch (column.type) {
+    case QMetaType::Bool:
+        return random.bounded(2) == 1;
+    case QMetaType::Int:
+        return random.bounded(int(column.maximum) + 1);
+    case QMetaType::LongLong:
+        return random.bounded(qint64(column.maximum) + 1);
+    case QMetaType::Double: {
+        double scale = std::pow(10.0, column.scale);
+        return std::floor(random.generateDouble() * column.maximum * scale) / scale;
+    }
+    case QMetaType::QDate:
+        return QDate(2000, 1, 1).addDays(random.bounded(9000));
+    case QMetaType::QTime:
+        return QTime(0, 0).addSecs(random.bounded(86400));
+    case QMetaType::QDateTime:
+        return QDateTime(QDate(2000, 1, 1), QTime(0, 0), Qt::UTC).addSecs(random.bounded(qint64(9000) * 86400));
+    case QMetaType::QByteArray: {
+        QByteArray res(16, '\0');
+        random.fillRange(reinterpret_cast<quint32*>(res.data()), 4);
+        return res;
+    }
+    case QMetaType::QUuid: {
+        QByteArray bytes(16, '\0');
+        random.fillRange(reinterpret_cast<quint32*>(bytes.data()), 4);
+        return QUuid::fromRfc4122(bytes).toString(QUuid::WithoutBraces);
+    }
+    default:
+        break;
+    }
+    static const QStringList words = {"alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel",
+                                      "india", "juliet", "kilo", "lima", "mike", "november", "oscar", "papa"};
+    QString res = words[random.bounded(int(words.size()))];
+    int count = random.bounded(3);
+    for(int i=0;i<count;i++) {
+        res += " " + words[random.bounded(int(words.size()))];
+    }
+    res += QString(" %1").arg(random.bounded(10000));
+    if (column.size > 0) {
+        res = res.left(column.size);
+    }
+    return res;
+}
+
+void DataGenerator::start(const QList<Table> &tables, const QList<SRelation> &relations, int concurrency, quint32 seed)
+{
+    QStringList names;
+    for(const Table& table: tables) {
+        names.append(table.table.name);
+    }
+    QStringList ordered = order(names, relations);
+
+    QMap<QString, Plan> plans;
+    for(const Table& table: tables) {
+        Plan plan;
+        plan.name = table.table.name;
+        plan.rows = table.rows;
+        plan.seed = seed ^ qHash(plan.name);
+        for(const SColumn& column: table.table.columns) {
+            plan.columns.append(this->column(column, table.unique.contains(column.name, Qt::CaseInsensitive)));
+            plan.columnNames.append(column.name);
+        }
+        plans[plan.name] = plan;
+    }
+
+    // referenced columns must be distinct to be found by child rows
+    QList<SRelation> used;
+    for(const SRelation& relation: relations) {
+        if (!plans.contains(relation.childTable) || !plans.contains(relation.parentTable)) {
+            continue;
+        }
+        Plan& parent = plans[relation.parentTable];
+        bool ok = relation.childColumns.size() == relation.parentColumns.size();
+        for(int i=0;ok && i<relation.parentColumns.size();i++) {
+            ok = indexOf(parent.columns, relation.parentColumns[i]) > -1
+                    && indexOf(plans[relation.childTable].columns, relation.childColumns[i]) > -1;
+        }
+        if (!ok) {
+            continue;
+        }
+        for(const QString& name: relation.parentColumns) {
+            parent.columns[indexOf(parent.columns, name)].unique = true;
+        }
+        used.append(relation);
+    }
+
+    {
+        ConnectionLease lease(mConnectionName);
+        for(Plan& plan: plans) {
+            plan.offset = lease.isValid() ? existingRows(lease.database(), plan) : 0;
+            // enum and set columns run out of distinct values
+            for(const Column& column: std::as_const(plan.columns)) {
+                qint64 count = uniqueCount(column);
+                if (column.unique && count > -1) {
+                    plan.rows = qBound<qint64>(0, count - plan.offset, plan.rows);
+                }
+            }
+        }
+    }
+
+    for(const SRelation& relation: std::as_const(used)) {
+        Plan& child = plans[relation.childTable];
+        const Plan& parent = plans[relation.parentTable];
+        int index = child.parentRows.size();
+        QList<Column> parentColumns;
+        bool oneToOne = false;
+        for(int i=0;i<relation.childColumns.size();i++) {
+            Column& column = child.columns[indexOf(child.columns, relation.childColumns[i])];
+            column.relation = index;
+            column.position = i;
+            oneToOne = oneToOne || column.unique;
+            parentColumns.append(parent.columns[indexOf(parent.columns, relation.parentColumns[i])]);
+        }
+        child.parentRows.append(parent.rows);
+        child.parentOffsets.append(parent.offset);
+        child.parentColumns.append(parentColumns);
+        child.oneToOne.append(oneToOne);
+        child.self.append(relation.childTable == relation.parentTable);
+    }
+
+    for(const QString& name: std::as_const(ordered)) {
+        mState->plans.append(plans[name]);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(mConnectionName, false);
+    // sqlite locks whole database on write
+    mConcurrency = db.driverName() == DRIVER_SQLITE ? 1 : qMax(1, concurrency);
+    mTable = 0;
+    mRows = 0;
+    mFinished = false;
+    startTable();
+}
+
+void DataGenerator::startTable()
+{
+    while (mTable < mState->plans.size() && mState->plans[mTable].rows <= 0) {
+        mTable++;
+    }
+    if (mTable >= mState->plans.size() || mState->cancelled.loadAcquire()) {
+        mFinished = true;
+        emit finished();
+        return;
+    }
+    const Plan& plan = mState->plans[mTable];
+    qint64 chunks = (plan.rows + chunkSize - 1) / chunkSize;
+    int workers = int(qMin<qint64>(mConcurrency, chunks));
+    mState->nextChunk.storeRelease(0);
+    mState->active.storeRelease(workers);
+    QSharedPointer<State> state = mState;
+    int table = mTable;
+    for(int i=0;i<workers;i++) {
+        ConnectionPool::startWorker([state, table](){
+            run(state, table);
+        });
+    }
+}
+
+void DataGenerator::run(QSharedPointer<State> state, int table)
+{
+    TRACE_SCOPE("DataGenerator::run");
+    const Plan& plan = state->plans[table];
+    qint64 chunks = (plan.rows + chunkSize - 1) / chunkSize;
+
+    auto fail = [&](const QString& error) {
+        QMutexLocker locker(&state->mutex);
+        state->errors.append(QString("%1: %2").arg(plan.name, error));
+        state->cancelled.storeRelease(1);
+    };
+
+    {
+        ConnectionLease lease(state->connectionName);
+        if (!lease.isValid()) {
+            fail(lease.error());
+        }
+        qint64 chunk = 0;
+        while (lease.isValid() && !state->cancelled.loadAcquire()
+               && (chunk = state->nextChunk.fetchAndAddOrdered(1)) < chunks) {
+            // chunk seed makes data same regardless of number of workers
+            QRandomGenerator random(plan.seed ^ quint32(chunk * 2654435761u));
+            qint64 begin = plan.offset + chunk * chunkSize;
+            qint64 end = qMin(begin + chunkSize, plan.offset + plan.rows);
+            QList<QVariantList> rows;
+            rows.reserve(int(end - begin));
+            QList<qint64> parentRow(plan.parentRows.size());
+            for(qint64 row=begin;row<end;row++) {
+                for(int r=0;r<plan.parentRows.size();r++) {
+                    qint64 count = plan.parentRows[r];
+                    if (count < 1) {
+                        parentRow[r] = -1;
+                    } else if (plan.self[r]) {
+                        // earlier chunks may still be inserting, so parent is earlier row of this chunk or row itself
+                        parentRow[r] = plan.oneToOne[r] ? row : row - random.bounded(row - begin + 1);
+                    } else {
+                        parentRow[r] = plan.parentOffsets[r] + (plan.oneToOne[r] ? (row - plan.offset) % count : random.bounded(count));
+                    }
+                }
+                QVariantList values;
+                values.reserve(plan.columns.size());
+                for(const Column& column: plan.columns) {
+                    bool null = !column.notNull && !column.unique && random.bounded(100) < nullPercent;
+                    if (column.relation > -1) {
+                        qint64 parent = parentRow[column.relation];
+                        if (parent < 0) {
+                            values.append(QVariant());
+                        } else {
+                            values.append(uniqueValue(plan.parentColumns[column.relation][column.position], parent));
+                        }
+                    } else if (column.unique) {
+                        values.append(uniqueValue(column, row));
+                    } else if (null) {
+                        values.append(QVariant());
+                    } else {
+                        values.append(randomValue(column, random));
+                    }
+                }
+                rows.append(values);
+            }
+            QString error;
+            if (!BulkInsert::insert(lease.database(), plan.name, plan.columnNames, rows, error)) {
+                fail(error);
+                break;
+            }
+            QMutexLocker locker(&state->mutex);
+            if (state->owner) {
+                QMetaObject::invokeMethod(state->owner, "onChunkFinished", Qt::QueuedConnection, Q_ARG(int, int(rows.size())));
+            }
+        }
+    }
+
+    if (state->active.fetchAndSubOrdered(1) == 1) {
+        {
+            ConnectionLease lease(state->connectionName);
+            if (lease.isValid()) {
+                syncSequences(lease.database(), plan);
+            }
+        }
+        QMutexLocker locker(&state->mutex);
+        if (state->owner) {
+            QMetaObject::invokeMethod(state->owner, "onTableFinished", Qt::QueuedConnection);
+        }
+    }
+}
+
+void DataGenerator::onChunkFinished(int rows)
+{
+    mRows += rows;
+    emit progress(mRows);
+}
+
+void DataGenerator::onTableFinished()
+{
+    emit tableFinished(mState->plans[mTable].name);
+    mTable++;
+    startTable();
+}
+
+void DataGenerator::cancel()
+{
+    mState->cancelled.storeRelease(1);
+}
+
+bool DataGenerator::isFinished() const
+{
+    return mFinished;
+}
+
+QStringList DataGenerator::errors() const
+{
+    QMutexLocker locker(&mState->mutex);
+    return mState->errors;
+}
+
+qint64 DataGenerator::totalRows() const
+{
+    qint64 res = 0;
+    for(const Plan& plan: std::as_const(mState->plans)) {
+        res += plan.rows;
+    }
+    return res;
+}
@@ -0,0 +1,100 @@
+#ifndef DATAGENERATOR_H
+#define DATAGENERATOR_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVariant>
+#include "sdata.h"
+class QRandomGenerator;
+
+// Fills tables with synthetic rows for load testing. Values follow column types
+// (SqlDataTypes::fromDriverType), columns of primary keys and unique indexes get distinct values
+// and foreign key columns take keys of random parent rows. Distinct values are function of
+// row number, so parent keys are not kept in memory: tables are filled in topological order of
+// relations and child row refers to parent row number. Rows are appended: row numbers continue after
+// existing row count or largest value of numeric distinct column, and postgres sequences of these
+// columns are moved past inserted values. Rows are generated in chunks on worker threads, each worker
+// inserts its chunks with BulkInsert on connection leased from ConnectionPool.
+
+class DataGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    struct Table {
+        STable table;
+        // columns with distinct values
+        QStringList unique;
+        qint64 rows = 0;
+    };
+
+    struct Column {
+        QString name;
+        QMetaType::Type type = QMetaType::QString;
+        // length of text, precision of numeric, 0 if not specified
+        int size = 0;
+        int scale = 0;
+        // upper bound of random numbers
+        double maximum = 0;
+        bool notNull = false;
+        bool unique = false;
+        // values of enum and set columns
+        QStringList options;
+        // set column, value is comma separated subset of options
+        bool set = false;
+        // index of relation and position of column in it, -1 if column is not foreign key
+        int relation = -1;
+        int position = -1;
+    };
+
+    explicit DataGenerator(const QString& connectionName, QObject* parent = nullptr);
+    ~DataGenerator();
+
+    // relations to tables that are not generated are ignored, sqlite connections use one worker
+    void start(const QList<Table>& tables, const QList<SRelation>& relations, int concurrency, quint32 seed = 1);
+
+    // chunks that not started yet are skipped
+    void cancel();
+
+    bool isFinished() const;
+    QStringList errors() const;
+    qint64 totalRows() const;
+
+    // parents before children, tables in cycles are appended at the end in input order
+    static QStringList order(const QStringList& tables, const QList<SRelation>& relations, QStringList* cyclic = nullptr);
+
+    static Column column(const SColumn& column, bool unique);
+
+    // distinct value of row, same for same row
+    static QVariant uniqueValue(const Column& column, qint64 row);
+    // number of distinct values of enum and set columns, -1 if unlimited
+    static qint64 uniqueCount(const Column& column);
+
+    static QVariant randomValue(const Column& column, QRandomGenerator& random);
+
+    static const int chunkSize = 10000;
+    static const int nullPercent = 5;
+
+signals:
+    void progress(qint64 rows);
+    void tableFinished(QString table);
+    void finished();
+
+protected slots:
+    void onChunkFinished(int rows);
+    void onTableFinished();
+
+protected:
+    struct State;
+    static void run(QSharedPointer<State> state, int table);
+    void startTable();
+
+    QSharedPointer<State> mState;
+    QString mConnectionName;
+    int mConcurrency;
+    int mTable;
+    qint64 mRows;
+    bool mFinished;
+};
+
+#endif // DATAGENERATOR_H
@@ -17,6 +17,8 @@
 #include "sqldatatypes.h"
 #include "settings.h"
 #include "drivernames.h"
+#include "largevaluemodel.h"
+#include "fastformat.h"
 
 namespace {
 
@@ -40,7 +42,7 @@ QVariantList filterData(QAbstractItemModel *model, int row, const QList<bool>& f
     QVariantList res;
     for(int c=0; c<model->columnCount(); c++) {
         if (filter[c]) {
-            res << model->data(model->index(row,c));
+            res << LargeValueModel::fullData(model, model->index(row,c));
         }
     }
     return res;
@@ -49,7 +51,7 @@ QVariantList filterData(QAbstractItemModel *model, int row, const QList<bool>& f
 QVariantList modelRow(QAbstractItemModel *model, int row) {
     QVariantList res;
     for(int c=0; c<model->columnCount(); c++) {
-        res << model->data(model->index(row,c));
+        res << LargeValueModel::fullData(model, model->index(row,c));
     }
     return res;
 }
@@ -124,90 +126,106 @@ QStringList DataStreamer::variantListToStringList(const QVariantList& values,
     return res;
 }
 
-QString DataStreamer::variantToString(const QVariant& value,
-                                      DataFormat::Format format,
-                                      const Formats& formats,
-                                      const QLocale& locale,
-                                      QString& error) {
+void DataStreamer::appendVariant(QString &out,
+                                 const QVariant &value,
+                                 DataFormat::Format format,
+                                 const Formats &formats,
+                                 const QLocale &locale,
+                                 QString &error) {
 
-    QString t;
+    if (format != DataFormat::Csv && format != DataFormat::Tsv) {
+        out.append(variantToString(value, format, formats, locale, error));
+        return;
+    }
 
-    if (format == DataFormat::Csv || format == DataFormat::Tsv) {
-        if (value.isNull()) {
-            return "";
-        }
-        switch(value.typeId()) {
-        case QMetaType::Int:
-            return QString::number(value.toInt());
-        case QMetaType::UInt:
-            return QString::number(value.toUInt());
-        case QMetaType::LongLong:
-            return QString::number(value.toLongLong());
-        case QMetaType::ULongLong:
-            return QString::number(value.toULongLong());
-        case QMetaType::Double:
-            if (formats.realUseLocale) {
-                return locale.toString(value.toDouble());
-            } else {
-                return QString::number(value.toDouble());
-            }
-        case QMetaType::Bool:
-            return QString::number(value.toInt());
-        case QMetaType::QDate:
-        {
-            QDate value_ = value.toDate();
-            if (formats.dateTimeUseLocale) {
-                return locale.toString(value_,QLocale::ShortFormat);
-            }
-            return value_.toString(formats.dateFormat);
-        }
-        case QMetaType::QDateTime:
-        {
-            QDateTime value_ = value.toDateTime();
-            if (formats.dateTimeUseLocale) {
-                return locale.toString(value_,QLocale::ShortFormat);
-            }
-            return value_.toString(formats.dateFormat + " " + formats.timeFormat);
+    if (value.isNull()) {
+        return;
+    }
+    switch(value.typeId()) {
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+        FastFormat::appendInt(out, value.toLongLong());
+        break;
+    case QMetaType::UInt:
+    case QMetaType::ULongLong:
+        FastFormat::appendUInt(out, value.toULongLong());
+        break;
+    case QMetaType::Double:
+        if (formats.realUseLocale) {
+            out.append(locale.toString(value.toDouble()));
+        } else {
+            FastFormat::appendDouble(out, value.toDouble());
+        }
+        break;
+    case QMetaType::Bool:
+        out.append(QLatin1Char(value.toBool() ? '1' : '0'));
+        break;
+    case QMetaType::QDate:
+        if (formats.dateTimeUseLocale) {
+            out.append(locale.toString(value.toDate(),QLocale::ShortFormat));
+        } else {
+            formats.dateFormatter.append(out, value.toDate());
         }
-        case QMetaType::QTime:
-        {
-            QTime value_ = value.toTime();
-            if (formats.dateTimeUseLocale) {
-                return locale.toString(value_,QLocale::ShortFormat);
-            }
-            return value_.toString(formats.timeFormat);
+        break;
+    case QMetaType::QDateTime:
+        if (formats.dateTimeUseLocale) {
+            out.append(locale.toString(value.toDateTime(),QLocale::ShortFormat));
+        } else {
+            formats.dateTimeFormatter.append(out, value.toDateTime());
         }
-        case QMetaType::QString:
-            return value.toString().replace(QRegularExpression("\\n[\\r]?\\s*")," ");
-        case QMetaType::QByteArray:
-
-        /*{
-            auto* codec = QTextCodec::codecForName("UTF-8");
-            auto* decoder = codec->makeDecoder();
-            QString text = decoder->toUnicode(value.toByteArray());
-            if (!decoder->hasFailure()) {
-                return text;
-            }
-        }*/
+        break;
+    case QMetaType::QTime:
+        if (formats.dateTimeUseLocale) {
+            out.append(locale.toString(value.toTime(),QLocale::ShortFormat));
+        } else {
+            formats.timeFormatter.append(out, value.toTime());
+        }
+        break;
+    case QMetaType::QString:
+        FastFormat::appendSingleLine(out, value.toString());
+        break;
+    case QMetaType::QByteArray:
+
+    /*{
+        auto* codec = QTextCodec::codecForName("UTF-8");
+        auto* decoder = codec->makeDecoder();
+        QString text = decoder->toUnicode(value.toByteArray());
+        if (!decoder->hasFailure()) {
+            return text;
+        }
+    }*/
+
+        out.append(QLatin1String("0x"));
+        out.append(QLatin1String(value.toByteArray().toHex()));
+        break;
+
+    case QMetaType::QVariantList:
+    {
+        QVariantList vs = value.toList();
+        appendVariant(out, vs.value(0), format, formats, locale, error);
+        out.append(QLatin1String(" -> "));
+        appendVariant(out, vs.value(1), format, formats, locale, error);
+        break;
+    }
 
-            return "0x" + value.toByteArray().toHex();
+    default:
+        error = QString("DataStreamer::variantToString(format == %2) is not defined for value.type() == %1").arg(value.typeId()).arg(format);
+    }
+}
 
-        case QMetaType::QVariantList:
-        {
-            QVariantList vs = value.toList();
-            QVariant v1 = vs.value(0);
-            QVariant v2 = vs.value(1);
-            return QString("%1 -> %2")
-                    .arg(variantToString(v1, format, formats, locale, error))
-                    .arg(variantToString(v2, format, formats, locale, error));
-            break;
-        }
+QString DataStreamer::variantToString(const QVariant& value,
+                                      DataFormat::Format format,
+                                      const Formats& formats,
+                                      const QLocale& locale,
+                                      QString& error) {
 
-        default:
-            error = QString("DataStreamer::variantToString(format == %2) is not defined for value.type() == %1").arg(value.typeId()).arg(format);
+    if (format == DataFormat::Csv || format == DataFormat::Tsv) {
+        QString res;
+        appendVariant(res, value, format, formats, locale, error);
+        if (!error.isEmpty()) {
             return QString();
         }
-
+        return res;
     } else if (format == DataFormat::Json) {
         return variantToJson(value).toString();
     } else if (format == DataFormat::SqlInsert || format == DataFormat::SqlUpdate) {
@@ -226,7 +244,7 @@ QString DataStreamer::variantToString(const QVariant& value,
         case QMetaType::LongLong:
             return QString::number(value.toLongLong());
         case QMetaType::Double:
-            return QString::number(value.toDouble());
+            return FastFormat::number(value.toDouble());
         case QMetaType::QDate:
             return "'" + value.toDate().toString("yyyy-MM-dd") + "'";
         case QMetaType::QDateTime:
@@ -437,6 +455,69 @@ QString DataStreamer::stream(DataFormat::Format format,
     return result;
 }
 
+void DataStreamer::insertValues(QAbstractItemModel *model,
+                                const QList<Field> &fields,
+                                int minYear,
+                                bool inLocal,
+                                bool outUtc,
+                                const QLocale &locale,
+                                QStringList *columns,
+                                QList<QVariantList> *rows) {
+
+    QMap<QString,QMetaType::Type> m = SqlDataTypes::mapToVariant();
+
+    QList<int> fieldColumns;
+    for(int c=0;c<fields.size();c++) {
+        if (!fields[c].name().isEmpty()) {
+            fieldColumns.append(c);
+        }
+    }
+
+    QList<bool> hasValues(fieldColumns.size(), false);
+    QList<QVariantList> values;
+
+    for(int r=0;r < model->rowCount();r++) {
+        QVariantList row;
+        bool empty = true;
+        for(int i=0;i<fieldColumns.size();i++) {
+            int c = fieldColumns[i];
+            bool ok = false;
+            QVariant v = SqlDataTypes::tryConvert(model->data(model->index(r,c)),
+                        m[fields[c].type()], locale, minYear, inLocal, outUtc, &ok);
+            if (!v.isNull()) {
+                empty = false;
+                hasValues[i] = true;
+            }
+            row.append(v);
+        }
+        if (!empty) {
+            values.append(row);
+        }
+    }
+
+    QList<int> keep;
+    columns->clear();
+    for(int i=0;i<fieldColumns.size();i++) {
+        const Field& field = fields[fieldColumns[i]];
+        if (field.autoincrement() && !hasValues[i]) {
+            continue;
+        }
+        keep.append(i);
+        columns->append(field.name());
+    }
+
+    rows->clear();
+    rows->reserve(values.size());
+    for(const QVariantList& row: std::as_const(values)) {
+        QVariantList kept;
+        kept.reserve(keep.size());
+        for(int i: std::as_const(keep)) {
+            kept.append(row[i]);
+        }
+        rows->append(kept);
+    }
+}
+
 #if 0
 static QString prepareIdentifier(const QString &identifier,
         QSqlDriver::IdentifierType type, const QSqlDriver *driver)
@@ -555,6 +636,11 @@ QString DataStreamer::createTableStatement(const QSqlDatabase &db, const QString
 
         QString type = specific[variant[field.type()]];
 
+        if (!variant.contains(field.type())) {
+            // driver type such as DECIMAL(10,2)
+            type = field.type();
+        }
+
         if (driverName == DRIVER_PSQL && field.autoincrement() && variant[field.type()] == QMetaType::Int) {
             type = "SERIAL";
         }
@@ -632,11 +718,22 @@ void DataStreamer::stream(const QSqlDatabase& db, QTextStream &stream, QSqlQuery
 
         stream << filterHeader(model,data).join(sep) << "\n";
 
+        // line buffer keeps its capacity between rows
+        QString line;
         for(int r=0; r<rowCount; r++) {
-            stream << variantListToStringList(filterData(model,r,data),format,formats,locale,error).join(sep) << "\n";
-            if (!error.isEmpty()) {
-                return;
+            line.resize(0);
+            QVariantList values = filterData(model,r,data);
+            for(int i=0;i<values.size();i++) {
+                if (i > 0) {
+                    line.append(sep);
+                }
+                appendVariant(line,values[i],format,formats,locale,error);
+                if (!error.isEmpty()) {
+                    return;
+                }
             }
+            line.append(QLatin1Char('\n'));
+            stream << line;
         }
 
     } else if (format == DataFormat::Json) {
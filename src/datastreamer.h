@@ -31,11 +31,17 @@ public:
     static QString variantToString(const QVariant &value, DataFormat::Format format,
                                    const Formats& formats, const QLocale& locale,
                                    QString& error);
+    static void appendVariant(QString& out, const QVariant &value, DataFormat::Format format,
+                              const Formats& formats, const QLocale& locale,
+                              QString& error);
 
     static QString createTableStatement(const QSqlDatabase &db, const QString &table, const QList<Field> &fields, bool ifNotExists);
 
     static QString stream(DataFormat::Format format, const QSqlDatabase &db, QAbstractItemModel *model, int rowCount, const QString &table, const QList<Field> &fields, int dataColumns, int minYear, bool inLocal, bool outUtc, const QLocale &locale, bool *hasMore, QString &error);
 
+    // typed values of non empty rows for bulk insert, autoincrement columns without values are omitted
+    static void insertValues(QAbstractItemModel *model, const QList<Field> &fields, int minYear, bool inLocal, bool outUtc, const QLocale &locale, QStringList *columns, QList<QVariantList> *rows);
+
     static QStringList createIndexStatements(const QSqlDatabase &db, const QString &table, const QList<Field> &fields);
     static QString streamJson(const QSqlDatabase &db, QAbstractItemModel *model, int rowCount, const QString &table, const QList<Field> &fields, int dataColumns, int minYear, bool inLocal, bool outUtc, const QLocale &locale, bool *hasMore, QString &error);
     static QJsonValue variantToJson(const QVariant &v);
@@ -0,0 +1,299 @@
+#include "datetimeformatter.h"
+
+#include <QDateTime>
+#include <QLocale>
+
+namespace {
+
+void appendPadded(QString& out, int value, int width) {
+    if (value < 0) {
+        out.append(QLatin1Char('-'));
+        value = -value;
+    }
+    char buf[16];
+    int len = 0;
+    do {
+        buf[len++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    for(int i=len;i<width;i++) {
+        out.append(QLatin1Char('0'));
+    }
+    while (len > 0) {
+        out.append(QLatin1Char(buf[--len]));
+    }
+}
+
+// Qt treats a and A outside of quotes as am/pm marker, it switches h and hh to 12 hour clock
+bool hasAmPm(const QString& format) {
+    bool quoted = false;
+    for(QChar c: format) {
+        if (c == QLatin1Char('\'')) {
+            quoted = !quoted;
+        } else if (!quoted && (c == QLatin1Char('a') || c == QLatin1Char('A'))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+DateTimeFormatter::DateTimeFormatter(const QString &format)
+    : mFormat(format), mFallback(false)
+{
+    compile();
+}
+
+QString DateTimeFormatter::format() const
+{
+    return mFormat;
+}
+
+void DateTimeFormatter::compile()
+{
+    bool ampm = hasAmPm(mFormat);
+    QString literal;
+    auto flush = [&]() {
+        if (!literal.isEmpty()) {
+            mItems.append({Literal, literal});
+            literal.clear();
+        }
+    };
+
+    int n = mFormat.size();
+    int i = 0;
+    while (i < n) {
+        QChar c = mFormat[i];
+        if (c == QLatin1Char('\'')) {
+            if (i + 1 < n && mFormat[i + 1] == QLatin1Char('\'')) {
+                literal.append(c);
+                i += 2;
+                continue;
+            }
+            int j = i + 1;
+            while (j < n) {
+                if (mFormat[j] == QLatin1Char('\'')) {
+                    if (j + 1 < n && mFormat[j + 1] == QLatin1Char('\'')) {
+                        literal.append(QLatin1Char('\''));
+                        j += 2;
+                        continue;
+                    }
+                    break;
+                }
+                literal.append(mFormat[j]);
+                j++;
+            }
+            i = j + 1;
+            continue;
+        }
+
+        if (c == QLatin1Char('A') || c == QLatin1Char('a')) {
+            int count = 1;
+            if (i + 1 < n && (mFormat[i + 1] == QLatin1Char('P') || mFormat[i + 1] == QLatin1Char('p'))) {
+                count = 2;
+            }
+            flush();
+            mItems.append({c == QLatin1Char('A') ? AmPmUpper : AmPmLower, mFormat.mid(i, count)});
+            i += count;
+            continue;
+        }
+
+        int count = 1;
+        while (i + count < n && mFormat[i + count] == c) {
+            count++;
+        }
+
+        bool token = true;
+        bool supported = true;
+        Op op = Literal;
+        switch (c.unicode()) {
+        case 'd':
+            supported = count <= 4;
+            op = count == 1 ? Day : count == 2 ? Day2 : count == 3 ? DayShortName : DayLongName;
+            break;
+        case 'M':
+            supported = count <= 4;
+            op = count == 1 ? Month : count == 2 ? Month2 : count == 3 ? MonthShortName : MonthLongName;
+            break;
+        case 'y':
+            supported = count == 2 || count == 4;
+            op = count == 2 ? Year2 : Year4;
+            break;
+        case 'h':
+            supported = count <= 2;
+            op = ampm ? (count == 1 ? Hour12 : Hour12_2) : (count == 1 ? Hour : Hour2);
+            break;
+        case 'H':
+            supported = count <= 2;
+            op = count == 1 ? Hour : Hour2;
+            break;
+        case 'm':
+            supported = count <= 2;
+            op = count == 1 ? Minute : Minute2;
+            break;
+        case 's':
+            supported = count <= 2;
+            op = count == 1 ? Second : Second2;
+            break;
+        case 'z':
+            // meaning of z changed between Qt versions, only zzz is compiled
+            supported = count == 3;
+            op = Msec3;
+            break;
+        case 't':
+            supported = false;
+            break;
+        default:
+            token = false;
+        }
+
+        if (!supported) {
+            mFallback = true;
+            mItems.clear();
+            return;
+        }
+
+        if (!token) {
+            literal.append(mFormat.mid(i, count));
+        } else {
+            flush();
+            mItems.append({op, mFormat.mid(i, count)});
+        }
+        i += count;
+    }
+    flush();
+
+    QLocale c = QLocale::c();
+    for(const Item& item: std::as_const(mItems)) {
+        if ((item.op == DayShortName || item.op == DayLongName) && mDayNames[0].isEmpty()) {
+            for(int day=1;day<=7;day++) {
+                mDayNames[0].append(c.dayName(day, QLocale::ShortFormat));
+                mDayNames[1].append(c.dayName(day, QLocale::LongFormat));
+            }
+        }
+        if ((item.op == MonthShortName || item.op == MonthLongName) && mMonthNames[0].isEmpty()) {
+            for(int month=1;month<=12;month++) {
+                mMonthNames[0].append(c.monthName(month, QLocale::ShortFormat));
+                mMonthNames[1].append(c.monthName(month, QLocale::LongFormat));
+            }
+        }
+    }
+}
+
+void DateTimeFormatter::append(QString &out, const QDate &date, const QTime &time) const
+{
+    for(const Item& item: mItems) {
+        switch (item.op) {
+        case Literal:
+            out.append(item.text);
+            break;
+        case Day:
+        case Day2:
+        case DayShortName:
+        case DayLongName:
+        case Month:
+        case Month2:
+        case MonthShortName:
+        case MonthLongName:
+        case Year2:
+        case Year4:
+            if (!date.isValid()) {
+                // date ops are literals when formatting time
+                out.append(item.text);
+                break;
+            }
+            switch (item.op) {
+            case Day: appendPadded(out, date.day(), 1); break;
+            case Day2: appendPadded(out, date.day(), 2); break;
+            case DayShortName: out.append(mDayNames[0][date.dayOfWeek() - 1]); break;
+            case DayLongName: out.append(mDayNames[1][date.dayOfWeek() - 1]); break;
+            case Month: appendPadded(out, date.month(), 1); break;
+            case Month2: appendPadded(out, date.month(), 2); break;
+            case MonthShortName: out.append(mMonthNames[0][date.month() - 1]); break;
+            case MonthLongName: out.append(mMonthNames[1][date.month() - 1]); break;
+            case Year2: appendPadded(out, qAbs(date.year()) % 100, 2); break;
+            case Year4: appendPadded(out, date.year(), 4); break;
+            default: break;
+            }
+            break;
+        default:
+            if (!time.isValid()) {
+                // time ops are literals when formatting date
+                out.append(item.text);
+                break;
+            }
+            switch (item.op) {
+            case Hour: appendPadded(out, time.hour(), 1); break;
+            case Hour2: appendPadded(out, time.hour(), 2); break;
+            case Hour12: appendPadded(out, time.hour() % 12 == 0 ? 12 : time.hour() % 12, 1); break;
+            case Hour12_2: appendPadded(out, time.hour() % 12 == 0 ? 12 : time.hour() % 12, 2); break;
+            case Minute: appendPadded(out, time.minute(), 1); break;
+            case Minute2: appendPadded(out, time.minute(), 2); break;
+            case Second: appendPadded(out, time.second(), 1); break;
+            case Second2: appendPadded(out, time.second(), 2); break;
+            case Msec3: appendPadded(out, time.msec(), 3); break;
+            case AmPmUpper: out.append(time.hour() < 12 ? QLatin1String("AM") : QLatin1String("PM")); break;
+            case AmPmLower: out.append(time.hour() < 12 ? QLatin1String("am") : QLatin1String("pm")); break;
+            default: break;
+            }
+        }
+    }
+}
+
+void DateTimeFormatter::append(QString &out, const QDate &date) const
+{
+    if (!date.isValid()) {
+        return;
+    }
+    if (mFallback) {
+        out.append(date.toString(mFormat));
+        return;
+    }
+    append(out, date, QTime());
+}
+
+void DateTimeFormatter::append(QString &out, const QTime &time) const
+{
+    if (!time.isValid()) {
+        return;
+    }
+    if (mFallback) {
+        out.append(time.toString(mFormat));
+        return;
+    }
+    append(out, QDate(), time);
+}
+
+void DateTimeFormatter::append(QString &out, const QDateTime &dateTime) const
+{
+    if (!dateTime.isValid()) {
+        return;
+    }
+    if (mFallback) {
+        out.append(dateTime.toString(mFormat));
+        return;
+    }
+    append(out, dateTime.date(), dateTime.time());
+}
+
+QString DateTimeFormatter::toString(const QDate &date) const
+{
+    QString res;
+    append(res, date);
+    return res;
+}
+
+QString DateTimeFormatter::toString(const QTime &time) const
+{
+    QString res;
+    append(res, time);
+    return res;
+}
+
+QString DateTimeFormatter::toString(const QDateTime &dateTime) const
+{
+    QString res;
+    append(res, dateTime);
+    return res;
+}
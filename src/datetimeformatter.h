@@ -0,0 +1,70 @@
+#ifndef DATETIMEFORMATTER_H
+#define DATETIMEFORMATTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+class QDate;
+class QTime;
+class QDateTime;
+
+// Date/time format string (QDate::toString syntax) compiled once into list of
+// ops, formats into reusable buffer. Formats not covered by ops fall back to Qt.
+
+class DateTimeFormatter
+{
+public:
+    DateTimeFormatter(const QString& format = QString());
+
+    QString format() const;
+
+    void append(QString& out, const QDate& date) const;
+    void append(QString& out, const QTime& time) const;
+    void append(QString& out, const QDateTime& dateTime) const;
+
+    QString toString(const QDate& date) const;
+    QString toString(const QTime& time) const;
+    QString toString(const QDateTime& dateTime) const;
+
+protected:
+    enum Op {
+        Literal,
+        Day,
+        Day2,
+        DayShortName,
+        DayLongName,
+        Month,
+        Month2,
+        MonthShortName,
+        MonthLongName,
+        Year2,
+        Year4,
+        Hour,
+        Hour2,
+        Hour12,
+        Hour12_2,
+        Minute,
+        Minute2,
+        Second,
+        Second2,
+        Msec3,
+        AmPmUpper,
+        AmPmLower
+    };
+
+    struct Item {
+        Op op;
+        QString text;
+    };
+
+    void compile();
+    void append(QString& out, const QDate& date, const QTime& time) const;
+
+    QString mFormat;
+    QList<Item> mItems;
+    bool mFallback;
+    QStringList mDayNames[2];
+    QStringList mMonthNames[2];
+};
+
+#endif // DATETIMEFORMATTER_H
@@ -0,0 +1,93 @@
+#include "dump.h"
+
+Dump::Dump(QObject *parent) : QObject{parent}, mElapsed(0), mFinished(false)
+{
+
+}
+
+QString Dump::rowsName() const
+{
+    return "Rows";
+}
+
+int Dump::count() const
+{
+    return mTables.size();
+}
+
+Dump::Table Dump::table(int index) const
+{
+    return mTables.value(index);
+}
+
+QList<Dump::Table> Dump::tables() const
+{
+    return mTables;
+}
+
+bool Dump::isFinished() const
+{
+    return mFinished;
+}
+
+int Dump::count(Status status) const
+{
+    int res = 0;
+    for(const Table& table: mTables) {
+        if (table.status == status) {
+            res++;
+        }
+    }
+    return res;
+}
+
+qint64 Dump::bytes() const
+{
+    qint64 res = 0;
+    for(const Table& table: mTables) {
+        res += table.bytes;
+    }
+    return res;
+}
+
+qint64 Dump::rows() const
+{
+    qint64 res = 0;
+    for(const Table& table: mTables) {
+        res += qMax(qint64(0), table.rows);
+    }
+    return res;
+}
+
+double Dump::seconds() const
+{
+    if (!mTime.isValid()) {
+        return 0;
+    }
+    return (mFinished ? mElapsed : mTime.elapsed()) / 1000.0;
+}
+
+QString Dump::statusName(Status status)
+{
+    switch (status) {
+    case Queued: return "Queued";
+    case Running: return "Running";
+    case Done: return "Done";
+    case Failed: return "Failed";
+    case Cancelled: return "Cancelled";
+    }
+    return QString();
+}
+
+void Dump::startTime()
+{
+    mFinished = false;
+    mTime.start();
+}
+
+void Dump::setFinished()
+{
+    mElapsed = mTime.elapsed();
+    mFinished = true;
+    emit finished();
+}
@@ -0,0 +1,70 @@
+#ifndef DUMP_H
+#define DUMP_H
+
+#include <QObject>
+#include <QList>
+#include <QElapsedTimer>
+
+// Table by table dump or restore with live progress shown by DumpWidget, implemented by
+// DumpProcessPool (mysqldump processes), NativeDump (in process export) and
+// ParallelRestore (script per table)
+
+class Dump : public QObject
+{
+    Q_OBJECT
+public:
+    enum Status {
+        Queued,
+        Running,
+        Done,
+        Failed,
+        Cancelled
+    };
+
+    struct Table {
+        QString name;
+        QString path;
+        Status status = Queued;
+        // rows or statements, -1 when unknown
+        qint64 rows = -1;
+        // bytes written to file or executed
+        qint64 bytes = 0;
+        // bytes to execute, -1 when unknown
+        qint64 totalBytes = -1;
+        double seconds = 0;
+        QString error;
+    };
+
+    Dump(QObject* parent = nullptr);
+
+    virtual void cancel() = 0;
+    // name of Table::rows
+    virtual QString rowsName() const;
+
+    int count() const;
+    Table table(int index) const;
+    QList<Table> tables() const;
+
+    bool isFinished() const;
+    int count(Status status) const;
+    qint64 bytes() const;
+    qint64 rows() const;
+    double seconds() const;
+
+    static QString statusName(Status status);
+
+signals:
+    void tableChanged(int index);
+    void finished();
+
+protected:
+    void startTime();
+    void setFinished();
+
+    QList<Table> mTables;
+    QElapsedTimer mTime;
+    qint64 mElapsed;
+    bool mFinished;
+};
+
+#endif // DUMP_H
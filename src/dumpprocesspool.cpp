@@ -0,0 +1,134 @@
+#include "dumpprocesspool.h"
+
+#include <QProcess>
+#include <QTimer>
+#include <QFileInfo>
+
+DumpProcessPool::DumpProcessPool(const QString &program, QObject *parent)
+    : Dump{parent}, mProgram(program), mNext(0), mMaxProcesses(1), mCancelled(false), mTimer(new QTimer(this))
+{
+    connect(mTimer, SIGNAL(timeout()), this, SLOT(onPoll()));
+}
+
+DumpProcessPool::~DumpProcessPool()
+{
+    for(QProcess* process: std::as_const(mProcesses)) {
+        if (process) {
+            process->disconnect(this);
+            process->kill();
+            process->waitForFinished(1000);
+        }
+    }
+}
+
+void DumpProcessPool::append(const QString &name, const QStringList &args, const QString &resultFile)
+{
+    Table table;
+    table.name = name;
+    table.path = resultFile;
+    mTables.append(table);
+    mArgs.append(args);
+    mProcesses.append(nullptr);
+    mTimes.append(QElapsedTimer());
+}
+
+void DumpProcessPool::start(int processes)
+{
+    mMaxProcesses = qMax(1, processes);
+    mNext = 0;
+    mCancelled = false;
+    startTime();
+    mTimer->start(pollMs);
+    startNext();
+}
+
+void DumpProcessPool::cancel()
+{
+    mCancelled = true;
+    for(int i=mNext;i<mTables.size();i++) {
+        mTables[i].status = Cancelled;
+        emit tableChanged(i);
+    }
+    mNext = mTables.size();
+    for(QProcess* process: std::as_const(mProcesses)) {
+        if (process) {
+            process->kill();
+        }
+    }
+    startNext();
+}
+
+int DumpProcessPool::running() const
+{
+    int res = 0;
+    for(QProcess* process: mProcesses) {
+        if (process) {
+            res++;
+        }
+    }
+    return res;
+}
+
+void DumpProcessPool::startNext()
+{
+    while (!mCancelled && mNext < mTables.size() && running() < mMaxProcesses) {
+        int index = mNext++;
+        QProcess* process = new QProcess(this);
+        process->setProgram(mProgram);
+        process->setArguments(mArgs[index]);
+        process->setStandardOutputFile(QProcess::nullDevice());
+        mProcesses[index] = process;
+        mTimes[index].start();
+        mTables[index].status = Running;
+        connect(process, &QProcess::finished, this, [=](int exitCode, QProcess::ExitStatus exitStatus){
+            QString error;
+            if (exitStatus == QProcess::CrashExit) {
+                error = mCancelled ? QString("Cancelled") : QString("%1 crashed").arg(QFileInfo(mProgram).fileName());
+            } else if (exitCode != 0) {
+                error = QString("Exit code %1").arg(exitCode);
+            }
+            onProcessFinished(index, process, error);
+        });
+        connect(process, &QProcess::errorOccurred, this, [=](QProcess::ProcessError processError){
+            if (processError == QProcess::FailedToStart) {
+                onProcessFinished(index, process, process->errorString());
+            }
+        });
+        process->start(QIODevice::ReadOnly);
+        emit tableChanged(index);
+    }
+    if (running() == 0 && mNext >= mTables.size() && !mFinished) {
+        mTimer->stop();
+        setFinished();
+    }
+}
+
+void DumpProcessPool::onProcessFinished(int index, QProcess *process, const QString &error)
+{
+    if (mProcesses.value(index) != process) {
+        return;
+    }
+    mProcesses[index] = nullptr;
+    Table& table = mTables[index];
+    // mysqldump reports warnings (password on command line) to stderr with exit code 0
+    QString output = QString::fromUtf8(process->readAllStandardError()).trimmed();
+    table.error = error.isEmpty() ? output : (output.isEmpty() ? error : error + "\n" + output);
+    table.status = mCancelled ? Cancelled : (error.isEmpty() ? Done : Failed);
+    table.bytes = QFileInfo(table.path).size();
+    table.seconds = mTimes[index].elapsed() / 1000.0;
+    process->deleteLater();
+    emit tableChanged(index);
+    startNext();
+}
+
+void DumpProcessPool::onPoll()
+{
+    for(int i=0;i<mProcesses.size();i++) {
+        if (!mProcesses[i]) {
+            continue;
+        }
+        mTables[i].bytes = QFileInfo(mTables[i].path).size();
+        mTables[i].seconds = mTimes[i].elapsed() / 1000.0;
+        emit tableChanged(i);
+    }
+}
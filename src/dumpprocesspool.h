@@ -0,0 +1,49 @@
+#ifndef DUMPPROCESSPOOL_H
+#define DUMPPROCESSPOOL_H
+
+#include "dump.h"
+#include <QStringList>
+
+class QProcess;
+class QTimer;
+
+// Runs dump program (mysqldump) once per table in up to processes asynchronous QProcess
+// at a time, progress of running table is size of its result file polled by timer.
+// Processes have separate sessions, so tables are not dumped from one snapshot.
+
+class DumpProcessPool : public Dump
+{
+    Q_OBJECT
+public:
+    DumpProcessPool(const QString& program, QObject* parent = nullptr);
+    ~DumpProcessPool();
+
+    // name is shown in progress, args are expected to write to resultFile
+    void append(const QString& name, const QStringList& args, const QString& resultFile);
+
+    void start(int processes);
+    // kills running processes, queued tables are cancelled
+    void cancel() override;
+
+    int running() const;
+
+    static const int pollMs = 500;
+
+protected slots:
+    void onPoll();
+
+protected:
+    void startNext();
+    void onProcessFinished(int index, QProcess* process, const QString& error);
+
+    QString mProgram;
+    QList<QStringList> mArgs;
+    QList<QProcess*> mProcesses;
+    QList<QElapsedTimer> mTimes;
+    int mNext;
+    int mMaxProcesses;
+    bool mCancelled;
+    QTimer* mTimer;
+};
+
+#endif // DUMPPROCESSPOOL_H
@@ -0,0 +1,303 @@
+#include "fanoutquery.h"
+
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlField>
+#include <QSqlQueryModel>
+#include <vector>
+
+#include "connectionpool.h"
+#include "nativequery.h"
+#include "resultsource.h"
+#include "resultstore.h"
+#include "storesqlresult.h"
+#include "trace.h"
+
+struct FanOutQuery::State {
+    QStringList queries;
+    bool native = false;
+    qint64 spillThreshold = 0;
+    std::vector<Result> results;
+    QAtomicInt next;
+    QAtomicInt cancelled;
+    QMutex mutex;
+    FanOutQuery* owner = nullptr;
+
+    ~State() {
+        for(const Result& result: results) {
+            qDeleteAll(result.stores);
+        }
+    }
+};
+
+namespace {
+
+// Rows of several stores with source name prepended, takes ownership of stores
+
+class MergedResultSource : public ResultSource
+{
+public:
+    MergedResultSource(const QSqlRecord& record, const QStringList& names, const QList<ResultStore*>& stores)
+        : mRecord(record), mNames(names), mStores(stores), mIndex(0), mRow(0) {
+        mRecord.insert(0, QSqlField("source", QMetaType(QMetaType::QString)));
+    }
+
+    ~MergedResultSource() {
+        qDeleteAll(mStores.mid(mIndex));
+    }
+
+    QSqlRecord record() const override {
+        return mRecord;
+    }
+
+    int fetch(ResultStore* store, int count) override {
+        int fetched = 0;
+        while (fetched < count && mIndex < mStores.size()) {
+            ResultStore* source = mStores[mIndex];
+            if (mRow >= source->rowCount()) {
+                delete source;
+                mIndex++;
+                mRow = 0;
+                continue;
+            }
+            QVariantList row = source->row(mRow++);
+            row.prepend(mNames[mIndex]);
+            store->append(row);
+            fetched++;
+        }
+        return fetched;
+    }
+
+protected:
+    QSqlRecord mRecord;
+    QStringList mNames;
+    QList<ResultStore*> mStores;
+    int mIndex;
+    int mRow;
+};
+
+bool sameColumns(const QSqlRecord& r1, const QSqlRecord& r2) {
+    if (r1.count() != r2.count()) {
+        return false;
+    }
+    for(int i=0;i<r1.count();i++) {
+        if (r1.fieldName(i) != r2.fieldName(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+FanOutQuery::FanOutQuery(const QStringList &connectionNames, const QStringList &queries, QObject *parent)
+    : QObject(parent), mState(new State()), mConnectionNames(connectionNames), mQueries(queries), mFinishedCount(0)
+{
+    mState->queries = queries;
+    mState->owner = this;
+    mState->results.resize(connectionNames.size());
+    for(int i=0;i<connectionNames.size();i++) {
+        mState->results[i].connectionName = connectionNames[i];
+    }
+}
+
+FanOutQuery::~FanOutQuery()
+{
+    // running workers keep state alive and drop results when done
+    mState->cancelled.storeRelease(1);
+    QMutexLocker locker(&mState->mutex);
+    mState->owner = nullptr;
+}
+
+void FanOutQuery::start(int concurrency, bool native, qint64 spillThreshold)
+{
+    mState->native = native;
+    mState->spillThreshold = spillThreshold;
+    if (mState->results.empty()) {
+        emit finished();
+        return;
+    }
+    int workers = qBound(1, concurrency, int(mState->results.size()));
+    QSharedPointer<State> state = mState;
+    for(int i=0;i<workers;i++) {
+        // each worker takes next target until all are done
+        ConnectionPool::startWorker([state](){
+            int count = int(state->results.size());
+            int target;
+            while ((target = state->next.fetchAndAddOrdered(1)) < count) {
+                run(state, target);
+            }
+        });
+    }
+}
+
+void FanOutQuery::run(QSharedPointer<State> state, int target)
+{
+    TRACE_SCOPE("FanOutQuery::run");
+    Result& result = state->results[target];
+
+    auto skip = [&](const QString& error) {
+        result.errors.append(error);
+        result.timings.append(QueryTiming());
+        result.rowsAffected.append(-1);
+        result.stores.append(nullptr);
+    };
+    auto fail = [&](const QString& error) {
+        for(int i=0;i<state->queries.size();i++) {
+            skip(error);
+        }
+    };
+
+    if (state->cancelled.loadAcquire()) {
+        fail("Cancelled");
+    } else {
+        ConnectionLease lease(result.connectionName);
+        if (!lease.isValid()) {
+            fail(lease.error());
+        } else {
+            QSqlDatabase db = lease.database();
+            bool native = state->native && NativeQuery::isAvailable(db);
+            QElapsedTimer time;
+            for(const QString& query: std::as_const(state->queries)) {
+                if (state->cancelled.loadAcquire()) {
+                    skip("Cancelled");
+                    continue;
+                }
+                time.start();
+                QueryTiming timing;
+                ResultSource* source = nullptr;
+                QString error;
+                int rowsAffected = -1;
+                if (native) {
+                    NativeQuery::exec(db, query, &source, &rowsAffected, error);
+                } else {
+                    QSqlQuery q(db);
+                    q.setForwardOnly(true);
+                    if (!q.exec(query)) {
+                        error = q.lastError().text();
+                    } else {
+                        rowsAffected = q.numRowsAffected();
+                        if (q.isSelect()) {
+                            source = new QueryResultSource(std::move(q));
+                        }
+                    }
+                }
+                timing.exec = int(time.elapsed());
+                ResultStore* store = nullptr;
+                if (source) {
+                    store = new ResultStore(source->record(), state->spillThreshold);
+                    time.start();
+                    int count = 1;
+                    while (source->fetch(store, count) > 0) {
+                        if (timing.firstRow < 0) {
+                            timing.firstRow = timing.exec + int(time.elapsed());
+                        }
+                        count = ResultStore::chunkRows;
+                    }
+                    timing.fetch = int(time.elapsed());
+                    timing.bytes = store->totalBytes();
+                    delete source;
+                    rowsAffected = store->rowCount();
+                }
+                result.errors.append(error);
+                result.timings.append(timing);
+                result.rowsAffected.append(rowsAffected);
+                result.stores.append(store);
+            }
+            // queries may leave session variables, temporary tables or open transaction behind
+            lease.discard();
+        }
+    }
+
+    QMutexLocker locker(&state->mutex);
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onTargetFinished", Qt::QueuedConnection, Q_ARG(int, target));
+    }
+}
+
+void FanOutQuery::cancel()
+{
+    mState->cancelled.storeRelease(1);
+}
+
+void FanOutQuery::onTargetFinished(int target)
+{
+    mFinishedCount++;
+    emit targetFinished(target);
+    if (isFinished()) {
+        emit finished();
+    }
+}
+
+QStringList FanOutQuery::connectionNames() const
+{
+    return mConnectionNames;
+}
+
+QStringList FanOutQuery::queries() const
+{
+    return mQueries;
+}
+
+int FanOutQuery::finishedCount() const
+{
+    return mFinishedCount;
+}
+
+bool FanOutQuery::isFinished() const
+{
+    return mFinishedCount == mConnectionNames.size();
+}
+
+const FanOutQuery::Result &FanOutQuery::result(int target) const
+{
+    return mState->results[target];
+}
+
+QSqlQueryModel *FanOutQuery::model(int target, int index)
+{
+    Result& result = mState->results[target];
+    ResultStore* store = result.stores.value(index);
+    if (!store) {
+        return nullptr;
+    }
+    result.stores[index] = nullptr;
+    QSqlDatabase db = QSqlDatabase::database(result.connectionName, false);
+    QSqlQueryModel* model = new QSqlQueryModel();
+    model->setQuery(StoreSqlResult::query(db.driver(), store));
+    return model;
+}
+
+QSqlQueryModel *FanOutQuery::mergedModel(int index, QStringList *skipped)
+{
+    QStringList names;
+    QList<ResultStore*> stores;
+    QSqlRecord record;
+    QString connectionName;
+    for(Result& result: mState->results) {
+        ResultStore* store = result.stores.value(index);
+        if (!store) {
+            continue;
+        }
+        if (stores.isEmpty()) {
+            record = store->record();
+            connectionName = result.connectionName;
+        } else if (!sameColumns(record, store->record())) {
+            skipped->append(result.connectionName);
+            continue;
+        }
+        result.stores[index] = nullptr;
+        names.append(result.connectionName);
+        stores.append(store);
+    }
+    if (stores.isEmpty()) {
+        return nullptr;
+    }
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    QSqlQueryModel* model = new QSqlQueryModel();
+    model->setQuery(StoreSqlResult::query(db.driver(), new MergedResultSource(record, names, stores), mState->spillThreshold));
+    return model;
+}
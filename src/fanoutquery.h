@@ -0,0 +1,73 @@
+#ifndef FANOUTQUERY_H
+#define FANOUTQUERY_H
+
+#include <QObject>
+#include <QStringList>
+#include <QSharedPointer>
+#include "querytiming.h"
+class QSqlQueryModel;
+class ResultStore;
+
+// Runs same queries on several connections concurrently. Each target runs on
+// worker thread with connection leased from ConnectionPool, results are read
+// completely into ResultStore in worker and wrapped into models in gui thread,
+// either per target or merged into one model with source column.
+
+class FanOutQuery : public QObject
+{
+    Q_OBJECT
+public:
+    struct Result {
+        QString connectionName;
+        QStringList errors;
+        // exec, first row, fetch and bytes
+        QList<QueryTiming> timings;
+        // row count for queries with result set
+        QList<int> rowsAffected;
+        // nullptr for statements without result set
+        QList<ResultStore*> stores;
+    };
+
+    FanOutQuery(const QStringList& connectionNames, const QStringList& queries, QObject* parent = nullptr);
+    ~FanOutQuery();
+
+    // native - read results with NativeQuery when available
+    void start(int concurrency, bool native, qint64 spillThreshold);
+
+    // targets that not started yet and queries that not started yet are skipped
+    void cancel();
+
+    QStringList connectionNames() const;
+    QStringList queries() const;
+
+    int finishedCount() const;
+    bool isFinished() const;
+
+    // valid after targetFinished(target)
+    const Result& result(int target) const;
+
+    // model with result of query on target, model owns store, nullptr if there's no result set
+    QSqlQueryModel* model(int target, int index);
+
+    // result of query on all targets with source column prepended, targets
+    // with different columns are appended to skipped
+    QSqlQueryModel* mergedModel(int index, QStringList* skipped);
+
+signals:
+    void targetFinished(int target);
+    void finished();
+
+protected slots:
+    void onTargetFinished(int target);
+
+protected:
+    struct State;
+    static void run(QSharedPointer<State> state, int target);
+
+    QSharedPointer<State> mState;
+    QStringList mConnectionNames;
+    QStringList mQueries;
+    int mFinishedCount;
+};
+
+#endif // FANOUTQUERY_H
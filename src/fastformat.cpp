@@ -0,0 +1,61 @@
+#include "fastformat.h"
+
+#include <charconv>
+
+namespace FastFormat {
+
+void appendInt(QString &out, qlonglong value)
+{
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(QLatin1String(buf, res.ptr - buf));
+}
+
+void appendUInt(QString &out, qulonglong value)
+{
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(QLatin1String(buf, res.ptr - buf));
+}
+
+void appendDouble(QString &out, double value)
+{
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(QLatin1String(buf, res.ptr - buf));
+}
+
+QString number(double value)
+{
+    QString res;
+    appendDouble(res, value);
+    return res;
+}
+
+void appendSingleLine(QString &out, const QString &value)
+{
+    int n = value.size();
+    int p = value.indexOf(QLatin1Char('\n'));
+    if (p < 0) {
+        out.append(value);
+        return;
+    }
+    const QChar* data = value.constData();
+    int begin = 0;
+    while (p >= 0) {
+        out.append(data + begin, p - begin);
+        out.append(QLatin1Char(' '));
+        p++;
+        if (p < n && data[p] == QLatin1Char('\r')) {
+            p++;
+        }
+        while (p < n && data[p].isSpace()) {
+            p++;
+        }
+        begin = p;
+        p = p < n ? value.indexOf(QLatin1Char('\n'), p) : -1;
+    }
+    out.append(data + begin, n - begin);
+}
+
+}
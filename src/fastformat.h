@@ -0,0 +1,25 @@
+#ifndef FASTFORMAT_H
+#define FASTFORMAT_H
+
+#include <QString>
+
+// Number and text formatting that appends to reusable buffer without temporaries.
+// Doubles are written in shortest form that round-trips.
+
+namespace FastFormat {
+
+void appendInt(QString& out, qlonglong value);
+
+void appendUInt(QString& out, qulonglong value);
+
+void appendDouble(QString& out, double value);
+
+QString number(double value);
+
+// replaces newline with following whitespace by single space, same as
+// replace(QRegularExpression("\\n[\\r]?\\s*"), " ")
+void appendSingleLine(QString& out, const QString& value);
+
+}
+
+#endif // FASTFORMAT_H
@@ -23,4 +23,13 @@ Formats::Formats(DataFormat::ActionType action)
                                || (action == DataFormat::ActionSave && s->realOverrideForCsv()))) {
         realUseLocale = true;
     }
+
+    if (action == DataFormat::ActionView) {
+        dateTimeUseLocale = s->dateTimeUseLocale();
+        realUseLocale = s->realUseLocale();
+    }
+
+    dateFormatter = DateTimeFormatter(dateFormat);
+    timeFormatter = DateTimeFormatter(timeFormat);
+    dateTimeFormatter = DateTimeFormatter(dateFormat + " " + timeFormat);
 }
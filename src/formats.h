@@ -2,6 +2,7 @@
 #define FORMATS_H
 
 #include "dataformat.h"
+#include "datetimeformatter.h"
 
 #include <QString>
 
@@ -13,6 +14,11 @@ public:
     QString dateFormat;
     QString timeFormat;
     bool realUseLocale;
+
+    // compiled dateFormat, timeFormat and "dateFormat timeFormat"
+    DateTimeFormatter dateFormatter;
+    DateTimeFormatter timeFormatter;
+    DateTimeFormatter dateTimeFormatter;
 };
 
 
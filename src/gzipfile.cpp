@@ -0,0 +1,279 @@
+#include "gzipfile.h"
+
+#include <QtEndian>
+#include <QList>
+#include <cstring>
+
+namespace {
+
+const char magic[] = "\x1f\x8b";
+const int headerSize = 26;
+const int trailerSize = 8;
+// FEXTRA
+const char flagExtra = 4;
+// extra field: subfield id, length, zlib header, adler32, deflate size
+const int extraSize = 14;
+
+// qCompress returns 4 bytes of size only for empty input, final fixed block with end code
+const char emptyDeflate[] = "\x03\x00";
+
+// initialized once, workers write files concurrently
+const quint32* crcTable() {
+    static const QList<quint32> table = []() {
+        QList<quint32> res(256);
+        for(quint32 i=0;i<256;i++) {
+            quint32 c = i;
+            for(int k=0;k<8;k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            res[i] = c;
+        }
+        return res;
+    }();
+    return table.constData();
+}
+
+quint32 readLE(const char* data) {
+    return qFromLittleEndian<quint32>(data);
+}
+
+bool isMember(const QByteArray& header) {
+    return header.size() == headerSize && memcmp(header.constData(), magic, 2) == 0
+            && (header[3] & flagExtra) && header[12] == 'M' && header[13] == 'Q';
+}
+
+}
+
+GzipFile::GzipFile(const QString &path) : mFile(path)
+{
+
+}
+
+GzipFile::~GzipFile()
+{
+    if (mFile.isOpen()) {
+        close();
+    }
+}
+
+bool GzipFile::open()
+{
+    mBuffer.clear();
+    if (!mFile.open(QIODevice::WriteOnly)) {
+        mError = mFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool GzipFile::write(const QByteArray &data)
+{
+    mBuffer.append(data);
+    if (mBuffer.size() < blockSize) {
+        return true;
+    }
+    return writeMember();
+}
+
+bool GzipFile::close()
+{
+    // file with no members is not valid gzip
+    bool ok = (mBuffer.isEmpty() && mFile.size() > 0) || writeMember();
+    mFile.close();
+    return ok;
+}
+
+bool GzipFile::writeMember()
+{
+    QByteArray compressed = qCompress(mBuffer);
+    QByteArray deflate;
+    char zlibHeader[2] = {'\x78', '\x9c'};
+    char adler[4] = {0, 0, 0, 1};
+    if (compressed.size() > 4 + 2 + 4) {
+        zlibHeader[0] = compressed[4];
+        zlibHeader[1] = compressed[5];
+        deflate = compressed.mid(6, compressed.size() - 6 - 4);
+        memcpy(adler, compressed.constData() + compressed.size() - 4, 4);
+    } else {
+        deflate = QByteArray(emptyDeflate, 2);
+    }
+
+    char header[headerSize] = {'\x1f', '\x8b', 8, flagExtra, 0, 0, 0, 0, 0, '\xff'};
+    qToLittleEndian<quint16>(extraSize, header + 10);
+    header[12] = 'M';
+    header[13] = 'Q';
+    qToLittleEndian<quint16>(extraSize - 4, header + 14);
+    header[16] = zlibHeader[0];
+    header[17] = zlibHeader[1];
+    memcpy(header + 18, adler, 4);
+    qToLittleEndian<quint32>(quint32(deflate.size()), header + 22);
+
+    char trailer[trailerSize];
+    qToLittleEndian<quint32>(crc32(mBuffer.constData(), mBuffer.size()), trailer);
+    qToLittleEndian<quint32>(quint32(mBuffer.size()), trailer + 4);
+    mBuffer.clear();
+
+    if (mFile.write(header, headerSize) != headerSize
+            || mFile.write(deflate) != deflate.size()
+            || mFile.write(trailer, trailerSize) != trailerSize) {
+        mError = mFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString GzipFile::errorString() const
+{
+    return mError;
+}
+
+qint64 GzipFile::size() const
+{
+    return mFile.size();
+}
+
+QByteArray GzipFile::read(const QString &path, QString &error, qint64 maxSize)
+{
+    GzipReader reader(path);
+    if (!reader.open()) {
+        error = reader.errorString();
+        return QByteArray();
+    }
+    QByteArray res;
+    while (!reader.atEnd() && (maxSize < 0 || res.size() < maxSize)) {
+        res.append(reader.read());
+    }
+    if (!reader.errorString().isEmpty()) {
+        error = reader.errorString();
+        return QByteArray();
+    }
+    return res;
+}
+
+qint64 GzipFile::uncompressedSize(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    qint64 res = 0;
+    while (!file.atEnd()) {
+        QByteArray header = file.read(headerSize);
+        if (!isMember(header) || !file.seek(file.pos() + readLE(header.constData() + 22))) {
+            return -1;
+        }
+        QByteArray trailer = file.read(trailerSize);
+        if (trailer.size() != trailerSize) {
+            return -1;
+        }
+        res += readLE(trailer.constData() + 4);
+    }
+    return res;
+}
+
+bool GzipFile::isGzip(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return file.read(2) == QByteArray(magic, 2);
+}
+
+quint32 GzipFile::crc32(const char *data, qint64 size, quint32 crc)
+{
+    const quint32* table = crcTable();
+    crc = ~crc;
+    for(qint64 i=0;i<size;i++) {
+        crc = table[(crc ^ quint8(data[i])) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+GzipReader::GzipReader(const QString &path) : mFile(path)
+{
+
+}
+
+bool GzipReader::open()
+{
+    mError.clear();
+    if (!mFile.open(QIODevice::ReadOnly)) {
+        mError = mFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool GzipReader::atEnd() const
+{
+    return !mError.isEmpty() || !mFile.isOpen() || mFile.atEnd();
+}
+
+QByteArray GzipReader::read()
+{
+    if (atEnd()) {
+        return QByteArray();
+    }
+    qint64 pos = mFile.pos();
+    QByteArray header = mFile.read(headerSize);
+    if (!isMember(header)) {
+        mError = QString("%1 is not written by GzipFile").arg(mFile.fileName());
+        return QByteArray();
+    }
+    qint64 deflateSize = readLE(header.constData() + 22);
+    QByteArray deflate = mFile.read(deflateSize);
+    QByteArray trailer = mFile.read(trailerSize);
+    if (deflate.size() != deflateSize || trailer.size() != trailerSize) {
+        mError = QString("%1 is truncated").arg(mFile.fileName());
+        return QByteArray();
+    }
+    quint32 size = readLE(trailer.constData() + 4);
+    if (size == 0) {
+        return QByteArray();
+    }
+    QByteArray compressed(4, '\0');
+    qToBigEndian<quint32>(size, compressed.data());
+    compressed.append(header.constData() + 16, 2);
+    compressed.append(deflate);
+    compressed.append(header.constData() + 18, 4);
+    deflate.clear();
+    QByteArray block = qUncompress(compressed);
+    if (quint32(block.size()) != size || GzipFile::crc32(block.constData(), block.size()) != readLE(trailer.constData())) {
+        mError = QString("%1 is corrupted at %2").arg(mFile.fileName()).arg(pos);
+        return QByteArray();
+    }
+    return block;
+}
+
+qint64 GzipReader::skip(qint64 maxSize)
+{
+    if (atEnd()) {
+        return -1;
+    }
+    qint64 pos = mFile.pos();
+    QByteArray header = mFile.read(headerSize);
+    if (!isMember(header)) {
+        mError = QString("%1 is not written by GzipFile").arg(mFile.fileName());
+        return -1;
+    }
+    QByteArray trailer;
+    if (mFile.seek(pos + headerSize + readLE(header.constData() + 22))) {
+        trailer = mFile.read(trailerSize);
+    }
+    if (trailer.size() != trailerSize) {
+        mError = QString("%1 is truncated").arg(mFile.fileName());
+        return -1;
+    }
+    qint64 size = readLE(trailer.constData() + 4);
+    if (size > maxSize) {
+        mFile.seek(pos);
+        return -1;
+    }
+    return size;
+}
+
+QString GzipReader::errorString() const
+{
+    return mError;
+}
@@ -0,0 +1,68 @@
+#ifndef GZIPFILE_H
+#define GZIPFILE_H
+
+#include <QFile>
+#include <QByteArray>
+
+// Writes gzip file block by block: each block is compressed with qCompress and written as
+// separate gzip member, concatenated members are valid gzip file (gunzip, zcat). Qt has no
+// inflate for raw deflate data, so members store zlib header, adler32 and deflate size in
+// extra field and read() restores qUncompress input from them. Only files written by
+// GzipFile can be read back.
+
+class GzipFile
+{
+public:
+    GzipFile(const QString& path);
+    ~GzipFile();
+
+    bool open();
+    bool write(const QByteArray& data);
+    // flushes buffered block
+    bool close();
+
+    QString errorString() const;
+    // compressed bytes written to file
+    qint64 size() const;
+
+    // reads blocks until maxSize is reached (-1 - whole file)
+    static QByteArray read(const QString& path, QString& error, qint64 maxSize = -1);
+    // sum of member sizes, -1 if file is not written by GzipFile
+    static qint64 uncompressedSize(const QString& path);
+    static bool isGzip(const QString& path);
+
+    static quint32 crc32(const char* data, qint64 size, quint32 crc = 0);
+
+    static const int blockSize = 1024 * 1024;
+
+protected:
+    bool writeMember();
+
+    QFile mFile;
+    QByteArray mBuffer;
+    QString mError;
+};
+
+// Reads file written by GzipFile member by member, so large files are not uncompressed at once
+
+class GzipReader
+{
+public:
+    GzipReader(const QString& path);
+
+    bool open();
+    // true at end of file or after error
+    bool atEnd() const;
+    // uncompresses next member, empty on error
+    QByteArray read();
+    // skips next member if it is not larger than maxSize, returns uncompressed size or -1 if not skipped
+    qint64 skip(qint64 maxSize);
+
+    QString errorString() const;
+
+protected:
+    QFile mFile;
+    QString mError;
+};
+
+#endif // GZIPFILE_H
@@ -1,146 +1,151 @@
 #include "highlighter.h"
 
 #include "tokens.h"
+#include "trace.h"
 
 #include <QDebug>
+#include <QTextBlockUserData>
 
-QStringList spaceSplit(const QStringList& items) {
-    QStringList res;
-    foreach (const QString& item, items) {
-        res << item.split(" ");
-    }
-    return res;
-}
+namespace {
 
-QStringList wordBounded(const QStringList& items) {
-    QStringList res;
-    foreach (const QString& item, items) {
-        res << "\\b" + item + "\\b";
-    }
-    return res;
-}
+class BlockData : public QTextBlockUserData {
+public:
+    // at end of block
+    SqlLexer::State state;
+};
 
-static QStringList wordBoundedWithBracket(const QStringList& items) {
-    QStringList res;
-    foreach (const QString& item, items) {
-        res << "\\b" + item + "\\s*(?=\\()";
-    }
-    return res;
 }
-static QStringList wordBoundedWithoutBracket(const QStringList& items) {
-    QStringList res;
-    foreach (const QString& item, items) {
-        res << "\\b" + item + "\\s*(?![(_a-z])";
-    }
-    return res;
-}
-static QStringList wordBoundedWithSize(const QStringList& items) {
+
+QStringList spaceSplit(const QStringList& items) {
     QStringList res;
     foreach (const QString& item, items) {
-        res.append("\\b" + item + "\\b\\([0-9,]+\\)");
+        res << item.split(" ");
     }
     return res;
 }
 
-
 Highlighter::Highlighter(const Tokens &tokens, QTextDocument *parent) : QSyntaxHighlighter(parent)
 {
-    HighlightingRule rule;
+    auto addWords = [&](const QStringList& words, WordKind kind) {
+        for(const QString& word: words) {
+            if (!word.isEmpty()) {
+                mWords[word.toLower()] |= kind;
+            }
+        }
+    };
 
     keywordFormat.setForeground(Qt::darkBlue);
     //keywordFormat.setFontWeight(QFont::Bold);
-    QStringList keywordPatterns = wordBounded(spaceSplit(tokens.keywords()));
-    foreach (const QString &pattern, keywordPatterns) {
-        rule.pattern = QRegularExpression(pattern,QRegularExpression::CaseInsensitiveOption);
-        rule.format = keywordFormat;
-        highlightingRules.append(rule);
-    }
+    addWords(spaceSplit(tokens.keywords()), Keyword);
 
     //tableFormat.setFontWeight(QFont::Bold);
     tableFormat.setForeground(Qt::darkMagenta);
-    QStringList tablePatterns = wordBounded(tokens.tablesAndFields(false));
-    foreach (const QString &pattern, tablePatterns) {
-        rule.pattern = QRegularExpression(pattern,QRegularExpression::CaseInsensitiveOption);
-        rule.format = tableFormat;
-        highlightingRules.append(rule);
-    }
+    addWords(tokens.tablesAndFields(false), Table);
 
     //functionFormat.setFontWeight(QFont::Bold);
     functionFormat.setForeground(Qt::red);
-    QStringList functionPatterns = wordBoundedWithBracket(tokens.functions());
-    foreach (const QString &pattern, functionPatterns) {
-        rule.pattern = QRegularExpression(pattern,QRegularExpression::CaseInsensitiveOption);
-        rule.format = functionFormat;
-        highlightingRules.append(rule);
-    }
+    addWords(tokens.functions(), Function);
 
     typesFormat.setFontWeight(QFont::Bold);
-    QStringList typePatterns = wordBoundedWithoutBracket(tokens.types())
-                               + wordBoundedWithSize(tokens.sizedTypes());
-    foreach (const QString &pattern, typePatterns) {
-        rule.pattern = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
-        rule.format = typesFormat;
-        highlightingRules.append(rule);
-    }
+    addWords(spaceSplit(tokens.types()), Type);
+    addWords(tokens.sizedTypes(), SizedType);
 
     specialCharsFormat.setForeground(Qt::darkRed);
-    rule.pattern = QRegularExpression(";");
-    rule.format = specialCharsFormat;
-    highlightingRules.append(rule);
-
-    rule.pattern = QRegularExpression("(?<!/)[*]");
-    rule.format = specialCharsFormat;
-    highlightingRules.append(rule);
-
     singleLineCommentFormat.setForeground(Qt::gray);
-    rule.pattern = QRegularExpression("--[^\n]*");
-    rule.format = singleLineCommentFormat;
-    highlightingRules.append(rule);
-
     multiLineCommentFormat.setForeground(Qt::darkGray);
-
     quotationFormat.setForeground(Qt::darkGreen);
-    rule.pattern = QRegularExpression("'[^']*'");
-    rule.format = quotationFormat;
-    highlightingRules.append(rule);
-
-
 
+    //qDebug() << mWords.size() << "words";
+}
 
-    commentStartExpression = QRegularExpression("/\\*");
-    commentEndExpression = QRegularExpression("\\*/");
-
-    //qDebug() << highlightingRules.size() << "rules";
+SqlLexer::State Highlighter::blockState(const QTextBlock &block)
+{
+    QTextBlock previous = block.previous();
+    if (previous.isValid()) {
+        BlockData* data = dynamic_cast<BlockData*>(previous.userData());
+        if (data) {
+            return data->state;
+        }
+    }
+    return SqlLexer::State();
+}
 
+const QTextCharFormat *Highlighter::wordFormat(const QString &text, const SqlLexer::Token &token) const
+{
+    int kinds = mWords.value(text.mid(token.pos, token.size).toLower());
+    if (kinds == 0) {
+        return nullptr;
+    }
+    qsizetype next = token.pos + token.size;
+    while (next < text.size() && text[next].isSpace()) {
+        next++;
+    }
+    bool bracket = next < text.size() && text[next] == '(';
+    // types win over functions, functions over tables, tables over keywords
+    if (((kinds & Type) && !bracket) || ((kinds & SizedType) && bracket)) {
+        return &typesFormat;
+    }
+    if ((kinds & Function) && bracket) {
+        return &functionFormat;
+    }
+    if (kinds & Table) {
+        return &tableFormat;
+    }
+    if (kinds & Keyword) {
+        return &keywordFormat;
+    }
+    return nullptr;
 }
 
 void Highlighter::highlightBlock(const QString &text)
 {
-    foreach (const HighlightingRule &rule, highlightingRules) {
-        QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-        while (matchIterator.hasNext()) {
-            QRegularExpressionMatch match = matchIterator.next();
-            setFormat(match.capturedStart(), match.capturedLength(), rule.format);
+    TRACE_SCOPE("Highlighter::highlightBlock");
+    SqlLexer::State state = blockState(currentBlock());
+    SqlLexer lexer(text, &state);
+    SqlLexer::Token token;
+    SqlLexer::Context context = state.context;
+    while (lexer.next(token)) {
+        const QTextCharFormat* format = nullptr;
+        switch (token.type) {
+        case SqlLexer::Word:
+            format = wordFormat(text, token);
+            break;
+        case SqlLexer::String:
+            format = &quotationFormat;
+            break;
+        case SqlLexer::Comment:
+            if (context == SqlLexer::Code && QStringView(text).mid(token.pos).startsWith(QLatin1String("--"))) {
+                format = &singleLineCommentFormat;
+            } else {
+                format = &multiLineCommentFormat;
+            }
+            break;
+        case SqlLexer::Delimiter:
+            format = &specialCharsFormat;
+            break;
+        case SqlLexer::DelimiterCommand:
+            format = &keywordFormat;
+            break;
+        case SqlLexer::Operator:
+            if (text[token.pos] == '*') {
+                format = &specialCharsFormat;
+            }
+            break;
+        default:
+            break;
         }
-    }
-    setCurrentBlockState(0);
-
-    int startIndex = 0;
-    if (previousBlockState() != 1)
-        startIndex = text.indexOf(commentStartExpression);
-
-    while (startIndex >= 0) {
-        QRegularExpressionMatch match = commentEndExpression.match(text, startIndex);
-        int endIndex = match.capturedStart();
-        int commentLength = 0;
-        if (endIndex == -1) {
-            setCurrentBlockState(1);
-            commentLength = text.length() - startIndex;
-        } else {
-            commentLength = endIndex - startIndex
-                    + match.capturedLength();
+        if (format) {
+            setFormat(token.pos, token.size, *format);
         }
-        setFormat(startIndex, commentLength, multiLineCommentFormat);
-        startIndex = text.indexOf(commentStartExpression, startIndex + commentLength);
+        context = state.context;
+    }
+
+    BlockData* data = dynamic_cast<BlockData*>(currentBlockUserData());
+    if (!data) {
+        data = new BlockData();
+        setCurrentBlockUserData(data);
     }
+    data->state = state;
+    // next block is highlighted again when state changes
+    setCurrentBlockState(int(qHash(state)));
 }
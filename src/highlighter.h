@@ -2,28 +2,38 @@
 #define HIGHLIGHTER_H
 
 #include <QSyntaxHighlighter>
-#include <QRegularExpression>
+#include <QHash>
+#include "sqllexer.h"
 
 class Highlighters;
 class Tokens;
 
+// Highlights tokens of SqlLexer, lexer state at end of block is kept in block user data
+// so only edited block is lexed again, and next blocks only while their start state changes
+
 class Highlighter : public QSyntaxHighlighter
 {
 public:
     Highlighter(const Tokens& tokens, QTextDocument *parent);
 
+    // lexer state at start of block
+    static SqlLexer::State blockState(const QTextBlock& block);
+
 protected:
     void highlightBlock(const QString &text) Q_DECL_OVERRIDE;
 
-    struct HighlightingRule
-    {
-        QRegularExpression pattern;
-        QTextCharFormat format;
+    enum WordKind {
+        Keyword = 1,
+        Table = 2,
+        Function = 4,
+        Type = 8,
+        SizedType = 16
     };
-    QVector<HighlightingRule> highlightingRules;
 
-    QRegularExpression commentStartExpression;
-    QRegularExpression commentEndExpression;
+    const QTextCharFormat* wordFormat(const QString& text, const SqlLexer::Token& token) const;
+
+    // lowercase word to WordKind flags
+    QHash<QString, int> mWords;
 
     QTextCharFormat keywordFormat;
     QTextCharFormat tableFormat;
@@ -11,25 +11,272 @@
 #include <QVariant>
 #include <QSqlRecord>
 #include <QDebug>
+#include <QThread>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDeadlineTimer>
+#include <QCoreApplication>
 #include "settings.h"
 #include "drivernames.h"
 #include "query_exec.h"
+#include "querytiming.h"
+#include "sqlutil.h"
+#include "trace.h"
+#include "sqlparse.h"
 
-History::History(QObject* parent)
+namespace {
+
+// how long writer waits for more queries before committing batch
+const int batchMs = 200;
+const int maxBatch = 1000;
+const int busyTimeoutMs = 5000;
+
+void setPragmas(QSqlDatabase db) {
+    QSqlQuery q(db);
+    q.exec("PRAGMA journal_mode=WAL");
+    // with wal syncs on checkpoint only, last transactions may be lost on power failure
+    q.exec("PRAGMA synchronous=NORMAL");
+}
+
+QSqlDatabase openDatabase(const QString& connectionName, const QString& path) {
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, connectionName);
+    db.setDatabaseName(path);
+    db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(busyTimeoutMs));
+    if (db.open()) {
+        setPragmas(db);
+    }
+    return db;
+}
+
+}
+
+class HistoryWriter : public QThread
 {
+public:
+    struct Item {
+        qint64 id;
+        enum Kind {
+            Insert,
+            // timing of query with id
+            Timing,
+            // rows returned by query with id, known when result is read
+            Rows
+        };
+        Kind kind;
+        QDateTime date;
+        QString connectionName;
+        QString query;
+        QueryTiming timing;
+        bool ok = true;
+        int rows = -1;
+        int rowsAffected = -1;
+    };
 
-    QDir d(Settings::instance()->dir());
+    HistoryWriter(const QString& path) : mPath(path), mPosted(0), mWritten(0), mFlush(0), mStop(false) {
 
-    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE,"_history");
-    db.setDatabaseName(d.filePath("history.sqlite"));
-    if (!db.open()) {
+    }
+
+    // returns false if writer is stopped
+    bool post(const Item& item) {
+        QMutexLocker locker(&mMutex);
+        if (mStop) {
+            return false;
+        }
+        mItems.append(item);
+        mPosted++;
+        mWake.wakeOne();
+        return true;
+    }
+
+    void flush() {
+        QMutexLocker locker(&mMutex);
+        qint64 posted = mPosted;
+        mFlush++;
+        mWake.wakeOne();
+        while (mWritten < posted) {
+            mDone.wait(&mMutex);
+        }
+        mFlush--;
+    }
+
+    // writes queued items and stops thread
+    void stop() {
+        {
+            QMutexLocker locker(&mMutex);
+            mStop = true;
+            mWake.wakeOne();
+        }
+        wait();
+    }
+
+    // called from writer thread or from gui thread after stop
+    void write(QSqlDatabase db, const QList<Item>& items) {
+        TRACE_SCOPE("History::write");
+        db.transaction();
+        QSqlQuery insert(db);
+        insert.prepare("INSERT INTO query(rowid, date, connectionName, query, fingerprint) VALUES(?, ?, ?, ?, ?)");
+        QSqlQuery update(db);
+        update.prepare("UPDATE query SET execMs=?, firstRowMs=?, fetchMs=?, bytes=?, modelMs=?, layoutMs=? WHERE rowid=?");
+        QSqlQuery aggregate(db);
+        aggregate.prepare("INSERT INTO fingerprint(connectionName, fingerprint, query, count, errors, totalMs, maxMs, "
+                          "rowsReturned, rowsAffected, lastDate) "
+                          "SELECT connectionName, fingerprint, query, 1, ?, ?, ?, ?, ?, date FROM query WHERE rowid=? "
+                          "ON CONFLICT(connectionName, fingerprint) DO UPDATE SET count=count+1, errors=errors+excluded.errors, "
+                          "totalMs=totalMs+excluded.totalMs, maxMs=max(maxMs, excluded.maxMs), "
+                          "rowsReturned=rowsReturned+excluded.rowsReturned, rowsAffected=rowsAffected+excluded.rowsAffected, "
+                          "query=excluded.query, lastDate=excluded.lastDate");
+        QSqlQuery rows(db);
+        rows.prepare("UPDATE fingerprint SET rowsReturned=rowsReturned+? "
+                     "WHERE (connectionName, fingerprint) = (SELECT connectionName, fingerprint FROM query WHERE rowid=?)");
+        for(const Item& item: items) {
+            if (item.kind == Item::Rows) {
+                rows.bindValue(0, qMax(0, item.rows));
+                rows.bindValue(1, mIds.value(item.id, item.id));
+                if (!rows.exec()) {
+                    qDebug() << rows.lastError().text() << __FILE__ << __LINE__;
+                }
+                continue;
+            }
+            if (item.kind == Item::Timing) {
+                const QueryTiming& timing = item.timing;
+                qint64 id = mIds.value(item.id, item.id);
+                update.bindValue(0, timing.exec);
+                update.bindValue(1, timing.firstRow > -1 ? QVariant(timing.firstRow) : QVariant());
+                update.bindValue(2, timing.fetch);
+                update.bindValue(3, timing.bytes);
+                update.bindValue(4, timing.model);
+                update.bindValue(5, timing.layout);
+                update.bindValue(6, id);
+                if (!update.exec()) {
+                    qDebug() << update.lastError().text() << __FILE__ << __LINE__;
+                }
+                aggregate.bindValue(0, item.ok ? 0 : 1);
+                aggregate.bindValue(1, timing.total());
+                aggregate.bindValue(2, timing.total());
+                aggregate.bindValue(3, qMax(0, item.rows));
+                aggregate.bindValue(4, qMax(0, item.rowsAffected));
+                aggregate.bindValue(5, id);
+                if (!aggregate.exec()) {
+                    qDebug() << aggregate.lastError().text() << __FILE__ << __LINE__;
+                }
+                continue;
+            }
+            QString fingerprint = SqlParse::fingerprint(item.query);
+            insert.bindValue(0, item.id);
+            insert.bindValue(1, item.date);
+            insert.bindValue(2, item.connectionName);
+            insert.bindValue(3, item.query);
+            insert.bindValue(4, fingerprint);
+            if (insert.exec()) {
+                continue;
+            }
+            // id is taken by another instance of application writing same file
+            QSqlQuery q(db);
+            q.prepare("INSERT INTO query(date, connectionName, query, fingerprint) VALUES(?, ?, ?, ?)");
+            q.addBindValue(item.date);
+            q.addBindValue(item.connectionName);
+            q.addBindValue(item.query);
+            q.addBindValue(fingerprint);
+            if (q.exec()) {
+                mIds[item.id] = q.lastInsertId().toLongLong();
+            } else {
+                qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+            }
+        }
+        if (!db.commit()) {
+            qDebug() << db.lastError().text() << __FILE__ << __LINE__;
+        }
+    }
+
+protected:
+    void run() override {
+        const QString connectionName = "_history_writer";
+        {
+            QSqlDatabase db = openDatabase(connectionName, mPath);
+            if (!db.isOpen()) {
+                qDebug() << db.lastError().text() << __FILE__ << __LINE__;
+            }
+            while (true) {
+                QList<Item> items;
+                {
+                    QMutexLocker locker(&mMutex);
+                    while (mItems.isEmpty() && !mStop) {
+                        mWake.wait(&mMutex);
+                    }
+                    if (mItems.isEmpty()) {
+                        break;
+                    }
+                    // script execution adds query after query, commit them in one transaction
+                    QDeadlineTimer deadline(batchMs);
+                    while (!mStop && mFlush == 0 && mItems.size() < maxBatch && !deadline.hasExpired()) {
+                        mWake.wait(&mMutex, deadline);
+                    }
+                    items.swap(mItems);
+                }
+                if (db.isOpen()) {
+                    write(db, items);
+                }
+                QMutexLocker locker(&mMutex);
+                mWritten += items.size();
+                mDone.wakeAll();
+            }
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+
+    QString mPath;
+    QMutex mMutex;
+    QWaitCondition mWake;
+    QWaitCondition mDone;
+    QList<Item> mItems;
+    qint64 mPosted;
+    qint64 mWritten;
+    int mFlush;
+    bool mStop;
+    // ids remapped on collision, accessed by one thread at a time
+    QHash<qint64, qint64> mIds;
+};
+
+History::History(const QString& path) : mWriter(nullptr), mLastId(0), mFts(false)
+{
+    QSqlDatabase db = openDatabase("_history", path);
+    if (!db.isOpen()) {
         QMessageBox::critical(0, "error",db.lastError().text());
-        return;
+    } else {
+        db.exec("create table if not exists database(date datetime, connectionName text, driver text, host text, user text, password text, database text, port int)");
+        db.exec("create table if not exists query(date datetime, connectionName text, query text)");
+        // timing breakdown, ms
+        sql::create_or_alter(db, "query", {"date", "connectionName", "query", "execMs", "firstRowMs", "fetchMs", "bytes", "modelMs", "layoutMs", "fingerprint"});
+        // per query fingerprint totals, time is QueryTiming::total() in ms
+        db.exec("create table if not exists fingerprint(connectionName text, fingerprint text, query text, count int, "
+                "errors int, totalMs int, maxMs int, rowsReturned int, rowsAffected int, lastDate datetime, "
+                "primary key(connectionName, fingerprint))");
+        // history widget filters by date and connection and sorts by date
+        db.exec("create index if not exists query_date on query(date)");
+        db.exec("create index if not exists query_connectionName_date on query(connectionName, date)");
+        db.exec("create table if not exists relations(name text, value text)");
+        // latencies, ms
+        db.exec("create table if not exists loadtest(date datetime, connectionName text, query text, concurrency int, "
+                "iterations int, errors int, seconds double, minMs double, meanMs double, p50Ms double, p95Ms double, "
+                "p99Ms double, maxMs double)");
+        mFts = createFts(db);
+        QSqlQuery q(db);
+        if (q.exec("select max(rowid) from query") && q.next()) {
+            mLastId.storeRelaxed(q.value(0).toLongLong());
+        }
     }
+    mWriter = new HistoryWriter(path);
+    mWriter->start();
+}
 
-    db.exec("create table if not exists database(date datetime, connectionName text, driver text, host text, user text, password text, database text, port int)");
-    db.exec("create table if not exists query(date datetime, connectionName text, query text)");
-    db.exec("create table if not exists relations(name text, value text)");
+History::~History()
+{
+    close();
+    delete mWriter;
+    QSqlDatabase::database("_history").close();
+    QSqlDatabase::removeDatabase("_history");
 }
 
 History *History::mInstance = 0;
@@ -37,24 +284,201 @@ History *History::mInstance = 0;
 History *History::instance()
 {
     if (!mInstance) {
-        mInstance = new History();
+        QDir d(Settings::instance()->dir());
+        mInstance = new History(d.filePath("history.sqlite"));
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, [](){
+            mInstance->close();
+        });
     }
     return mInstance;
 }
 
-// python insert-record.py -o tmp.txt query -c date connectionName query
-static void insert_into_query(QSqlDatabase db, const QVariant& date, const QVariant& connectionName, const QVariant& query) {
+bool History::createFts(QSqlDatabase db)
+{
+    static const QStringList triggers = {
+        "create trigger query_fts_insert after insert on query begin "
+        "insert into query_fts(rowid, query) values (new.rowid, new.query); end",
+        "create trigger query_fts_delete after delete on query begin "
+        "insert into query_fts(query_fts, rowid, query) values ('delete', old.rowid, old.query); end",
+        "create trigger query_fts_update after update of query on query begin "
+        "insert into query_fts(query_fts, rowid, query) values ('delete', old.rowid, old.query); "
+        "insert into query_fts(rowid, query) values (new.rowid, new.query); end"
+    };
     QSqlQuery q(db);
-    q.prepare("INSERT INTO query(date, connectionName, query) VALUES(?, ?, ?)");
-    q.addBindValue(date);
-    q.addBindValue(connectionName);
-    q.addBindValue(query);
+    if (!q.exec("select rowid from query_fts limit 0")) {
+        // trigram tokenizer (sqlite 3.34) indexes every 3 characters, so match works as substring search
+        if (!q.exec("create virtual table query_fts using fts5(query, content='query', tokenize='trigram')")) {
+            qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+            // sqlite without fts5, triggers created by other build would fail inserts
+            for(const QString& name: QStringList{"query_fts_insert", "query_fts_delete", "query_fts_update"}) {
+                q.exec("drop trigger if exists " + name);
+            }
+            return false;
+        }
+    }
+    if (q.exec("select 1 from sqlite_master where type='trigger' and name='query_fts_insert'") && q.next()) {
+        return true;
+    }
+    q.finish();
+    db.transaction();
+    for(const QString& trigger: triggers) {
+        if (!q.exec(trigger)) {
+            qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+        }
+    }
+    // index existing history, once
+    if (!q.exec("insert into query_fts(query_fts) values ('rebuild')")) {
+        qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+    }
+    db.commit();
+    return true;
+}
+
+qint64 History::addQuery(const QString& connectionName, const QString& query) {
+    HistoryWriter::Item item;
+    item.id = mLastId.fetchAndAddOrdered(1) + 1;
+    item.kind = HistoryWriter::Item::Insert;
+    item.date = QDateTime::currentDateTime();
+    item.connectionName = connectionName;
+    item.query = query;
+    if (!mWriter->post(item)) {
+        mWriter->write(QSqlDatabase::database("_history"), {item});
+    }
+    return item.id;
+}
+
+void History::setQueryTiming(qint64 id, const QueryTiming &timing, bool ok, int rows, int rowsAffected)
+{
+    if (id < 1) {
+        return;
+    }
+    HistoryWriter::Item item;
+    item.id = id;
+    item.kind = HistoryWriter::Item::Timing;
+    item.timing = timing;
+    item.ok = ok;
+    item.rows = rows;
+    item.rowsAffected = rowsAffected;
+    if (!mWriter->post(item)) {
+        mWriter->write(QSqlDatabase::database("_history"), {item});
+    }
+}
+
+void History::setQueryRows(qint64 id, int rows)
+{
+    if (id < 1) {
+        return;
+    }
+    HistoryWriter::Item item;
+    item.id = id;
+    item.kind = HistoryWriter::Item::Rows;
+    item.rows = rows;
+    if (!mWriter->post(item)) {
+        mWriter->write(QSqlDatabase::database("_history"), {item});
+    }
+}
+
+void History::flush()
+{
+    mWriter->flush();
+}
+
+void History::close()
+{
+    if (mWriter->isRunning()) {
+        mWriter->stop();
+    }
+}
+
+bool History::hasFts() const
+{
+    return mFts;
+}
+
+void History::textCondition(const QString &text, QStringList &conditions, QVariantList &values) const
+{
+    if (text.isEmpty()) {
+        return;
+    }
+    // trigram index can't match shorter strings
+    if (mFts && text.size() >= 3) {
+        conditions.append("rowid in (select rowid from query_fts where query_fts match ?)");
+        values.append("\"" + QString(text).replace("\"", "\"\"") + "\"");
+    } else {
+        conditions.append("query like ?");
+        values.append("%" + text + "%");
+    }
+}
+
+void History::dateCondition(const QDate &date1, const QDate &date2, QStringList &conditions, QVariantList &values)
+{
+    // date is stored as iso text, comparing text uses index, date(date) doesn't
+    if (date1.isValid()) {
+        conditions.append("date >= ?");
+        values.append(date1.toString(Qt::ISODate));
+    }
+    if (date2.isValid()) {
+        conditions.append("date < ?");
+        values.append(date2.addDays(1).toString(Qt::ISODate));
+    }
+}
+
+void History::addLoadTest(const LoadTest::Result &result)
+{
+    QSqlDatabase db = QSqlDatabase::database("_history");
+    QSqlQuery q(db);
+    q.prepare("INSERT INTO loadtest(date, connectionName, query, concurrency, iterations, errors, seconds, "
+              "minMs, meanMs, p50Ms, p95Ms, p99Ms, maxMs) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    q.addBindValue(result.started);
+    q.addBindValue(result.connectionName);
+    q.addBindValue(result.query);
+    q.addBindValue(result.concurrency);
+    q.addBindValue(result.iterations);
+    q.addBindValue(result.errors);
+    q.addBindValue(result.seconds);
+    q.addBindValue(result.min);
+    q.addBindValue(result.mean);
+    q.addBindValue(result.p50);
+    q.addBindValue(result.p95);
+    q.addBindValue(result.p99);
+    q.addBindValue(result.max);
     QUERY_EXEC(q);
 }
 
-void History::addQuery(const QString& connectionName, const QString& query) {
+QList<LoadTest::Result> History::loadTests(const QString &connectionName, const QString &query)
+{
     QSqlDatabase db = QSqlDatabase::database("_history");
-    insert_into_query(db, QDateTime::currentDateTime(), connectionName, query);
+    QSqlQuery q(db);
+    q.prepare(QString("SELECT date, connectionName, query, concurrency, iterations, errors, seconds, "
+                      "minMs, meanMs, p50Ms, p95Ms, p99Ms, maxMs FROM loadtest WHERE connectionName=? %1 "
+                      "ORDER BY date DESC").arg(query.isEmpty() ? "" : "AND query=?"));
+    q.addBindValue(connectionName);
+    if (!query.isEmpty()) {
+        q.addBindValue(query);
+    }
+    QList<LoadTest::Result> res;
+    if (!q.exec()) {
+        qDebug() << q.lastError().text();
+        return res;
+    }
+    while (q.next()) {
+        LoadTest::Result result;
+        result.started = q.value(0).toDateTime();
+        result.connectionName = q.value(1).toString();
+        result.query = q.value(2).toString();
+        result.concurrency = q.value(3).toInt();
+        result.iterations = q.value(4).toLongLong();
+        result.errors = q.value(5).toLongLong();
+        result.seconds = q.value(6).toDouble();
+        result.min = q.value(7).toDouble();
+        result.mean = q.value(8).toDouble();
+        result.p50 = q.value(9).toDouble();
+        result.p95 = q.value(10).toDouble();
+        result.p99 = q.value(11).toDouble();
+        result.max = q.value(12).toDouble();
+        res.append(result);
+    }
+    return res;
 }
 
 void History::addJoin(const QString& connectionName1, const QString& query1, const QStringList& columns1,
@@ -3,6 +3,17 @@
 
 #include <QString>
 #include <QObject>
+#include <QAtomicInteger>
+#include <QVariantList>
+#include "loadtest.h"
+struct QueryTiming;
+class HistoryWriter;
+class QSqlDatabase;
+class QDate;
+
+// Queries are written by background thread in batched transactions (WAL journal),
+// ids are allocated upfront so caller can attach timing before record is written.
+// Query text is indexed by fts5 trigram table for substring search.
 
 class History
 {
@@ -10,15 +21,41 @@ public:
 
     static History* instance();
 
-    void addQuery(const QString &database, const QString &query);
+    explicit History(const QString& path);
+    ~History();
+
+    // returns id of history record
+    qint64 addQuery(const QString &database, const QString &query);
+    // once per query, adds execution to statistics of query fingerprint
+    void setQueryTiming(qint64 id, const QueryTiming& timing, bool ok = true, int rows = -1, int rowsAffected = -1);
+    // rows returned by query that were not known at setQueryTiming (result read as view scrolls)
+    void setQueryRows(qint64 id, int rows);
     void addDatabase(const QString &connectionName, const QString &driver, const QString &host, const QString &user, const QString &password, const QString &database, int port);
 
+    // blocks until queued queries are written
+    void flush();
+    // flushes and stops writer, queries added after that are written synchronously
+    void close();
+
+    bool hasFts() const;
+    // appends condition on query.query that matches substring text
+    void textCondition(const QString& text, QStringList& conditions, QVariantList& values) const;
+    // appends condition on query.date, date2 inclusive, null date is open end
+    static void dateCondition(const QDate& date1, const QDate& date2, QStringList& conditions, QVariantList& values);
+
+    void addLoadTest(const LoadTest::Result& result);
+    // newest first
+    QList<LoadTest::Result> loadTests(const QString& connectionName, const QString& query = QString());
+
     void addJoin(const QString &connectionName1, const QString &query1, const QStringList &columns1,
                  const QString &connectionName2, const QString &query2, const QStringList &columns2);
 protected:
     static History* mInstance;
-    History(QObject* parent = 0);
+    static bool createFts(QSqlDatabase db);
 
+    HistoryWriter* mWriter;
+    QAtomicInteger<qint64> mLastId;
+    bool mFts;
 };
 
 #endif // HISTORY_H
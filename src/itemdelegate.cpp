@@ -5,37 +5,50 @@
 
 #include "settings.h"
 
+static const int maxDisplaySize = 4096;
 
-ItemDelegate::ItemDelegate(QObject *parent) : QStyledItemDelegate (parent)
+ItemDelegate::ItemDelegate(QObject *parent) : QStyledItemDelegate (parent),
+    mFormats(DataFormat::ActionView), mRevision(Settings::instance()->revision())
 {
 
 }
 
+const Formats &ItemDelegate::formats() const
+{
+    int revision = Settings::instance()->revision();
+    if (mRevision != revision) {
+        mFormats = Formats(DataFormat::ActionView);
+        mRevision = revision;
+    }
+    return mFormats;
+}
+
 QString ItemDelegate::displayText(const QVariant &value, const QLocale &locale) const
 {
     auto t = value.typeId();
     if (t == QMetaType::QDateTime || t == QMetaType::QDate || t == QMetaType::QTime) {
-        if (Settings::instance()->dateTimeUseLocale()) {
+        const Formats& formats = this->formats();
+        if (formats.dateTimeUseLocale) {
             return QStyledItemDelegate::displayText(value,locale);
         } else {
             if (t == QMetaType::QDateTime) {
-                const QDateTime dateTime = value.toDateTime();
-                QString text = dateTime.toString(Settings::instance()->dateFormat())
-                        + QLatin1Char(' ')
-                        + dateTime.toString(Settings::instance()->timeFormat());
-                return text;
+                return formats.dateTimeFormatter.toString(value.toDateTime());
             } else if (t == QMetaType::QDate) {
-                return value.toDate().toString(Settings::instance()->dateFormat());
+                return formats.dateFormatter.toString(value.toDate());
             } else if (t == QMetaType::QTime) {
-                return value.toTime().toString(Settings::instance()->timeFormat());
+                return formats.timeFormatter.toString(value.toTime());
             }
         }
     } else if (t == QMetaType::Double) {
-        if (!Settings::instance()->realUseLocale()) {
+        if (!formats().realUseLocale) {
             return QString::number(value.toDouble());
         }
     } else if (t == QMetaType::QByteArray) {
+        // only visible part of value is decoded
         QByteArray data = value.toByteArray();
+        if (data.size() > maxDisplaySize) {
+            return QString::fromUtf8(data.left(maxDisplaySize)) + QChar(0x2026);
+        }
         return QString::fromUtf8(data);
 
 #if 0
@@ -60,6 +73,11 @@ QString ItemDelegate::displayText(const QVariant &value, const QLocale &locale)
         }
         return hex.join(" ");
 #endif
+    } else if (t == QMetaType::QString) {
+        QString text = value.toString();
+        if (text.size() > maxDisplaySize) {
+            return QStyledItemDelegate::displayText(text.left(maxDisplaySize) + QChar(0x2026), locale);
+        }
     } else if (t == QMetaType::QVariantList) {
         QVariantList vs = value.toList();
         QVariant v1 = vs.value(0);
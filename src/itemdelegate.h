@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QStyledItemDelegate>
+#include "formats.h"
 
 class ItemDelegate : public QStyledItemDelegate
 {
@@ -13,7 +14,12 @@ public:
 
     QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
 
+protected:
+    // formats compiled from settings, rebuilt when settings change
+    const Formats& formats() const;
 
+    mutable Formats mFormats;
+    mutable int mRevision;
 };
 
 #endif // ITEMDELEGATE_H
@@ -0,0 +1,213 @@
+#include "largefile.h"
+
+#include <cstring>
+#include "trace.h"
+
+LargeFile::LargeFile() : mData(nullptr), mSize(0)
+{
+
+}
+
+LargeFile::~LargeFile()
+{
+    close();
+}
+
+bool LargeFile::open(const QString &path)
+{
+    TRACE_SCOPE("LargeFile::open");
+    close();
+    mFile.setFileName(path);
+    if (!mFile.open(QIODevice::ReadOnly)) {
+        mError = mFile.errorString();
+        return false;
+    }
+    mSize = mFile.size();
+    if (mSize == 0) {
+        return true;
+    }
+    uchar* data = mFile.map(0, mSize);
+    if (!data) {
+        mError = mFile.errorString();
+        mFile.close();
+        mSize = 0;
+        return false;
+    }
+    mData = reinterpret_cast<const char*>(data);
+    qint64 pos = (mSize >= 3 && memcmp(mData, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+    mLines.append(pos);
+    while (pos < mSize) {
+        const void* newline = memchr(mData + pos, '\n', size_t(mSize - pos));
+        if (!newline) {
+            break;
+        }
+        pos = static_cast<const char*>(newline) - mData + 1;
+        if (pos < mSize) {
+            mLines.append(pos);
+        }
+    }
+    mCheckpoints.resize((mLines.size() + checkpointLines - 1) / checkpointLines);
+    mCheckpoints[0] = {SqlLexer::State(), true, true};
+    return true;
+}
+
+void LargeFile::close()
+{
+    if (mData) {
+        mFile.unmap(reinterpret_cast<uchar*>(const_cast<char*>(mData)));
+        mData = nullptr;
+    }
+    mFile.close();
+    mSize = 0;
+    mLines.clear();
+    mCheckpoints.clear();
+    mError.clear();
+}
+
+QString LargeFile::path() const
+{
+    return mFile.fileName();
+}
+
+QString LargeFile::errorString() const
+{
+    return mError;
+}
+
+qint64 LargeFile::size() const
+{
+    return mSize;
+}
+
+qint64 LargeFile::lineCount() const
+{
+    return mLines.size();
+}
+
+qint64 LargeFile::lineOffset(qint64 line) const
+{
+    return line < mLines.size() ? mLines[line] : mSize;
+}
+
+qint64 LargeFile::lineSize(qint64 line) const
+{
+    qint64 begin = lineOffset(line);
+    qint64 end = lineOffset(line + 1);
+    if (end > begin && mData[end - 1] == '\n') {
+        end--;
+    }
+    if (end > begin && mData[end - 1] == '\r') {
+        end--;
+    }
+    return end - begin;
+}
+
+QString LargeFile::line(qint64 line, qint64 maxBytes) const
+{
+    if (line < 0 || line >= mLines.size()) {
+        return QString();
+    }
+    qint64 size = lineSize(line);
+    if (maxBytes >= 0) {
+        size = qMin(size, maxBytes);
+    }
+    return QString::fromUtf8(mData + mLines[line], size);
+}
+
+void LargeFile::lexLine(qint64 line, SqlLexer::State *state) const
+{
+    QString text = this->line(line);
+    SqlLexer lexer(text, state);
+    SqlLexer::Token token;
+    while (lexer.next(token)) {
+        // state only
+    }
+}
+
+SqlLexer::State LargeFile::state(qint64 line, bool exact)
+{
+    if (mLines.isEmpty()) {
+        return SqlLexer::State();
+    }
+    line = qBound(qint64(0), line, lineCount() - 1);
+    qint64 target = line / checkpointLines;
+    qint64 known = target;
+    while (known > 0 && !(mCheckpoints[known].valid && (mCheckpoints[known].exact || !exact))) {
+        known--;
+    }
+    if (!exact && known < target
+            && lineOffset(target * checkpointLines) - lineOffset(known * checkpointLines) > maxLexBytes) {
+        known = target;
+        mCheckpoints[known] = {SqlLexer::State(), true, false};
+    }
+    SqlLexer::State state = mCheckpoints[known].state;
+    bool stateExact = mCheckpoints[known].exact;
+    for(qint64 i=known * checkpointLines;i<line;i++) {
+        if (i % checkpointLines == 0 && i / checkpointLines > known) {
+            Checkpoint& checkpoint = mCheckpoints[i / checkpointLines];
+            if (!checkpoint.valid || (stateExact && !checkpoint.exact)) {
+                checkpoint = {state, true, stateExact};
+            }
+        }
+        lexLine(i, &state);
+    }
+    return state;
+}
+
+bool LargeFile::statementRange(qint64 first, qint64 last, ScriptRunner::Position &from, qint64 &to)
+{
+    TRACE_SCOPE("LargeFile::statementRange");
+    if (mLines.isEmpty() || first > last) {
+        return false;
+    }
+    state(first, true);
+    // start lexing at checkpoint between statements
+    qint64 known = first / checkpointLines;
+    while (known > 0) {
+        const Checkpoint& checkpoint = mCheckpoints[known];
+        if (checkpoint.valid && checkpoint.exact && checkpoint.state.context == SqlLexer::Code
+                && checkpoint.state.statementStart) {
+            break;
+        }
+        known--;
+    }
+    SqlLexer::State state = mCheckpoints[known].state;
+    qint64 start = known * checkpointLines;
+    // position after last delimiter
+    ScriptRunner::Position boundary = {lineOffset(start), state.delimiter};
+    bool inStatement = false;
+    bool found = false;
+    for(qint64 i=start;i<lineCount();i++) {
+        QString text = line(i);
+        SqlLexer lexer(text, &state);
+        SqlLexer::Token token;
+        while (lexer.next(token)) {
+            switch (token.type) {
+            case SqlLexer::Whitespace:
+            case SqlLexer::Comment:
+            case SqlLexer::DelimiterCommand:
+                break;
+            case SqlLexer::Delimiter:
+                boundary = {lineOffset(i) + SqlSplitter::utf8Size(QStringView(text).left(token.pos + token.size)),
+                            state.delimiter};
+                inStatement = false;
+                break;
+            default:
+                if (!inStatement) {
+                    inStatement = true;
+                    if (i > last) {
+                        to = boundary.offset;
+                        return found;
+                    }
+                    if (i >= first && !found) {
+                        from = boundary;
+                        found = true;
+                    }
+                }
+                break;
+            }
+        }
+    }
+    to = mSize;
+    return found;
+}
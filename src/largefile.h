@@ -0,0 +1,63 @@
+#ifndef LARGEFILE_H
+#define LARGEFILE_H
+
+#include <QFile>
+#include <QList>
+#include "sqllexer.h"
+#include "scriptrunner.h"
+
+// Memory mapped sql file with line index, text is decoded line by line and never
+// copied into QString as whole. Lexer state at start of every checkpointLines-th
+// line is computed on demand and cached, so any line can be highlighted by lexing
+// at most checkpointLines lines.
+
+class LargeFile
+{
+public:
+    LargeFile();
+    ~LargeFile();
+
+    bool open(const QString& path);
+    void close();
+
+    QString path() const;
+    QString errorString() const;
+
+    qint64 size() const;
+    qint64 lineCount() const;
+    // byte offset of line start
+    qint64 lineOffset(qint64 line) const;
+    // bytes without line break
+    qint64 lineSize(qint64 line) const;
+    QString line(qint64 line, qint64 maxBytes = -1) const;
+
+    // lexer state at start of line. When exact is false and last known state is more
+    // than maxLexBytes before line, lexing starts from default state (may be wrong
+    // inside of huge multiline string or comment, good enough for highlighting)
+    SqlLexer::State state(qint64 line, bool exact);
+
+    // range of statements whose first token is within lines first..last, to is byte
+    // offset after last delimiter
+    bool statementRange(qint64 first, qint64 last, ScriptRunner::Position& from, qint64& to);
+
+    void lexLine(qint64 line, SqlLexer::State* state) const;
+
+    static const int checkpointLines = 64;
+    static const qint64 maxLexBytes = 64 * 1024 * 1024;
+
+protected:
+    struct Checkpoint {
+        SqlLexer::State state;
+        bool valid = false;
+        bool exact = false;
+    };
+
+    QFile mFile;
+    const char* mData;
+    qint64 mSize;
+    QList<qint64> mLines;
+    QList<Checkpoint> mCheckpoints;
+    QString mError;
+};
+
+#endif // LARGEFILE_H
@@ -0,0 +1,246 @@
+#include "loadtest.h"
+
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <algorithm>
+#include <cmath>
+
+#include "connectionpool.h"
+#include "trace.h"
+
+struct LoadTest::State {
+    QString connectionName;
+    QString query;
+    qint64 iterations = 0;
+    int duration = 0;
+    QElapsedTimer time;
+    QAtomicInteger<qint64> next;
+    QAtomicInt active;
+    QAtomicInt cancelled;
+    QMutex mutex;
+    LoadTest* owner = nullptr;
+};
+
+double LoadTest::Result::throughput() const
+{
+    return seconds > 0 ? iterations / seconds : 0;
+}
+
+LoadTest::LoadTest(const QString &connectionName, const QString &query, QObject *parent)
+    : QObject{parent}, mState(new State()), mConnectionName(connectionName), mQuery(query),
+      mTime(0), mConcurrency(0), mErrors(0), mFinished(false)
+{
+    mState->connectionName = connectionName;
+    mState->query = query;
+    mState->owner = this;
+}
+
+LoadTest::~LoadTest()
+{
+    mState->cancelled.storeRelease(1);
+    QMutexLocker locker(&mState->mutex);
+    mState->owner = nullptr;
+}
+
+void LoadTest::start(int concurrency, qint64 iterations, int duration)
+{
+    mConcurrency = qMax(1, concurrency);
+    mState->iterations = iterations;
+    mState->duration = duration;
+    mStarted = QDateTime::currentDateTime();
+    mState->active.storeRelease(mConcurrency);
+    mState->time.start();
+    QSharedPointer<State> state = mState;
+    for(int i=0;i<mConcurrency;i++) {
+        ConnectionPool::startWorker([state, i](){
+            run(state, i);
+        });
+    }
+}
+
+void LoadTest::run(QSharedPointer<State> state, int worker)
+{
+    TRACE_SCOPE("LoadTest::run");
+    QList<double> samples;
+    int errors = 0;
+    QString error;
+    QElapsedTimer batch;
+    batch.start();
+
+    auto flush = [&]() {
+        QMutexLocker locker(&state->mutex);
+        if (state->owner && (!samples.isEmpty() || errors > 0)) {
+            QMetaObject::invokeMethod(state->owner, "onSamples", Qt::QueuedConnection,
+                                      Q_ARG(QList<double>, samples), Q_ARG(int, errors), Q_ARG(QString, error));
+        }
+        samples.clear();
+        errors = 0;
+        batch.restart();
+    };
+
+    {
+        ConnectionLease lease(state->connectionName);
+        if (!lease.isValid()) {
+            errors++;
+            error = lease.error();
+        } else {
+            QRandomGenerator random(quint32(worker) + 1);
+            bool isTemplate = LoadTest::isTemplate(state->query);
+            QSqlQuery q(lease.database());
+            q.setForwardOnly(true);
+            bool prepared = !isTemplate && q.prepare(state->query);
+            QElapsedTimer time;
+            while (!state->cancelled.loadAcquire()) {
+                if (state->duration > 0 && state->time.elapsed() >= state->duration) {
+                    break;
+                }
+                qint64 iteration = state->next.fetchAndAddOrdered(1);
+                if (state->iterations > 0 && iteration >= state->iterations) {
+                    break;
+                }
+                time.start();
+                bool ok;
+                if (prepared) {
+                    ok = q.exec();
+                } else {
+                    ok = q.exec(isTemplate ? expand(state->query, iteration, random) : state->query);
+                }
+                if (ok) {
+                    while (q.next()) {
+                    }
+                    samples.append(time.nsecsElapsed() / 1e6);
+                } else {
+                    errors++;
+                    error = q.lastError().text();
+                }
+                q.finish();
+                if (batch.elapsed() >= batchMs) {
+                    flush();
+                }
+            }
+        }
+    }
+    flush();
+
+    if (state->active.fetchAndSubOrdered(1) == 1) {
+        QMutexLocker locker(&state->mutex);
+        if (state->owner) {
+            QMetaObject::invokeMethod(state->owner, "onWorkerFinished", Qt::QueuedConnection);
+        }
+    }
+}
+
+void LoadTest::onSamples(QList<double> samples, int errors, QString error)
+{
+    mLatencies.append(samples);
+    mErrors += errors;
+    if (!error.isEmpty()) {
+        mLastError = error;
+    }
+    emit progress();
+}
+
+void LoadTest::onWorkerFinished()
+{
+    mTime = mState->time.elapsed();
+    mFinished = true;
+    emit finished();
+}
+
+void LoadTest::cancel()
+{
+    mState->cancelled.storeRelease(1);
+}
+
+bool LoadTest::isFinished() const
+{
+    return mFinished;
+}
+
+const QList<double> &LoadTest::latencies() const
+{
+    return mLatencies;
+}
+
+qint64 LoadTest::errorCount() const
+{
+    return mErrors;
+}
+
+QString LoadTest::lastError() const
+{
+    return mLastError;
+}
+
+LoadTest::Result LoadTest::result() const
+{
+    Result res;
+    res.connectionName = mConnectionName;
+    res.query = mQuery;
+    res.started = mStarted;
+    res.concurrency = mConcurrency;
+    res.iterations = mLatencies.size();
+    res.errors = mErrors;
+    res.seconds = (mFinished ? mTime : mState->time.elapsed()) / 1000.0;
+    if (mLatencies.isEmpty()) {
+        return res;
+    }
+    QList<double> sorted = mLatencies;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0;
+    for(double value: std::as_const(sorted)) {
+        sum += value;
+    }
+    res.min = sorted.first();
+    res.max = sorted.last();
+    res.mean = sum / sorted.size();
+    res.p50 = percentile(sorted, 50);
+    res.p95 = percentile(sorted, 95);
+    res.p99 = percentile(sorted, 99);
+    return res;
+}
+
+double LoadTest::percentile(const QList<double> &sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    qsizetype rank = qsizetype(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[qBound<qsizetype>(0, rank - 1, sorted.size() - 1)];
+}
+
+static QRegularExpression placeholderRx() {
+    static QRegularExpression rx("\\$\\{(i|random:(-?\\d+):(-?\\d+))\\}");
+    return rx;
+}
+
+bool LoadTest::isTemplate(const QString &query)
+{
+    return placeholderRx().match(query).hasMatch();
+}
+
+QString LoadTest::expand(const QString &query, qint64 iteration, QRandomGenerator &random)
+{
+    QString res;
+    qsizetype pos = 0;
+    auto it = placeholderRx().globalMatch(query);
+    while (it.hasNext()) {
+        QRegularExpressionMatch m = it.next();
+        res.append(QStringView(query).mid(pos, m.capturedStart() - pos));
+        if (m.captured(1) == "i") {
+            res.append(QString::number(iteration));
+        } else {
+            qint64 min = m.captured(2).toLongLong();
+            qint64 max = m.captured(3).toLongLong();
+            res.append(QString::number(max > min ? min + random.bounded(max - min + 1) : min));
+        }
+        pos = m.capturedEnd();
+    }
+    res.append(QStringView(query).mid(pos));
+    return res;
+}
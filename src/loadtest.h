@@ -0,0 +1,89 @@
+#ifndef LOADTEST_H
+#define LOADTEST_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QDateTime>
+#include <QList>
+class QRandomGenerator;
+
+// Runs query repeatedly on several connections leased from ConnectionPool to see how it
+// behaves under concurrency. Each worker executes query and reads all rows, latency of
+// execution includes fetch. Query can be template: ${i} is replaced with iteration number
+// and ${random:min:max} with random integer, query without placeholders is prepared once
+// per worker. Latencies are sent to gui thread in batches, progress() is emitted for each batch.
+
+class LoadTest : public QObject
+{
+    Q_OBJECT
+public:
+    struct Result {
+        QString connectionName;
+        QString query;
+        QDateTime started;
+        int concurrency = 0;
+        qint64 iterations = 0;
+        qint64 errors = 0;
+        double seconds = 0;
+        // latencies, ms
+        double min = 0;
+        double mean = 0;
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+        double max = 0;
+
+        double throughput() const;
+    };
+
+    LoadTest(const QString& connectionName, const QString& query, QObject* parent = nullptr);
+    ~LoadTest();
+
+    // stops after iterations or duration (ms), whichever comes first, 0 means no limit
+    void start(int concurrency, qint64 iterations, int duration);
+
+    // workers stop after current execution
+    void cancel();
+
+    bool isFinished() const;
+
+    // latencies of finished executions (ms) in order of arrival
+    const QList<double>& latencies() const;
+    qint64 errorCount() const;
+    QString lastError() const;
+
+    Result result() const;
+
+    // nearest rank, values must be sorted
+    static double percentile(const QList<double>& sorted, double p);
+
+    static bool isTemplate(const QString& query);
+    static QString expand(const QString& query, qint64 iteration, QRandomGenerator& random);
+
+    static const int batchMs = 100;
+
+signals:
+    void progress();
+    void finished();
+
+protected slots:
+    void onSamples(QList<double> samples, int errors, QString error);
+    void onWorkerFinished();
+
+protected:
+    struct State;
+    static void run(QSharedPointer<State> state, int worker);
+
+    QSharedPointer<State> mState;
+    QString mConnectionName;
+    QString mQuery;
+    QDateTime mStarted;
+    qint64 mTime;
+    int mConcurrency;
+    QList<double> mLatencies;
+    qint64 mErrors;
+    QString mLastError;
+    bool mFinished;
+};
+
+#endif // LOADTEST_H
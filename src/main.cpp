@@ -4,6 +4,7 @@
 #include "version.h"
 #include "tests.h"
 #include "datetime.h"
+#include "trace.h"
 #include <QDebug>
 #include <QTimeZone>
 
@@ -16,6 +17,15 @@ int main(int argc, char *argv[])
     a.setApplicationName("mugi-query");
     a.setApplicationVersion(VERSION);
 
+    // MUGI_TRACE=200 - trace from start, record gui stalls longer than 200 ms
+    if (qEnvironmentVariableIsSet("MUGI_TRACE")) {
+        int threshold = qEnvironmentVariableIntValue("MUGI_TRACE");
+        if (threshold > 0) {
+            Trace::instance()->setStallThreshold(threshold);
+        }
+        Trace::instance()->setEnabled(true);
+    }
+
     MainWindow w;
     w.show();
 
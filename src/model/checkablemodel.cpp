@@ -22,6 +22,13 @@ void CheckableModel::setChecked(Qt::CheckState state) {
     }
 }
 
+void CheckableModel::setChecked(const QStringList &items) {
+    for(int row=0;row<this->rowCount();row++) {
+        auto index = this->index(row, 0);
+        this->setData(index, items.contains(this->data(index).toString()) ? Qt::Checked : Qt::Unchecked, Qt::CheckStateRole);
+    }
+}
+
 QStringList CheckableModel::checked() const {
     QStringList res;
     for(int row=0;row<this->rowCount();row++) {
@@ -12,6 +12,7 @@ public:
     void append(const QStringList& items);
 
     void setChecked(Qt::CheckState state);
+    void setChecked(const QStringList& items);
     QStringList checked() const;
 public slots:
     void checkAll();
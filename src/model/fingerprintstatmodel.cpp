@@ -0,0 +1,21 @@
+#include "fingerprintstatmodel.h"
+
+#include <QSqlQuery>
+#include "query_exec.h"
+
+FingerprintStatModel::FingerprintStatModel(QObject *parent) : QSqlQueryModel(parent)
+{
+
+}
+
+void FingerprintStatModel::select(Order order, int limit)
+{
+    static const QStringList orderBy = {"totalMs", "meanMs", "maxMs", "count"};
+    QSqlQuery q(QSqlDatabase::database("_history"));
+    q.prepare(QString("select connectionName, fingerprint, count, errors, totalMs, "
+                      "round(totalMs * 1.0 / count, 1) as meanMs, maxMs, rowsReturned, rowsAffected, lastDate, query "
+                      "from fingerprint order by %1 desc limit ?").arg(orderBy[order]));
+    q.addBindValue(limit);
+    QUERY_EXEC(q);
+    setQuery(std::move(q));
+}
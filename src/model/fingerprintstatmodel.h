@@ -0,0 +1,36 @@
+#ifndef FINGERPRINTSTATMODEL_H
+#define FINGERPRINTSTATMODEL_H
+
+#include <QSqlQueryModel>
+
+// Per fingerprint execution statistics from history, see History::setQueryTiming
+
+class FingerprintStatModel : public QSqlQueryModel
+{
+    Q_OBJECT
+public:
+    enum cols {
+        col_connectionName,
+        col_fingerprint,
+        col_count,
+        col_errors,
+        col_totalMs,
+        col_meanMs,
+        col_maxMs,
+        col_rowsReturned,
+        col_rowsAffected,
+        col_lastDate,
+        col_query
+    };
+    enum Order {
+        TotalTime,
+        MeanTime,
+        MaxTime,
+        Count
+    };
+    FingerprintStatModel(QObject *parent = nullptr);
+
+    void select(Order order, int limit = 1000);
+};
+
+#endif // FINGERPRINTSTATMODEL_H
@@ -0,0 +1,262 @@
+#include "largevaluemodel.h"
+
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlField>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include "drivernames.h"
+#include "settings.h"
+#include "storesqlresult.h"
+#include "sqllexer.h"
+
+namespace {
+
+QString unquoteIdentifier(const QString& name) {
+    if (name.size() > 1) {
+        QChar first = name[0];
+        QChar last = name[name.size()-1];
+        if ((first == '`' && last == '`') || (first == '"' && last == '"') || (first == '[' && last == ']')) {
+            return name.mid(1, name.size() - 2);
+        }
+    }
+    return name;
+}
+
+bool largeColumnExprs(const QString& driverName, const QString& column, bool binary, int prefix,
+                      QString& prefixExpr, QString& lengthExpr) {
+    if (driverName == DRIVER_MYSQL || driverName == DRIVER_MARIADB) {
+        prefixExpr = QString("SUBSTRING(%1,1,%2)").arg(column).arg(prefix);
+        lengthExpr = QString(binary ? "LENGTH(%1)" : "CHAR_LENGTH(%1)").arg(column);
+        return true;
+    } else if (driverName == DRIVER_SQLITE) {
+        prefixExpr = QString("substr(%1,1,%2)").arg(column).arg(prefix);
+        lengthExpr = QString("length(%1)").arg(column);
+        return true;
+    } else if (driverName == DRIVER_PSQL) {
+        prefixExpr = QString("substring(%1 from 1 for %2)").arg(column).arg(prefix);
+        lengthExpr = QString(binary ? "octet_length(%1)" : "char_length(%1)").arg(column);
+        return true;
+    }
+    // todo odbc: mssql and access have different substring and length functions
+    return false;
+}
+
+bool isLargeField(const QSqlField& field, int prefix) {
+    int type = field.metaType().id();
+    if (type != QMetaType::QString && type != QMetaType::QByteArray) {
+        return false;
+    }
+    return field.length() < 0 || field.length() > prefix;
+}
+
+int valueCost(const QVariant& value) {
+    if (value.typeId() == QMetaType::QByteArray) {
+        return qMax(1, (int) value.toByteArray().size());
+    }
+    return qMax(1, (int) value.toString().size() * 2);
+}
+
+}
+
+LargeValueModel::LargeValueModel(QObject *parent) : QSqlQueryModel(parent), mPrefix(0)
+{
+    mCache.setMaxCost(qint64(qMax(1, Settings::instance()->largeValueCacheSize())) * 1024 * 1024);
+}
+
+LargeValueModel *LargeValueModel::create(const QSqlDatabase &db, const QString &query, int prefix, QObject *parent)
+{
+    if (prefix < 1) {
+        return nullptr;
+    }
+
+    // only plain select * from single table, anything that can bring columns of other
+    // tables (joins, comma joins, unions, subqueries, table functions) is left as is
+    QList<SqlLexer::Token> tokens = SqlLexer::codeTokens(query);
+    auto text = [&](int i) {
+        return QStringView(query).mid(tokens[i].pos, tokens[i].size);
+    };
+    auto isWord = [&](int i, const char* word) {
+        return i < tokens.size() && tokens[i].type == SqlLexer::Word
+                && text(i).compare(QLatin1String(word), Qt::CaseInsensitive) == 0;
+    };
+    auto isOperator = [&](int i, char c) {
+        return i < tokens.size() && tokens[i].type == SqlLexer::Operator && text(i) == QChar(c);
+    };
+    auto isName = [&](int i) {
+        return i < tokens.size() && (tokens[i].type == SqlLexer::Word || tokens[i].type == SqlLexer::QuotedIdentifier);
+    };
+
+    if (!isWord(0, "select") || !isOperator(1, '*') || !isWord(2, "from") || !isName(3)) {
+        return nullptr;
+    }
+    int last = 3;
+    while (isOperator(last + 1, '.') && isName(last + 2)) {
+        last += 2;
+    }
+    QStringList parts;
+    for(int i=3;i<=last;i+=2) {
+        parts.append(unquoteIdentifier(text(i).toString()));
+    }
+    for(int i=last+1;i<tokens.size();i++) {
+        if (tokens[i].type == SqlLexer::Delimiter && i == tokens.size() - 1) {
+            break;
+        }
+        if (tokens[i].type == SqlLexer::Delimiter || isOperator(i, ',') || isOperator(i, '(')
+                || isWord(i, "join") || isWord(i, "union") || isWord(i, "intersect") || isWord(i, "except")) {
+            return nullptr;
+        }
+    }
+    qsizetype tableBegin = tokens[3].pos;
+    qsizetype tableEnd = tokens[last].pos + tokens[last].size;
+    QString table = parts.join(".");
+    QString tableText = query.mid(tableBegin, tableEnd - tableBegin);
+    QString rest = query.mid(tableEnd);
+
+    QSqlRecord record = db.record(table);
+    QSqlIndex primaryKey = db.primaryIndex(table);
+    if (record.isEmpty() || primaryKey.isEmpty()) {
+        return nullptr;
+    }
+
+    QSqlDriver* driver = db.driver();
+    QString driverName = db.driverName();
+
+    QStringList columns;
+    QStringList lengths;
+    QHash<int,int> lengthColumns;
+
+    for(int c=0;c<record.count();c++) {
+        QSqlField field = record.field(c);
+        QString name = driver->escapeIdentifier(field.name(), QSqlDriver::FieldName);
+        QString prefixExpr;
+        QString lengthExpr;
+        if (!primaryKey.contains(field.name()) && isLargeField(field, prefix)
+                && largeColumnExprs(driverName, name, field.metaType().id() == QMetaType::QByteArray,
+                                    prefix, prefixExpr, lengthExpr)) {
+            columns.append(prefixExpr + " AS " + name);
+            lengthColumns[c] = record.count() + lengths.size();
+            lengths.append(lengthExpr + " AS " + driver->escapeIdentifier(QString("__length_%1").arg(c), QSqlDriver::FieldName));
+        } else {
+            columns.append(name);
+        }
+    }
+
+    if (lengthColumns.isEmpty()) {
+        return nullptr;
+    }
+
+    LargeValueModel* model = new LargeValueModel(parent);
+    model->mConnectionName = db.connectionName();
+    model->mTable = table;
+    model->mRecord = record;
+    model->mPrimaryKey = primaryKey;
+    model->mPrefix = prefix;
+    model->mLengthColumns = lengthColumns;
+    model->mRewrittenQuery = QString("SELECT %1 FROM %2%3")
+            .arg((columns + lengths).join(", "))
+            .arg(tableText)
+            .arg(rest);
+    return model;
+}
+
+QVariant LargeValueModel::fullData(const QAbstractItemModel *model, const QModelIndex &index)
+{
+    if (qobject_cast<const LargeValueModel*>(model)) {
+        return model->data(index, Qt::EditRole);
+    }
+    return model->data(index);
+}
+
+QString LargeValueModel::rewrittenQuery() const
+{
+    return mRewrittenQuery;
+}
+
+int LargeValueModel::valueLength(const QModelIndex &index) const
+{
+    if (!mLengthColumns.contains(index.column())) {
+        return -1;
+    }
+    QModelIndex lengthIndex = createIndex(index.row(), mLengthColumns[index.column()]);
+    QVariant value = QSqlQueryModel::data(lengthIndex, Qt::EditRole);
+    if (value.isNull()) {
+        return -1;
+    }
+    return value.toInt();
+}
+
+bool LargeValueModel::isTruncated(const QModelIndex &index) const
+{
+    return valueLength(index) > mPrefix;
+}
+
+QVariant LargeValueModel::fullValue(const QModelIndex &index) const
+{
+    if (!isTruncated(index)) {
+        return QSqlQueryModel::data(index, Qt::EditRole);
+    }
+
+    QStringList keyValues;
+    QVariantList bindValues;
+    for(int i=0;i<mPrimaryKey.count();i++) {
+        int column = mRecord.indexOf(mPrimaryKey.fieldName(i));
+        QVariant value = QSqlQueryModel::data(createIndex(index.row(), column), Qt::EditRole);
+        keyValues.append(value.toString());
+        bindValues.append(value);
+    }
+    QString key = keyValues.join("\t") + QString("\t%1").arg(index.column());
+
+    if (QVariant* cached = mCache.object(key)) {
+        return *cached;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDriver* driver = db.driver();
+    StoreSqlResult::fetchPending(driver);
+
+    QStringList conditions;
+    for(int i=0;i<mPrimaryKey.count();i++) {
+        conditions.append(driver->escapeIdentifier(mPrimaryKey.fieldName(i), QSqlDriver::FieldName) + " = ?");
+    }
+
+    QSqlQuery q(db);
+    q.prepare(QString("SELECT %1 FROM %2 WHERE %3")
+              .arg(driver->escapeIdentifier(mRecord.fieldName(index.column()), QSqlDriver::FieldName))
+              .arg(driver->escapeIdentifier(mTable, QSqlDriver::TableName))
+              .arg(conditions.join(" AND ")));
+    for(const QVariant& value: std::as_const(bindValues)) {
+        q.addBindValue(value);
+    }
+    if (!q.exec() || !q.next()) {
+        qDebug() << "LargeValueModel::fullValue" << q.lastError().text();
+        return QSqlQueryModel::data(index, Qt::EditRole);
+    }
+    QVariant value = q.value(0);
+    mCache.insert(key, new QVariant(value), valueCost(value));
+    return value;
+}
+
+int LargeValueModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return qMax(0, QSqlQueryModel::columnCount(parent) - mLengthColumns.size());
+}
+
+QVariant LargeValueModel::data(const QModelIndex &item, int role) const
+{
+    if (!item.isValid()) {
+        return QVariant();
+    }
+    if (role == Qt::EditRole && mLengthColumns.contains(item.column())) {
+        return fullValue(item);
+    }
+    QVariant value = QSqlQueryModel::data(item, role);
+    if (role == Qt::DisplayRole && value.typeId() == QMetaType::QString && isTruncated(item)) {
+        return value.toString() + QChar(0x2026);
+    }
+    return value;
+}
@@ -0,0 +1,51 @@
+#ifndef LARGEVALUEMODEL_H
+#define LARGEVALUEMODEL_H
+
+#include <QSqlQueryModel>
+#include <QSqlRecord>
+#include <QSqlIndex>
+#include <QCache>
+#include <QHash>
+
+// Query model for "select * from table" results with blob / text columns
+// truncated on the server side: each large column is fetched as a prefix plus
+// its length, full values are fetched on demand by primary key and kept in
+// a bounded LRU cache. Display role returns the prefix, edit role the full value.
+
+class LargeValueModel : public QSqlQueryModel
+{
+    Q_OBJECT
+public:
+
+    // returns nullptr if query can not be rewritten (not a simple select,
+    // no primary key, no large columns or unsupported driver)
+    static LargeValueModel* create(const QSqlDatabase& db, const QString& query, int prefix, QObject* parent = nullptr);
+
+    static QVariant fullData(const QAbstractItemModel* model, const QModelIndex& index);
+
+    QString rewrittenQuery() const;
+
+    bool isTruncated(const QModelIndex& index) const;
+
+    int valueLength(const QModelIndex& index) const;
+
+    QVariant fullValue(const QModelIndex& index) const;
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &item, int role = Qt::DisplayRole) const override;
+
+protected:
+    LargeValueModel(QObject* parent = nullptr);
+
+    QString mConnectionName;
+    QString mTable;
+    QSqlRecord mRecord;
+    QSqlIndex mPrimaryKey;
+    QString mRewrittenQuery;
+    int mPrefix;
+    // column -> hidden length column
+    QHash<int,int> mLengthColumns;
+    mutable QCache<QString, QVariant> mCache;
+};
+
+#endif // LARGEVALUEMODEL_H
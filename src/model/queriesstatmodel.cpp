@@ -4,23 +4,46 @@
 
 QueriesStatModel::QueriesStatModel(const QStringList& queries,
                                    const QStringList errors,
-                                   const QList<int> &perf,
+                                   const QList<QueryTiming> &timings,
                                    const QList<int> &rowsAffected,
-                                   QObject* parent) :
-    QStandardItemModel(queries.size(),4,parent)
+                                   QObject* parent,
+                                   const QStringList &targets) :
+    QStandardItemModel(queries.size(),targets.isEmpty() ? 10 : 11,parent)
 {
-
-    setHeaderData(0,Qt::Horizontal,"query");
-    setHeaderData(1,Qt::Horizontal,"ms");
-    setHeaderData(2,Qt::Horizontal,"rows");
-    setHeaderData(3,Qt::Horizontal,"error");
+    // target column when query is executed on several connections
+    int c = targets.isEmpty() ? 0 : 1;
+    if (c > 0) {
+        setHeaderData(0,Qt::Horizontal,"target");
+    }
+    setHeaderData(c,Qt::Horizontal,"query");
+    setHeaderData(c+1,Qt::Horizontal,"ms");
+    setHeaderData(c+2,Qt::Horizontal,"rows");
+    setHeaderData(c+3,Qt::Horizontal,"exec");
+    setHeaderData(c+4,Qt::Horizontal,"first row");
+    setHeaderData(c+5,Qt::Horizontal,"fetch");
+    setHeaderData(c+6,Qt::Horizontal,"bytes");
+    setHeaderData(c+7,Qt::Horizontal,"model");
+    setHeaderData(c+8,Qt::Horizontal,"layout");
+    setHeaderData(c+9,Qt::Horizontal,"error");
 
     for(int i=0;i<queries.size();i++) {
         RowValueSetter s(this,i);
-        s(0,queries[i].trimmed());
-        s(1,perf[i]);
-        s(2,rowsAffected[i]);
-        s(3,errors[i]);
+        if (c > 0) {
+            s(0,targets[i]);
+        }
+        s(c,queries[i].trimmed());
+        const QueryTiming& timing = timings[i];
+        s(c+1,timing.total());
+        s(c+2,rowsAffected[i]);
+        s(c+3,timing.exec);
+        if (timing.firstRow > -1) {
+            s(c+4,timing.firstRow);
+        }
+        s(c+5,timing.fetch);
+        s(c+6,timing.bytes);
+        s(c+7,timing.model);
+        s(c+8,timing.layout);
+        s(c+9,errors[i]);
     }
 
     mHasErrors = false;
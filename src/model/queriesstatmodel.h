@@ -3,15 +3,17 @@
 
 #include <QObject>
 #include <QStandardItemModel>
+#include "querytiming.h"
 
 class QueriesStatModel : public QStandardItemModel
 {
 public:
     QueriesStatModel(const QStringList& queries,
                      const QStringList errors,
-                     const QList<int> &perf,
+                     const QList<QueryTiming> &timings,
                      const QList<int> &rowsAffected,
-                     QObject *parent = 0);
+                     QObject *parent = 0,
+                     const QStringList& targets = QStringList());
 
     bool hasErrors() const;
 
@@ -1,6 +1,235 @@
 #include "queryhistorymodel.h"
 
-QueryHistoryModel::QueryHistoryModel(QObject *parent) : QSqlQueryModel(parent)
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+#include <climits>
+#include "drivernames.h"
+#include "connectionpool.h"
+#include "trace.h"
+
+struct QueryHistoryModel::State {
+    QMutex mutex;
+    QueryHistoryModel* owner = nullptr;
+};
+
+namespace {
+
+const QStringList columns = {"date", "connectionName", "query", "execMs", "firstRowMs", "fetchMs",
+                             "bytes", "modelMs", "layoutMs", "fingerprint"};
+
+QString where(const QStringList& conditions) {
+    return conditions.isEmpty() ? QString() : " where " + conditions.join(" and ");
+}
+
+}
+
+QueryHistoryModel::QueryHistoryModel(QObject *parent)
+    : QAbstractTableModel(parent), mState(new State()), mGeneration(0), mRowCount(0),
+      mTotalCount(-1), mAtEnd(true), mUsed(0)
+{
+    mState->owner = this;
+}
+
+QueryHistoryModel::~QueryHistoryModel()
+{
+    QMutexLocker locker(&mState->mutex);
+    mState->owner = nullptr;
+}
+
+void QueryHistoryModel::setFilter(const QStringList &conditions, const QVariantList &values)
+{
+    beginResetModel();
+    mConditions = conditions;
+    mValues = values;
+    mPages.clear();
+    mKeys.clear();
+    mRowCount = 0;
+    mTotalCount = -1;
+    mAtEnd = false;
+    endResetModel();
+    fetchMore(QModelIndex());
+    startCount();
+}
+
+qint64 QueryHistoryModel::totalCount() const
+{
+    return mTotalCount;
+}
+
+void QueryHistoryModel::startCount()
+{
+    int generation = ++mGeneration;
+    QString path = QSqlDatabase::database("_history").databaseName();
+    QString sql = "select count(*) from query" + where(mConditions);
+    QVariantList values = mValues;
+    QSharedPointer<State> state = mState;
+    ConnectionPool::startWorker([=](){
+        TRACE_SCOPE("QueryHistoryModel::count");
+        qint64 count = -1;
+        QString connectionName = QString("_history_count_%1").arg(quintptr(QThread::currentThreadId()));
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, connectionName);
+            db.setDatabaseName(path);
+            if (db.open()) {
+                QSqlQuery q(db);
+                q.prepare(sql);
+                for(const QVariant& value: values) {
+                    q.addBindValue(value);
+                }
+                if (q.exec() && q.next()) {
+                    count = q.value(0).toLongLong();
+                } else {
+                    qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+                }
+            }
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+        QMutexLocker locker(&state->mutex);
+        if (state->owner) {
+            QMetaObject::invokeMethod(state->owner, "onCounted", Qt::QueuedConnection,
+                                      Q_ARG(int, generation), Q_ARG(qint64, count));
+        }
+    });
+}
+
+void QueryHistoryModel::onCounted(int generation, qint64 count)
+{
+    if (generation != mGeneration || count < 0) {
+        return;
+    }
+    mTotalCount = count;
+    mAtEnd = true;
+    int rows = int(qMin<qint64>(count, INT_MAX));
+    // queries added after count started are at the top and already fetched
+    if (rows > mRowCount) {
+        beginInsertRows(QModelIndex(), mRowCount, rows - 1);
+        mRowCount = rows;
+        endInsertRows();
+    }
+    emit counted(count);
+}
+
+int QueryHistoryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return mRowCount;
+}
+
+int QueryHistoryModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return columns.size();
+}
+
+QVariant QueryHistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+        return QVariant();
+    }
+    const Page* page = this->page(index.row() / pageSize);
+    int row = index.row() % pageSize;
+    if (row >= page->rows.size()) {
+        return QVariant();
+    }
+    // rowid is first
+    return page->rows[row].value(index.column() + 1);
+}
+
+QVariant QueryHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return columns.value(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool QueryHistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !mAtEnd;
+}
+
+void QueryHistoryModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || mAtEnd) {
+        return;
+    }
+    int count = page(mRowCount / pageSize)->rows.size();
+    if (count < pageSize) {
+        mAtEnd = true;
+    }
+    if (count > 0) {
+        beginInsertRows(QModelIndex(), mRowCount, mRowCount + count - 1);
+        mRowCount += count;
+        endInsertRows();
+    }
+}
+
+const QueryHistoryModel::Page *QueryHistoryModel::page(int index) const
+{
+    auto it = mPages.find(index);
+    if (it == mPages.end()) {
+        if (mPages.size() >= maxPages) {
+            auto lru = mPages.begin();
+            for(auto i = mPages.begin(); i != mPages.end(); i++) {
+                if (i->used < lru->used) {
+                    lru = i;
+                }
+            }
+            mPages.erase(lru);
+        }
+        it = mPages.insert(index, load(index));
+    }
+    it->used = ++mUsed;
+    return &it.value();
+}
+
+QueryHistoryModel::Page QueryHistoryModel::load(int index) const
 {
+    TRACE_SCOPE("QueryHistoryModel::load");
+    // continue from nearest known page start, offset skips pages between
+    int from = 0;
+    QStringList conditions = mConditions;
+    QVariantList values = mValues;
+    auto it = mKeys.upperBound(index);
+    if (it != mKeys.begin()) {
+        it--;
+        from = it.key();
+        conditions.append("(date, rowid) < (?, ?)");
+        values << it->date << it->rowid;
+    }
+    values << pageSize << qint64(index - from) * pageSize;
 
+    QSqlQuery q(QSqlDatabase::database("_history"));
+    q.setForwardOnly(true);
+    q.prepare("select rowid, " + columns.join(", ") + " from query" + where(conditions) +
+              " order by date desc, rowid desc limit ? offset ?");
+    for(const QVariant& value: std::as_const(values)) {
+        q.addBindValue(value);
+    }
+    Page page;
+    if (!q.exec()) {
+        qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+        return page;
+    }
+    while (q.next()) {
+        QVariantList row;
+        for(int i=0;i<=columns.size();i++) {
+            row.append(q.value(i));
+        }
+        page.rows.append(row);
+    }
+    if (page.rows.size() == pageSize) {
+        const QVariantList& last = page.rows.last();
+        mKeys[index + 1] = {last[1], last[0].toLongLong()};
+    }
+    return page;
 }
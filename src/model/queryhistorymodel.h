@@ -2,18 +2,84 @@
 #define HISTORYMODEL_H
 
 #include <QObject>
-#include <QSqlQueryModel>
+#include <QAbstractTableModel>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVariantList>
+#include <QHash>
+#include <QMap>
 
-class QueryHistoryModel : public QSqlQueryModel
+// Rows of history query table newest first, read in pages on demand. Pages are
+// addressed by keyset (date, rowid) of previous page, so scrolling down does not
+// rescan skipped rows, and only last used pages are kept. Total count is computed
+// in background, until then rows are appended by fetchMore like QSqlQueryModel.
+
+class QueryHistoryModel : public QAbstractTableModel
 {
     Q_OBJECT
 public:
     enum cols {
         col_date,
         col_connectionName,
-        col_query
+        col_query,
+        col_execMs,
+        col_firstRowMs,
+        col_fetchMs,
+        col_bytes,
+        col_modelMs,
+        col_layoutMs,
+        col_fingerprint
     };
+    static const int pageSize = 256;
+    static const int maxPages = 16;
+
     QueryHistoryModel(QObject *parent = nullptr);
+    ~QueryHistoryModel();
+
+    // conditions on query table joined by and, values are bound in order
+    void setFilter(const QStringList& conditions, const QVariantList& values);
+    // -1 while counting
+    qint64 totalCount() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+signals:
+    void counted(qint64);
+
+protected slots:
+    void onCounted(int generation, qint64 count);
+
+protected:
+    struct State;
+    struct Page {
+        QList<QVariantList> rows;
+        qint64 used = 0;
+    };
+    // date and rowid of last row of previous page
+    struct Key {
+        QVariant date;
+        qint64 rowid;
+    };
+
+    const Page* page(int index) const;
+    Page load(int index) const;
+    void startCount();
+
+    QSharedPointer<State> mState;
+    QStringList mConditions;
+    QVariantList mValues;
+    int mGeneration;
+    int mRowCount;
+    qint64 mTotalCount;
+    bool mAtEnd;
+    mutable QHash<int, Page> mPages;
+    mutable QMap<int, Key> mKeys;
+    mutable qint64 mUsed;
 };
 
 #endif // HISTORYMODEL_H
@@ -0,0 +1,626 @@
+#include "nativedump.h"
+
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QMap>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlField>
+#include <QSqlIndex>
+#include <QSqlError>
+#include <QDebug>
+
+#include "connectionpool.h"
+#include "gzipfile.h"
+#include "drivernames.h"
+#include "trace.h"
+
+struct NativeDump::State {
+    QString connectionName;
+    QString dir;
+    QStringList tables;
+    Format format = Sql;
+    bool compress = false;
+    bool schema = true;
+    bool data = true;
+    int insertRows = 1000;
+    int jobs = 1;
+    QAtomicInt next;
+    QAtomicInt active;
+    QAtomicInt snapshotFailed;
+    QAtomicInt cancelled;
+    // released by worker when its transaction is started
+    QSemaphore ready;
+    QMutex mutex;
+    NativeDump* owner = nullptr;
+};
+
+namespace {
+
+// characters buffered before conversion to utf-8 and write
+const int flushSize = 1024 * 1024;
+
+bool isMysql(const QSqlDatabase& db) {
+    return db.driverName() == DRIVER_MYSQL || db.driverName() == DRIVER_MARIADB;
+}
+
+bool isPostgres(const QSqlDatabase& db) {
+    return db.driverName() == DRIVER_PSQL;
+}
+
+// plain or gzip file
+class Output {
+public:
+    Output(const QString& path, bool compress) : mFile(path), mGzip(path), mCompress(compress) {
+
+    }
+    bool open() {
+        return mCompress ? mGzip.open() : mFile.open(QIODevice::WriteOnly);
+    }
+    bool write(const QByteArray& data) {
+        return mCompress ? mGzip.write(data) : mFile.write(data) == data.size();
+    }
+    bool close() {
+        if (mCompress) {
+            return mGzip.close();
+        }
+        bool ok = mFile.flush();
+        mFile.close();
+        return ok;
+    }
+    qint64 size() const {
+        return mCompress ? mGzip.size() : mFile.size();
+    }
+    QString errorString() const {
+        return mCompress ? mGzip.errorString() : mFile.errorString();
+    }
+protected:
+    QFile mFile;
+    GzipFile mGzip;
+    bool mCompress;
+};
+
+void appendCsv(QString& out, const QVariant& value) {
+    if (value.isNull()) {
+        return;
+    }
+    QString text;
+    switch (value.typeId()) {
+    case QMetaType::QDateTime:
+        text = value.toDateTime().toString(Qt::ISODateWithMs);
+        break;
+    case QMetaType::QDate:
+        text = value.toDate().toString(Qt::ISODate);
+        break;
+    case QMetaType::QTime:
+        text = value.toTime().toString(Qt::ISODateWithMs);
+        break;
+    case QMetaType::QByteArray:
+        text = QString::fromLatin1(value.toByteArray().toHex());
+        break;
+    default:
+        text = value.toString();
+        break;
+    }
+    if (text.contains(',') || text.contains('"') || text.contains('\n') || text.contains('\r')) {
+        out.append('"');
+        out.append(QString(text).replace("\"", "\"\""));
+        out.append('"');
+    } else {
+        out.append(text);
+    }
+}
+
+}
+
+NativeDump::NativeDump(const QString &connectionName, QObject *parent)
+    : Dump{parent}, mState(new State()), mConnectionName(connectionName), mFormat(Sql), mCompress(false),
+      mSchema(true), mData(true), mInsertRows(1000), mConsistent(false)
+{
+
+}
+
+NativeDump::~NativeDump()
+{
+    mState->cancelled.storeRelease(1);
+    QMutexLocker locker(&mState->mutex);
+    mState->owner = nullptr;
+}
+
+void NativeDump::setFormat(Format format)
+{
+    mFormat = format;
+}
+
+void NativeDump::setCompress(bool value)
+{
+    mCompress = value;
+}
+
+void NativeDump::setSchema(bool value)
+{
+    mSchema = value;
+}
+
+void NativeDump::setData(bool value)
+{
+    mData = value;
+}
+
+void NativeDump::setInsertRows(int rows)
+{
+    mInsertRows = qMax(1, rows);
+}
+
+void NativeDump::start(const QStringList &tables, const QString &dir, int jobs)
+{
+    {
+        QMutexLocker locker(&mState->mutex);
+        mState->owner = nullptr;
+    }
+    mState.reset(new State());
+    mState->connectionName = mConnectionName;
+    mState->dir = dir;
+    mState->tables = tables;
+    mState->format = mFormat;
+    mState->compress = mCompress;
+    mState->schema = mSchema;
+    mState->data = mData;
+    mState->insertRows = mInsertRows;
+    mState->jobs = qBound(1, qMin(jobs, int(tables.size())), maxJobs);
+    mState->owner = this;
+    mTables.clear();
+    for(const QString& table: tables) {
+        Table item;
+        item.name = table;
+        item.path = QDir(dir).filePath(fileName(table, mFormat, mCompress));
+        mTables.append(item);
+    }
+    mConsistent = false;
+    mLastError.clear();
+    startTime();
+    QSharedPointer<State> state = mState;
+    ConnectionPool::startWorker([state](){
+        coordinate(state);
+    });
+}
+
+void NativeDump::coordinate(QSharedPointer<State> state)
+{
+    TRACE_SCOPE("NativeDump::coordinate");
+    bool shared = state->jobs == 1;
+    {
+        ConnectionLease lease(state->connectionName);
+        QSqlDatabase db = lease.database();
+        QSqlQuery q(db);
+        bool locked = false;
+        bool exported = false;
+        QString snapshot;
+        if (!lease.isValid()) {
+            postError(state, lease.error());
+        } else if (state->jobs > 1 && isMysql(db)) {
+            // blocks writes until every worker has started its transaction
+            locked = q.exec("FLUSH TABLES WITH READ LOCK");
+            if (!locked) {
+                postError(state, "Tables are dumped from different snapshots: " + q.lastError().text());
+            }
+        } else if (state->jobs > 1 && isPostgres(db)) {
+            // exported snapshot is valid while exporting transaction is open
+            exported = q.exec("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY")
+                    && q.exec("SELECT pg_export_snapshot()") && q.next();
+            if (exported) {
+                snapshot = q.value(0).toString();
+            } else {
+                postError(state, "Tables are dumped from different snapshots: " + q.lastError().text());
+                q.exec("ROLLBACK");
+            }
+        }
+        // coordinator is counted to report snapshot before finish
+        state->active.storeRelease(state->jobs + 1);
+        for(int i=0;i<state->jobs;i++) {
+            ConnectionPool::startWorker([state, snapshot](){
+                work(state, snapshot);
+            });
+        }
+        state->ready.acquire(state->jobs);
+        if (locked) {
+            q.exec("UNLOCK TABLES");
+        }
+        if (exported) {
+            q.exec("COMMIT");
+        }
+        shared = (shared || locked || exported) && lease.isValid() && !state->snapshotFailed.loadAcquire();
+    }
+    {
+        QMutexLocker locker(&state->mutex);
+        if (state->owner) {
+            QMetaObject::invokeMethod(state->owner, "onSnapshot", Qt::QueuedConnection, Q_ARG(bool, shared));
+        }
+    }
+    postFinished(state);
+}
+
+void NativeDump::work(QSharedPointer<State> state, const QString &snapshot)
+{
+    TRACE_SCOPE("NativeDump::work");
+    {
+        ConnectionLease lease(state->connectionName);
+        QSqlDatabase db = lease.database();
+        QSqlQuery q(db);
+        bool transaction = false;
+        if (!lease.isValid()) {
+            postError(state, lease.error());
+            state->snapshotFailed.storeRelease(1);
+        } else if (isMysql(db)) {
+            transaction = q.exec("SET SESSION TRANSACTION ISOLATION LEVEL REPEATABLE READ")
+                    && q.exec("START TRANSACTION WITH CONSISTENT SNAPSHOT");
+        } else if (isPostgres(db)) {
+            transaction = q.exec("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY")
+                    && (snapshot.isEmpty() || q.exec(QString("SET TRANSACTION SNAPSHOT '%1'").arg(snapshot)));
+            if (!transaction) {
+                postError(state, q.lastError().text());
+                q.exec("ROLLBACK");
+                // own snapshot, tables of this worker are not consistent with others
+                state->snapshotFailed.storeRelease(1);
+                transaction = q.exec("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+            }
+        } else {
+            transaction = db.transaction();
+        }
+        if (lease.isValid() && !transaction && db.driver()->hasFeature(QSqlDriver::Transactions)) {
+            postError(state, "Failed to start transaction: " + q.lastError().text());
+            state->snapshotFailed.storeRelease(1);
+        }
+        state->ready.release();
+
+        if (lease.isValid()) {
+            while (!state->cancelled.loadAcquire()) {
+                int index = state->next.fetchAndAddOrdered(1);
+                if (index >= state->tables.size()) {
+                    break;
+                }
+                dumpTable(state, db, index);
+            }
+            if (transaction) {
+                if (isMysql(db) || isPostgres(db)) {
+                    q.exec("COMMIT");
+                } else {
+                    db.rollback();
+                }
+            }
+        }
+    }
+    postFinished(state);
+}
+
+void NativeDump::dumpTable(QSharedPointer<State> state, QSqlDatabase &db, int index)
+{
+    TRACE_SCOPE("NativeDump::dumpTable");
+    QElapsedTimer time;
+    time.start();
+    QString table = state->tables[index];
+    QString path = QDir(state->dir).filePath(fileName(table, state->format, state->compress));
+    QSqlDriver* driver = db.driver();
+    QString name = driver->escapeIdentifier(table, QSqlDriver::TableName);
+    qint64 rows = 0;
+    QString error;
+    bool cancelled = false;
+
+    postTable(state, index, Running, 0, 0, 0, QString());
+
+    Output output(path, state->compress);
+    if (!output.open()) {
+        postTable(state, index, Failed, -1, 0, time.elapsed() / 1000.0, output.errorString());
+        return;
+    }
+
+    bool sql = state->format == Sql;
+    QStringList sequences;
+    if (sql && state->schema) {
+        QString create = createStatement(db, table, error, &sequences);
+        if (error.isEmpty() && !output.write(QString("DROP TABLE IF EXISTS %1;\n%2;\n\n").arg(name, create).toUtf8())) {
+            error = output.errorString();
+        }
+    }
+
+    if (error.isEmpty() && (!sql || state->data)) {
+        QSqlQuery q(db);
+        q.setForwardOnly(true);
+        if (!q.exec("SELECT * FROM " + name)) {
+            error = q.lastError().text();
+        } else {
+            QSqlRecord record = q.record();
+            int columns = record.count();
+            QString chunk;
+            QString insert;
+            if (sql) {
+                QStringList names;
+                for(int c=0;c<columns;c++) {
+                    names.append(driver->escapeIdentifier(record.fieldName(c), QSqlDriver::FieldName));
+                }
+                insert = QString("INSERT INTO %1 (%2) VALUES\n").arg(name, names.join(", "));
+            } else {
+                for(int c=0;c<columns;c++) {
+                    if (c > 0) {
+                        chunk.append(',');
+                    }
+                    appendCsv(chunk, record.fieldName(c));
+                }
+                chunk.append('\n');
+            }
+            // rows in current insert statement
+            int statementRows = 0;
+            QElapsedTimer report;
+            report.start();
+            while (q.next()) {
+                if (state->cancelled.loadAcquire()) {
+                    cancelled = true;
+                    break;
+                }
+                if (sql) {
+                    chunk.append(statementRows == 0 ? insert : QString(",\n"));
+                    chunk.append('(');
+                    for(int c=0;c<columns;c++) {
+                        if (c > 0) {
+                            chunk.append(", ");
+                        }
+                        QSqlField field = record.field(c);
+                        field.setValue(q.value(c));
+                        chunk.append(driver->formatValue(field));
+                    }
+                    chunk.append(')');
+                    if (++statementRows >= state->insertRows) {
+                        chunk.append(";\n");
+                        statementRows = 0;
+                    }
+                } else {
+                    for(int c=0;c<columns;c++) {
+                        if (c > 0) {
+                            chunk.append(',');
+                        }
+                        appendCsv(chunk, q.value(c));
+                    }
+                    chunk.append('\n');
+                }
+                rows++;
+                if (chunk.size() >= flushSize) {
+                    if (!output.write(chunk.toUtf8())) {
+                        error = output.errorString();
+                        break;
+                    }
+                    chunk.clear();
+                }
+                if (report.elapsed() >= progressMs) {
+                    postTable(state, index, Running, rows, output.size(), time.elapsed() / 1000.0, QString());
+                    report.restart();
+                }
+            }
+            if (statementRows > 0) {
+                chunk.append(";\n");
+            }
+            for(const QString& column: std::as_const(sequences)) {
+                chunk.append(sequenceStatement(db, table, column) + ";\n");
+            }
+            if (error.isEmpty() && q.lastError().isValid()) {
+                error = q.lastError().text();
+            }
+            if (error.isEmpty() && !cancelled && !output.write(chunk.toUtf8())) {
+                error = output.errorString();
+            }
+        }
+    }
+
+    if (!output.close() && error.isEmpty()) {
+        error = output.errorString();
+    }
+    qint64 bytes = output.size();
+    Status status = Done;
+    if (cancelled || !error.isEmpty()) {
+        // partial file would be restored as complete one
+        QFile::remove(path);
+        status = cancelled ? Cancelled : Failed;
+        bytes = 0;
+    }
+    postTable(state, index, status, rows, bytes, time.elapsed() / 1000.0, error);
+}
+
+void NativeDump::postTable(QSharedPointer<State> state, int index, Status status, qint64 rows, qint64 bytes,
+                           double seconds, const QString &error)
+{
+    QMutexLocker locker(&state->mutex);
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onTable", Qt::QueuedConnection,
+                                  Q_ARG(int, index), Q_ARG(int, int(status)), Q_ARG(qint64, rows),
+                                  Q_ARG(qint64, bytes), Q_ARG(double, seconds), Q_ARG(QString, error));
+    }
+}
+
+void NativeDump::postFinished(QSharedPointer<State> state)
+{
+    if (state->active.fetchAndAddOrdered(-1) != 1) {
+        return;
+    }
+    QMutexLocker locker(&state->mutex);
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onFinished", Qt::QueuedConnection);
+    }
+}
+
+void NativeDump::postError(QSharedPointer<State> state, const QString &error)
+{
+    qDebug() << error << __FILE__ << __LINE__;
+    QMutexLocker locker(&state->mutex);
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onError", Qt::QueuedConnection, Q_ARG(QString, error));
+    }
+}
+
+QString NativeDump::createStatement(QSqlDatabase db, const QString &table, QString &error, QStringList *sequences)
+{
+    QSqlQuery q(db);
+    QString name = db.driver()->escapeIdentifier(table, QSqlDriver::TableName);
+    if (isMysql(db)) {
+        if (!q.exec("SHOW CREATE TABLE " + name) || !q.next()) {
+            error = q.lastError().text();
+            return QString();
+        }
+        return q.value(1).toString();
+    }
+    if (db.driverName() == DRIVER_SQLITE) {
+        q.prepare("SELECT sql FROM sqlite_master WHERE name = ?");
+        q.addBindValue(table);
+        if (!q.exec() || !q.next()) {
+            error = q.lastError().isValid() ? q.lastError().text() : QString("Table %1 not found").arg(table);
+            return QString();
+        }
+        return q.value(0).toString();
+    }
+    if (isPostgres(db)) {
+        // columns and primary key, other constraints and indexes are not dumped
+        QString schema = "public";
+        QString tableName = table;
+        int dot = table.indexOf('.');
+        if (dot > -1) {
+            schema = table.left(dot);
+            tableName = table.mid(dot + 1);
+        }
+        q.prepare("SELECT column_name, data_type, udt_name, character_maximum_length, numeric_precision, "
+                  "numeric_scale, is_nullable, column_default, is_identity FROM information_schema.columns "
+                  "WHERE table_schema = ? AND table_name = ? ORDER BY ordinal_position");
+        q.addBindValue(schema);
+        q.addBindValue(tableName);
+        if (!q.exec()) {
+            error = q.lastError().text();
+            return QString();
+        }
+        QStringList columns;
+        while (q.next()) {
+            QString type = q.value(1).toString();
+            if (type == "USER-DEFINED") {
+                type = q.value(2).toString();
+            } else if (type == "ARRAY") {
+                type = q.value(2).toString().mid(1) + "[]";
+            } else if (!q.value(3).isNull()) {
+                type += QString("(%1)").arg(q.value(3).toInt());
+            } else if (type == "numeric" && !q.value(4).isNull()) {
+                type += QString("(%1,%2)").arg(q.value(4).toInt()).arg(q.value(5).toInt());
+            }
+            QString columnDefault = q.value(7).toString();
+            QString identity;
+            // sequence of serial column is not dumped, serial type creates it
+            static const QMap<QString, QString> serials = {
+                {"smallint", "smallserial"}, {"integer", "serial"}, {"bigint", "bigserial"}
+            };
+            bool serial = columnDefault.startsWith("nextval(") && serials.contains(type);
+            if (serial) {
+                type = serials[type];
+                columnDefault.clear();
+            } else if (q.value(8).toString() == "YES") {
+                // by default, so restored values are accepted
+                identity = " GENERATED BY DEFAULT AS IDENTITY";
+            }
+            if ((serial || !identity.isEmpty()) && sequences) {
+                sequences->append(q.value(0).toString());
+            }
+            QString column = db.driver()->escapeIdentifier(q.value(0).toString(), QSqlDriver::FieldName) + " " + type;
+            if (q.value(6).toString() == "NO") {
+                column += " NOT NULL";
+            }
+            if (!columnDefault.isEmpty()) {
+                column += " DEFAULT " + columnDefault;
+            }
+            column += identity;
+            columns.append(column);
+        }
+        if (columns.isEmpty()) {
+            error = QString("Table %1 not found").arg(table);
+            return QString();
+        }
+        QSqlIndex primaryKey = db.primaryIndex(table);
+        if (!primaryKey.isEmpty()) {
+            QStringList names;
+            for(int i=0;i<primaryKey.count();i++) {
+                names.append(db.driver()->escapeIdentifier(primaryKey.fieldName(i), QSqlDriver::FieldName));
+            }
+            columns.append(QString("PRIMARY KEY (%1)").arg(names.join(", ")));
+        }
+        return QString("CREATE TABLE %1 (\n  %2\n)").arg(name, columns.join(",\n  "));
+    }
+    error = QString("Schema dump is not implemented for %1").arg(db.driverName());
+    return QString();
+}
+
+QString NativeDump::sequenceStatement(QSqlDatabase db, const QString &table, const QString &column)
+{
+    QSqlDriver* driver = db.driver();
+    QString name = driver->escapeIdentifier(table, QSqlDriver::TableName);
+    QString field = driver->escapeIdentifier(column, QSqlDriver::FieldName);
+    return QString("SELECT setval(pg_get_serial_sequence('%1', '%2'), COALESCE((SELECT MAX(%3) FROM %4), 0) + 1, false)")
+            .arg(QString(name).replace("'", "''"), QString(column).replace("'", "''"), field, name);
+}
+
+QString NativeDump::fileName(const QString &table, Format format, bool compress)
+{
+    static const QRegularExpression rx("[\\\\/:*?\"<>|]");
+    QString name = QString(table).replace(rx, "_");
+    return name + (format == Sql ? ".sql" : ".csv") + (compress ? ".gz" : "");
+}
+
+void NativeDump::onTable(int index, int status, qint64 rows, qint64 bytes, double seconds, QString error)
+{
+    if (index < 0 || index >= mTables.size()) {
+        return;
+    }
+    Table& table = mTables[index];
+    table.status = Status(status);
+    table.rows = rows;
+    table.bytes = bytes;
+    table.seconds = seconds;
+    table.error = error;
+    emit tableChanged(index);
+}
+
+void NativeDump::onSnapshot(bool consistent)
+{
+    mConsistent = consistent;
+}
+
+void NativeDump::onError(QString error)
+{
+    mLastError = error;
+}
+
+void NativeDump::onFinished()
+{
+    // tables not taken by workers (connection failed or cancelled)
+    for(int i=0;i<mTables.size();i++) {
+        if (mTables[i].status == Queued) {
+            mTables[i].status = mState->cancelled.loadAcquire() ? Cancelled : Failed;
+            mTables[i].error = mLastError;
+            emit tableChanged(i);
+        }
+    }
+    setFinished();
+}
+
+void NativeDump::cancel()
+{
+    mState->cancelled.storeRelease(1);
+}
+
+bool NativeDump::isConsistent() const
+{
+    return mConsistent;
+}
+
+QString NativeDump::lastError() const
+{
+    return mLastError;
+}
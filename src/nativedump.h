@@ -0,0 +1,80 @@
+#ifndef NATIVEDUMP_H
+#define NATIVEDUMP_H
+
+#include "dump.h"
+#include <QSharedPointer>
+
+class QSqlDatabase;
+
+// Exports tables to files in worker threads, each worker leases its own connection and
+// takes tables from shared queue. Workers read from one snapshot: on mysql coordinator holds
+// FLUSH TABLES WITH READ LOCK while workers START TRANSACTION WITH CONSISTENT SNAPSHOT, on
+// postgres workers import snapshot exported by coordinator. Without RELOAD privilege (mysql)
+// or on other drivers each worker has its own snapshot, isConsistent() tells which happened.
+
+class NativeDump : public Dump
+{
+    Q_OBJECT
+public:
+    enum Format {
+        Sql,
+        Csv
+    };
+
+    NativeDump(const QString& connectionName, QObject* parent = nullptr);
+    ~NativeDump();
+
+    void setFormat(Format format);
+    // gzip files
+    void setCompress(bool value);
+    // create table statements, sql format only
+    void setSchema(bool value);
+    void setData(bool value);
+    // rows per insert statement
+    void setInsertRows(int rows);
+
+    void start(const QStringList& tables, const QString& dir, int jobs);
+    void cancel() override;
+
+    bool isConsistent() const;
+    QString lastError() const;
+
+    static QString fileName(const QString& table, Format format, bool compress);
+    // serial and identity columns (postgres) are appended to sequences, their sequences
+    // should be moved past restored values with sequenceStatement
+    static QString createStatement(QSqlDatabase db, const QString& table, QString& error,
+                                   QStringList* sequences = nullptr);
+    static QString sequenceStatement(QSqlDatabase db, const QString& table, const QString& column);
+
+    static const int progressMs = 200;
+    static const int maxJobs = 32;
+
+protected slots:
+    void onTable(int index, int status, qint64 rows, qint64 bytes, double seconds, QString error);
+    void onSnapshot(bool consistent);
+    void onError(QString error);
+    void onFinished();
+
+protected:
+    struct State;
+    static void coordinate(QSharedPointer<State> state);
+    static void work(QSharedPointer<State> state, const QString& snapshot);
+    static void dumpTable(QSharedPointer<State> state, QSqlDatabase& db, int index);
+    static void postTable(QSharedPointer<State> state, int index, Status status, qint64 rows, qint64 bytes,
+                          double seconds, const QString& error);
+    static void postError(QSharedPointer<State> state, const QString& error);
+    // last of coordinator and workers reports finish
+    static void postFinished(QSharedPointer<State> state);
+
+    QSharedPointer<State> mState;
+    QString mConnectionName;
+    Format mFormat;
+    bool mCompress;
+    bool mSchema;
+    bool mData;
+    int mInsertRows;
+    bool mConsistent;
+    QString mLastError;
+};
+
+#endif // NATIVEDUMP_H
@@ -0,0 +1,1023 @@
+#include "nativequery.h"
+
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlField>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QtEndian>
+#include <QDebug>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "resultsource.h"
+#include "resultstore.h"
+#include "drivernames.h"
+#include "odbcquery.h"
+
+#ifdef HAVE_LIBPQ
+#include <libpq-fe.h>
+#endif
+
+#ifdef HAVE_MYSQLCLIENT
+#include <mysql.h>
+#endif
+
+#if defined(HAVE_LIBPQ) || defined(HAVE_MYSQLCLIENT)
+
+namespace {
+
+// text protocol decoders shared by backends
+
+int parseDigits(const char* data, int count) {
+    int value = 0;
+    for(int i=0;i<count;i++) {
+        if (data[i] < '0' || data[i] > '9') {
+            return -1;
+        }
+        value = value * 10 + (data[i] - '0');
+    }
+    return value;
+}
+
+QDate parseDate(const char* data, int size) {
+    // YYYY-MM-DD
+    if (size < 10 || data[4] != '-' || data[7] != '-') {
+        return QDate();
+    }
+    return QDate(parseDigits(data, 4), parseDigits(data + 5, 2), parseDigits(data + 8, 2));
+}
+
+// hh:mm:ss[.ffffff], returns number of consumed chars
+int parseTime(const char* data, int size, QTime& time) {
+    if (size < 8 || data[2] != ':' || data[5] != ':') {
+        time = QTime();
+        return 0;
+    }
+    int pos = 8;
+    int msec = 0;
+    if (pos < size && data[pos] == '.') {
+        pos++;
+        int digits = 0;
+        while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+            if (digits < 3) {
+                msec = msec * 10 + (data[pos] - '0');
+                digits++;
+            }
+            pos++;
+        }
+        for(;digits<3;digits++) {
+            msec *= 10;
+        }
+    }
+    time = QTime(parseDigits(data, 2), parseDigits(data + 3, 2), parseDigits(data + 6, 2), msec);
+    return pos;
+}
+
+QDateTime parseDateTime(const char* data, int size) {
+    QDate date = parseDate(data, size);
+    if (!date.isValid()) {
+        return QDateTime();
+    }
+    if (size < 19 || (data[10] != ' ' && data[10] != 'T')) {
+        return QDateTime(date, QTime(0, 0));
+    }
+    QTime time;
+    int pos = 11 + parseTime(data + 11, size - 11, time);
+    if (pos < size && (data[pos] == '+' || data[pos] == '-')) {
+        // postgres timestamptz: +hh[:mm[:ss]]
+        int sign = data[pos] == '-' ? -1 : 1;
+        int offset = 0;
+        const char* p = data + pos + 1;
+        int left = size - pos - 1;
+        for(int part=0;part<3 && left >= 2;part++) {
+            offset = offset * 60 + parseDigits(p, 2);
+            p += 2;
+            left -= 2;
+            if (left > 0 && *p == ':') {
+                p++;
+                left--;
+            } else {
+                for(part++;part<3;part++) {
+                    offset *= 60;
+                }
+            }
+        }
+        return QDateTime(date, time, QTimeZone::utc()).addSecs(-sign * offset);
+    }
+    return QDateTime(date, time);
+}
+
+QVariant decodeText(QMetaType::Type type, const char* data, int size) {
+    switch (type) {
+    case QMetaType::Bool:
+        return QVariant(size > 0 && (data[0] == 't' || data[0] == '1'));
+    case QMetaType::Int:
+    case QMetaType::LongLong: {
+        qlonglong value = 0;
+        std::from_chars(data, data + size, value);
+        return type == QMetaType::Int ? QVariant(int(value)) : QVariant(value);
+    }
+    case QMetaType::UInt:
+    case QMetaType::ULongLong: {
+        qulonglong value = 0;
+        std::from_chars(data, data + size, value);
+        return type == QMetaType::UInt ? QVariant(uint(value)) : QVariant(value);
+    }
+    case QMetaType::Double: {
+        double value = 0;
+        std::from_chars(data, data + size, value);
+        return QVariant(value);
+    }
+    case QMetaType::QDate:
+        return QVariant(parseDate(data, size));
+    case QMetaType::QTime: {
+        QTime time;
+        parseTime(data, size, time);
+        return QVariant(time);
+    }
+    case QMetaType::QDateTime:
+        return QVariant(parseDateTime(data, size));
+    case QMetaType::QByteArray:
+        if (size >= 2 && data[0] == '\\' && data[1] == 'x') {
+            // postgres bytea hex output
+            return QVariant(QByteArray::fromHex(QByteArray::fromRawData(data + 2, size - 2)));
+        }
+        return QVariant(QByteArray(data, size));
+    default:
+        return QVariant(QString::fromUtf8(data, size));
+    }
+}
+
+QSqlRecord makeRecord(const QStringList& names, const QList<QMetaType::Type>& types) {
+    QSqlRecord record;
+    for(int i=0;i<names.size();i++) {
+        record.append(QSqlField(names[i], QMetaType(types[i])));
+    }
+    return record;
+}
+
+} // namespace
+
+#endif
+
+#ifdef HAVE_LIBPQ
+
+namespace {
+
+enum PsqlOid {
+    BoolOid = 16,
+    ByteaOid = 17,
+    CharOid = 18,
+    NameOid = 19,
+    Int8Oid = 20,
+    Int2Oid = 21,
+    Int4Oid = 23,
+    TextOid = 25,
+    OidOid = 26,
+    JsonOid = 114,
+    XmlOid = 142,
+    Float4Oid = 700,
+    Float8Oid = 701,
+    BpcharOid = 1042,
+    VarcharOid = 1043,
+    DateOid = 1082,
+    TimeOid = 1083,
+    TimestampOid = 1114,
+    TimestampTzOid = 1184,
+    NumericOid = 1700,
+    UuidOid = 2950,
+    JsonbOid = 3802
+};
+
+// postgres epoch
+const QDate psqlEpoch(2000, 1, 1);
+const qint64 usecsPerDay = Q_INT64_C(86400000000);
+
+QMetaType::Type psqlType(Oid oid) {
+    switch (oid) {
+    case BoolOid: return QMetaType::Bool;
+    case ByteaOid: return QMetaType::QByteArray;
+    case Int8Oid: return QMetaType::LongLong;
+    case Int2Oid:
+    case Int4Oid: return QMetaType::Int;
+    case OidOid: return QMetaType::UInt;
+    case Float4Oid:
+    case Float8Oid:
+    case NumericOid: return QMetaType::Double;
+    case DateOid: return QMetaType::QDate;
+    case TimeOid: return QMetaType::QTime;
+    case TimestampOid:
+    case TimestampTzOid: return QMetaType::QDateTime;
+    default: return QMetaType::QString;
+    }
+}
+
+bool psqlBinarySupported(Oid oid) {
+    switch (oid) {
+    case BoolOid: case ByteaOid: case CharOid: case NameOid: case Int8Oid: case Int2Oid:
+    case Int4Oid: case TextOid: case OidOid: case JsonOid: case XmlOid: case Float4Oid:
+    case Float8Oid: case BpcharOid: case VarcharOid: case DateOid: case TimeOid:
+    case TimestampOid: case TimestampTzOid: case NumericOid: case UuidOid: case JsonbOid:
+        return true;
+    }
+    return false;
+}
+
+qint64 floorDiv(qint64 a, qint64 b) {
+    qint64 d = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? d - 1 : d;
+}
+
+// base 10000 digits with weight of first digit
+double psqlNumeric(const char* data, int size) {
+    if (size < 8) {
+        return 0;
+    }
+    int ndigits = qFromBigEndian<qint16>(data);
+    int weight = qFromBigEndian<qint16>(data + 2);
+    quint16 sign = qFromBigEndian<quint16>(data + 4);
+    if (sign == 0xC000) {
+        return qQNaN();
+    }
+    if (sign == 0xD000) {
+        return qInf();
+    }
+    if (sign == 0xF000) {
+        return -qInf();
+    }
+    if (size < 8 + ndigits * 2) {
+        return 0;
+    }
+    double value = 0;
+    for(int i=0;i<ndigits;i++) {
+        value += qFromBigEndian<qint16>(data + 8 + i * 2) * std::pow(10000.0, weight - i);
+    }
+    return sign == 0x4000 ? -value : value;
+}
+
+QVariant decodeBinary(Oid oid, const char* data, int size) {
+    switch (oid) {
+    case BoolOid:
+        return QVariant(size > 0 && data[0] != 0);
+    case ByteaOid:
+        return QVariant(QByteArray(data, size));
+    case Int8Oid:
+        return size == 8 ? QVariant(qlonglong(qFromBigEndian<qint64>(data))) : QVariant();
+    case Int2Oid:
+        return size == 2 ? QVariant(int(qFromBigEndian<qint16>(data))) : QVariant();
+    case Int4Oid:
+        return size == 4 ? QVariant(int(qFromBigEndian<qint32>(data))) : QVariant();
+    case OidOid:
+        return size == 4 ? QVariant(uint(qFromBigEndian<quint32>(data))) : QVariant();
+    case Float4Oid: {
+        if (size != 4) {
+            return QVariant();
+        }
+        quint32 bits = qFromBigEndian<quint32>(data);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return QVariant(double(value));
+    }
+    case Float8Oid: {
+        if (size != 8) {
+            return QVariant();
+        }
+        quint64 bits = qFromBigEndian<quint64>(data);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return QVariant(value);
+    }
+    case NumericOid:
+        return QVariant(psqlNumeric(data, size));
+    case DateOid: {
+        if (size != 4) {
+            return QVariant();
+        }
+        qint32 days = qFromBigEndian<qint32>(data);
+        if (days == std::numeric_limits<qint32>::max() || days == std::numeric_limits<qint32>::min()) {
+            // infinity
+            return QVariant(QDate());
+        }
+        return QVariant(psqlEpoch.addDays(days));
+    }
+    case TimeOid:
+        return size == 8 ? QVariant(QTime::fromMSecsSinceStartOfDay(int(qFromBigEndian<qint64>(data) / 1000))) : QVariant();
+    case TimestampOid:
+    case TimestampTzOid: {
+        if (size != 8) {
+            return QVariant();
+        }
+        qint64 usecs = qFromBigEndian<qint64>(data);
+        if (usecs == std::numeric_limits<qint64>::max() || usecs == std::numeric_limits<qint64>::min()) {
+            return QVariant(QDateTime());
+        }
+        qint64 days = floorDiv(usecs, usecsPerDay);
+        QDate date = psqlEpoch.addDays(days);
+        QTime time = QTime::fromMSecsSinceStartOfDay(int((usecs - days * usecsPerDay) / 1000));
+        if (oid == TimestampTzOid) {
+            return QVariant(QDateTime(date, time, QTimeZone::utc()));
+        }
+        return QVariant(QDateTime(date, time));
+    }
+    case UuidOid: {
+        if (size != 16) {
+            return QVariant();
+        }
+        QString hex = QString::fromLatin1(QByteArray(data, size).toHex());
+        return QVariant(hex.insert(20, QLatin1Char('-')).insert(16, QLatin1Char('-')).insert(12, QLatin1Char('-')).insert(8, QLatin1Char('-')));
+    }
+    case JsonbOid:
+        // version byte followed by text
+        return size > 0 ? QVariant(QString::fromUtf8(data + 1, size - 1)) : QVariant(QString());
+    default:
+        return QVariant(QString::fromUtf8(data, size));
+    }
+}
+
+void psqlDrain(PGconn* conn) {
+    while (PGresult* res = PQgetResult(conn)) {
+        ExecStatusType status = PQresultStatus(res);
+        PQclear(res);
+        if (status == PGRES_COPY_IN) {
+            PQputCopyEnd(conn, "COPY FROM STDIN is not supported");
+        } else if (status == PGRES_COPY_OUT) {
+            char* buffer;
+            while (PQgetCopyData(conn, &buffer, 0) > 0) {
+                PQfreemem(buffer);
+            }
+        }
+    }
+}
+
+// Rows of select (or any other statement returning tuples) in single row mode
+
+class PsqlResultSource : public ResultSource
+{
+public:
+    PsqlResultSource(PGconn* conn, PGresult* first, bool binary, const QString& query)
+        : mConn(conn), mFirst(first), mBinary(binary), mQuery(query), mDone(false) {
+        QStringList names;
+        int columns = PQnfields(first);
+        for(int c=0;c<columns;c++) {
+            Oid oid = PQftype(first, c);
+            names.append(QString::fromUtf8(PQfname(first, c)));
+            mOids.append(oid);
+            mTypes.append(psqlType(oid));
+        }
+        mRecord = makeRecord(names, mTypes);
+    }
+
+    ~PsqlResultSource() {
+        if (mFirst) {
+            PQclear(mFirst);
+        }
+        if (!mDone) {
+            psqlDrain(mConn);
+        }
+    }
+
+    QSqlRecord record() const override {
+        return mRecord;
+    }
+
+    int fetch(ResultStore* store, int count) override {
+        int fetched = 0;
+        while (fetched < count && !mDone) {
+            PGresult* res = mFirst ? mFirst : PQgetResult(mConn);
+            mFirst = nullptr;
+            if (!res) {
+                mDone = true;
+                break;
+            }
+            ExecStatusType status = PQresultStatus(res);
+            if (status == PGRES_SINGLE_TUPLE || status == PGRES_TUPLES_OK) {
+                fetched += append(store, res);
+            } else if (status != PGRES_COMMAND_OK) {
+                mError = QString::fromUtf8(PQresultErrorMessage(res));
+                qDebug() << "PsqlResultSource" << mError;
+            }
+            PQclear(res);
+        }
+        return fetched;
+    }
+
+    QString lastQuery() const override {
+        return mQuery;
+    }
+
+    QString lastError() const override {
+        return mError;
+    }
+
+protected:
+    int append(ResultStore* store, PGresult* res) {
+        int rows = PQntuples(res);
+        int columns = mTypes.size();
+        for(int r=0;r<rows;r++) {
+            QVariantList row;
+            row.reserve(columns);
+            for(int c=0;c<columns;c++) {
+                if (PQgetisnull(res, r, c)) {
+                    row.append(QVariant(QMetaType(mTypes[c])));
+                    continue;
+                }
+                const char* data = PQgetvalue(res, r, c);
+                int size = PQgetlength(res, r, c);
+                row.append(mBinary ? decodeBinary(mOids[c], data, size) : decodeText(mTypes[c], data, size));
+            }
+            store->append(row);
+        }
+        return rows;
+    }
+
+    PGconn* mConn;
+    PGresult* mFirst;
+    bool mBinary;
+    QString mQuery;
+    QString mError;
+    bool mDone;
+    QList<Oid> mOids;
+    QList<QMetaType::Type> mTypes;
+    QSqlRecord mRecord;
+};
+
+// Rows of COPY ... TO STDOUT in text format, fields are split on tabs and unescaped,
+// column count is taken from first line
+
+class PsqlCopySource : public ResultSource
+{
+public:
+    PsqlCopySource(PGconn* conn, const QString& query) : mConn(conn), mQuery(query), mDone(false) {
+        QStringList names;
+        QList<QMetaType::Type> types;
+        if (readLine(mFirst)) {
+            for(int c=0;c<mFirst.size();c++) {
+                names.append(QString("column_%1").arg(c + 1));
+                types.append(QMetaType::QString);
+            }
+        }
+        mRecord = makeRecord(names, types);
+    }
+
+    ~PsqlCopySource() {
+        while (!mDone) {
+            QVariantList row;
+            readLine(row);
+        }
+    }
+
+    QSqlRecord record() const override {
+        return mRecord;
+    }
+
+    int fetch(ResultStore* store, int count) override {
+        int fetched = 0;
+        if (!mFirst.isEmpty()) {
+            store->append(mFirst);
+            mFirst.clear();
+            fetched++;
+        }
+        QVariantList row;
+        while (fetched < count && readLine(row)) {
+            row.resize(mRecord.count());
+            store->append(row);
+            fetched++;
+        }
+        return fetched;
+    }
+
+    QString lastQuery() const override {
+        return mQuery;
+    }
+
+protected:
+    bool readLine(QVariantList& row) {
+        if (mDone) {
+            return false;
+        }
+        char* buffer;
+        int size = PQgetCopyData(mConn, &buffer, 0);
+        if (size < 0) {
+            if (size == -2) {
+                qDebug() << "PsqlCopySource" << PQerrorMessage(mConn);
+            }
+            psqlDrain(mConn);
+            mDone = true;
+            return false;
+        }
+        row.clear();
+        if (size > 0 && buffer[size - 1] == '\n') {
+            size--;
+        }
+        int begin = 0;
+        for(int i=0;i<=size;i++) {
+            if (i == size || buffer[i] == '\t') {
+                row.append(field(buffer + begin, i - begin));
+                begin = i + 1;
+            }
+        }
+        PQfreemem(buffer);
+        return true;
+    }
+
+    static QVariant field(const char* data, int size) {
+        if (size == 2 && data[0] == '\\' && data[1] == 'N') {
+            return QVariant(QMetaType(QMetaType::QString));
+        }
+        if (!memchr(data, '\\', size)) {
+            return QVariant(QString::fromUtf8(data, size));
+        }
+        QByteArray res;
+        res.reserve(size);
+        for(int i=0;i<size;i++) {
+            if (data[i] != '\\' || i + 1 == size) {
+                res.append(data[i]);
+                continue;
+            }
+            char c = data[++i];
+            switch (c) {
+            case 'b': res.append('\b'); break;
+            case 'f': res.append('\f'); break;
+            case 'n': res.append('\n'); break;
+            case 'r': res.append('\r'); break;
+            case 't': res.append('\t'); break;
+            case 'v': res.append('\v'); break;
+            case 'x': {
+                int value = 0;
+                int digits = 0;
+                while (digits < 2 && i + 1 < size && isxdigit(uchar(data[i + 1]))) {
+                    value = value * 16 + QByteArray(1, data[++i]).toInt(nullptr, 16);
+                    digits++;
+                }
+                res.append(char(value));
+                break;
+            }
+            default:
+                if (c >= '0' && c <= '7') {
+                    int value = c - '0';
+                    for(int digits=1;digits<3 && i + 1 < size && data[i + 1] >= '0' && data[i + 1] <= '7';digits++) {
+                        value = value * 8 + (data[++i] - '0');
+                    }
+                    res.append(char(value));
+                } else {
+                    res.append(c);
+                }
+            }
+        }
+        return QVariant(QString::fromUtf8(res));
+    }
+
+    PGconn* mConn;
+    QString mQuery;
+    bool mDone;
+    QVariantList mFirst;
+    QSqlRecord mRecord;
+};
+
+PGconn* psqlHandle(const QSqlDatabase& db) {
+    QVariant handle = db.driver()->handle();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "PGconn*") == 0) {
+        return *static_cast<PGconn* const*>(handle.constData());
+    }
+    return nullptr;
+}
+
+// first keyword after whitespace and comments
+QString psqlKeyword(const QString& query) {
+    int i = 0;
+    int n = query.size();
+    while (i < n) {
+        if (query[i].isSpace()) {
+            i++;
+        } else if (query.mid(i, 2) == "--") {
+            int end = query.indexOf('\n', i);
+            i = end < 0 ? n : end + 1;
+        } else if (query.mid(i, 2) == "/*") {
+            int end = query.indexOf("*/", i + 2);
+            i = end < 0 ? n : end + 2;
+        } else {
+            break;
+        }
+    }
+    int begin = i;
+    while (i < n && query[i].isLetter()) {
+        i++;
+    }
+    return query.mid(begin, i - begin).toLower();
+}
+
+bool psqlFirst(PGconn* conn, bool binary, const QString& query, ResultSource** source, int* rowsAffected, QString& error) {
+    PGresult* res = PQgetResult(conn);
+    if (!res) {
+        error = QString::fromUtf8(PQerrorMessage(conn));
+        return false;
+    }
+    switch (PQresultStatus(res)) {
+    case PGRES_SINGLE_TUPLE:
+    case PGRES_TUPLES_OK:
+        *source = new PsqlResultSource(conn, res, binary, query);
+        return true;
+    case PGRES_COPY_OUT:
+        PQclear(res);
+        *source = new PsqlCopySource(conn, query);
+        return true;
+    case PGRES_COMMAND_OK:
+        *rowsAffected = QByteArray(PQcmdTuples(res)).toInt();
+        PQclear(res);
+        psqlDrain(conn);
+        return true;
+    case PGRES_EMPTY_QUERY:
+        PQclear(res);
+        psqlDrain(conn);
+        return true;
+    default:
+        error = QString::fromUtf8(PQresultErrorMessage(res));
+        PQclear(res);
+        psqlDrain(conn);
+        return false;
+    }
+}
+
+// value in COPY text format: \N for null, backslash, tab and newlines escaped
+void psqlCopyValue(const QVariant& value, QByteArray& out) {
+    if (value.isNull()) {
+        out.append("\\N");
+        return;
+    }
+    QByteArray text;
+    switch (value.metaType().id()) {
+    case QMetaType::Bool:
+        out.append(value.toBool() ? 't' : 'f');
+        return;
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        out.append(QByteArray::number(value.toLongLong()));
+        return;
+    case QMetaType::Double:
+        out.append(QByteArray::number(value.toDouble(), 'g', 17));
+        return;
+    case QMetaType::QDate:
+        out.append(value.toDate().toString(Qt::ISODate).toLatin1());
+        return;
+    case QMetaType::QTime:
+        out.append(value.toTime().toString("HH:mm:ss.zzz").toLatin1());
+        return;
+    case QMetaType::QDateTime:
+        out.append(value.toDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz").toLatin1());
+        return;
+    case QMetaType::QByteArray:
+        // bytea hex format, backslash itself is escaped in COPY text
+        out.append("\\\\x");
+        out.append(value.toByteArray().toHex());
+        return;
+    default:
+        text = value.toString().toUtf8();
+    }
+    for(char c: std::as_const(text)) {
+        switch (c) {
+        case '\\': out.append("\\\\"); break;
+        case '\t': out.append("\\t"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        default: out.append(c);
+        }
+    }
+}
+
+bool psqlCopyIn(PGconn* conn, const QString& table, const QStringList& columns,
+                const QList<QVariantList>& rows, QString& error) {
+    QByteArray sql = QString("COPY %1 (%2) FROM STDIN").arg(table).arg(columns.join(", ")).toUtf8();
+    PGresult* res = PQexec(conn, sql.constData());
+    if (PQresultStatus(res) != PGRES_COPY_IN) {
+        error = QString::fromUtf8(PQresultErrorMessage(res));
+        PQclear(res);
+        psqlDrain(conn);
+        return false;
+    }
+    PQclear(res);
+
+    QByteArray buffer;
+    buffer.reserve(NativeQuery::copyBufferSize + 4096);
+    bool ok = true;
+    for(const QVariantList& row: rows) {
+        for(int c=0;c<row.size();c++) {
+            if (c > 0) {
+                buffer.append('\t');
+            }
+            psqlCopyValue(row[c], buffer);
+        }
+        buffer.append('\n');
+        if (buffer.size() >= NativeQuery::copyBufferSize) {
+            ok = PQputCopyData(conn, buffer.constData(), buffer.size()) == 1;
+            buffer.clear();
+            if (!ok) {
+                break;
+            }
+        }
+    }
+    if (ok && !buffer.isEmpty()) {
+        ok = PQputCopyData(conn, buffer.constData(), buffer.size()) == 1;
+    }
+    if (PQputCopyEnd(conn, ok ? nullptr : "aborted") != 1) {
+        ok = false;
+    }
+    if (!ok) {
+        error = QString::fromUtf8(PQerrorMessage(conn));
+    }
+    while (PGresult* result = PQgetResult(conn)) {
+        if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+            if (error.isEmpty()) {
+                error = QString::fromUtf8(PQresultErrorMessage(result));
+            }
+            ok = false;
+        }
+        PQclear(result);
+    }
+    return ok;
+}
+
+bool psqlExec(PGconn* conn, const QString& query, ResultSource** source, int* rowsAffected, QString& error) {
+    QByteArray sql = query.toUtf8();
+    static const QStringList selects = {"select", "with", "values", "table"};
+
+    // extended protocol lets us see column types before execution and choose binary format,
+    // failed prepare aborts transaction so it's only tried outside of one
+    if (selects.contains(psqlKeyword(query)) && PQtransactionStatus(conn) == PQTRANS_IDLE) {
+        PGresult* prepared = PQprepare(conn, "", sql.constData(), 0, nullptr);
+        bool ok = PQresultStatus(prepared) == PGRES_COMMAND_OK;
+        PQclear(prepared);
+        if (ok) {
+            PGresult* description = PQdescribePrepared(conn, "");
+            bool binary = PQresultStatus(description) == PGRES_COMMAND_OK;
+            for(int c=0;binary && c<PQnfields(description);c++) {
+                binary = psqlBinarySupported(PQftype(description, c));
+            }
+            PQclear(description);
+            if (!PQsendQueryPrepared(conn, "", 0, nullptr, nullptr, nullptr, binary ? 1 : 0)) {
+                error = QString::fromUtf8(PQerrorMessage(conn));
+                return false;
+            }
+            PQsetSingleRowMode(conn);
+            return psqlFirst(conn, binary, query, source, rowsAffected, error);
+        }
+    }
+
+    if (!PQsendQuery(conn, sql.constData())) {
+        error = QString::fromUtf8(PQerrorMessage(conn));
+        return false;
+    }
+    PQsetSingleRowMode(conn);
+    return psqlFirst(conn, false, query, source, rowsAffected, error);
+}
+
+} // namespace
+
+#endif // HAVE_LIBPQ
+
+#ifdef HAVE_MYSQLCLIENT
+
+namespace {
+
+QMetaType::Type mysqlType(const MYSQL_FIELD& field) {
+    bool isUnsigned = field.flags & UNSIGNED_FLAG;
+    // charset 63 is binary
+    bool isBinary = field.charsetnr == 63;
+    switch (field.type) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_YEAR:
+        return isUnsigned ? QMetaType::UInt : QMetaType::Int;
+    case MYSQL_TYPE_LONGLONG:
+        return isUnsigned ? QMetaType::ULongLong : QMetaType::LongLong;
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+        return QMetaType::Double;
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_NEWDATE:
+        return QMetaType::QDate;
+    case MYSQL_TYPE_TIME:
+        return QMetaType::QTime;
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIMESTAMP:
+        return QMetaType::QDateTime;
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB:
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_BIT:
+    case MYSQL_TYPE_GEOMETRY:
+        return isBinary ? QMetaType::QByteArray : QMetaType::QString;
+    default:
+        return QMetaType::QString;
+    }
+}
+
+void mysqlDrain(MYSQL* mysql) {
+    while (mysql_more_results(mysql) && mysql_next_result(mysql) == 0) {
+        if (MYSQL_RES* res = mysql_use_result(mysql)) {
+            while (mysql_fetch_row(res)) {
+
+            }
+            mysql_free_result(res);
+        }
+    }
+}
+
+// Rows streamed from server with mysql_use_result (text protocol)
+
+class MysqlResultSource : public ResultSource
+{
+public:
+    MysqlResultSource(MYSQL* mysql, MYSQL_RES* res, const QString& query)
+        : mMysql(mysql), mRes(res), mQuery(query) {
+        QStringList names;
+        unsigned int columns = mysql_num_fields(res);
+        MYSQL_FIELD* fields = mysql_fetch_fields(res);
+        for(unsigned int c=0;c<columns;c++) {
+            names.append(QString::fromUtf8(fields[c].name));
+            mTypes.append(mysqlType(fields[c]));
+        }
+        mRecord = makeRecord(names, mTypes);
+    }
+
+    ~MysqlResultSource() {
+        if (mRes) {
+            while (mysql_fetch_row(mRes)) {
+
+            }
+            finish();
+        }
+    }
+
+    QSqlRecord record() const override {
+        return mRecord;
+    }
+
+    int fetch(ResultStore* store, int count) override {
+        int fetched = 0;
+        int columns = mTypes.size();
+        while (mRes && fetched < count) {
+            MYSQL_ROW data = mysql_fetch_row(mRes);
+            if (!data) {
+                if (mysql_errno(mMysql)) {
+                    mError = QString::fromUtf8(mysql_error(mMysql));
+                    qDebug() << "MysqlResultSource" << mError;
+                }
+                finish();
+                break;
+            }
+            unsigned long* lengths = mysql_fetch_lengths(mRes);
+            QVariantList row;
+            row.reserve(columns);
+            for(int c=0;c<columns;c++) {
+                if (!data[c]) {
+                    row.append(QVariant(QMetaType(mTypes[c])));
+                } else {
+                    row.append(decodeText(mTypes[c], data[c], int(lengths[c])));
+                }
+            }
+            store->append(row);
+            fetched++;
+        }
+        return fetched;
+    }
+
+    QString lastQuery() const override {
+        return mQuery;
+    }
+
+    QString lastError() const override {
+        return mError;
+    }
+
+protected:
+    void finish() {
+        mysql_free_result(mRes);
+        mRes = nullptr;
+        mysqlDrain(mMysql);
+    }
+
+    MYSQL* mMysql;
+    MYSQL_RES* mRes;
+    QString mQuery;
+    QString mError;
+    QList<QMetaType::Type> mTypes;
+    QSqlRecord mRecord;
+};
+
+MYSQL* mysqlHandle(const QSqlDatabase& db) {
+    QVariant handle = db.driver()->handle();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "MYSQL*") == 0) {
+        return *static_cast<MYSQL* const*>(handle.constData());
+    }
+    return nullptr;
+}
+
+bool mysqlExec(MYSQL* mysql, const QString& query, ResultSource** source, int* rowsAffected, QString& error) {
+    QByteArray sql = query.toUtf8();
+    if (mysql_real_query(mysql, sql.constData(), sql.size()) != 0) {
+        error = QString::fromUtf8(mysql_error(mysql));
+        return false;
+    }
+    MYSQL_RES* res = mysql_use_result(mysql);
+    if (!res) {
+        if (mysql_field_count(mysql) != 0) {
+            error = QString::fromUtf8(mysql_error(mysql));
+            return false;
+        }
+        *rowsAffected = int(mysql_affected_rows(mysql));
+        mysqlDrain(mysql);
+        return true;
+    }
+    *source = new MysqlResultSource(mysql, res, query);
+    return true;
+}
+
+} // namespace
+
+#endif // HAVE_MYSQLCLIENT
+
+bool NativeQuery::isAvailable(const QSqlDatabase &db)
+{
+    if (!db.isOpen()) {
+        return false;
+    }
+#ifdef HAVE_LIBPQ
+    if (db.driverName() == DRIVER_PSQL) {
+        return psqlHandle(db) != nullptr;
+    }
+#endif
+#ifdef HAVE_MYSQLCLIENT
+    if (db.driverName() == DRIVER_MYSQL || db.driverName() == DRIVER_MARIADB) {
+        return mysqlHandle(db) != nullptr;
+    }
+#endif
+    if (db.driverName() == DRIVER_ODBC) {
+        return OdbcQuery::isAvailable(db);
+    }
+    return false;
+}
+
+bool NativeQuery::exec(const QSqlDatabase &db, const QString &query, ResultSource **source, int *rowsAffected, QString &error)
+{
+    *source = nullptr;
+    *rowsAffected = -1;
+#ifdef HAVE_LIBPQ
+    if (PGconn* conn = psqlHandle(db)) {
+        return psqlExec(conn, query, source, rowsAffected, error);
+    }
+#endif
+#ifdef HAVE_MYSQLCLIENT
+    if (MYSQL* mysql = mysqlHandle(db)) {
+        return mysqlExec(mysql, query, source, rowsAffected, error);
+    }
+#endif
+    if (db.driverName() == DRIVER_ODBC) {
+        return OdbcQuery::exec(db, query, source, rowsAffected, error);
+    }
+    Q_UNUSED(query);
+    error = QString("Native client is not available for %1").arg(db.driverName());
+    return false;
+}
+
+bool NativeQuery::canCopyIn(const QSqlDatabase &db)
+{
+#ifdef HAVE_LIBPQ
+    return db.isOpen() && db.driverName() == DRIVER_PSQL && psqlHandle(db) != nullptr;
+#else
+    Q_UNUSED(db);
+    return false;
+#endif
+}
+
+bool NativeQuery::copyIn(const QSqlDatabase &db, const QString &table, const QStringList &columns,
+                         const QList<QVariantList> &rows, QString &error)
+{
+#ifdef HAVE_LIBPQ
+    if (PGconn* conn = psqlHandle(db)) {
+        QSqlDriver* driver = db.driver();
+        QStringList names;
+        for(const QString& column: columns) {
+            names.append(driver->escapeIdentifier(column, QSqlDriver::FieldName));
+        }
+        return psqlCopyIn(conn, driver->escapeIdentifier(table, QSqlDriver::TableName), names, rows, error);
+    }
+#endif
+    Q_UNUSED(table);
+    Q_UNUSED(columns);
+    Q_UNUSED(rows);
+    error = QString("COPY is not available for %1").arg(db.driverName());
+    return false;
+}
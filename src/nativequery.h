@@ -0,0 +1,37 @@
+#ifndef NATIVEQUERY_H
+#define NATIVEQUERY_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+class QSqlDatabase;
+class ResultSource;
+
+// Executes query through native client library on connection handle of Qt driver
+// (libpq for QPSQL, libmysqlclient for QMYSQL and QMARIADB) and decodes rows from
+// wire format without QSqlQuery. PostgreSQL selects run in single row mode with binary
+// result format when all column types are known, other statements (including
+// COPY ... TO STDOUT) run as simple queries. MySQL results are streamed with mysql_use_result.
+// ODBC connections are handled by OdbcQuery.
+// Compiled in with WITH_LIBPQ, WITH_MYSQLCLIENT and WITH_ODBC cmake options.
+
+class NativeQuery
+{
+public:
+    static bool isAvailable(const QSqlDatabase& db);
+
+    // on success source is set to row source (or nullptr for statements without result set),
+    // source shares connection and must be exhausted before next query
+    static bool exec(const QSqlDatabase& db, const QString& query, ResultSource** source, int* rowsAffected, QString& error);
+
+    // PostgreSQL connection with libpq handle, rows can be loaded with COPY ... FROM STDIN
+    static bool canCopyIn(const QSqlDatabase& db);
+
+    // sends rows in COPY text format, runs in caller's transaction if there is one
+    static bool copyIn(const QSqlDatabase& db, const QString& table, const QStringList& columns,
+                       const QList<QVariantList>& rows, QString& error);
+
+    static const int copyBufferSize = 256 * 1024;
+};
+
+#endif // NATIVEQUERY_H
@@ -0,0 +1,650 @@
+#include "odbcquery.h"
+
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlField>
+#include <QSqlRecord>
+#include <QDateTime>
+#include <QDebug>
+#include <vector>
+#include <cstring>
+
+#include "drivernames.h"
+
+#ifdef HAVE_ODBC
+
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#endif
+#include <sql.h>
+#include <sqlext.h>
+
+#include "resultsource.h"
+#include "resultstore.h"
+
+namespace {
+
+// SQLWCHAR is utf-16 on windows and unixODBC, utf-32 on iODBC
+std::vector<SQLWCHAR> toSqlWChar(const QString& text) {
+    std::vector<SQLWCHAR> res;
+    if constexpr (sizeof(SQLWCHAR) == 2) {
+        res.assign(text.utf16(), text.utf16() + text.size());
+    } else {
+        QList<uint> ucs4 = text.toUcs4();
+        res.assign(ucs4.begin(), ucs4.end());
+    }
+    res.push_back(0);
+    return res;
+}
+
+QString fromSqlWChar(const void* data, int chars) {
+    if constexpr (sizeof(SQLWCHAR) == 2) {
+        return QString::fromUtf16(static_cast<const char16_t*>(data), chars);
+    }
+    return QString::fromUcs4(static_cast<const char32_t*>(data), chars);
+}
+
+QString odbcError(SQLSMALLINT type, SQLHANDLE handle) {
+    QStringList messages;
+    SQLWCHAR state[6];
+    SQLINTEGER native;
+    SQLWCHAR text[1024];
+    SQLSMALLINT size;
+    for(SQLSMALLINT i=1;;i++) {
+        SQLRETURN r = SQLGetDiagRecW(type, handle, i, state, &native, text, 1024, &size);
+        if (!SQL_SUCCEEDED(r)) {
+            break;
+        }
+        messages.append(fromSqlWChar(text, qMin<int>(size, 1023)));
+    }
+    return messages.join("\n");
+}
+
+SQLHDBC odbcHandle(const QSqlDatabase& db) {
+    if (db.driverName() != DRIVER_ODBC || !db.isOpen()) {
+        return nullptr;
+    }
+    QVariant handle = db.driver()->handle();
+    if (!handle.isValid() || (qstrcmp(handle.typeName(), "SQLHANDLE") != 0 && qstrcmp(handle.typeName(), "void*") != 0)) {
+        return nullptr;
+    }
+    return *static_cast<SQLHDBC const*>(handle.constData());
+}
+
+QVariant decode(SQLSMALLINT cType, QMetaType::Type type, const char* data, SQLLEN indicator, SQLLEN size) {
+    if (indicator == SQL_NULL_DATA) {
+        return QVariant(QMetaType(type));
+    }
+    switch (cType) {
+    case SQL_C_BIT:
+        return QVariant(data[0] != 0);
+    case SQL_C_SLONG: {
+        SQLINTEGER value;
+        memcpy(&value, data, sizeof(value));
+        return QVariant(int(value));
+    }
+    case SQL_C_SBIGINT: {
+        SQLBIGINT value;
+        memcpy(&value, data, sizeof(value));
+        return QVariant(qlonglong(value));
+    }
+    case SQL_C_DOUBLE: {
+        double value;
+        memcpy(&value, data, sizeof(value));
+        return QVariant(value);
+    }
+    case SQL_C_TYPE_DATE: {
+        DATE_STRUCT value;
+        memcpy(&value, data, sizeof(value));
+        return QVariant(QDate(value.year, value.month, value.day));
+    }
+    case SQL_C_TYPE_TIME: {
+        TIME_STRUCT value;
+        memcpy(&value, data, sizeof(value));
+        return QVariant(QTime(value.hour, value.minute, value.second));
+    }
+    case SQL_C_TYPE_TIMESTAMP: {
+        TIMESTAMP_STRUCT value;
+        memcpy(&value, data, sizeof(value));
+        return QVariant(QDateTime(QDate(value.year, value.month, value.day),
+                                  QTime(value.hour, value.minute, value.second, int(value.fraction / 1000000))));
+    }
+    case SQL_C_WCHAR: {
+        SQLLEN bytes = (indicator == SQL_NO_TOTAL || indicator > size - SQLLEN(sizeof(SQLWCHAR))) ? size - SQLLEN(sizeof(SQLWCHAR)) : indicator;
+        return QVariant(fromSqlWChar(data, int(bytes / sizeof(SQLWCHAR))));
+    }
+    default: {
+        SQLLEN bytes = (indicator == SQL_NO_TOTAL || indicator > size) ? size : indicator;
+        return QVariant(QByteArray(data, int(bytes)));
+    }
+    }
+}
+
+// Result set read with block cursor, columns bound column-wise
+
+class OdbcResultSource : public ResultSource
+{
+public:
+    // rows per SQLFetch are limited by this amount of buffer memory
+    static const int blockBytes = 1024 * 1024;
+    static const int maxArraySize = 4096;
+    static const int maxBoundChars = 4000;
+
+    OdbcResultSource(SQLHSTMT stmt, const QString& query)
+        : mStmt(stmt), mQuery(query), mArraySize(1), mFetched(0), mPos(0), mBound(true), mDone(false) {
+        describe();
+        bind();
+    }
+
+    ~OdbcResultSource() {
+        SQLCloseCursor(mStmt);
+        SQLFreeHandle(SQL_HANDLE_STMT, mStmt);
+    }
+
+    QSqlRecord record() const override {
+        return mRecord;
+    }
+
+    int fetch(ResultStore* store, int count) override {
+        int fetched = 0;
+        int columns = mColumns.size();
+        while (fetched < count) {
+            if (mPos >= mFetched && !fetchBlock()) {
+                break;
+            }
+            QVariantList row;
+            row.reserve(columns);
+            for(int c=0;c<columns;c++) {
+                row.append(mBound ? value(c, mPos) : getData(c));
+            }
+            store->append(row);
+            mPos++;
+            fetched++;
+        }
+        return fetched;
+    }
+
+    QString lastQuery() const override {
+        return mQuery;
+    }
+
+protected:
+    struct Column {
+        SQLSMALLINT cType;
+        QMetaType::Type type;
+        SQLLEN size;
+        QByteArray buffer;
+        std::vector<SQLLEN> indicators;
+    };
+
+    void describe() {
+        SQLSMALLINT count = 0;
+        SQLNumResultCols(mStmt, &count);
+        for(SQLUSMALLINT c=1;c<=count;c++) {
+            SQLWCHAR name[256];
+            SQLSMALLINT nameSize = 0;
+            SQLSMALLINT sqlType = 0;
+            SQLULEN size = 0;
+            SQLSMALLINT digits = 0;
+            SQLSMALLINT nullable = 0;
+            SQLDescribeColW(mStmt, c, name, 256, &nameSize, &sqlType, &size, &digits, &nullable);
+
+            Column column;
+            column.cType = SQL_C_WCHAR;
+            column.type = QMetaType::QString;
+            column.size = 0;
+            bool variable = false;
+            switch (sqlType) {
+            case SQL_BIT:
+                column.cType = SQL_C_BIT;
+                column.type = QMetaType::Bool;
+                column.size = 1;
+                break;
+            case SQL_TINYINT:
+            case SQL_SMALLINT:
+            case SQL_INTEGER:
+                column.cType = SQL_C_SLONG;
+                column.type = QMetaType::Int;
+                column.size = sizeof(SQLINTEGER);
+                break;
+            case SQL_BIGINT:
+                column.cType = SQL_C_SBIGINT;
+                column.type = QMetaType::LongLong;
+                column.size = sizeof(SQLBIGINT);
+                break;
+            case SQL_REAL:
+            case SQL_FLOAT:
+            case SQL_DOUBLE:
+            case SQL_DECIMAL:
+            case SQL_NUMERIC:
+                column.cType = SQL_C_DOUBLE;
+                column.type = QMetaType::Double;
+                column.size = sizeof(double);
+                break;
+            case SQL_DATE:
+            case SQL_TYPE_DATE:
+                column.cType = SQL_C_TYPE_DATE;
+                column.type = QMetaType::QDate;
+                column.size = sizeof(DATE_STRUCT);
+                break;
+            case SQL_TIME:
+            case SQL_TYPE_TIME:
+                column.cType = SQL_C_TYPE_TIME;
+                column.type = QMetaType::QTime;
+                column.size = sizeof(TIME_STRUCT);
+                break;
+            case SQL_TIMESTAMP:
+            case SQL_TYPE_TIMESTAMP:
+                column.cType = SQL_C_TYPE_TIMESTAMP;
+                column.type = QMetaType::QDateTime;
+                column.size = sizeof(TIMESTAMP_STRUCT);
+                break;
+            case SQL_BINARY:
+            case SQL_VARBINARY:
+                column.cType = SQL_C_BINARY;
+                column.type = QMetaType::QByteArray;
+                variable = true;
+                break;
+            case SQL_LONGVARBINARY:
+                column.cType = SQL_C_BINARY;
+                column.type = QMetaType::QByteArray;
+                mBound = false;
+                break;
+            case SQL_CHAR:
+            case SQL_VARCHAR:
+            case SQL_WCHAR:
+            case SQL_WVARCHAR:
+            case SQL_GUID:
+                variable = true;
+                break;
+            default:
+                // long text and driver specific types
+                mBound = false;
+                break;
+            }
+            if (variable) {
+                if (size == 0 || size > SQLULEN(maxBoundChars)) {
+                    mBound = false;
+                } else if (column.cType == SQL_C_WCHAR) {
+                    // multibyte char columns may be longer in characters than reported in bytes
+                    column.size = SQLLEN(size + 1) * sizeof(SQLWCHAR);
+                } else {
+                    column.size = SQLLEN(size);
+                }
+            }
+            mColumns.append(column);
+            mRecord.append(QSqlField(fromSqlWChar(name, qMin<int>(nameSize, 255)), QMetaType(column.type)));
+        }
+    }
+
+    void bind() {
+        if (!mBound) {
+            // SQLGetData with block cursor is optional feature of driver, read row by row
+            return;
+        }
+        SQLLEN rowBytes = 0;
+        for(const Column& column: std::as_const(mColumns)) {
+            rowBytes += column.size + SQLLEN(sizeof(SQLLEN));
+        }
+        mArraySize = qBound(SQLLEN(1), SQLLEN(blockBytes) / qMax(rowBytes, SQLLEN(1)), SQLLEN(maxArraySize));
+        SQLSetStmtAttr(mStmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER) SQL_BIND_BY_COLUMN, 0);
+        if (!SQL_SUCCEEDED(SQLSetStmtAttr(mStmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) SQLULEN(mArraySize), 0))) {
+            mArraySize = 1;
+        }
+        SQLSetStmtAttr(mStmt, SQL_ATTR_ROWS_FETCHED_PTR, &mFetched, 0);
+        for(int c=0;c<mColumns.size();c++) {
+            Column& column = mColumns[c];
+            column.buffer.resize(column.size * mArraySize);
+            column.indicators.resize(mArraySize);
+            SQLBindCol(mStmt, SQLUSMALLINT(c + 1), column.cType, column.buffer.data(), column.size, column.indicators.data());
+        }
+    }
+
+    bool fetchBlock() {
+        if (mDone) {
+            return false;
+        }
+        mFetched = 0;
+        mPos = 0;
+        SQLRETURN r = SQLFetch(mStmt);
+        if (!SQL_SUCCEEDED(r)) {
+            if (r != SQL_NO_DATA) {
+                qDebug() << "OdbcResultSource" << odbcError(SQL_HANDLE_STMT, mStmt);
+            }
+            mDone = true;
+            return false;
+        }
+        if (!mBound) {
+            mFetched = 1;
+        }
+        return mFetched > 0;
+    }
+
+    QVariant value(int c, SQLULEN row) const {
+        const Column& column = mColumns[c];
+        return decode(column.cType, column.type, column.buffer.constData() + column.size * SQLLEN(row), column.indicators[row], column.size);
+    }
+
+    QVariant getData(int c) {
+        const Column& column = mColumns[c];
+        SQLUSMALLINT number = SQLUSMALLINT(c + 1);
+        SQLLEN indicator = 0;
+        if (column.cType != SQL_C_WCHAR && column.cType != SQL_C_BINARY) {
+            char buffer[sizeof(TIMESTAMP_STRUCT) + sizeof(double)];
+            SQLRETURN r = SQLGetData(mStmt, number, column.cType, buffer, column.size, &indicator);
+            if (!SQL_SUCCEEDED(r)) {
+                return QVariant(QMetaType(column.type));
+            }
+            return decode(column.cType, column.type, buffer, indicator, column.size);
+        }
+        // variable size, read in parts
+        QByteArray data;
+        char buffer[8192];
+        SQLLEN terminator = column.cType == SQL_C_WCHAR ? SQLLEN(sizeof(SQLWCHAR)) : 0;
+        while (true) {
+            SQLRETURN r = SQLGetData(mStmt, number, column.cType, buffer, sizeof(buffer), &indicator);
+            if (r == SQL_NO_DATA) {
+                break;
+            }
+            if (!SQL_SUCCEEDED(r)) {
+                qDebug() << "OdbcResultSource" << odbcError(SQL_HANDLE_STMT, mStmt);
+                break;
+            }
+            if (indicator == SQL_NULL_DATA) {
+                return QVariant(QMetaType(column.type));
+            }
+            SQLLEN part = (indicator == SQL_NO_TOTAL || indicator > SQLLEN(sizeof(buffer)) - terminator) ?
+                        SQLLEN(sizeof(buffer)) - terminator : indicator;
+            data.append(buffer, int(part));
+            if (r == SQL_SUCCESS) {
+                break;
+            }
+        }
+        if (column.cType == SQL_C_WCHAR) {
+            return QVariant(fromSqlWChar(data.constData(), int(data.size() / sizeof(SQLWCHAR))));
+        }
+        return QVariant(data);
+    }
+
+    SQLHSTMT mStmt;
+    QString mQuery;
+    QList<Column> mColumns;
+    QSqlRecord mRecord;
+    SQLLEN mArraySize;
+    SQLULEN mFetched;
+    SQLULEN mPos;
+    bool mBound;
+    bool mDone;
+};
+
+// Column of parameter array
+struct Param {
+    SQLSMALLINT cType;
+    SQLSMALLINT sqlType;
+    SQLULEN columnSize;
+    SQLSMALLINT digits;
+    SQLLEN size;
+    QByteArray buffer;
+    std::vector<SQLLEN> indicators;
+};
+
+Param makeParam(const QList<QVariantList>& rows, int begin, int count, int p) {
+    Param param;
+    QMetaType::Type type = QMetaType::UnknownType;
+    for(int i=begin;i<begin+count && type == QMetaType::UnknownType;i++) {
+        const QVariant& value = rows[i][p];
+        if (!value.isNull()) {
+            type = QMetaType::Type(value.typeId());
+        }
+    }
+    param.digits = 0;
+    switch (type) {
+    case QMetaType::Bool:
+        param.cType = SQL_C_BIT;
+        param.sqlType = SQL_BIT;
+        param.columnSize = 1;
+        param.size = 1;
+        break;
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        param.cType = SQL_C_SBIGINT;
+        param.sqlType = SQL_BIGINT;
+        param.columnSize = 19;
+        param.size = sizeof(SQLBIGINT);
+        break;
+    case QMetaType::Float:
+    case QMetaType::Double:
+        param.cType = SQL_C_DOUBLE;
+        param.sqlType = SQL_DOUBLE;
+        param.columnSize = 15;
+        param.size = sizeof(double);
+        break;
+    case QMetaType::QDate:
+        param.cType = SQL_C_TYPE_DATE;
+        param.sqlType = SQL_TYPE_DATE;
+        param.columnSize = 10;
+        param.size = sizeof(DATE_STRUCT);
+        break;
+    case QMetaType::QTime:
+        param.cType = SQL_C_TYPE_TIME;
+        param.sqlType = SQL_TYPE_TIME;
+        param.columnSize = 8;
+        param.size = sizeof(TIME_STRUCT);
+        break;
+    case QMetaType::QDateTime:
+        param.cType = SQL_C_TYPE_TIMESTAMP;
+        param.sqlType = SQL_TYPE_TIMESTAMP;
+        param.columnSize = 23;
+        param.digits = 3;
+        param.size = sizeof(TIMESTAMP_STRUCT);
+        break;
+    case QMetaType::QByteArray: {
+        int size = 1;
+        for(int i=begin;i<begin+count;i++) {
+            size = qMax(size, int(rows[i][p].toByteArray().size()));
+        }
+        param.cType = SQL_C_BINARY;
+        param.sqlType = SQL_VARBINARY;
+        param.columnSize = size;
+        param.size = size;
+        break;
+    }
+    default: {
+        int size = 1;
+        for(int i=begin;i<begin+count;i++) {
+            size = qMax(size, int(rows[i][p].toString().size()));
+        }
+        param.cType = SQL_C_WCHAR;
+        param.sqlType = SQL_WVARCHAR;
+        param.columnSize = size;
+        param.size = SQLLEN(size + 1) * sizeof(SQLWCHAR);
+    }
+    }
+
+    param.buffer.resize(param.size * count);
+    param.buffer.fill(0);
+    param.indicators.resize(count);
+    for(int i=0;i<count;i++) {
+        const QVariant& value = rows[begin + i][p];
+        char* data = param.buffer.data() + param.size * i;
+        SQLLEN& indicator = param.indicators[i];
+        if (value.isNull()) {
+            indicator = SQL_NULL_DATA;
+            continue;
+        }
+        indicator = param.size;
+        switch (param.cType) {
+        case SQL_C_BIT:
+            data[0] = value.toBool() ? 1 : 0;
+            break;
+        case SQL_C_SBIGINT: {
+            SQLBIGINT v = value.toLongLong();
+            memcpy(data, &v, sizeof(v));
+            break;
+        }
+        case SQL_C_DOUBLE: {
+            double v = value.toDouble();
+            memcpy(data, &v, sizeof(v));
+            break;
+        }
+        case SQL_C_TYPE_DATE: {
+            QDate date = value.toDate();
+            DATE_STRUCT v = {SQLSMALLINT(date.year()), SQLUSMALLINT(date.month()), SQLUSMALLINT(date.day())};
+            memcpy(data, &v, sizeof(v));
+            break;
+        }
+        case SQL_C_TYPE_TIME: {
+            QTime time = value.toTime();
+            TIME_STRUCT v = {SQLUSMALLINT(time.hour()), SQLUSMALLINT(time.minute()), SQLUSMALLINT(time.second())};
+            memcpy(data, &v, sizeof(v));
+            break;
+        }
+        case SQL_C_TYPE_TIMESTAMP: {
+            QDateTime dateTime = value.toDateTime();
+            QDate date = dateTime.date();
+            QTime time = dateTime.time();
+            TIMESTAMP_STRUCT v = {SQLSMALLINT(date.year()), SQLUSMALLINT(date.month()), SQLUSMALLINT(date.day()),
+                                  SQLUSMALLINT(time.hour()), SQLUSMALLINT(time.minute()), SQLUSMALLINT(time.second()),
+                                  SQLUINTEGER(time.msec()) * 1000000};
+            memcpy(data, &v, sizeof(v));
+            break;
+        }
+        case SQL_C_BINARY: {
+            QByteArray v = value.toByteArray();
+            memcpy(data, v.constData(), v.size());
+            indicator = v.size();
+            break;
+        }
+        default: {
+            std::vector<SQLWCHAR> v = toSqlWChar(value.toString());
+            memcpy(data, v.data(), v.size() * sizeof(SQLWCHAR));
+            indicator = SQLLEN(v.size() - 1) * sizeof(SQLWCHAR);
+        }
+        }
+    }
+    return param;
+}
+
+} // namespace
+
+#endif // HAVE_ODBC
+
+bool OdbcQuery::isAvailable(const QSqlDatabase &db)
+{
+#ifdef HAVE_ODBC
+    return odbcHandle(db) != nullptr;
+#else
+    Q_UNUSED(db);
+    return false;
+#endif
+}
+
+bool OdbcQuery::exec(const QSqlDatabase &db, const QString &query, ResultSource **source, int *rowsAffected, QString &error)
+{
+    *source = nullptr;
+    *rowsAffected = -1;
+#ifdef HAVE_ODBC
+    SQLHDBC dbc = odbcHandle(db);
+    if (!dbc) {
+        error = "Connection is not open";
+        return false;
+    }
+    SQLHSTMT stmt;
+    if (!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_STMT, dbc, &stmt))) {
+        error = odbcError(SQL_HANDLE_DBC, dbc);
+        return false;
+    }
+    SQLSetStmtAttr(stmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER) SQL_CURSOR_FORWARD_ONLY, SQL_IS_UINTEGER);
+    std::vector<SQLWCHAR> sql = toSqlWChar(query);
+    SQLRETURN r = SQLExecDirectW(stmt, sql.data(), SQL_NTS);
+    if (r != SQL_NO_DATA && !SQL_SUCCEEDED(r)) {
+        error = odbcError(SQL_HANDLE_STMT, stmt);
+        SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+        return false;
+    }
+    SQLSMALLINT columns = 0;
+    SQLNumResultCols(stmt, &columns);
+    if (columns == 0) {
+        SQLLEN count = -1;
+        SQLRowCount(stmt, &count);
+        *rowsAffected = int(count);
+        SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+        return true;
+    }
+    *source = new OdbcResultSource(stmt, query);
+    return true;
+#else
+    Q_UNUSED(db);
+    Q_UNUSED(query);
+    error = "Built without ODBC";
+    return false;
+#endif
+}
+
+bool OdbcQuery::insert(const QSqlDatabase &db, const QString &query, const QList<QVariantList> &rows, QString &error)
+{
+#ifdef HAVE_ODBC
+    SQLHDBC dbc = odbcHandle(db);
+    if (!dbc) {
+        error = "Connection is not open";
+        return false;
+    }
+    if (rows.isEmpty()) {
+        return true;
+    }
+    SQLHSTMT stmt;
+    if (!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_STMT, dbc, &stmt))) {
+        error = odbcError(SQL_HANDLE_DBC, dbc);
+        return false;
+    }
+    std::vector<SQLWCHAR> sql = toSqlWChar(query);
+    if (!SQL_SUCCEEDED(SQLPrepareW(stmt, sql.data(), SQL_NTS))) {
+        error = odbcError(SQL_HANDLE_STMT, stmt);
+        SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+        return false;
+    }
+    std::vector<SQLUSMALLINT> status(paramsetSize);
+    SQLULEN processed = 0;
+    SQLSetStmtAttr(stmt, SQL_ATTR_PARAM_BIND_TYPE, (SQLPOINTER) SQL_PARAM_BIND_BY_COLUMN, 0);
+    SQLSetStmtAttr(stmt, SQL_ATTR_PARAM_STATUS_PTR, status.data(), 0);
+    SQLSetStmtAttr(stmt, SQL_ATTR_PARAMS_PROCESSED_PTR, &processed, 0);
+
+    int columns = rows[0].size();
+    bool ok = true;
+    for(int begin=0;begin<rows.size() && ok;begin+=paramsetSize) {
+        int count = qMin(int(paramsetSize), int(rows.size()) - begin);
+        SQLSetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) SQLULEN(count), 0);
+        QList<Param> params;
+        for(int p=0;p<columns;p++) {
+            params.append(makeParam(rows, begin, count, p));
+        }
+        for(int p=0;p<columns;p++) {
+            Param& param = params[p];
+            SQLBindParameter(stmt, SQLUSMALLINT(p + 1), SQL_PARAM_INPUT, param.cType, param.sqlType,
+                             param.columnSize, param.digits, param.buffer.data(), param.size, param.indicators.data());
+        }
+        SQLRETURN r = SQLExecute(stmt);
+        if (!SQL_SUCCEEDED(r) && r != SQL_NO_DATA) {
+            error = odbcError(SQL_HANDLE_STMT, stmt);
+            ok = false;
+        }
+        for(SQLULEN i=0;i<processed && ok;i++) {
+            if (status[i] == SQL_PARAM_ERROR) {
+                error = QString("Row %1: %2").arg(begin + int(i) + 1).arg(odbcError(SQL_HANDLE_STMT, stmt));
+                ok = false;
+            }
+        }
+        SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+    }
+    SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+    return ok;
+#else
+    Q_UNUSED(db);
+    Q_UNUSED(query);
+    Q_UNUSED(rows);
+    error = "Built without ODBC";
+    return false;
+#endif
+}
@@ -0,0 +1,28 @@
+#ifndef ODBCQUERY_H
+#define ODBCQUERY_H
+
+#include <QString>
+#include <QVariantList>
+class QSqlDatabase;
+class ResultSource;
+
+// Executes query on connection handle of QODBC driver with block cursor:
+// columns are bound column-wise and fetched SQL_ATTR_ROW_ARRAY_SIZE rows per SQLFetch
+// (results with long columns fall back to one row per fetch and SQLGetData).
+// Inserts use parameter arrays (SQL_ATTR_PARAMSET_SIZE). Compiled in with WITH_ODBC cmake option.
+
+class OdbcQuery
+{
+public:
+    static bool isAvailable(const QSqlDatabase& db);
+
+    // on success source is set to row source (or nullptr for statements without result set)
+    static bool exec(const QSqlDatabase& db, const QString& query, ResultSource** source, int* rowsAffected, QString& error);
+
+    // executes query with ? placeholders once for every row
+    static bool insert(const QSqlDatabase& db, const QString& query, const QList<QVariantList>& rows, QString& error);
+
+    static const int paramsetSize = 1024;
+};
+
+#endif // ODBCQUERY_H
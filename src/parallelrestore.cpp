@@ -0,0 +1,316 @@
+#include "parallelrestore.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QDebug>
+
+#include "scriptrunner.h"
+#include "sqllexer.h"
+#include "gzipfile.h"
+#include "drivernames.h"
+
+namespace {
+
+QString untick(QStringView name) {
+    if (name.size() >= 2 && (name[0] == '`' || name[0] == '"' || name[0] == '[')) {
+        QChar quote = name[0] == '[' ? QChar(']') : name[0];
+        return name.mid(1, name.size() - 2).toString().replace(QString(2, quote), QString(quote));
+    }
+    return name.toString();
+}
+
+}
+
+ParallelRestore::ParallelRestore(const QString &connectionName, QObject *parent)
+    : Dump{parent}, mConnectionName(connectionName), mBatchSize(1000), mStopOnError(true),
+      mDeferChecks(true), mJobs(1), mCancelled(false)
+{
+
+}
+
+void ParallelRestore::setBatchSize(int statements)
+{
+    mBatchSize = qMax(1, statements);
+}
+
+void ParallelRestore::setStopOnError(bool value)
+{
+    mStopOnError = value;
+}
+
+void ParallelRestore::setDeferChecks(bool value)
+{
+    mDeferChecks = value;
+}
+
+void ParallelRestore::start(const QStringList &files, int jobs, const QMap<QString, QStringList> &references)
+{
+    mDriverName = QSqlDatabase::database(mConnectionName, false).driverName();
+    mTables.clear();
+    mReferences.clear();
+    for(const QString& path: files) {
+        Table table;
+        table.name = tableName(path);
+        table.path = path;
+        table.totalBytes = GzipFile::isGzip(path) ? GzipFile::uncompressedSize(path) : QFileInfo(path).size();
+        mTables.append(table);
+        QString name = table.name.toLower();
+        QStringList tableReferences = fileReferences(path) + references.value(name);
+        tableReferences.removeAll(name);
+        tableReferences.removeDuplicates();
+        mReferences.append(tableReferences);
+    }
+    mRunners = QList<ScriptRunner*>(files.size(), nullptr);
+    mJobs = qMax(1, jobs);
+    mCancelled = false;
+    startTime();
+    startNext();
+}
+
+void ParallelRestore::cancel()
+{
+    mCancelled = true;
+    for(int i=0;i<mTables.size();i++) {
+        if (mTables[i].status == Queued) {
+            mTables[i].status = Cancelled;
+            emit tableChanged(i);
+        }
+    }
+    for(ScriptRunner* runner: std::as_const(mRunners)) {
+        if (runner) {
+            runner->cancel();
+        }
+    }
+    startNext();
+}
+
+QString ParallelRestore::rowsName() const
+{
+    return "Statements";
+}
+
+QStringList ParallelRestore::references(int index) const
+{
+    return mReferences.value(index);
+}
+
+bool ParallelRestore::isReady(int index) const
+{
+    const QStringList& references = mReferences[index];
+    if (references.isEmpty()) {
+        return true;
+    }
+    for(int i=0;i<mTables.size();i++) {
+        if (i == index || (mTables[i].status != Queued && mTables[i].status != Running)) {
+            continue;
+        }
+        if (references.contains(mTables[i].name.toLower())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ParallelRestore::startNext()
+{
+    int running = count(Running);
+    while (!mCancelled && running < mJobs) {
+        int next = -1;
+        for(int i=0;i<mTables.size() && next < 0;i++) {
+            if (mTables[i].status == Queued && isReady(i)) {
+                next = i;
+            }
+        }
+        if (next < 0 && running == 0) {
+            // references form cycle
+            for(int i=0;i<mTables.size() && next < 0;i++) {
+                if (mTables[i].status == Queued) {
+                    next = i;
+                }
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        ScriptRunner* runner = new ScriptRunner(mConnectionName, this);
+        runner->setBatchSize(mBatchSize);
+        runner->setStopOnError(mStopOnError);
+        if (mDeferChecks) {
+            runner->setInitStatements(initStatements(mDriverName));
+            runner->setDeferIndexes(true);
+        }
+        connect(runner, &ScriptRunner::progress, this, [=](){
+            onProgress(next);
+        });
+        connect(runner, &ScriptRunner::error, this, [=](QString, QString error){
+            mTables[next].error = error;
+            emit tableChanged(next);
+        });
+        connect(runner, &ScriptRunner::finished, this, [=](){
+            onFinished(next);
+        });
+        mRunners[next] = runner;
+        mTables[next].status = Running;
+        runner->startFile(mTables[next].path);
+        running++;
+        emit tableChanged(next);
+    }
+    if (running == 0 && count(Queued) == 0 && !mFinished) {
+        setFinished();
+    }
+}
+
+void ParallelRestore::onProgress(int index)
+{
+    ScriptRunner* runner = mRunners.value(index);
+    if (!runner) {
+        return;
+    }
+    Table& table = mTables[index];
+    table.bytes = runner->bytes();
+    table.totalBytes = runner->totalBytes();
+    table.rows = runner->statements();
+    table.seconds = runner->seconds();
+    emit tableChanged(index);
+}
+
+void ParallelRestore::onFinished(int index)
+{
+    ScriptRunner* runner = mRunners.value(index);
+    if (!runner) {
+        return;
+    }
+    onProgress(index);
+    Table& table = mTables[index];
+    if (runner->isFailed()) {
+        table.status = Failed;
+    } else if (runner->resumePosition().offset < runner->totalBytes()) {
+        table.status = Cancelled;
+    } else {
+        table.status = Done;
+    }
+    mRunners[index] = nullptr;
+    runner->deleteLater();
+    emit tableChanged(index);
+    startNext();
+}
+
+QString ParallelRestore::tableName(const QString &path)
+{
+    QString name = QFileInfo(path).fileName();
+    for(const QString& suffix: {".gz", ".sql"}) {
+        if (name.endsWith(suffix, Qt::CaseInsensitive)) {
+            name.chop(suffix.size());
+        }
+    }
+    return name;
+}
+
+QStringList ParallelRestore::textReferences(const QString &text)
+{
+    QStringList res;
+    QList<SqlLexer::Token> tokens = SqlLexer::codeTokens(text);
+    auto tokenText = [&](int i) {
+        return QStringView(text).mid(tokens[i].pos, tokens[i].size);
+    };
+    for(int i=0;i<tokens.size();i++) {
+        if (tokens[i].type != SqlLexer::Word || tokenText(i).compare(QLatin1String("references"), Qt::CaseInsensitive) != 0) {
+            continue;
+        }
+        // schema.table, last part is table
+        QString name;
+        int j = i + 1;
+        while (j < tokens.size() && (tokens[j].type == SqlLexer::Word || tokens[j].type == SqlLexer::QuotedIdentifier)) {
+            name = untick(tokenText(j));
+            if (j + 1 < tokens.size() && tokenText(j + 1) == QLatin1String(".")) {
+                j += 2;
+            } else {
+                break;
+            }
+        }
+        if (!name.isEmpty() && !res.contains(name.toLower())) {
+            res.append(name.toLower());
+        }
+    }
+    return res;
+}
+
+QStringList ParallelRestore::fileReferences(const QString &path)
+{
+    QByteArray head;
+    if (GzipFile::isGzip(path)) {
+        QString error;
+        head = GzipFile::read(path, error, headSize);
+    } else {
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly)) {
+            head = file.read(headSize);
+        }
+    }
+    if (head.size() >= headSize) {
+        // lexer pieces end at line boundary
+        head = head.left(head.lastIndexOf('\n') + 1);
+    }
+    return textReferences(QString::fromUtf8(head));
+}
+
+QMap<QString, QStringList> ParallelRestore::databaseReferences(QSqlDatabase db)
+{
+    QMap<QString, QStringList> res;
+    QSqlQuery q(db);
+    QString driverName = db.driverName();
+    auto append = [&](const QString& table, const QString& reference) {
+        QString name = table.toLower();
+        if (!res[name].contains(reference.toLower())) {
+            res[name].append(reference.toLower());
+        }
+    };
+    if (driverName == DRIVER_MYSQL || driverName == DRIVER_MARIADB) {
+        if (!q.exec("SELECT TABLE_NAME, REFERENCED_TABLE_NAME FROM information_schema.KEY_COLUMN_USAGE "
+                    "WHERE TABLE_SCHEMA = DATABASE() AND REFERENCED_TABLE_NAME IS NOT NULL")) {
+            qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+        }
+        while (q.next()) {
+            append(q.value(0).toString(), q.value(1).toString());
+        }
+    } else if (driverName == DRIVER_PSQL) {
+        if (!q.exec("SELECT tc.table_name, ccu.table_name FROM information_schema.table_constraints tc "
+                    "JOIN information_schema.constraint_column_usage ccu ON ccu.constraint_name = tc.constraint_name "
+                    "AND ccu.constraint_schema = tc.constraint_schema WHERE tc.constraint_type = 'FOREIGN KEY'")) {
+            qDebug() << q.lastError().text() << __FILE__ << __LINE__;
+        }
+        while (q.next()) {
+            append(q.value(0).toString(), q.value(1).toString());
+        }
+    } else if (driverName == DRIVER_SQLITE) {
+        const QStringList tables = db.tables();
+        for(const QString& table: tables) {
+            if (!q.exec(QString("PRAGMA foreign_key_list(%1)").arg(db.driver()->escapeIdentifier(table, QSqlDriver::TableName)))) {
+                continue;
+            }
+            while (q.next()) {
+                append(table, q.value(2).toString());
+            }
+        }
+    }
+    return res;
+}
+
+QStringList ParallelRestore::initStatements(const QString &driverName)
+{
+    if (driverName == DRIVER_MYSQL || driverName == DRIVER_MARIADB) {
+        return {"SET FOREIGN_KEY_CHECKS = 0", "SET UNIQUE_CHECKS = 0"};
+    }
+    if (driverName == DRIVER_SQLITE) {
+        return {"PRAGMA foreign_keys = OFF"};
+    }
+    if (driverName == DRIVER_PSQL) {
+        // disables foreign key triggers, needs superuser
+        return {"SET session_replication_role = replica"};
+    }
+    return QStringList();
+}
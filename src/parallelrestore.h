@@ -0,0 +1,63 @@
+#ifndef PARALLELRESTORE_H
+#define PARALLELRESTORE_H
+
+#include "dump.h"
+#include <QMap>
+#include <QStringList>
+
+class ScriptRunner;
+class QSqlDatabase;
+
+// Restores directory of per table dump files (.sql or .sql.gz) with ScriptRunner per file,
+// each on its own pooled connection. Table starts when tables it references are loaded,
+// references are taken from CREATE TABLE statements at start of file and from database.
+// Cycles are broken by starting first queued table. With deferred checks foreign key
+// checks are off for session and CREATE INDEX statements run after data.
+
+class ParallelRestore : public Dump
+{
+    Q_OBJECT
+public:
+    ParallelRestore(const QString& connectionName, QObject* parent = nullptr);
+
+    void setBatchSize(int statements);
+    void setStopOnError(bool value);
+    void setDeferChecks(bool value);
+
+    // references: table to tables it references, lower case names
+    void start(const QStringList& files, int jobs, const QMap<QString, QStringList>& references = QMap<QString, QStringList>());
+    void cancel() override;
+    QString rowsName() const override;
+
+    QStringList references(int index) const;
+
+    // file name without .gz and .sql
+    static QString tableName(const QString& path);
+    static QStringList textReferences(const QString& text);
+    // references in first headSize bytes of file
+    static QStringList fileReferences(const QString& path);
+    static QMap<QString, QStringList> databaseReferences(QSqlDatabase db);
+    // session settings to turn off foreign key checks
+    static QStringList initStatements(const QString& driverName);
+
+    // create statements precede data in dumps
+    static const int headSize = 64 * 1024;
+
+protected:
+    void startNext();
+    bool isReady(int index) const;
+    void onProgress(int index);
+    void onFinished(int index);
+
+    QString mConnectionName;
+    QString mDriverName;
+    int mBatchSize;
+    bool mStopOnError;
+    bool mDeferChecks;
+    int mJobs;
+    bool mCancelled;
+    QList<QStringList> mReferences;
+    QList<ScriptRunner*> mRunners;
+};
+
+#endif // PARALLELRESTORE_H
@@ -4,6 +4,7 @@
 #include <QRegularExpression>
 #include <QQueue>
 #include "zipunzip.h"
+#include "sqllexer.h"
 
 namespace  {
 
@@ -357,17 +358,6 @@ bool goesFirst(const QRegularExpressionMatch& m1, const QRegularExpressionMatch&
     return goesFirst(m1,ms);
 }
 
-QStringList filter(const QList<QPair<JoinToken::JoinToken,QString> >& tokens, JoinToken::JoinToken type) {
-    QStringList result;
-    for(int i=0;i<tokens.size();i++) {
-        const QPair<JoinToken::JoinToken,QString>& token = tokens[i];
-        if (token.first == type) {
-            result << token.second;
-        }
-    }
-    return result;
-}
-
 }
 
 QList<QPair<JoinToken::JoinToken,QString> > QueryParser::joinSplit(const QString& joinExpr) {
@@ -429,19 +419,6 @@ QList<QPair<JoinToken::JoinToken,QString> > QueryParser::joinSplit(const QString
     return zipToPairList(types, tokens);
 }
 
-namespace {
-
-
-QStringList mapTrimmed(const QStringList& vs) {
-    QStringList res;
-    foreach(const QString& v, vs) {
-        res << v.trimmed();
-    }
-    return res;
-}
-
-}
-
 QMap<QString,QString> QueryParser::filterAliases(const QMap<QString,QString>& aliases, const QStringList& tables) {
     QMap<QString,QString> result;
     QStringList keys = aliases.keys();
@@ -454,44 +431,109 @@ QMap<QString,QString> QueryParser::filterAliases(const QMap<QString,QString>& al
     return result;
 }
 
-void collectAliases(const QString& flatQuery, QMap<QString,QString>& result) {
-
-    QRegularExpression::PatternOptions opt = QRegularExpression::CaseInsensitiveOption | QRegularExpression::MultilineOption;
-
-    QRegularExpression rx1("select.*from(.*)", opt);
-    QRegularExpression rx2("select.*from(.*)(where|having|group\\s+by|limit)", opt);
-    QRegularExpressionMatch m1 = rx1.match(flatQuery);
-    QRegularExpressionMatch m2 = rx2.match(flatQuery);
-    QRegularExpressionMatch m = m2.hasMatch() ? m2 : m1;
+namespace {
 
-    if (!m.hasMatch()) {
-        return;
+// words that can't be alias
+bool isReserved(QStringView word) {
+    static const QStringList words = {
+        "as", "on", "using", "join", "left", "right", "inner", "outer", "cross", "natural", "full",
+        "straight_join", "lateral", "select", "from", "where", "group", "order", "having", "limit",
+        "union", "except", "intersect", "window", "for", "into", "set", "values", "returning"
+    };
+    for(const QString& item: words) {
+        if (word.compare(item, Qt::CaseInsensitive) == 0) {
+            return true;
+        }
     }
+    return false;
+}
 
-    QString joinExp = m.captured(1);
-
-    QList<QPair<JoinToken::JoinToken,QString> > tokens = QueryParser::joinSplit(joinExp);
-
-    QStringList filtered = mapTrimmed(filter(tokens, JoinToken::JoinTokenTable));
-
-    foreach(const QString& item, filtered) {
-        QStringList words = item.split(QRegularExpression("\\s+"));
-        if (words.size() == 2) {
-            QString table = words[0];
-            QString alias = words[1];
-            if (table != "()") {
-                result[alias] = table;
-            }
+// words that end from clause
+bool endsFrom(QStringView word) {
+    static const QStringList words = {
+        "where", "group", "order", "having", "limit", "union", "except", "intersect", "window", "for",
+        "set", "values", "returning"
+    };
+    for(const QString& item: words) {
+        if (word.compare(item, Qt::CaseInsensitive) == 0) {
+            return true;
         }
     }
+    return false;
+}
 
 }
 
 QMap<QString,QString> QueryParser::aliases(const QString& query) {
+    // from clause of each subquery is tracked separately
+    struct Scope {
+        bool from = false;
+        bool expectTable = false;
+        bool expectAlias = false;
+        // empty for derived table
+        QString table;
+    };
     QMap<QString,QString> result;
-    QStringList queries = flatQueries(query);
-    foreach(const QString& flatQuery, queries) {
-        collectAliases(flatQuery, result);
+    QList<SqlLexer::Token> tokens = SqlLexer::codeTokens(query);
+    QList<Scope> scopes = {Scope()};
+    auto text = [&](int i) {
+        return QStringView(query).mid(tokens[i].pos, tokens[i].size);
+    };
+    for(int i=0;i<tokens.size();i++) {
+        Scope& scope = scopes.last();
+        const SqlLexer::Token& token = tokens[i];
+        QStringView word = text(i);
+        if (token.type == SqlLexer::Delimiter) {
+            scopes = {Scope()};
+        } else if (token.type == SqlLexer::Operator) {
+            if (word == QLatin1String("(")) {
+                if (scope.expectTable) {
+                    scope.expectTable = false;
+                    scope.expectAlias = true;
+                    scope.table.clear();
+                }
+                scopes.append(Scope());
+            } else if (word == QLatin1String(")")) {
+                if (scopes.size() > 1) {
+                    scopes.removeLast();
+                }
+            } else if (word == QLatin1String(",") && scope.from) {
+                scope.expectTable = true;
+                scope.expectAlias = false;
+            }
+        } else if (token.type == SqlLexer::Word || token.type == SqlLexer::QuotedIdentifier) {
+            bool keyword = token.type == SqlLexer::Word && isReserved(word);
+            if (scope.expectTable && !keyword) {
+                // possibly qualified name
+                qsizetype begin = token.pos;
+                while (i + 2 < tokens.size() && text(i + 1) == QLatin1String(".")
+                       && tokens[i + 2].type != SqlLexer::Operator) {
+                    i += 2;
+                }
+                scope.table = query.mid(begin, tokens[i].pos + tokens[i].size - begin);
+                scope.expectTable = false;
+                scope.expectAlias = true;
+            } else if (scope.expectAlias && !keyword) {
+                if (!scope.table.isEmpty()) {
+                    result[word.toString()] = scope.table;
+                }
+                scope.expectAlias = false;
+            } else if (scope.expectAlias && word.compare(QLatin1String("as"), Qt::CaseInsensitive) == 0) {
+                // alias follows
+            } else if (word.compare(QLatin1String("from"), Qt::CaseInsensitive) == 0
+                       || word.compare(QLatin1String("join"), Qt::CaseInsensitive) == 0
+                       || word.compare(QLatin1String("straight_join"), Qt::CaseInsensitive) == 0) {
+                scope.from = true;
+                scope.expectTable = true;
+                scope.expectAlias = false;
+            } else {
+                if (endsFrom(word)) {
+                    scope.from = false;
+                }
+                scope.expectTable = false;
+                scope.expectAlias = false;
+            }
+        }
     }
     return result;
 }
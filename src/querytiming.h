@@ -0,0 +1,27 @@
+#ifndef QUERYTIMING_H
+#define QUERYTIMING_H
+
+#include <QtGlobal>
+
+// Timing breakdown of one statement, ms
+
+struct QueryTiming {
+    // execution until result is available
+    int exec = 0;
+    // from start of execution to first row, -1 if there's no rows
+    int firstRow = -1;
+    // reading first chunk of rows into ResultStore, rest is read as view scrolls
+    int fetch = 0;
+    // size of rows in memory
+    qint64 bytes = 0;
+    // building QSqlQueryModel
+    int model = 0;
+    // setting model to result view, header and column layout, without painting
+    int layout = 0;
+
+    int total() const {
+        return exec + fetch + model + layout;
+    }
+};
+
+#endif // QUERYTIMING_H
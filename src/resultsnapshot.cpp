@@ -0,0 +1,350 @@
+#include "resultsnapshot.h"
+
+#include <QSqlQueryModel>
+#include <QSqlQuery>
+#include <QSqlResult>
+#include <QSqlDriver>
+#include <QSqlField>
+#include <QDataStream>
+#include <cstring>
+#include "valuecodec.h"
+
+namespace {
+
+const char snapshotMagic[] = "MQSNAP01";
+const int magicSize = 8;
+const quint32 snapshotVersion = 1;
+
+// driver for snapshot results, QSqlQuery and QSqlQueryModel expect one
+class SnapshotDriver : public QSqlDriver
+{
+public:
+    bool hasFeature(DriverFeature feature) const override {
+        return feature == QuerySize;
+    }
+    bool open(const QString &, const QString &, const QString &, const QString &, int, const QString &) override {
+        return false;
+    }
+    void close() override {
+
+    }
+    QSqlResult *createResult() const override {
+        return nullptr;
+    }
+};
+
+const QSqlDriver* snapshotDriver() {
+    static SnapshotDriver* driver = new SnapshotDriver();
+    return driver;
+}
+
+class SnapshotSqlResult : public QSqlResult
+{
+public:
+    SnapshotSqlResult(SnapshotReader* reader) : QSqlResult(snapshotDriver()), mReader(reader) {
+        setQuery(QString());
+        setSelect(true);
+        setActive(true);
+        setAt(QSql::BeforeFirstRow);
+    }
+    ~SnapshotSqlResult() {
+        delete mReader;
+    }
+protected:
+    QVariant data(int i) override {
+        return mReader->value(at(), i);
+    }
+    bool isNull(int i) override {
+        return mReader->value(at(), i).isNull();
+    }
+    bool reset(const QString &) override {
+        return false;
+    }
+    bool fetch(int i) override {
+        if (i < 0 || i >= mReader->rowCount()) {
+            return false;
+        }
+        setAt(i);
+        return true;
+    }
+    bool fetchFirst() override {
+        return fetch(0);
+    }
+    bool fetchLast() override {
+        return fetch(mReader->rowCount() - 1);
+    }
+    int size() override {
+        return mReader->rowCount();
+    }
+    int numRowsAffected() override {
+        return -1;
+    }
+    QSqlRecord record() const override {
+        return mReader->record();
+    }
+    SnapshotReader* mReader;
+};
+
+}
+
+bool ResultSnapshot::save(QAbstractItemModel *model, const QSqlRecord &modelRecord, const QString &path, bool compress, QString &error)
+{
+    int columns = model->columnCount();
+    int rows = model->rowCount();
+
+    // models may have hidden columns
+    QSqlRecord record;
+    for(int c=0;c<columns;c++) {
+        record.append(c < modelRecord.count() ? modelRecord.field(c) : QSqlField(model->headerData(c, Qt::Horizontal).toString()));
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    file.write(snapshotMagic, magicSize);
+
+    QByteArray index;
+    QDataStream indexStream(&index, QIODevice::WriteOnly);
+    indexStream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 blockCount = 0;
+    for(int start=0;start<rows;start+=blockRows) {
+        int count = qMin(blockRows, rows - start);
+        indexStream << quint32(count);
+        for(int c=0;c<columns;c++) {
+            QByteArray nulls((count + 7) / 8, '\0');
+            QByteArray values;
+            QDataStream stream(&values, QIODevice::WriteOnly);
+            stream.setVersion(QDataStream::Qt_6_0);
+            for(int r=0;r<count;r++) {
+                QVariant value = model->data(model->index(start + r, c), Qt::EditRole);
+                if (value.isNull()) {
+                    nulls[r / 8] = nulls[r / 8] | char(1 << (r % 8));
+                } else {
+                    ValueCodec::write(stream, value);
+                }
+            }
+            QByteArray data = nulls + values;
+            if (compress) {
+                data = qCompress(data);
+            }
+            qint64 offset = file.pos();
+            if (file.write(data) != data.size()) {
+                error = file.errorString();
+                return false;
+            }
+            indexStream << qint64(offset) << qint64(data.size());
+        }
+        blockCount++;
+    }
+
+    qint64 footerOffset = file.pos();
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << snapshotVersion << quint32(columns);
+    for(int c=0;c<columns;c++) {
+        stream << record.fieldName(c).toUtf8() << qint32(record.field(c).metaType().id());
+    }
+    stream << qint64(rows) << quint32(blockRows) << quint8(compress ? 1 : 0) << blockCount;
+    stream.writeRawData(index.constData(), index.size());
+    stream << footerOffset;
+    stream.writeRawData(snapshotMagic, magicSize);
+
+    if (stream.status() != QDataStream::Ok) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ResultSnapshot::save(QSqlQueryModel *model, const QString &path, bool compress, QString &error)
+{
+    while (model->canFetchMore()) {
+        model->fetchMore();
+    }
+    return save(model, model->record(), path, compress, error);
+}
+
+QSqlQueryModel *ResultSnapshot::open(const QString &path, QString &error, QObject *parent)
+{
+    SnapshotReader* reader = new SnapshotReader(path);
+    if (!reader->open(error)) {
+        delete reader;
+        return nullptr;
+    }
+    QSqlQueryModel* model = new QSqlQueryModel(parent);
+    model->setQuery(QSqlQuery(new SnapshotSqlResult(reader)));
+    return model;
+}
+
+QString ResultSnapshot::fileFilter()
+{
+    return "Result snapshots (*.mqsnap);; All files (*.*)";
+}
+
+SnapshotReader::SnapshotReader(const QString &path)
+    : mFile(path), mData(nullptr), mSize(0), mRowCount(0), mBlockRows(ResultSnapshot::blockRows), mCompressed(false)
+{
+    mCache.setMaxCost(256 * 1024 * 1024);
+}
+
+SnapshotReader::~SnapshotReader()
+{
+    if (mData) {
+        mFile.unmap(mData);
+    }
+}
+
+bool SnapshotReader::open(QString &error)
+{
+    if (!mFile.open(QIODevice::ReadOnly)) {
+        error = mFile.errorString();
+        return false;
+    }
+    mSize = mFile.size();
+    if (mSize < magicSize * 2 + (qint64) sizeof(qint64)) {
+        error = QString("%1 is not a snapshot file").arg(mFile.fileName());
+        return false;
+    }
+    mData = mFile.map(0, mSize);
+    if (!mData) {
+        error = mFile.errorString();
+        return false;
+    }
+    const char* data = reinterpret_cast<const char*>(mData);
+    if (memcmp(data, snapshotMagic, magicSize) != 0 || memcmp(data + mSize - magicSize, snapshotMagic, magicSize) != 0) {
+        error = QString("%1 is not a snapshot file").arg(mFile.fileName());
+        return false;
+    }
+
+    qint64 footerOffset;
+    {
+        QByteArray bytes = QByteArray::fromRawData(data + mSize - magicSize - sizeof(qint64), sizeof(qint64));
+        QDataStream stream(bytes);
+        stream >> footerOffset;
+    }
+    qint64 footerSize = mSize - magicSize - sizeof(qint64) - footerOffset;
+    if (footerOffset < magicSize || footerSize <= 0) {
+        error = QString("%1 is corrupted").arg(mFile.fileName());
+        return false;
+    }
+
+    QByteArray footer = QByteArray::fromRawData(data + footerOffset, footerSize);
+    QDataStream stream(footer);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 version;
+    quint32 columns;
+    stream >> version >> columns;
+    if (version != snapshotVersion) {
+        error = QString("%1: unsupported snapshot version %2").arg(mFile.fileName()).arg(version);
+        return false;
+    }
+    for(quint32 c=0;c<columns;c++) {
+        QByteArray name;
+        qint32 type;
+        stream >> name >> type;
+        mRecord.append(QSqlField(QString::fromUtf8(name), QMetaType(type)));
+    }
+
+    qint64 rows;
+    quint32 blockRows;
+    quint8 compressed;
+    quint32 blockCount;
+    stream >> rows >> blockRows >> compressed >> blockCount;
+    mRowCount = rows;
+    mBlockRows = blockRows;
+    mCompressed = compressed != 0;
+
+    for(quint32 i=0;i<blockCount && stream.status() == QDataStream::Ok;i++) {
+        Block block;
+        quint32 count;
+        stream >> count;
+        block.rows = count;
+        for(quint32 c=0;c<columns;c++) {
+            qint64 offset;
+            qint64 size;
+            stream >> offset >> size;
+            if (offset < magicSize || size < 0 || offset + size > footerOffset) {
+                error = QString("%1 is corrupted").arg(mFile.fileName());
+                return false;
+            }
+            block.offsets.append(offset);
+            block.sizes.append(size);
+        }
+        mBlocks.append(block);
+    }
+
+    if (stream.status() != QDataStream::Ok || mBlockRows < 1
+            || qint64(mBlocks.size()) * mBlockRows < mRowCount) {
+        error = QString("%1 is corrupted").arg(mFile.fileName());
+        return false;
+    }
+    return true;
+}
+
+QString SnapshotReader::path() const
+{
+    return mFile.fileName();
+}
+
+QSqlRecord SnapshotReader::record() const
+{
+    return mRecord;
+}
+
+int SnapshotReader::rowCount() const
+{
+    return mRowCount;
+}
+
+const QVariantList *SnapshotReader::column(int block, int column) const
+{
+    qint64 key = qint64(block) * mRecord.count() + column;
+    if (QVariantList* values = mCache.object(key)) {
+        return values;
+    }
+
+    const Block& info = mBlocks[block];
+    QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char*>(mData) + info.offsets[column], info.sizes[column]);
+    if (mCompressed) {
+        data = qUncompress(data);
+    }
+    int nullBytes = (info.rows + 7) / 8;
+    QMetaType type = mRecord.field(column).metaType();
+
+    QVariantList* values = new QVariantList();
+    values->reserve(info.rows);
+    qint64 cost = 0;
+    if (data.size() < nullBytes) {
+        for(int r=0;r<info.rows;r++) {
+            values->append(QVariant(type));
+        }
+    } else {
+        QByteArray bytes = QByteArray::fromRawData(data.constData() + nullBytes, data.size() - nullBytes);
+        QDataStream stream(bytes);
+        stream.setVersion(QDataStream::Qt_6_0);
+        for(int r=0;r<info.rows;r++) {
+            if (data[r / 8] & (1 << (r % 8))) {
+                values->append(QVariant(type));
+            } else {
+                QVariant value = ValueCodec::read(stream);
+                cost += ValueCodec::memorySize(value);
+                values->append(value);
+            }
+        }
+    }
+    mCache.insert(key, values, qBound(qint64(1), cost, qint64(mCache.maxCost())));
+    return values;
+}
+
+QVariant SnapshotReader::value(int row, int column) const
+{
+    if (row < 0 || row >= mRowCount || column < 0 || column >= mRecord.count()) {
+        return QVariant();
+    }
+    const QVariantList* values = this->column(row / mBlockRows, column);
+    return values->value(row % mBlockRows);
+}
@@ -0,0 +1,72 @@
+#ifndef RESULTSNAPSHOT_H
+#define RESULTSNAPSHOT_H
+
+#include <QSqlRecord>
+#include <QFile>
+#include <QCache>
+#include <QList>
+
+class QAbstractItemModel;
+class QSqlQueryModel;
+
+// Typed binary snapshot of query result.
+// Layout: header magic, column blocks (null bitmap followed by encoded non-null
+// values, optionally compressed), footer with schema and block index, footer
+// offset and trailing magic.
+
+class ResultSnapshot
+{
+public:
+    static bool save(QAbstractItemModel* model, const QSqlRecord& record, const QString& path, bool compress, QString& error);
+
+    static bool save(QSqlQueryModel* model, const QString& path, bool compress, QString& error);
+
+    // returns model backed by memory mapped snapshot file or nullptr on error
+    static QSqlQueryModel* open(const QString& path, QString& error, QObject* parent = nullptr);
+
+    static QString fileFilter();
+
+    static const int blockRows = 4096;
+};
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(const QString& path);
+    ~SnapshotReader();
+
+    bool open(QString& error);
+
+    QString path() const;
+
+    QSqlRecord record() const;
+
+    int rowCount() const;
+
+    QVariant value(int row, int column) const;
+
+protected:
+
+    struct Block {
+        int rows;
+        QList<qint64> offsets;
+        QList<qint64> sizes;
+    };
+
+    const QVariantList* column(int block, int column) const;
+
+    QFile mFile;
+    uchar* mData;
+    qint64 mSize;
+    QSqlRecord mRecord;
+    int mRowCount;
+    int mBlockRows;
+    bool mCompressed;
+    QList<Block> mBlocks;
+    mutable QCache<qint64, QVariantList> mCache;
+
+private:
+    Q_DISABLE_COPY(SnapshotReader)
+};
+
+#endif // RESULTSNAPSHOT_H
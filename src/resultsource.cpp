@@ -0,0 +1,65 @@
+#include "resultsource.h"
+
+#include <QSqlError>
+#include "resultstore.h"
+
+ResultSource::~ResultSource()
+{
+
+}
+
+QString ResultSource::lastQuery() const
+{
+    return QString();
+}
+
+int ResultSource::numRowsAffected() const
+{
+    return -1;
+}
+
+QString ResultSource::lastError() const
+{
+    return QString();
+}
+
+QueryResultSource::QueryResultSource(QSqlQuery &&query) : mQuery(std::move(query))
+{
+    mRecord = mQuery.record();
+}
+
+QSqlRecord QueryResultSource::record() const
+{
+    return mRecord;
+}
+
+int QueryResultSource::fetch(ResultStore *store, int count)
+{
+    int columns = mRecord.count();
+    int fetched = 0;
+    while (fetched < count && mQuery.next()) {
+        QVariantList row;
+        row.reserve(columns);
+        for(int c=0;c<columns;c++) {
+            row.append(mQuery.value(c));
+        }
+        store->append(row);
+        fetched++;
+    }
+    return fetched;
+}
+
+QString QueryResultSource::lastQuery() const
+{
+    return mQuery.lastQuery();
+}
+
+int QueryResultSource::numRowsAffected() const
+{
+    return mQuery.numRowsAffected();
+}
+
+QString QueryResultSource::lastError() const
+{
+    return mQuery.lastError().isValid() ? mQuery.lastError().text() : QString();
+}
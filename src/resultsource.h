@@ -0,0 +1,46 @@
+#ifndef RESULTSOURCE_H
+#define RESULTSOURCE_H
+
+#include <QSqlRecord>
+#include <QSqlQuery>
+class ResultStore;
+
+// Producer of result rows for ResultStore
+
+class ResultSource
+{
+public:
+    virtual ~ResultSource();
+
+    virtual QSqlRecord record() const = 0;
+
+    // appends at most count rows to store, returns number of appended rows, 0 when exhausted
+    virtual int fetch(ResultStore* store, int count) = 0;
+
+    virtual QString lastQuery() const;
+
+    virtual int numRowsAffected() const;
+
+    // error that ended fetch early, empty if source is exhausted normally
+    virtual QString lastError() const;
+};
+
+// Reads rows from executed forward only query
+
+class QueryResultSource : public ResultSource
+{
+public:
+    QueryResultSource(QSqlQuery&& query);
+
+    QSqlRecord record() const override;
+    int fetch(ResultStore* store, int count) override;
+    QString lastQuery() const override;
+    int numRowsAffected() const override;
+    QString lastError() const override;
+
+protected:
+    QSqlQuery mQuery;
+    QSqlRecord mRecord;
+};
+
+#endif // RESULTSOURCE_H
@@ -0,0 +1,201 @@
+#include "resultstore.h"
+
+#include <QTemporaryFile>
+#include <QDataStream>
+#include <QDir>
+#include <QDebug>
+#include "valuecodec.h"
+
+namespace {
+
+qint64 rowBytes(const QVariantList& row) {
+    qint64 res = sizeof(QVariantList);
+    for(const QVariant& value: row) {
+        res += ValueCodec::memorySize(value);
+    }
+    return res;
+}
+
+}
+
+ResultStore::ResultStore(const QSqlRecord &record, qint64 spillThreshold)
+    : mRecord(record), mSpillThreshold(spillThreshold), mRowCount(0), mFirstInMemory(0),
+      mMemoryBytes(0), mSpilledBytes(0), mTotalBytes(0), mFile(nullptr), mLargeIndex(-1)
+{
+    mCache.setMaxCost(qMax(spillThreshold / 4, qint64(16 * 1024 * 1024)));
+}
+
+ResultStore::~ResultStore()
+{
+    for(const ChunkInfo& info: std::as_const(mChunks)) {
+        delete info.chunk;
+    }
+    delete mFile;
+}
+
+QSqlRecord ResultStore::record() const
+{
+    return mRecord;
+}
+
+int ResultStore::rowCount() const
+{
+    return mRowCount;
+}
+
+int ResultStore::columnCount() const
+{
+    return mRecord.count();
+}
+
+void ResultStore::append(const QVariantList &row)
+{
+    if (mChunks.isEmpty() || mChunks.last().chunk->rows.size() >= chunkRows) {
+        ChunkInfo info;
+        info.chunk = new Chunk();
+        info.chunk->rows.reserve(chunkRows);
+        mChunks.append(info);
+    }
+    Chunk* chunk = mChunks.last().chunk;
+    qint64 bytes = rowBytes(row);
+    chunk->rows.append(row);
+    chunk->bytes += bytes;
+    mMemoryBytes += bytes;
+    mTotalBytes += bytes;
+    mRowCount++;
+
+    // last chunk is never spilled
+    while (mSpillThreshold > 0 && mMemoryBytes > mSpillThreshold && mFirstInMemory < mChunks.size() - 1) {
+        spill(mFirstInMemory);
+        mFirstInMemory++;
+    }
+}
+
+void ResultStore::spill(int index)
+{
+    ChunkInfo& info = mChunks[index];
+
+    if (!mFile) {
+        mFile = new QTemporaryFile(QDir(QDir::tempPath()).filePath("mugi-query-XXXXXX.bin"));
+        if (!mFile->open()) {
+            qDebug() << "ResultStore: can not open" << mFile->fileName() << mFile->errorString();
+            delete mFile;
+            mFile = nullptr;
+            mSpillThreshold = 0;
+            return;
+        }
+    }
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << quint32(info.chunk->rows.size());
+    for(const QVariantList& row: std::as_const(info.chunk->rows)) {
+        for(const QVariant& value: row) {
+            ValueCodec::write(stream, value);
+        }
+    }
+
+    qint64 offset = mFile->size();
+    if (!mFile->seek(offset) || mFile->write(data) != data.size() || !mFile->flush()) {
+        qDebug() << "ResultStore: can not write" << mFile->fileName() << mFile->errorString();
+        mSpillThreshold = 0;
+        return;
+    }
+
+    info.offset = offset;
+    info.size = data.size();
+    info.bytes = info.chunk->bytes;
+    mMemoryBytes -= info.chunk->bytes;
+    mSpilledBytes += data.size();
+    delete info.chunk;
+    info.chunk = nullptr;
+}
+
+const ResultStore::Chunk *ResultStore::chunk(int index) const
+{
+    const ChunkInfo& info = mChunks[index];
+    if (info.chunk) {
+        return info.chunk;
+    }
+    if (Chunk* cached = mCache.object(index)) {
+        return cached;
+    }
+    if (mLargeIndex == index) {
+        return mLarge.data();
+    }
+
+    Chunk* chunk = new Chunk();
+    chunk->bytes = info.bytes;
+    uchar* data = mFile->map(info.offset, info.size);
+    if (!data) {
+        qDebug() << "ResultStore: can not map" << mFile->fileName() << mFile->errorString();
+    } else {
+        QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), info.size);
+        QDataStream stream(bytes);
+        stream.setVersion(QDataStream::Qt_6_0);
+        quint32 rows;
+        stream >> rows;
+        int columns = mRecord.count();
+        chunk->rows.reserve(rows);
+        for(quint32 r=0;r<rows;r++) {
+            QVariantList row;
+            row.reserve(columns);
+            for(int c=0;c<columns;c++) {
+                row.append(ValueCodec::read(stream));
+            }
+            chunk->rows.append(row);
+        }
+        mFile->unmap(data);
+    }
+
+    if (chunk->bytes >= mCache.maxCost()) {
+        mLarge.reset(chunk);
+        mLargeIndex = index;
+        return chunk;
+    }
+    mCache.insert(index, chunk, qMax(qint64(1), chunk->bytes));
+    return chunk;
+}
+
+QVariant ResultStore::value(int row, int column) const
+{
+    if (row < 0 || row >= mRowCount || column < 0 || column >= mRecord.count()) {
+        return QVariant();
+    }
+    const Chunk* chunk = this->chunk(row / chunkRows);
+    int index = row % chunkRows;
+    if (index >= chunk->rows.size()) {
+        return QVariant();
+    }
+    return chunk->rows[index].value(column);
+}
+
+QVariantList ResultStore::row(int row) const
+{
+    if (row < 0 || row >= mRowCount) {
+        return QVariantList();
+    }
+    const Chunk* chunk = this->chunk(row / chunkRows);
+    return chunk->rows.value(row % chunkRows);
+}
+
+qint64 ResultStore::memoryBytes() const
+{
+    return mMemoryBytes;
+}
+
+qint64 ResultStore::spilledBytes() const
+{
+    return mSpilledBytes;
+}
+
+qint64 ResultStore::totalBytes() const
+{
+    return mTotalBytes;
+}
+
+bool ResultStore::isSpilled() const
+{
+    return mSpilledBytes > 0;
+}
@@ -0,0 +1,83 @@
+#ifndef RESULTSTORE_H
+#define RESULTSTORE_H
+
+#include <QSqlRecord>
+#include <QVariantList>
+#include <QScopedPointer>
+#include <QCache>
+#include <QList>
+
+class QTemporaryFile;
+
+// Row storage for query results. Rows are appended in chunks, when memory used
+// by chunks exceeds spill threshold older chunks are encoded in compact binary
+// format and written to temporary file. Spilled chunks are mapped and decoded on
+// access, recently used decoded chunks are kept in cache.
+
+class ResultStore
+{
+public:
+    // spillThreshold in bytes, 0 - keep everything in memory
+    ResultStore(const QSqlRecord& record, qint64 spillThreshold);
+    ~ResultStore();
+
+    QSqlRecord record() const;
+
+    int rowCount() const;
+
+    int columnCount() const;
+
+    void append(const QVariantList& row);
+
+    QVariant value(int row, int column) const;
+
+    QVariantList row(int row) const;
+
+    qint64 memoryBytes() const;
+
+    qint64 spilledBytes() const;
+
+    // memory size of all appended rows, spilled included
+    qint64 totalBytes() const;
+
+    bool isSpilled() const;
+
+    static const int chunkRows = 1024;
+
+protected:
+
+    struct Chunk {
+        QList<QVariantList> rows;
+        qint64 bytes = 0;
+    };
+
+    struct ChunkInfo {
+        // nullptr if spilled
+        Chunk* chunk = nullptr;
+        qint64 offset = -1;
+        qint64 size = 0;
+        qint64 bytes = 0;
+    };
+
+    void spill(int index);
+    const Chunk* chunk(int index) const;
+
+    QSqlRecord mRecord;
+    qint64 mSpillThreshold;
+    QList<ChunkInfo> mChunks;
+    int mRowCount;
+    int mFirstInMemory;
+    qint64 mMemoryBytes;
+    qint64 mSpilledBytes;
+    qint64 mTotalBytes;
+    QTemporaryFile* mFile;
+    mutable QCache<int, Chunk> mCache;
+    // decoded chunk that does not fit in cache
+    mutable QScopedPointer<Chunk> mLarge;
+    mutable int mLargeIndex;
+
+private:
+    Q_DISABLE_COPY(ResultStore)
+};
+
+#endif // RESULTSTORE_H
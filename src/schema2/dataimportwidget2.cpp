@@ -224,10 +224,7 @@ void DataImportWidget2::on_openCsv_clicked()
     if (path.isEmpty()) {
         return;
     }
-
-    mAppender->setActive(false);
-    parseCsv(path, mTable->rowCount(), mModel);
-    mAppender->setActive(true);
+    openCsv(path);
 
     /*QTableView* view = new QTableView();
     view->setModel(model);
@@ -237,6 +234,13 @@ void DataImportWidget2::on_openCsv_clicked()
 
 }
 
+void DataImportWidget2::openCsv(const QString &path)
+{
+    mAppender->setActive(false);
+    parseCsv(path, mTable->rowCount(), mModel);
+    mAppender->setActive(true);
+}
+
 void DataImportWidget2::on_alterTable_clicked()
 {
 
@@ -259,7 +263,7 @@ QSqlRecord DataImportWidget2::record(QSqlDatabase db, const QString& tableName,
 
 
 
-void DataImportWidget2::on_execute_clicked()
+int DataImportWidget2::insertRows(QStringList* failedQueries, QStringList* errors)
 {
     // todo check pending schema changes
 
@@ -269,8 +273,6 @@ void DataImportWidget2::on_execute_clicked()
     QSqlDriver* driver = db.driver();
     auto tableName = mTable->tableName();
 
-    QStringList failedQueries;
-    QStringList errors;
     int count = 0;
 
     QProgressDialog dialog(this);
@@ -285,8 +287,8 @@ void DataImportWidget2::on_execute_clicked()
             if (q.exec(query)) {
                 count += 1;
             } else {
-                failedQueries.append(query);
-                errors.append(q.lastError().text());
+                failedQueries->append(query);
+                errors->append(q.lastError().text());
             }
         }
         dialog.setValue(row);
@@ -294,6 +296,14 @@ void DataImportWidget2::on_execute_clicked()
     }
 
     dialog.close();
+    return count;
+}
+
+void DataImportWidget2::on_execute_clicked()
+{
+    QStringList failedQueries;
+    QStringList errors;
+    int count = insertRows(&failedQueries, &errors);
 
     if (errors.size() > 0) {
         QStandardItemModel* errorModel = new QStandardItemModel(errors.size(), 2);
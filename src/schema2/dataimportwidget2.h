@@ -26,6 +26,10 @@ public:
 
     void init(Schema2Data *data, Schema2TableModel* table);
 
+    void openCsv(const QString& path);
+    // returns number of inserted rows
+    int insertRows(QStringList* failedQueries, QStringList* errors);
+
 protected:
     Schema2TableModel* mTable;
     Ui::DataImportWidget2 *ui;
@@ -1,5 +1,6 @@
 #include "schema2changeset.h"
 #include "history.h"
+#include "connectionpool.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -26,7 +27,8 @@ void Schema2ChangeSet::append(const QStringList &queries, const Schema2ChangeSet
 bool Schema2ChangeSet::execute(const QString& connectionName)
 {
     History* history = History::instance();
-    QSqlDatabase db = QSqlDatabase::database(connectionName);
+    ConnectionLease lease(connectionName);
+    QSqlDatabase db = lease.isValid() ? lease.database() : QSqlDatabase::database(connectionName);
     bool ok = true;
     for(int row=0;row<mItems.size();row++) {
         QSqlQuery q(db);
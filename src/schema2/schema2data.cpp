@@ -2,6 +2,7 @@
 #include <QSqlDatabase>
 
 #include "drivernames.h"
+#include "connectionpool.h"
 #include <QSqlQuery>
 #include "schema2tablemodel.h"
 #include <QSqlRecord>
@@ -17,6 +18,7 @@
 #include "datautils.h"
 #include "schema2store.h"
 #include "reporterror.h"
+#include "trace.h"
 #include "schema2arrange.h"
 #include <QSortFilterProxyModel>
 #include "checkablestringlistmodel.h"
@@ -205,7 +207,7 @@ void Schema2Data::tablePulled(const QString& tableName, Status status) {
 
 void Schema2Data::pullTablesMysql() {
 
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDatabase db = database();
 
     QStringList tables = db.tables();
 
@@ -253,7 +255,7 @@ void Schema2Data::pullTablesMysql() {
 
 void Schema2Data::pullTablesOdbcAccess(const OdbcUri& uri) {
 
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDatabase db = database();
 
     QStringList tables = db.tables();
 
@@ -330,7 +332,7 @@ void Schema2Data::pullTablesOdbcAccess(const OdbcUri& uri) {
 
 void Schema2Data::pullTablesOther() {
 
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDatabase db = database();
 
     QStringList tables = db.tables();
 
@@ -368,7 +370,8 @@ void Schema2Data::pullTablesOther() {
 }
 
 void Schema2Data::pullTables() {
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    TRACE_SCOPE("Schema2Data::pullTables");
+    QSqlDatabase db = database();
     OdbcUri uri(db.databaseName());
     if (db.driverName() == DRIVER_MYSQL || db.driverName() == DRIVER_MARIADB) {
         pullTablesMysql();
@@ -418,7 +421,7 @@ static int indexOf(const QList<SRelation>& relations, const QString& name, const
 
 void Schema2Data::pullRelationsMysql() {
 
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDatabase db = database();
 
     QStringList tables = db.tables();
 
@@ -525,7 +528,7 @@ void Schema2Data::indexPulled(const QString indexName, const QString& tableName,
 
 void Schema2Data::pullIndexesOdbcAccess(const OdbcUri& uri) {
 
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDatabase db = database();
 
     QString filePath = unquoted(uri.dbq());
 
@@ -614,7 +617,7 @@ void Schema2Data::relationPulled(const QString& constraintName, const QString& c
 #endif
 
 void Schema2Data::pullRelationsOdbcAccess(const OdbcUri& uri) {
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDatabase db = database();
 
     QString filePath = unquoted(uri.dbq());
     if (filePath.isEmpty()) {
@@ -661,7 +664,8 @@ void Schema2Data::pullRelationsOdbcAccess(const OdbcUri& uri) {
 }
 
 void Schema2Data::pullRelations() {
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    TRACE_SCOPE("Schema2Data::pullRelations");
+    QSqlDatabase db = database();
     OdbcUri uri(db.databaseName());
     if (db.driverName() == DRIVER_MYSQL || db.driverName() == DRIVER_MARIADB) {
         pullRelationsMysql();
@@ -699,7 +703,7 @@ int indexOf(const QList<MysqlIndex>& indexes, const QString& tableName, const QS
 
 void Schema2Data::pullIndexesMysql() {
 
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDatabase db = database();
     QSqlQuery q(db);
     q.prepare("SELECT TABLE_NAME, NON_UNIQUE, INDEX_NAME, COLUMN_NAME "
               "FROM INFORMATION_SCHEMA.STATISTICS WHERE TABLE_SCHEMA=? "
@@ -743,7 +747,8 @@ void Schema2Data::pullIndexesMysql() {
 }
 
 void Schema2Data::pullIndexes() {
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    TRACE_SCOPE("Schema2Data::pullIndexes");
+    QSqlDatabase db = database();
     OdbcUri uri(db.databaseName());
     if (db.driverName() == DRIVER_MYSQL || db.driverName() == DRIVER_MARIADB) {
         pullIndexesMysql();
@@ -756,12 +761,25 @@ void Schema2Data::pullIndexes() {
 
 void Schema2Data::pull()
 {
+    TRACE_SCOPE("Schema2Data::pull");
+    // own connection, so pull is not affected by session state (open transaction, pending results)
+    ConnectionLease lease(mConnectionName);
+    mLease = &lease;
     pullTables();
     pullIndexes();
     pullRelations();
+    mLease = nullptr;
     mTables->setTableItemsPos();
 }
 
+QSqlDatabase Schema2Data::database() const
+{
+    if (mLease && mLease->isValid()) {
+        return mLease->database();
+    }
+    return QSqlDatabase::database(mConnectionName);
+}
+
 
 
 void Schema2Data::push(QWidget* widget)
@@ -1407,7 +1425,7 @@ void Schema2Data::showAlterView(const QString &tableName)
 
 #include "dataimportwidget2.h"
 
-void Schema2Data::showDataImportWidget(const QString &tableName)
+DataImportWidget2* Schema2Data::showDataImportWidget(const QString &tableName)
 {
     if (!mDataImportWidgets.contains(tableName)) {
         DataImportWidget2* widget = new DataImportWidget2();
@@ -1416,6 +1434,7 @@ void Schema2Data::showDataImportWidget(const QString &tableName)
     }
     auto* widget = mDataImportWidgets.get(tableName);
     showAndRaise(widget);
+    return widget;
 }
 
 void Schema2Data::arrange(bool all)
@@ -1453,7 +1472,7 @@ void Schema2Data::onSelectModelChanged(QModelIndex, QModelIndex) {
 
 Schema2Data::Schema2Data(const QString &connectionName, QObject *parent)
     : mConnectionName(connectionName), mScene(new QGraphicsScene),
-      mView(nullptr), /*mSelectModel(new CheckableStringListModel({}, this)),*/
+      mView(nullptr), mLease(nullptr), /*mSelectModel(new CheckableStringListModel({}, this)),*/
       mSelectProxyModel(new QSortFilterProxyModel(this)), mTables(new Schema2TablesModel(connectionName, mScene, this)),
       QObject{parent}
 {
@@ -23,6 +23,8 @@ class Schema2TablesModel;
 class QSqlDriver;
 class DataImportWidget2;
 class OdbcUri;
+class ConnectionLease;
+class QSqlDatabase;
 
 #include "schema2join.h"
 #include "hash.h"
@@ -61,7 +63,7 @@ public:
 
     void showAlterView(const QString& tableName);
 
-    void showDataImportWidget(const QString &tableName);
+    DataImportWidget2* showDataImportWidget(const QString &tableName);
 
     void arrange(bool all);
 
@@ -115,6 +117,9 @@ public:
 protected:
     Schema2Data(const QString& connectionName, QObject *parent = nullptr);
 
+    // connection leased for pull or named connection
+    QSqlDatabase database() const;
+
     QString mConnectionName;
 
     QGraphicsScene* mScene;
@@ -123,6 +128,8 @@ protected:
 
     Schema2View* mView;
 
+    ConnectionLease* mLease;
+
     Schema2TablesModel* mTables;
 
     //QHash<QString, Schema2TableView*> mViews;
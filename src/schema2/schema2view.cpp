@@ -20,6 +20,11 @@
 #include "style.h"
 #include "stylewidget.h"
 #include <QAction>
+#include <QProgressDialog>
+#include <QThread>
+#include "schema2indexesmodel.h"
+#include "schema2index.h"
+#include "datagenerator.h"
 
 Schema2View::Schema2View(QWidget *parent) :
     mData(0),
@@ -93,6 +98,10 @@ Schema2View::Schema2View(QWidget *parent) :
         mData->tables()->setChecked(related, true);
     });
 
+    QAction* generateData = new QAction("Generate data", this);
+    ui->filterView->addAction(generateData);
+    connect(generateData, SIGNAL(triggered()), this, SLOT(onGenerateData()));
+
     ui->style->addItems({"pumpkin", "bubblegum"});
 }
 
@@ -362,3 +371,62 @@ void Schema2View::on_style_currentTextChanged(const QString &value)
     updateView();
 }
 
+void Schema2View::onGenerateData()
+{
+    Schema2TablesModel* tablesModel = mData->tables();
+    QStringList names = tablesModel->checked(true);
+    if (names.isEmpty()) {
+        names = tablesModel->tableNames();
+    }
+    bool ok;
+    int rows = QInputDialog::getInt(this, "Generate data",
+                                    QString("Rows to append to each of %1 tables").arg(names.size()),
+                                    100000, 1, INT_MAX, 1, &ok);
+    if (!ok) {
+        return;
+    }
+
+    QList<DataGenerator::Table> tables;
+    QList<SRelation> relations;
+    for(const QString& name: std::as_const(names)) {
+        Schema2TableModel* table = tablesModel->table(name);
+        DataGenerator::Table item;
+        item.table.name = table->tableName();
+        for(int row=0;row<table->rowCount();row++) {
+            item.table.columns.append(table->at(row));
+        }
+        for(Schema2Index* index: table->indexes()->values()) {
+            if (index->primary() || index->unique()) {
+                item.unique.append(index->columns());
+            }
+        }
+        item.rows = rows;
+        tables.append(item);
+        for(Schema2Relation* relation: table->relations()->values()) {
+            relations.append(SRelation(relation->name(), table->tableName(), relation->childColumns(),
+                                       relation->parentTable(), relation->parentColumns()));
+        }
+    }
+
+    DataGenerator* generator = new DataGenerator(mData->connectionName(), this);
+    QProgressDialog* progress = new QProgressDialog("Generating data", "Cancel", 0, 1000, this);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setMinimumDuration(0);
+    connect(progress, &QProgressDialog::canceled, generator, &DataGenerator::cancel);
+    connect(generator, &DataGenerator::tableFinished, progress, [=](QString table){
+        progress->setLabelText(QString("%1 done").arg(table));
+    });
+    connect(generator, &DataGenerator::progress, progress, [=](qint64 done){
+        // enum and set columns may limit rows
+        progress->setValue(int(done * 1000 / qMax<qint64>(generator->totalRows(), 1)));
+    });
+    connect(generator, &DataGenerator::finished, this, [=](){
+        progress->close();
+        QStringList errors = generator->errors();
+        if (!errors.isEmpty()) {
+            QMessageBox::critical(this, "Error", errors.join("\n"));
+        }
+        generator->deleteLater();
+    });
+    generator->start(tables, relations, QThread::idealThreadCount());
+}
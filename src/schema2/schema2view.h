@@ -60,6 +60,7 @@ protected slots:
     void onArrange();
     void onScript();
     void onSave();
+    void onGenerateData();
 
     void onPull();
     void onPush();
@@ -0,0 +1,500 @@
+#include "scriptrunner.h"
+
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QFile>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlDriver>
+#include <QDebug>
+#include <cstring>
+
+#include "connectionpool.h"
+#include "sqllexer.h"
+#include "drivernames.h"
+#include "gzipfile.h"
+#include "trace.h"
+
+struct ScriptRunner::State {
+    QString connectionName;
+    QString path;
+    // utf-8 script when not running file
+    QByteArray text;
+    Position from;
+    qint64 to = -1;
+    int batchSize = 1000;
+    bool stopOnError = true;
+    QStringList init;
+    bool deferIndexes = false;
+    QAtomicInt cancelled;
+    QMutex mutex;
+    ScriptRunner* owner = nullptr;
+};
+
+namespace {
+
+// statement shown in error, inserts from dumps are megabytes long
+const int maxStatement = 10000;
+
+// end of block at line end after pos + size, lexer state is carried between lines only
+qint64 blockEnd(const char* data, qint64 size, qint64 pos, qint64 blockSize) {
+    qint64 end = qMin(size, pos + blockSize);
+    if (end == size) {
+        return end;
+    }
+    for(qint64 i=end;i>pos;i--) {
+        if (data[i - 1] == '\n') {
+            return i;
+        }
+    }
+    const void* newline = memchr(data + end, '\n', size_t(size - end));
+    return newline ? static_cast<const char*>(newline) - data + 1 : size;
+}
+
+bool isCreateIndex(const QString& statement) {
+    QList<SqlLexer::Token> tokens = SqlLexer::codeTokens(statement);
+    auto isWord = [&](int i, const char* word) {
+        return i < tokens.size() && tokens[i].type == SqlLexer::Word
+                && QStringView(statement).mid(tokens[i].pos, tokens[i].size).compare(QLatin1String(word), Qt::CaseInsensitive) == 0;
+    };
+    return isWord(0, "create") && (isWord(1, "index") || (isWord(1, "unique") && isWord(2, "index")));
+}
+
+// statements executed in batch transaction, others (DDL, SET, LOCK) may commit implicitly
+// (mysql) so batch is committed before them and they run on their own
+bool isDml(const QString& statement) {
+    QList<SqlLexer::Token> tokens = SqlLexer::codeTokens(statement);
+    if (tokens.isEmpty() || tokens[0].type != SqlLexer::Word) {
+        return false;
+    }
+    static const QStringList words = {"insert", "update", "delete", "replace", "select"};
+    QString word = statement.mid(tokens[0].pos, tokens[0].size).toLower();
+    return words.contains(word);
+}
+
+bool replay(QSqlDatabase& db, QSqlQuery& q, const QList<SqlSplitter::Statement>& statements) {
+    db.transaction();
+    for(const SqlSplitter::Statement& statement: statements) {
+        if (!q.exec(statement.text)) {
+            db.rollback();
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+}
+
+ScriptRunner::ScriptRunner(const QString &connectionName, QObject *parent)
+    : QObject{parent}, mState(new State()), mConnectionName(connectionName), mBatchSize(1000),
+      mStopOnError(true), mDeferIndexes(false), mTotalBytes(0), mBytes(0), mStatements(0), mErrors(0), mElapsed(0),
+      mFinished(false), mFailed(false)
+{
+
+}
+
+ScriptRunner::~ScriptRunner()
+{
+    mState->cancelled.storeRelease(1);
+    QMutexLocker locker(&mState->mutex);
+    mState->owner = nullptr;
+}
+
+void ScriptRunner::setBatchSize(int statements)
+{
+    mBatchSize = qMax(1, statements);
+}
+
+void ScriptRunner::setStopOnError(bool value)
+{
+    mStopOnError = value;
+}
+
+void ScriptRunner::setInitStatements(const QStringList &statements)
+{
+    mInitStatements = statements;
+}
+
+void ScriptRunner::setDeferIndexes(bool value)
+{
+    mDeferIndexes = value;
+}
+
+void ScriptRunner::startFile(const QString &path, const Position &from, qint64 to)
+{
+    QSharedPointer<State> state(new State());
+    state->path = path;
+    mTotalBytes = GzipFile::isGzip(path) ? GzipFile::uncompressedSize(path) : QFile(path).size();
+    if (to >= 0 && to < mTotalBytes) {
+        mTotalBytes = to;
+    }
+    start(state, from, to);
+}
+
+void ScriptRunner::startText(const QString &text, const Position &from)
+{
+    QSharedPointer<State> state(new State());
+    state->text = text.toUtf8();
+    mTotalBytes = state->text.size();
+    start(state, from, -1);
+}
+
+void ScriptRunner::start(QSharedPointer<State> state, const Position &from, qint64 to)
+{
+    {
+        QMutexLocker locker(&mState->mutex);
+        mState->owner = nullptr;
+    }
+    mState = state;
+    mState->connectionName = mConnectionName;
+    mState->from = from;
+    mState->to = to;
+    mState->batchSize = mBatchSize;
+    mState->stopOnError = mStopOnError;
+    mState->init = mInitStatements;
+    mState->deferIndexes = mDeferIndexes;
+    mState->owner = this;
+    mBytes = from.offset;
+    mStatements = 0;
+    mErrors = 0;
+    mFinished = false;
+    mFailed = false;
+    mResume = from;
+    mSkip = from;
+    mLastError.clear();
+    mFailedStatement.clear();
+    mTime.start();
+    ConnectionPool::startWorker([state](){
+        run(state);
+    });
+}
+
+void ScriptRunner::run(QSharedPointer<State> state)
+{
+    TRACE_SCOPE("ScriptRunner::run");
+    Position position = state->from;
+    qint64 count = 0;
+    qint64 errors = 0;
+    bool failed = false;
+
+    auto postProgress = [&]() {
+        QMutexLocker locker(&state->mutex);
+        if (state->owner) {
+            QMetaObject::invokeMethod(state->owner, "onProgress", Qt::QueuedConnection,
+                                      Q_ARG(qint64, position.offset), Q_ARG(qint64, count), Q_ARG(qint64, errors));
+        }
+    };
+    auto postError = [&](const QString& statement, const QString& error, const Position& begin, qint64 end) {
+        QMutexLocker locker(&state->mutex);
+        if (state->owner) {
+            QMetaObject::invokeMethod(state->owner, "onError", Qt::QueuedConnection,
+                                      Q_ARG(QString, statement.left(maxStatement)), Q_ARG(QString, error),
+                                      Q_ARG(qint64, begin.offset), Q_ARG(qint64, end), Q_ARG(QString, begin.delimiter));
+        }
+    };
+
+    {
+        ConnectionLease lease(state->connectionName);
+        QFile file(state->path);
+        uchar* mapped = nullptr;
+        const char* data = state->text.constData();
+        qint64 size = state->text.size();
+        // gzip members are uncompressed into state->text as script is executed, windowBegin is offset of its first byte
+        GzipReader reader(state->path);
+        bool gzip = false;
+        qint64 windowBegin = 0;
+        if (!lease.isValid()) {
+            postError(QString(), lease.error(), position, position.offset);
+            failed = true;
+        } else if (!state->path.isEmpty() && GzipFile::isGzip(state->path)) {
+            gzip = true;
+            size = GzipFile::uncompressedSize(state->path);
+            if (reader.open()) {
+                // members before resume position are not uncompressed
+                qint64 skipped;
+                while ((skipped = reader.skip(position.offset - windowBegin)) >= 0) {
+                    windowBegin += skipped;
+                }
+            }
+            if (size < 0 || !reader.errorString().isEmpty()) {
+                postError(QString(), reader.errorString().isEmpty() ? QString("%1 is not written by GzipFile").arg(state->path)
+                                                                    : reader.errorString(), position, position.offset);
+                failed = true;
+            }
+        } else if (!state->path.isEmpty()) {
+            size = file.size();
+            if (!file.open(QIODevice::ReadOnly) || (size > 0 && !(mapped = file.map(0, size)))) {
+                postError(QString(), file.errorString(), position, position.offset);
+                failed = true;
+            }
+            data = reinterpret_cast<const char*>(mapped);
+        }
+        if (state->to >= 0 && state->to < size) {
+            size = state->to;
+        }
+
+        // keeps members from pos to first line end after block in state->text
+        auto fill = [&](qint64 pos) {
+            state->text.remove(0, qMin(pos - windowBegin, qint64(state->text.size())));
+            windowBegin = pos;
+            auto complete = [&]() {
+                return windowBegin + state->text.size() >= size
+                        || (state->text.size() > blockSize
+                            && memchr(state->text.constData() + blockSize, '\n', size_t(state->text.size() - blockSize)));
+            };
+            while (!complete() && !reader.atEnd()) {
+                state->text.append(reader.read());
+            }
+            if (!reader.errorString().isEmpty() || (state->text.isEmpty() && pos < size)) {
+                postError(QString(), reader.errorString().isEmpty() ? QString("%1 is truncated").arg(state->path)
+                                                                    : reader.errorString(), position, position.offset);
+                return false;
+            }
+            return true;
+        };
+        if (gzip && !failed) {
+            failed = !fill(position.offset);
+            data = state->text.constData();
+        }
+
+        if (!failed) {
+            QSqlDatabase db = lease.database();
+            QSqlQuery q(db);
+            for(const QString& statement: std::as_const(state->init)) {
+                if (!q.exec(statement)) {
+                    qDebug() << statement << q.lastError().text() << __FILE__ << __LINE__;
+                }
+            }
+            if (!state->init.isEmpty()) {
+                // session settings (disabled checks) must not leak to next user of connection
+                lease.discard();
+            }
+            bool transactions = state->batchSize > 1 && db.driver()->hasFeature(QSqlDriver::Transactions);
+            qint64 pos = position.offset;
+            if (pos == 0 && size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+                pos = 3;
+            }
+            SqlSplitter splitter(pos, position.delimiter);
+            splitter.setExecutableComments(db.driverName() == DRIVER_MYSQL || db.driverName() == DRIVER_MARIADB);
+            // executed in current transaction
+            QList<SqlSplitter::Statement> batch;
+            QList<SqlSplitter::Statement> deferred;
+            QElapsedTimer report;
+            report.start();
+            bool stop = false;
+
+            // on failure resumes from first statement of batch
+            auto commit = [&]() {
+                if (db.commit()) {
+                    batch.clear();
+                    return true;
+                }
+                postError(QString(), db.lastError().text(), {batch.first().begin, batch.first().delimiter}, position.offset);
+                position = {batch.first().begin, batch.first().delimiter};
+                failed = true;
+                stop = true;
+                batch.clear();
+                return false;
+            };
+
+            while (!stop && pos < size) {
+                const char* begin;
+                qint64 end;
+                if (gzip) {
+                    if (!fill(pos)) {
+                        failed = true;
+                        break;
+                    }
+                    begin = state->text.constData();
+                    end = windowBegin + blockEnd(begin, qMin(qint64(state->text.size()), size - windowBegin), 0, blockSize);
+                } else {
+                    begin = data + pos;
+                    end = blockEnd(data, size, pos, blockSize);
+                }
+                QString text = QString::fromUtf8(begin, end - pos);
+                pos = end;
+                QList<SqlSplitter::Statement> statements;
+                splitter.append(text, statements);
+                if (pos >= size) {
+                    splitter.finish(statements);
+                }
+                text.clear();
+                for(const SqlSplitter::Statement& statement: std::as_const(statements)) {
+                    if (state->cancelled.loadAcquire()) {
+                        stop = true;
+                        break;
+                    }
+                    if (state->deferIndexes && isCreateIndex(statement.text)) {
+                        deferred.append(statement);
+                        position = {statement.end, statement.delimiter};
+                        continue;
+                    }
+                    bool batched = transactions && isDml(statement.text);
+                    if (!batched && !batch.isEmpty() && !commit()) {
+                        break;
+                    }
+                    if (batched && batch.isEmpty()) {
+                        db.transaction();
+                    }
+                    TRACE_SCOPE("ScriptRunner::exec");
+                    if (q.exec(statement.text)) {
+                        count++;
+                        position = {statement.end, statement.delimiter};
+                        if (batched) {
+                            batch.append(statement);
+                            if (batch.size() >= state->batchSize && !commit()) {
+                                break;
+                            }
+                        }
+                    } else {
+                        errors++;
+                        QString error = q.lastError().text();
+                        if (batched) {
+                            db.rollback();
+                            // statements before failed one were rolled back with it
+                            if (!batch.isEmpty() && !replay(db, q, batch)) {
+                                Position first = {batch.first().begin, batch.first().delimiter};
+                                postError(statement.text, error + "\nStatements before it failed after rollback",
+                                          first, statement.begin);
+                                position = first;
+                                failed = true;
+                                stop = true;
+                                batch.clear();
+                                break;
+                            }
+                            batch.clear();
+                        }
+                        postError(statement.text, error, {statement.begin, statement.delimiter}, statement.end);
+                        if (state->stopOnError) {
+                            position = {statement.begin, statement.delimiter};
+                            failed = true;
+                            stop = true;
+                            break;
+                        }
+                        position = {statement.end, statement.delimiter};
+                    }
+                    if (report.elapsed() >= progressMs) {
+                        postProgress();
+                        report.restart();
+                    }
+                }
+            }
+            if (!batch.isEmpty()) {
+                commit();
+            }
+            if (!stop && !failed) {
+                position = {size, splitter.delimiter()};
+            }
+            // executed even when stopped, except ones after resume position (rolled back batch)
+            for(const SqlSplitter::Statement& statement: std::as_const(deferred)) {
+                if (statement.begin >= position.offset) {
+                    break;
+                }
+                TRACE_SCOPE("ScriptRunner::exec");
+                if (q.exec(statement.text)) {
+                    count++;
+                } else {
+                    errors++;
+                    postError(statement.text, q.lastError().text(), {statement.begin, statement.delimiter}, statement.end);
+                    failed = failed || state->stopOnError;
+                }
+            }
+        }
+        if (mapped) {
+            file.unmap(mapped);
+        }
+    }
+
+    postProgress();
+    QMutexLocker locker(&state->mutex);
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onFinished", Qt::QueuedConnection,
+                                  Q_ARG(qint64, position.offset), Q_ARG(QString, position.delimiter), Q_ARG(bool, failed));
+    }
+}
+
+void ScriptRunner::onProgress(qint64 bytes, qint64 statements, qint64 errors)
+{
+    mBytes = bytes;
+    mStatements = statements;
+    mErrors = errors;
+    emit progress();
+}
+
+void ScriptRunner::onError(QString statement, QString error, qint64 begin, qint64 end, QString delimiter)
+{
+    mFailedStatement = statement;
+    mLastError = error;
+    mResume = {begin, delimiter};
+    mSkip = {end, delimiter};
+    emit this->error(statement, error);
+}
+
+void ScriptRunner::onFinished(qint64 offset, QString delimiter, bool failed)
+{
+    mResume = {offset, delimiter};
+    mFailed = failed;
+    mFinished = true;
+    mElapsed = mTime.elapsed();
+    emit finished();
+}
+
+void ScriptRunner::cancel()
+{
+    mState->cancelled.storeRelease(1);
+}
+
+bool ScriptRunner::isFinished() const
+{
+    return mFinished;
+}
+
+bool ScriptRunner::isFailed() const
+{
+    return mFailed;
+}
+
+qint64 ScriptRunner::totalBytes() const
+{
+    return mTotalBytes;
+}
+
+qint64 ScriptRunner::bytes() const
+{
+    return mBytes;
+}
+
+qint64 ScriptRunner::statements() const
+{
+    return mStatements;
+}
+
+qint64 ScriptRunner::errors() const
+{
+    return mErrors;
+}
+
+double ScriptRunner::seconds() const
+{
+    return (mFinished ? mElapsed : mTime.elapsed()) / 1000.0;
+}
+
+ScriptRunner::Position ScriptRunner::resumePosition() const
+{
+    return mResume;
+}
+
+ScriptRunner::Position ScriptRunner::skipPosition() const
+{
+    return mSkip;
+}
+
+QString ScriptRunner::lastError() const
+{
+    return mLastError;
+}
+
+QString ScriptRunner::failedStatement() const
+{
+    return mFailedStatement;
+}
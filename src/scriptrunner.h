@@ -0,0 +1,103 @@
+#ifndef SCRIPTRUNNER_H
+#define SCRIPTRUNNER_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <QStringList>
+
+// Executes sql script on connection leased from ConnectionPool in worker thread. File is
+// memory mapped and split into statements by SqlSplitter block by block, so only current
+// block and statements of current transaction are held in memory. DML statements are committed
+// in batches, other statements (DDL commits implicitly on mysql) end batch and run on their own.
+// When statement fails batch is rolled back and statements before failed one are executed
+// again, so position after last committed statement is always consistent and script can be
+// resumed from failed statement or after it. Files written by GzipFile are decompressed
+// member by member as blocks are split, offsets are offsets in decompressed script.
+
+class ScriptRunner : public QObject
+{
+    Q_OBJECT
+public:
+    // utf-8 byte offset of statement and delimiter in effect at it
+    struct Position {
+        qint64 offset = 0;
+        QString delimiter = ";";
+    };
+
+    ScriptRunner(const QString& connectionName, QObject* parent = nullptr);
+    ~ScriptRunner();
+
+    void setBatchSize(int statements);
+    void setStopOnError(bool value);
+    // executed on leased connection before script, failures are ignored
+    // (session settings that need privileges), connection is closed after script
+    void setInitStatements(const QStringList& statements);
+    // CREATE INDEX statements are executed when script ends (or stops), so index is
+    // built once after data is loaded
+    void setDeferIndexes(bool value);
+
+    // executes statements between from and to (byte offset, -1 - end of file)
+    void startFile(const QString& path, const Position& from = Position(), qint64 to = -1);
+    void startText(const QString& text, const Position& from = Position());
+
+    // stops after current statement, executed statements are committed
+    void cancel();
+
+    bool isFinished() const;
+    bool isFailed() const;
+
+    qint64 totalBytes() const;
+    // bytes of executed statements
+    qint64 bytes() const;
+    qint64 statements() const;
+    qint64 errors() const;
+    double seconds() const;
+
+    // first statement not executed, failed statement if stopped on error
+    Position resumePosition() const;
+    // statement after failed one
+    Position skipPosition() const;
+
+    QString lastError() const;
+    QString failedStatement() const;
+
+    static const int blockSize = 4 * 1024 * 1024;
+    static const int progressMs = 100;
+
+signals:
+    void progress();
+    void error(QString statement, QString error);
+    void finished();
+
+protected slots:
+    void onProgress(qint64 bytes, qint64 statements, qint64 errors);
+    void onError(QString statement, QString error, qint64 begin, qint64 end, QString delimiter);
+    void onFinished(qint64 offset, QString delimiter, bool failed);
+
+protected:
+    struct State;
+    void start(QSharedPointer<State> state, const Position& from, qint64 to);
+    static void run(QSharedPointer<State> state);
+
+    QSharedPointer<State> mState;
+    QString mConnectionName;
+    int mBatchSize;
+    bool mStopOnError;
+    QStringList mInitStatements;
+    bool mDeferIndexes;
+    qint64 mTotalBytes;
+    qint64 mBytes;
+    qint64 mStatements;
+    qint64 mErrors;
+    QElapsedTimer mTime;
+    qint64 mElapsed;
+    bool mFinished;
+    bool mFailed;
+    Position mResume;
+    Position mSkip;
+    QString mLastError;
+    QString mFailedStatement;
+};
+
+#endif // SCRIPTRUNNER_H
@@ -11,7 +11,7 @@ Settings* Settings::mInstance = 0;
 #include <QJsonObject>
 #include <QDebug>
 
-Settings::Settings()
+Settings::Settings() : mRevision(0)
 {
     QString appData = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     QString name = qApp->applicationName();
@@ -65,6 +65,12 @@ void Settings::save()
     obj["MysqlPath"] = mMysqlPath;
     obj["MysqldumpPath"] = mMysqldumpPath;
     obj["HomePath"] = mHomePath;
+    obj["LargeValuePrefix"] = mLargeValuePrefix;
+    obj["LargeValueCacheSize"] = mLargeValueCacheSize;
+    obj["ResultSpillThreshold"] = mResultSpillThreshold;
+    obj["SnapshotCompress"] = mSnapshotCompress;
+    obj["NativeResults"] = mNativeResults;
+    obj["ConnectTimeout"] = mConnectTimeout;
     saveJson(settingsPath(),obj);
 }
 
@@ -80,6 +86,12 @@ void loadValue(const QJsonObject& obj, const QString& name, QString* v) {
     }
 }
 
+void loadValue(const QJsonObject& obj, const QString& name, int* v) {
+    if (obj.contains(name)) {
+        *v = obj[name].toInt();
+    }
+}
+
 void Settings::load()
 {
     mSavePasswords = false;
@@ -91,6 +103,12 @@ void Settings::load()
     mRealUseLocale = false;
     mRealOverrideForCopy = false;
     mRealOverrideForCsv = false;
+    mLargeValuePrefix = 0;
+    mLargeValueCacheSize = 64;
+    mResultSpillThreshold = 512;
+    mSnapshotCompress = false;
+    mNativeResults = true;
+    mConnectTimeout = 15;
 
     mHomePath = QDir(QStandardPaths::writableLocation(QStandardPaths::HomeLocation)).filePath("mugi-query");
 
@@ -114,7 +132,14 @@ void Settings::load()
     loadValue(obj,"MysqlPath",&mMysqlPath);
     loadValue(obj,"MysqldumpPath",&mMysqldumpPath);
     loadValue(obj,"HomePath", &mHomePath);
+    loadValue(obj,"LargeValuePrefix",&mLargeValuePrefix);
+    loadValue(obj,"LargeValueCacheSize",&mLargeValueCacheSize);
+    loadValue(obj,"ResultSpillThreshold",&mResultSpillThreshold);
+    loadValue(obj,"SnapshotCompress",&mSnapshotCompress);
+    loadValue(obj,"NativeResults",&mNativeResults);
+    loadValue(obj,"ConnectTimeout",&mConnectTimeout);
     mHomePath = QDir::toNativeSeparators(mHomePath);
+    mRevision++;
 }
 
 /************************* GETTERS **************************/
@@ -151,27 +176,35 @@ void Settings::setSavePasswords(bool value) {
 }
 void Settings::setDateTimeOverrideForCsv(bool value) {
     mDateTimeOverrideForCsv = value;
+    mRevision++;
 }
 void Settings::setDateTimeOverrideForCopy(bool value) {
     mDateTimeOverrideForCopy = value;
+    mRevision++;
 }
 void Settings::setRealOverrideForCopy(bool value) {
     mRealOverrideForCopy = value;
+    mRevision++;
 }
 void Settings::setRealOverrideForCsv(bool value) {
     mRealOverrideForCsv = value;
+    mRevision++;
 }
 void Settings::setRealUseLocale(bool value) {
     mRealUseLocale = value;
+    mRevision++;
 }
 void Settings::setDateFormat(const QString& value) {
     mDateFormat = value;
+    mRevision++;
 }
 void Settings::setTimeFormat(const QString& value) {
     mTimeFormat = value;
+    mRevision++;
 }
 void Settings::setDateTimeUseLocale(bool value) {
     mDateTimeUseLocale = value;
+    mRevision++;
 }
 
 QString Settings::mysqlPath() const
@@ -244,3 +277,68 @@ QString Settings::homePath() const
 {
     return mHomePath;
 }
+
+int Settings::largeValuePrefix() const
+{
+    return mLargeValuePrefix;
+}
+
+void Settings::setLargeValuePrefix(int value)
+{
+    mLargeValuePrefix = value;
+}
+
+int Settings::largeValueCacheSize() const
+{
+    return mLargeValueCacheSize;
+}
+
+void Settings::setLargeValueCacheSize(int value)
+{
+    mLargeValueCacheSize = value;
+}
+
+int Settings::resultSpillThreshold() const
+{
+    return mResultSpillThreshold;
+}
+
+void Settings::setResultSpillThreshold(int value)
+{
+    mResultSpillThreshold = value;
+}
+
+bool Settings::snapshotCompress() const
+{
+    return mSnapshotCompress;
+}
+
+void Settings::setSnapshotCompress(bool value)
+{
+    mSnapshotCompress = value;
+}
+
+bool Settings::nativeResults() const
+{
+    return mNativeResults;
+}
+
+void Settings::setNativeResults(bool value)
+{
+    mNativeResults = value;
+}
+
+int Settings::connectTimeout() const
+{
+    return mConnectTimeout;
+}
+
+void Settings::setConnectTimeout(int value)
+{
+    mConnectTimeout = value;
+}
+
+int Settings::revision() const
+{
+    return mRevision;
+}
@@ -56,6 +56,22 @@ public:
     void setHomePath(const QString& path);
     QString homePath() const;
 
+    int largeValuePrefix() const;
+    void setLargeValuePrefix(int value);
+    int largeValueCacheSize() const;
+    void setLargeValueCacheSize(int value);
+    int resultSpillThreshold() const;
+    void setResultSpillThreshold(int value);
+    bool snapshotCompress() const;
+    void setSnapshotCompress(bool value);
+    bool nativeResults() const;
+    void setNativeResults(bool value);
+    int connectTimeout() const;
+    void setConnectTimeout(int value);
+
+    // incremented on every change of data format settings
+    int revision() const;
+
 private:
 
     Settings();
@@ -74,6 +90,13 @@ private:
     QString mMysqlPath;
     QString mMysqldumpPath;
     QString mHomePath;
+    int mLargeValuePrefix;
+    int mLargeValueCacheSize;
+    int mResultSpillThreshold;
+    bool mSnapshotCompress;
+    bool mNativeResults;
+    int mConnectTimeout;
+    int mRevision;
 
     QString mDir;
 
@@ -14,6 +14,7 @@ QStringList SqlDataTypes::names()
     // \1,
 
     QStringList result = {"INT",
+                          "BIGINT",
                           "DOUBLE",
                           "TEXT",
                           "DATE",
@@ -27,6 +28,7 @@ QMap<QString, QMetaType::Type> SqlDataTypes::mapToVariant()
 {
     QMap<QString,QMetaType::Type> m;
     m["INT"] = QMetaType::Int;
+    m["BIGINT"] = QMetaType::LongLong;
     m["DOUBLE"] = QMetaType::Double;
     m["TEXT"] = QMetaType::QString;
     m["DATE"] = QMetaType::QDate;
@@ -72,9 +74,19 @@ QMap<QMetaType::Type, QString> SqlDataTypes::mapToDriver(const QString &driver)
         m[QMetaType::QDateTime] = "DATETIME";
         m[QMetaType::QString] = "TEXT";
         m[QMetaType::QByteArray] = "BLOB";
+    } else if (driver == DRIVER_PSQL) {
+        m[QMetaType::Int] = "INT";
+        m[QMetaType::LongLong] = "BIGINT";
+        m[QMetaType::Double] = "DOUBLE PRECISION";
+        m[QMetaType::QDate] = "DATE";
+        m[QMetaType::QTime] = "TIME";
+        m[QMetaType::QDateTime] = "TIMESTAMP";
+        m[QMetaType::QString] = "TEXT";
+        m[QMetaType::QByteArray] = "BYTEA";
     } else {
 
         m[QMetaType::Int] = "INT";
+        m[QMetaType::LongLong] = "BIGINT";
         m[QMetaType::Double] = "DOUBLE";
         m[QMetaType::QString] = "TEXT";
         m[QMetaType::QDate] = "DATE";
@@ -89,6 +101,54 @@ QMap<QMetaType::Type, QString> SqlDataTypes::mapToDriver(const QString &driver)
     return m;
 }
 
+QMetaType::Type SqlDataTypes::fromDriverType(const QString &type, int *size, int *scale)
+{
+    QString name = type.trimmed().toLower();
+    static QRegularExpression rx("\\(\\s*(\\d+)\\s*(,\\s*(\\d+)\\s*)?\\)");
+    QRegularExpressionMatch m = rx.match(name);
+    if (size) {
+        *size = m.hasMatch() ? m.captured(1).toInt() : 0;
+    }
+    if (scale) {
+        *scale = m.hasMatch() ? m.captured(3).toInt() : 0;
+    }
+    if (m.hasMatch()) {
+        name = name.left(m.capturedStart()).trimmed();
+    }
+    if (name.startsWith("enum") || name.startsWith("set") || name.startsWith("interval")) {
+        return QMetaType::QString;
+    }
+    if (name == "bool" || name == "boolean" || name == "bit") {
+        return QMetaType::Bool;
+    }
+    if (name.contains("bigint") || name == "int8" || name == "bigserial" || name == "serial8") {
+        return QMetaType::LongLong;
+    }
+    if ((name.contains("int") && !name.contains("point")) || name.contains("serial") || name == "year") {
+        return QMetaType::Int;
+    }
+    if (name.contains("numeric") || name.contains("decimal") || name.contains("real")
+            || name.contains("double") || name.contains("float") || name.contains("money")) {
+        return QMetaType::Double;
+    }
+    if (name.startsWith("timestamp") || name.contains("datetime")) {
+        return QMetaType::QDateTime;
+    }
+    if (name == "date") {
+        return QMetaType::QDate;
+    }
+    if (name.startsWith("time")) {
+        return QMetaType::QTime;
+    }
+    if (name.contains("blob") || name.contains("binary") || name == "bytea" || name == "image") {
+        return QMetaType::QByteArray;
+    }
+    if (name == "uuid" || name == "uniqueidentifier") {
+        return QMetaType::QUuid;
+    }
+    return QMetaType::QString;
+}
+
 QVariant SqlDataTypes::tryConvert(const QVariant& v, QMetaType::Type t,
                                   const QLocale& locale,
                                   int minYear,
@@ -123,6 +183,8 @@ QVariant SqlDataTypes::tryConvert(const QVariant& v, QMetaType::Type t,
 
     if (t == QMetaType::Int) {
         return v.toInt(ok);
+    } else if (t == QMetaType::LongLong) {
+        return v.toLongLong(ok);
     } else if (t == QMetaType::Double) {
 
         bool ok_;
@@ -19,6 +19,10 @@ public:
 
     static QMap<QMetaType::Type, QString> mapToDriver(const QString& driver);
 
+    // type of values for column type as reported by driver (varchar(32), bigint, timestamp with time zone),
+    // size is length or precision if specified, scale is digits after point for numeric types
+    static QMetaType::Type fromDriverType(const QString& type, int* size = nullptr, int* scale = nullptr);
+
     static QVariant tryConvert(const QVariant &v, QMetaType::Type t, const QLocale &locale, int minYear,
                                bool inLocalTime, bool outUtc, bool *ok);
 
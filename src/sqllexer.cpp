@@ -0,0 +1,360 @@
+#include "sqllexer.h"
+
+namespace {
+
+bool isWordStart(QChar c) {
+    return c.isLetter() || c == '_' || c == '@' || c == '$';
+}
+
+bool isWordChar(QChar c) {
+    return c.isLetterOrNumber() || c == '_' || c == '@' || c == '$';
+}
+
+}
+
+bool SqlLexer::State::operator==(const State &other) const
+{
+    return context == other.context && quote == other.quote && depth == other.depth && tag == other.tag
+            && delimiter == other.delimiter && statementStart == other.statementStart;
+}
+
+bool SqlLexer::State::operator!=(const State &other) const
+{
+    return !(*this == other);
+}
+
+size_t qHash(const SqlLexer::State &state, size_t seed)
+{
+    return qHashMulti(seed, int(state.context), state.quote, state.depth, state.tag, state.delimiter,
+                      state.statementStart);
+}
+
+SqlLexer::SqlLexer(QStringView text, State *state) : mText(text), mState(state), mPos(0)
+{
+
+}
+
+QList<SqlLexer::Token> SqlLexer::tokens(QStringView text, State *state)
+{
+    QList<Token> res;
+    SqlLexer lexer(text, state);
+    Token token;
+    while (lexer.next(token)) {
+        res.append(token);
+    }
+    return res;
+}
+
+QList<SqlLexer::Token> SqlLexer::codeTokens(QStringView text)
+{
+    QList<Token> res;
+    State state;
+    SqlLexer lexer(text, &state);
+    Token token;
+    while (lexer.next(token)) {
+        if (token.type != Whitespace && token.type != Comment) {
+            res.append(token);
+        }
+    }
+    return res;
+}
+
+qsizetype SqlLexer::lineEnd(qsizetype pos) const
+{
+    while (pos < mText.size() && mText[pos] != '\n' && mText[pos] != '\r') {
+        pos++;
+    }
+    return pos;
+}
+
+qsizetype SqlLexer::scanString(qsizetype pos, QChar quote, bool escapes)
+{
+    while (pos < mText.size()) {
+        QChar c = mText[pos];
+        if (escapes && c == '\\') {
+            pos += 2;
+            continue;
+        }
+        if (c == quote) {
+            // doubled quote is part of string
+            if (pos + 1 < mText.size() && mText[pos + 1] == quote) {
+                pos += 2;
+                continue;
+            }
+            mState->context = Code;
+            mState->quote = QChar();
+            return pos + 1;
+        }
+        pos++;
+    }
+    mState->quote = quote;
+    return mText.size();
+}
+
+qsizetype SqlLexer::scanComment(qsizetype pos)
+{
+    while (pos < mText.size()) {
+        QChar c = mText[pos];
+        if (c == '*' && pos + 1 < mText.size() && mText[pos + 1] == '/') {
+            pos += 2;
+            if (--mState->depth == 0) {
+                mState->context = Code;
+                return pos;
+            }
+            continue;
+        }
+        if (c == '/' && pos + 1 < mText.size() && mText[pos + 1] == '*') {
+            pos += 2;
+            mState->depth++;
+            continue;
+        }
+        pos++;
+    }
+    mState->context = InComment;
+    return mText.size();
+}
+
+qsizetype SqlLexer::scanDollarString(qsizetype pos)
+{
+    qsizetype end = mText.indexOf(QStringView(mState->tag), pos);
+    if (end < 0) {
+        mState->context = InDollarString;
+        return mText.size();
+    }
+    mState->context = Code;
+    end += mState->tag.size();
+    mState->tag.clear();
+    return end;
+}
+
+bool SqlLexer::next(Token &token)
+{
+    if (mPos >= mText.size()) {
+        return false;
+    }
+    State& state = *mState;
+    qsizetype begin = mPos;
+    auto result = [&](TokenType type) {
+        token = {type, begin, mPos - begin};
+        return true;
+    };
+
+    switch (state.context) {
+    case InString:
+        mPos = scanString(mPos, state.quote, true);
+        return result(String);
+    case InQuotedIdentifier:
+        mPos = scanString(mPos, state.quote, state.quote == '"');
+        return result(QuotedIdentifier);
+    case InComment:
+        mPos = scanComment(mPos);
+        return result(Comment);
+    case InDollarString:
+        mPos = scanDollarString(mPos);
+        return result(String);
+    case Code:
+        break;
+    }
+
+    const qsizetype size = mText.size();
+    QChar c = mText[mPos];
+    QChar c1 = mPos + 1 < size ? mText[mPos + 1] : QChar();
+
+    if (state.statementStart && (c == 'd' || c == 'D') && mPos + 9 < size
+            && mText.mid(mPos, 9).compare(QLatin1String("delimiter"), Qt::CaseInsensitive) == 0
+            && (mText[mPos + 9] == ' ' || mText[mPos + 9] == '\t')) {
+        mPos = lineEnd(mPos);
+        QStringView arg = mText.mid(begin + 9, mPos - begin - 9).trimmed();
+        qsizetype space = 0;
+        while (space < arg.size() && !arg[space].isSpace()) {
+            space++;
+        }
+        if (space > 0) {
+            state.delimiter = arg.left(space).toString();
+        }
+        return result(DelimiterCommand);
+    }
+    if (mText.mid(mPos).startsWith(state.delimiter)) {
+        mPos += state.delimiter.size();
+        state.statementStart = true;
+        return result(Delimiter);
+    }
+    if (c.isSpace()) {
+        while (mPos < size && mText[mPos].isSpace()) {
+            mPos++;
+        }
+        return result(Whitespace);
+    }
+    if (c == '-' && c1 == '-') {
+        mPos = lineEnd(mPos);
+        return result(Comment);
+    }
+    if (c == '/' && c1 == '*') {
+        state.depth = 1;
+        mPos = scanComment(mPos + 2);
+        return result(Comment);
+    }
+
+    state.statementStart = false;
+
+    if (c == '\'') {
+        state.context = InString;
+        mPos = scanString(mPos + 1, c, true);
+        return result(String);
+    }
+    if (c == '"' || c == '`') {
+        state.context = InQuotedIdentifier;
+        mPos = scanString(mPos + 1, c, c == '"');
+        return result(QuotedIdentifier);
+    }
+    if (c == '$') {
+        // $$ or $tag$, $1 is parameter
+        qsizetype end = mPos + 1;
+        if (c1.isLetter() || c1 == '_') {
+            while (end < size && (mText[end].isLetterOrNumber() || mText[end] == '_')) {
+                end++;
+            }
+        }
+        if (end < size && mText[end] == '$') {
+            state.tag = mText.mid(mPos, end + 1 - mPos).toString();
+            mPos = scanDollarString(end + 1);
+            return result(String);
+        }
+    }
+    if (c.isDigit() || (c == '.' && c1.isDigit())) {
+        mPos++;
+        while (mPos < size) {
+            QChar d = mText[mPos];
+            if (d.isLetterOrNumber() || d == '.') {
+                mPos++;
+            } else if ((d == '+' || d == '-') && (mText[mPos - 1] == 'e' || mText[mPos - 1] == 'E')) {
+                mPos++;
+            } else {
+                break;
+            }
+        }
+        return result(Number);
+    }
+    if (isWordStart(c)) {
+        mPos++;
+        while (mPos < size && isWordChar(mText[mPos])) {
+            mPos++;
+        }
+        return result(Word);
+    }
+    mPos++;
+    return result(Operator);
+}
+
+SqlSplitter::SqlSplitter(qint64 offset, const QString &delimiter)
+    : mHasCode(false), mExecutableComments(false), mBegin(offset), mOffset(offset), mDelimiter(delimiter)
+{
+    mState.delimiter = delimiter;
+}
+
+void SqlSplitter::setExecutableComments(bool value)
+{
+    mExecutableComments = value;
+}
+
+void SqlSplitter::append(QStringView text, QList<Statement> &statements)
+{
+    SqlLexer lexer(text, &mState);
+    SqlLexer::Token token;
+    // statement text starts at first code token, offsets are counted up to counted
+    qsizetype start = 0;
+    qsizetype counted = 0;
+    while (lexer.next(token)) {
+        qsizetype end = token.pos + token.size;
+        switch (token.type) {
+        case SqlLexer::Delimiter:
+            if (mHasCode) {
+                mText.append(text.mid(start, token.pos - start));
+            }
+            mOffset += utf8Size(text.mid(counted, end - counted));
+            counted = end;
+            if (mHasCode) {
+                statements.append({mText.trimmed(), mBegin, mOffset, mDelimiter});
+            }
+            mText.clear();
+            mHasCode = false;
+            mBegin = mOffset;
+            mDelimiter = mState.delimiter;
+            start = end;
+            break;
+        case SqlLexer::DelimiterCommand:
+            mText.clear();
+            start = end;
+            break;
+        case SqlLexer::Whitespace:
+        case SqlLexer::Comment:
+            if (!mHasCode && mExecutableComments && token.type == SqlLexer::Comment
+                    && text.mid(token.pos).startsWith(QLatin1String("/*!"))) {
+                mHasCode = true;
+            }
+            if (!mHasCode) {
+                start = end;
+            }
+            break;
+        default:
+            mHasCode = true;
+            break;
+        }
+    }
+    if (mHasCode) {
+        mText.append(text.mid(start));
+    }
+    mOffset += utf8Size(text.mid(counted));
+}
+
+void SqlSplitter::finish(QList<Statement> &statements)
+{
+    if (mHasCode) {
+        statements.append({mText.trimmed(), mBegin, mOffset, mDelimiter});
+    }
+    mText.clear();
+    mHasCode = false;
+    mBegin = mOffset;
+}
+
+qint64 SqlSplitter::offset() const
+{
+    return mOffset;
+}
+
+QString SqlSplitter::delimiter() const
+{
+    return mState.delimiter;
+}
+
+QStringList SqlSplitter::split(const QString &text)
+{
+    SqlSplitter splitter;
+    QList<Statement> statements;
+    splitter.append(text, statements);
+    splitter.finish(statements);
+    QStringList res;
+    for(const Statement& statement: std::as_const(statements)) {
+        res.append(statement.text);
+    }
+    return res;
+}
+
+qint64 SqlSplitter::utf8Size(QStringView text)
+{
+    qint64 size = 0;
+    for(qsizetype i=0;i<text.size();i++) {
+        char16_t c = text[i].unicode();
+        if (c < 0x80) {
+            size += 1;
+        } else if (c < 0x800) {
+            size += 2;
+        } else if (QChar::isHighSurrogate(c) && i + 1 < text.size() && QChar::isLowSurrogate(text[i + 1].unicode())) {
+            size += 4;
+            i++;
+        } else {
+            size += 3;
+        }
+    }
+    return size;
+}
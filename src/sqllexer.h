@@ -0,0 +1,125 @@
+#ifndef SQLLEXER_H
+#define SQLLEXER_H
+
+#include <QString>
+#include <QStringView>
+#include <QList>
+#include <QHashFunctions>
+
+// Tokenizes sql without copying text: tokens are positions in QStringView. Strings,
+// quoted identifiers, nested /* */ comments and $tag$ dollar quoted strings may span
+// several pieces of text, State carries them from one piece to next, so text can be
+// lexed line by line or block by block. Pieces must end at line boundary. DELIMITER
+// command at start of statement changes statement delimiter like in mysql client.
+
+class SqlLexer
+{
+public:
+    enum TokenType {
+        Whitespace,
+        Word,
+        Number,
+        String,
+        QuotedIdentifier,
+        Comment,
+        Operator,
+        Delimiter,
+        DelimiterCommand
+    };
+
+    // construct unfinished at end of previous piece
+    enum Context {
+        Code,
+        InString,
+        InQuotedIdentifier,
+        InComment,
+        InDollarString
+    };
+
+    struct Token {
+        TokenType type;
+        qsizetype pos;
+        qsizetype size;
+    };
+
+    struct State {
+        Context context = Code;
+        // quote of unfinished string or identifier
+        QChar quote;
+        // depth of unfinished comment
+        int depth = 0;
+        // tag of unfinished dollar quoted string including $
+        QString tag;
+        QString delimiter = ";";
+        // only whitespace and comments since last delimiter
+        bool statementStart = true;
+
+        bool operator==(const State& other) const;
+        bool operator!=(const State& other) const;
+    };
+
+    SqlLexer(QStringView text, State* state);
+
+    bool next(Token& token);
+
+    static QList<Token> tokens(QStringView text, State* state);
+    // tokens without whitespace and comments
+    static QList<Token> codeTokens(QStringView text);
+
+protected:
+    qsizetype scanString(qsizetype pos, QChar quote, bool escapes);
+    qsizetype scanComment(qsizetype pos);
+    qsizetype scanDollarString(qsizetype pos);
+    qsizetype lineEnd(qsizetype pos) const;
+
+    QStringView mText;
+    State* mState;
+    qsizetype mPos;
+};
+
+size_t qHash(const SqlLexer::State& state, size_t seed = 0);
+
+// Splits script into statements by current delimiter, text is appended piece by piece
+// and statements are reported with utf-8 byte offsets, so execution can be resumed
+// from statement in file. Statements with comments only are skipped.
+
+class SqlSplitter
+{
+public:
+    struct Statement {
+        QString text;
+        // byte offsets, begin is right after previous delimiter, end is after delimiter
+        qint64 begin;
+        qint64 end;
+        // delimiter in effect at begin
+        QString delimiter;
+    };
+
+    SqlSplitter(qint64 offset = 0, const QString& delimiter = ";");
+
+    // mysql executes /*! */ comments
+    void setExecutableComments(bool value);
+
+    // text must end at line boundary, except for last piece
+    void append(QStringView text, QList<Statement>& statements);
+    // reports text after last delimiter
+    void finish(QList<Statement>& statements);
+
+    qint64 offset() const;
+    QString delimiter() const;
+
+    static QStringList split(const QString& text);
+
+    static qint64 utf8Size(QStringView text);
+
+protected:
+    SqlLexer::State mState;
+    QString mText;
+    bool mHasCode;
+    bool mExecutableComments;
+    qint64 mBegin;
+    qint64 mOffset;
+    QString mDelimiter;
+};
+
+#endif // SQLLEXER_H
@@ -3,119 +3,153 @@
 SqlParse::SqlParse() {}
 
 #include <QRegularExpression>
+#include "sqllexer.h"
 
-static QString untick(const QString& s) {
-    if (s.startsWith("`") && s.endsWith("`")) {
-        return s.mid(1,s.size()-2);
+namespace {
+
+QString untick(QStringView s) {
+    if (s.size() > 1 && ((s.startsWith('`') && s.endsWith('`')) || (s.startsWith('"') && s.endsWith('"')))) {
+        return s.mid(1,s.size()-2).toString();
     }
-    return s;
+    return s.toString();
+}
+
+class TokenReader {
+public:
+    TokenReader(QStringView query) : mQuery(query), mTokens(SqlLexer::codeTokens(query)) {
+
+    }
+    QStringView text(int i) const {
+        return mQuery.mid(mTokens[i].pos, mTokens[i].size);
+    }
+    bool isWord(int i, const char* word) const {
+        return i < mTokens.size() && mTokens[i].type == SqlLexer::Word
+                && text(i).compare(QLatin1String(word), Qt::CaseInsensitive) == 0;
+    }
+    // skips optional words
+    int skip(int i, const QList<const char*>& words) const {
+        for(const char* word: words) {
+            if (isWord(i, word)) {
+                i++;
+            }
+        }
+        return i;
+    }
+    // possibly qualified name, parts are unquoted
+    QString name(int& i) const {
+        QString res;
+        while (i < mTokens.size()) {
+            SqlLexer::TokenType type = mTokens[i].type;
+            if (type != SqlLexer::Word && type != SqlLexer::QuotedIdentifier) {
+                break;
+            }
+            res += untick(text(i));
+            i++;
+            if (i + 1 < mTokens.size() && text(i) == QLatin1String(".")) {
+                res += ".";
+                i++;
+            } else {
+                break;
+            }
+        }
+        return res;
+    }
+    int size() const {
+        return mTokens.size();
+    }
+protected:
+    QStringView mQuery;
+    QList<SqlLexer::Token> mTokens;
+};
+
 }
 
 QueryEffect SqlParse::queryEffect(const QString &query)
 {
-    QRegularExpression rx("(create|drop|alter)\\s+table\\s+([^ ]*)", QRegularExpression::CaseInsensitiveOption);
-    auto m = rx.match(query);
-    if (m.hasMatch()) {
+    TokenReader reader(query);
+    for(int i=0;i<reader.size();i++) {
         QueryEffect::Type type = QueryEffect::None;
-        auto c = m.captured(1);
-        auto table = untick(m.captured(2));
-        if (c == "create") {
+        if (reader.isWord(i, "create")) {
             type = QueryEffect::Create;
-        } else if (c == "drop") {
+        } else if (reader.isWord(i, "drop")) {
             type = QueryEffect::Drop;
-        } else if (c == "alter") {
+        } else if (reader.isWord(i, "alter")) {
             type = QueryEffect::Alter;
-        }
-        return QueryEffect(type, table, QString());
-    }
-    rx = QRegularExpression("rename\\s+table\\s+([^ ]*)\\s+to\\s+([^ ]*)", QRegularExpression::CaseInsensitiveOption);
-    m = rx.match(query);
-    if (m.hasMatch()) {
-        auto oldName = untick(m.captured(1));
-        auto table = untick(m.captured(2));
-        return QueryEffect(QueryEffect::Rename, table, oldName);
-    }
-    return QueryEffect();
-}
-
-static int countSlashes(const QString &queries, int p) {
-    int count = 0;
-    while (p > -1) {
-        if (queries[p] == '\\') {
-            count += 1;
-            p -= 1;
+        } else if (reader.isWord(i, "rename")) {
+            type = QueryEffect::Rename;
         } else {
-            break;
+            continue;
         }
-    }
-    return count;
-}
-
-// todo nested multiline comments
-QList<int> SqlParse::colorQueries(const QString &queries) {
-    int state = Query;
-    QList<int> res;
-    int nextState = Undefined;
-    for(int i=0;i<queries.size();i++) {
-        QChar c = queries[i];
-        if (nextState != Undefined) {
-            state = nextState;
-            nextState = Undefined;
+        int j = reader.skip(i + 1, {"temporary"});
+        if (!reader.isWord(j, "table")) {
+            continue;
         }
-        if (state == Query) {
-            switch(c.unicode()) {
-            case '/': if (queries.mid(i,2) == "/*") state = MultilineComment; break;
-            case '-': if (queries.mid(i,2) == "--") state = InlineComment; break;
-            case '\'': state = String; break;
-            case ';': state = Separator; nextState = Query; break;
-            }
-        //} else if (state == Separator) {
-
-        } else if (state == String) {
-            if (c == '\'') {
-                if ((countSlashes(queries, i-1) % 2) == 0) {
-                    nextState = Query;
-                }
-            }
-        } else if (state == InlineComment) {
-            if (c == '\n') {
-                state = Query;
-            }
-        } else if (state == MultilineComment) {
-            if (c == '/' && i > 0 && queries[i-1] == '*') {
-                nextState = Query;
-            }
+        j = reader.skip(j + 1, {"if", "not", "exists"});
+        QString table = reader.name(j);
+        if (table.isEmpty()) {
+            continue;
+        }
+        if (type != QueryEffect::Rename) {
+            return QueryEffect(type, table, QString());
+        }
+        if (!reader.isWord(j, "to")) {
+            continue;
+        }
+        j++;
+        QString newName = reader.name(j);
+        if (!newName.isEmpty()) {
+            return QueryEffect(QueryEffect::Rename, newName, table);
         }
-        res.append(state);
     }
-    return res;
+    return QueryEffect();
 }
 
-static QList<int> indexOf(const QList<int>& cs, int c) {
-    QList<int> res;
-    int p = cs.indexOf(c);
-    while (p > -1) {
-        res.append(p);
-        if (p > -1) {
-            p = cs.indexOf(c, p + 1);
+QList<int> SqlParse::colorQueries(const QString &queries) {
+    QList<int> res(queries.size(), Query);
+    SqlLexer::State state;
+    SqlLexer lexer(queries, &state);
+    SqlLexer::Token token;
+    SqlLexer::Context context = state.context;
+    while (lexer.next(token)) {
+        int color = Query;
+        switch (token.type) {
+        case SqlLexer::String:
+            color = String;
+            break;
+        case SqlLexer::Comment:
+            color = context == SqlLexer::Code && queries[token.pos] == '-' ? InlineComment : MultilineComment;
+            break;
+        case SqlLexer::Delimiter:
+            color = Separator;
+            break;
+        default:
+            break;
+        }
+        if (color != Query) {
+            std::fill(res.begin() + token.pos, res.begin() + token.pos + token.size, color);
         }
+        context = state.context;
     }
     return res;
 }
 
 QStringList SqlParse::splitQueries(const QString &queries)
 {
-    QList<int> colors = colorQueries(queries);
-    QList<int> ixs = indexOf(colors, SqlParse::Separator);
-    ixs.prepend(-1);
-    ixs.append(colors.size());
     QStringList res;
-    for(int i=0;i<ixs.size()-1;i++) {
-        int p1 = ixs[i]+1;
-        int p2 = ixs[i+1];
-        int l = p2 - p1;
-        res.append(queries.mid(p1, l));
+    SqlLexer::State state;
+    SqlLexer lexer(queries, &state);
+    SqlLexer::Token token;
+    qsizetype begin = 0;
+    while (lexer.next(token)) {
+        if (token.type == SqlLexer::Delimiter) {
+            res.append(queries.mid(begin, token.pos - begin));
+            begin = token.pos + token.size;
+        } else if (token.type == SqlLexer::DelimiterCommand) {
+            // client command, not sent to server
+            begin = token.pos + token.size;
+        }
     }
+    res.append(queries.mid(begin));
     return res;
 }
 
@@ -130,6 +164,52 @@ bool SqlParse::isSimpleSelect(const QString &query, QString &tableName)
     return false;
 }
 
+static bool isWordChar(QChar c) {
+    return c.isLetterOrNumber() || c == '_' || c == '?' || c == '$' || c == '@' || c == '`' || c == '"';
+}
+
+QString SqlParse::fingerprint(const QString &query)
+{
+    QString res;
+    res.reserve(query.size());
+    bool space = false;
+    auto append = [&](QStringView text) {
+        // space is kept between words only, "a = 1" and "a=1" are same
+        if (space && !res.isEmpty() && isWordChar(res.back()) && isWordChar(text.front())) {
+            res.append(' ');
+        }
+        space = false;
+        res.append(text);
+    };
+    SqlLexer::State state;
+    SqlLexer lexer(query, &state);
+    SqlLexer::Token token;
+    while (lexer.next(token)) {
+        switch (token.type) {
+        case SqlLexer::String:
+        case SqlLexer::Number:
+            append(u"?");
+            break;
+        case SqlLexer::Whitespace:
+        case SqlLexer::Comment:
+        case SqlLexer::DelimiterCommand:
+            space = true;
+            break;
+        default:
+            append(query.mid(token.pos, token.size).toLower());
+            break;
+        }
+    }
+    while (res.endsWith(';')) {
+        res.chop(1);
+    }
+    static QRegularExpression list("\\(\\?(,\\?)*\\)");
+    static QRegularExpression rows("\\(\\?\\+\\)(,\\(\\?\\+\\))+");
+    res.replace(list, "(?+)");
+    res.replace(rows, "(?+)");
+    return res;
+}
+
 QueryEffect::QueryEffect() : type(None) {
 
 }
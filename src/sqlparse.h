@@ -43,6 +43,10 @@ public:
     static QStringList splitQueries(const QString &queries);
 
     static bool isSimpleSelect(const QString& query, QString& tableName);
+
+    // query with literals replaced by ?, lists of literals collapsed into (?+), comments
+    // removed, case and whitespace folded - same for executions of one query with different values
+    static QString fingerprint(const QString& query);
 };
 
 #endif // SQLPARSE_H
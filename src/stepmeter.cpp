@@ -0,0 +1,184 @@
+#include "stepmeter.h"
+
+#include <QTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+StepMeter::StepMeter(QObject *parent)
+    : QObject{parent}, mHeartbeat(new QTimer(this)), mLastBeat(0), mRunning(false)
+{
+    mHeartbeat->setInterval(interval);
+    connect(mHeartbeat,SIGNAL(timeout()),this,SLOT(onHeartbeat()));
+    mTime.start();
+}
+
+void StepMeter::begin(const QString &name)
+{
+    if (mRunning) {
+        end();
+    }
+    mStep = Step();
+    mStep.name = name;
+    mRunning = true;
+    mTime.restart();
+    mLastBeat = 0;
+    mHeartbeat->start();
+}
+
+void StepMeter::onHeartbeat()
+{
+    qint64 now = mTime.elapsed();
+    qint64 gap = now - mLastBeat;
+    if (gap > stallThreshold) {
+        mStep.stalls += 1;
+        mStep.stallMs += gap;
+        mStep.longestStallMs = qMax(mStep.longestStallMs, gap);
+    }
+    mLastBeat = now;
+}
+
+void StepMeter::end()
+{
+    if (!mRunning) {
+        return;
+    }
+    // gap that ends with this call is not seen by heartbeat
+    onHeartbeat();
+    mHeartbeat->stop();
+    mStep.wallMs = mTime.elapsed();
+    mStep.peakRssKb = peakRssKb();
+    mStep.rssKb = rssKb();
+    mSteps.append(mStep);
+    mRunning = false;
+}
+
+void StepMeter::setNote(const QString &note)
+{
+    if (mRunning) {
+        mStep.note = note;
+    } else if (!mSteps.isEmpty()) {
+        mSteps.last().note = note;
+    }
+}
+
+bool StepMeter::isRunning() const
+{
+    return mRunning;
+}
+
+QList<StepMeter::Step> StepMeter::steps() const
+{
+    return mSteps;
+}
+
+QByteArray StepMeter::toJson() const
+{
+    QJsonArray steps;
+    for(const Step& step: mSteps) {
+        QJsonObject obj;
+        obj["name"] = step.name;
+        obj["wallMs"] = step.wallMs;
+        obj["stallMs"] = step.stallMs;
+        obj["stalls"] = step.stalls;
+        obj["longestStallMs"] = step.longestStallMs;
+        obj["peakRssKb"] = step.peakRssKb;
+        obj["rssKb"] = step.rssKb;
+        if (!step.note.isEmpty()) {
+            obj["note"] = step.note;
+        }
+        steps.append(obj);
+    }
+    QJsonObject root;
+    root["steps"] = steps;
+    return QJsonDocument(root).toJson();
+}
+
+QString StepMeter::toText() const
+{
+    QString res;
+    QTextStream stream(&res);
+    stream << QString("%1 %2 %3 %4 %5 %6\n")
+              .arg("step", -16).arg("wall ms", 10).arg("stall ms", 10)
+              .arg("stalls", 7).arg("peak kb", 10).arg("rss kb", 10);
+    for(const Step& step: mSteps) {
+        stream << QString("%1 %2 %3 %4 %5 %6 %7\n")
+                  .arg(step.name, -16).arg(step.wallMs, 10).arg(step.stallMs, 10)
+                  .arg(step.stalls, 7).arg(step.peakRssKb, 10).arg(step.rssKb, 10).arg(step.note);
+    }
+    return res;
+}
+
+bool StepMeter::save(const QString &path, QString &error) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    file.write(toJson());
+    return true;
+}
+
+#if defined(Q_OS_LINUX)
+static qint64 procStatusKb(const QByteArray& key) {
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (line.startsWith(key)) {
+            return line.mid(key.size()).trimmed().split(' ').value(0).toLongLong();
+        }
+    }
+    return -1;
+}
+#endif
+
+qint64 StepMeter::peakRssKb()
+{
+#if defined(Q_OS_LINUX)
+    return procStatusKb("VmHWM:");
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return qint64(counters.PeakWorkingSetSize / 1024);
+#elif defined(Q_OS_MACOS)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return qint64(usage.ru_maxrss / 1024);
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return qint64(usage.ru_maxrss);
+#else
+    return -1;
+#endif
+}
+
+qint64 StepMeter::rssKb()
+{
+#if defined(Q_OS_LINUX)
+    return procStatusKb("VmRSS:");
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return qint64(counters.WorkingSetSize / 1024);
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,61 @@
+#ifndef STEPMETER_H
+#define STEPMETER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+class QTimer;
+
+// Measures named steps of scenario: wall time, peak and current resident set size and
+// time gui thread was blocked. Heartbeat timer ticks every interval ms, gaps between
+// ticks longer than stallThreshold are counted as stalls.
+
+class StepMeter : public QObject
+{
+    Q_OBJECT
+public:
+    struct Step {
+        QString name;
+        qint64 wallMs = 0;
+        qint64 stallMs = 0;
+        int stalls = 0;
+        qint64 longestStallMs = 0;
+        qint64 peakRssKb = 0;
+        qint64 rssKb = 0;
+        QString note;
+    };
+
+    explicit StepMeter(QObject *parent = nullptr);
+
+    void begin(const QString& name);
+    void end();
+    void setNote(const QString& note);
+
+    bool isRunning() const;
+
+    QList<Step> steps() const;
+
+    QByteArray toJson() const;
+    QString toText() const;
+    bool save(const QString& path, QString& error) const;
+
+    // -1 if not available on platform
+    static qint64 peakRssKb();
+    static qint64 rssKb();
+
+    static const int interval = 10;
+    static const int stallThreshold = 50;
+
+protected slots:
+    void onHeartbeat();
+
+protected:
+    QTimer* mHeartbeat;
+    QElapsedTimer mTime;
+    qint64 mLastBeat;
+    bool mRunning;
+    Step mStep;
+    QList<Step> mSteps;
+};
+
+#endif // STEPMETER_H
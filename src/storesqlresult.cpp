@@ -0,0 +1,179 @@
+#include "storesqlresult.h"
+
+#include "resultsource.h"
+#include "resultstore.h"
+#include "settings.h"
+#include "querytiming.h"
+#include "trace.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QMultiHash>
+
+namespace {
+
+QMutex pendingMutex;
+// results with open source by driver of connection
+QMultiHash<const QSqlDriver*, StoreSqlResult*> pending;
+
+}
+
+StoreSqlResult::StoreSqlResult(const QSqlDriver *driver, ResultSource *source, ResultStore *store)
+    : QSqlResult(driver), mSource(source), mStore(store), mNumRowsAffected(source ? source->numRowsAffected() : -1)
+{
+    if (source) {
+        setQuery(source->lastQuery());
+        QMutexLocker locker(&pendingMutex);
+        pending.insert(driver, this);
+    }
+    setSelect(true);
+    setActive(true);
+    setAt(QSql::BeforeFirstRow);
+}
+
+StoreSqlResult::~StoreSqlResult()
+{
+    if (mSource) {
+        QMutexLocker locker(&pendingMutex);
+        pending.remove(driver(), this);
+    }
+    delete mSource;
+    delete mStore;
+}
+
+QSqlQuery StoreSqlResult::query(QSqlQuery &&query, qint64 spillThreshold, QueryTiming *timing)
+{
+    const QSqlDriver* driver = query.driver();
+    return StoreSqlResult::query(driver, new QueryResultSource(std::move(query)), spillThreshold, timing);
+}
+
+QSqlQuery StoreSqlResult::query(const QSqlDriver *driver, ResultSource *source, qint64 spillThreshold, QueryTiming *timing)
+{
+    TRACE_SCOPE("StoreSqlResult::query");
+    StoreSqlResult* result = new StoreSqlResult(driver, source, new ResultStore(source->record(), spillThreshold));
+    QElapsedTimer time;
+    time.start();
+    // first row is fetched alone to measure latency
+    if (result->fetchMore(1) && timing) {
+        timing->firstRow = timing->exec + int(time.elapsed());
+    }
+    result->fetchMore(ResultStore::chunkRows - 1);
+    if (timing) {
+        timing->fetch = int(time.elapsed());
+        timing->bytes = result->mStore->totalBytes();
+    }
+    return QSqlQuery(result);
+}
+
+QSqlQuery StoreSqlResult::query(const QSqlDriver *driver, ResultStore *store)
+{
+    return QSqlQuery(new StoreSqlResult(driver, nullptr, store));
+}
+
+qint64 StoreSqlResult::spillThreshold()
+{
+    return qint64(Settings::instance()->resultSpillThreshold()) * 1024 * 1024;
+}
+
+void StoreSqlResult::fetchAll()
+{
+    TRACE_SCOPE("StoreSqlResult::fetchAll");
+    while (fetchMore(ResultStore::chunkRows)) {
+
+    }
+    TRACE_COUNTER("rows", mStore->rowCount());
+    TRACE_COUNTER("bytes", mStore->totalBytes());
+}
+
+void StoreSqlResult::fetchPending(const QSqlDriver *driver)
+{
+    QList<StoreSqlResult*> results;
+    {
+        QMutexLocker locker(&pendingMutex);
+        results = pending.values(driver);
+    }
+    for(StoreSqlResult* result: std::as_const(results)) {
+        result->fetchAll();
+    }
+}
+
+bool StoreSqlResult::fetchMore(int count)
+{
+    if (!mSource) {
+        return false;
+    }
+    if (mSource->fetch(mStore, count) > 0) {
+        return true;
+    }
+    QMutexLocker locker(&pendingMutex);
+    pending.remove(driver(), this);
+    delete mSource;
+    mSource = nullptr;
+    return false;
+}
+
+ResultStore *StoreSqlResult::store() const
+{
+    return mStore;
+}
+
+bool StoreSqlResult::fetchTo(int row)
+{
+    while (mSource && mStore->rowCount() <= row) {
+        TRACE_SCOPE("StoreSqlResult::fetchTo");
+        fetchMore(qMax(row + 1 - mStore->rowCount(), int(ResultStore::chunkRows)));
+    }
+    return row < mStore->rowCount();
+}
+
+QVariant StoreSqlResult::data(int i)
+{
+    return mStore->value(at(), i);
+}
+
+bool StoreSqlResult::isNull(int i)
+{
+    return mStore->value(at(), i).isNull();
+}
+
+bool StoreSqlResult::reset(const QString &)
+{
+    return false;
+}
+
+bool StoreSqlResult::fetch(int i)
+{
+    if (i < 0 || !fetchTo(i)) {
+        return false;
+    }
+    setAt(i);
+    return true;
+}
+
+bool StoreSqlResult::fetchFirst()
+{
+    return fetch(0);
+}
+
+bool StoreSqlResult::fetchLast()
+{
+    fetchAll();
+    return fetch(mStore->rowCount() - 1);
+}
+
+int StoreSqlResult::size()
+{
+    if (mSource) {
+        return -1;
+    }
+    return mStore->rowCount();
+}
+
+int StoreSqlResult::numRowsAffected()
+{
+    return mNumRowsAffected;
+}
+
+QSqlRecord StoreSqlResult::record() const
+{
+    return mStore->record();
+}
@@ -0,0 +1,62 @@
+#ifndef STORESQLRESULT_H
+#define STORESQLRESULT_H
+
+#include <QSqlResult>
+#include <QSqlQuery>
+class ResultSource;
+class ResultStore;
+struct QueryTiming;
+
+// QSqlResult that serves rows from ResultStore filled by ResultSource, used to
+// feed QSqlQueryModel (and everything built on it) with results that may not fit in memory.
+// Rows are read from source as model asks for them. Source keeps connection busy, so before
+// running another query on connection its pending results are read to the end with fetchPending
+
+class StoreSqlResult : public QSqlResult
+{
+public:
+    // takes ownership of source and store, source is nullptr when store is already filled
+    StoreSqlResult(const QSqlDriver* driver, ResultSource* source, ResultStore* store);
+    ~StoreSqlResult();
+
+    // wraps executed select query, reads first chunk of rows into ResultStore
+    static QSqlQuery query(QSqlQuery&& query, qint64 spillThreshold, QueryTiming* timing = nullptr);
+
+    // reads first chunk of rows from source into ResultStore, takes ownership of source,
+    // fills firstRow, fetch and bytes of timing (exec is expected to be set)
+    static QSqlQuery query(const QSqlDriver* driver, ResultSource* source, qint64 spillThreshold, QueryTiming* timing = nullptr);
+
+    // wraps filled store (from other thread), takes ownership of store
+    static QSqlQuery query(const QSqlDriver* driver, ResultStore* store);
+
+    // spill threshold from settings in bytes
+    static qint64 spillThreshold();
+
+    void fetchAll();
+
+    // reads to the end results that still use connection of driver
+    static void fetchPending(const QSqlDriver* driver);
+
+    ResultStore* store() const;
+
+protected:
+    QVariant data(int i) override;
+    bool isNull(int i) override;
+    bool reset(const QString& query) override;
+    bool fetch(int i) override;
+    bool fetchFirst() override;
+    bool fetchLast() override;
+    int size() override;
+    int numRowsAffected() override;
+    QSqlRecord record() const override;
+
+    bool fetchTo(int row);
+    // false when source is exhausted
+    bool fetchMore(int count);
+
+    ResultSource* mSource;
+    ResultStore* mStore;
+    int mNumRowsAffected;
+};
+
+#endif // STORESQLRESULT_H
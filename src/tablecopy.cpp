@@ -0,0 +1,543 @@
+#include "tablecopy.h"
+
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QQueue>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlField>
+#include <QSqlIndex>
+#include <QSqlError>
+#include <QDebug>
+
+#include "connectionpool.h"
+#include "bulkinsert.h"
+#include "nativequery.h"
+#include "resultsource.h"
+#include "resultstore.h"
+#include "datastreamer.h"
+#include "sqldatatypes.h"
+#include "drivernames.h"
+#include "trace.h"
+
+struct TableCopy::Batch {
+    // -1 - no more tables
+    int index = -1;
+    // set in first batch of table
+    QList<Field> fields;
+    QList<QVariantList> rows;
+    qint64 bytes = 0;
+    // last batch of table
+    bool last = false;
+    QString error;
+};
+
+struct TableCopy::State {
+    QString source;
+    QString target;
+    QStringList tables;
+    bool createTables = true;
+    int batchRows = 1000;
+    int queueSize = 4;
+    QAtomicInt active;
+    QAtomicInt cancelled;
+    // table writer failed to insert, reader skips rest of it
+    QAtomicInt failedTable{-1};
+    QAtomicInteger<qint64> readerWaitMs;
+    QAtomicInteger<qint64> writerWaitMs;
+    QMutex queueMutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    QQueue<Batch> queue;
+    QMutex mutex;
+    TableCopy* owner = nullptr;
+};
+
+namespace {
+
+// DECIMAL and NUMERIC columns by driver type id
+bool isDecimal(const QString& driverName, const QSqlField& field) {
+    int type = field.typeID();
+    if (driverName == DRIVER_PSQL) {
+        // NUMERICOID
+        return type == 1700;
+    }
+    if (driverName == DRIVER_MYSQL || driverName == DRIVER_MARIADB) {
+        // MYSQL_TYPE_DECIMAL, MYSQL_TYPE_NEWDECIMAL
+        return type == 0 || type == 246;
+    }
+    if (driverName == DRIVER_ODBC) {
+        // SQL_NUMERIC, SQL_DECIMAL
+        return type == 2 || type == 3;
+    }
+    return false;
+}
+
+// approximate size of value in transfer
+qint64 valueSize(const QVariant& value) {
+    switch (value.typeId()) {
+    case QMetaType::QString:
+        return value.toString().size();
+    case QMetaType::QByteArray:
+        return value.toByteArray().size();
+    default:
+        return 8;
+    }
+}
+
+}
+
+TableCopy::TableCopy(const QString &source, const QString &target, QObject *parent)
+    : Dump{parent}, mState(new State()), mSource(source), mTarget(target), mCreateTables(true),
+      mBatchRows(1000), mQueueSize(4)
+{
+
+}
+
+TableCopy::~TableCopy()
+{
+    cancel();
+    QMutexLocker locker(&mState->mutex);
+    mState->owner = nullptr;
+}
+
+void TableCopy::setCreateTables(bool value)
+{
+    mCreateTables = value;
+}
+
+void TableCopy::setBatchRows(int rows)
+{
+    mBatchRows = qMax(1, rows);
+}
+
+void TableCopy::setQueueSize(int batches)
+{
+    mQueueSize = qMax(1, batches);
+}
+
+void TableCopy::start(const QStringList &tables)
+{
+    {
+        QMutexLocker locker(&mState->mutex);
+        mState->owner = nullptr;
+    }
+    mState.reset(new State());
+    mState->source = mSource;
+    mState->target = mTarget;
+    mState->tables = tables;
+    mState->createTables = mCreateTables;
+    mState->batchRows = mBatchRows;
+    mState->queueSize = mQueueSize;
+    mState->active.storeRelease(2);
+    mState->owner = this;
+    mTables.clear();
+    for(const QString& table: tables) {
+        Table item;
+        item.name = table;
+        mTables.append(item);
+    }
+    startTime();
+    QSharedPointer<State> state = mState;
+    ConnectionPool::startWorker([state](){
+        read(state);
+    });
+    ConnectionPool::startWorker([state](){
+        write(state);
+    });
+}
+
+void TableCopy::cancel()
+{
+    mState->cancelled.storeRelease(1);
+    QMutexLocker locker(&mState->queueMutex);
+    mState->notEmpty.wakeAll();
+    mState->notFull.wakeAll();
+}
+
+QString TableCopy::source() const
+{
+    return mSource;
+}
+
+QString TableCopy::target() const
+{
+    return mTarget;
+}
+
+double TableCopy::readerWaitSeconds() const
+{
+    return mState->readerWaitMs.loadAcquire() / 1000.0;
+}
+
+double TableCopy::writerWaitSeconds() const
+{
+    return mState->writerWaitMs.loadAcquire() / 1000.0;
+}
+
+QList<Field> TableCopy::fields(QSqlDatabase db, const QString &table, const QSqlRecord &record)
+{
+    QSqlIndex primaryKey = db.primaryIndex(table);
+    QString driverName = db.driverName();
+    bool sqlite = driverName == DRIVER_SQLITE;
+    QList<Field> res;
+    for(int c=0;c<record.count();c++) {
+        QSqlField field = record.field(c);
+        Field item(field.name(), typeName(QMetaType::Type(field.metaType().id())));
+        if (isDecimal(driverName, field)) {
+            // read as text, double would round it
+            item.setType(decimalType(driverName, field.length(), field.precision()));
+        }
+        if (sqlite && item.type() == "INT") {
+            // declared integer holds 64 bit values
+            item.setType("BIGINT");
+        }
+        if (primaryKey.contains(field.name())) {
+            item.setPrimaryKey(true);
+            // mysql cannot index TEXT column without prefix length, other text columns stay TEXT
+            // since VARCHAR columns count against mysql row size limit
+            if (item.type() == "TEXT") {
+                item.setSize(field.length() > 0 ? qMin(field.length(), 255) : 255);
+            }
+        }
+        res.append(item);
+    }
+    return res;
+}
+
+QString TableCopy::typeName(QMetaType::Type type)
+{
+    switch (type) {
+    case QMetaType::Bool:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::UChar:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Int:
+        return "INT";
+    case QMetaType::UInt:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return "BIGINT";
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return "DOUBLE";
+    case QMetaType::QDate:
+        return "DATE";
+    case QMetaType::QTime:
+        return "TIME";
+    case QMetaType::QDateTime:
+        return "DATETIME";
+    case QMetaType::QByteArray:
+        return "BLOB";
+    default:
+        return "TEXT";
+    }
+}
+
+QString TableCopy::decimalType(const QString &driverName, int length, int precision)
+{
+    int digits = length;
+    int scale = precision;
+    if (driverName == DRIVER_PSQL && scale < 0 && digits > 0xffff) {
+        // QPSQL keeps typmod of table column in length
+        scale = digits & 0xffff;
+        digits = digits >> 16;
+    } else if (driverName == DRIVER_MYSQL || driverName == DRIVER_MARIADB) {
+        // display length counts decimal point (and sign, one extra digit is harmless)
+        digits -= scale > 0 ? 1 : 0;
+    }
+    if (digits <= 0 || scale < 0 || scale > digits) {
+        // unconstrained numeric, widest mysql decimal
+        return "DECIMAL(65,30)";
+    }
+    return QString("DECIMAL(%1,%2)").arg(qMin(digits, 65)).arg(qMin(scale, 30));
+}
+
+void TableCopy::read(QSharedPointer<State> state)
+{
+    TRACE_SCOPE("TableCopy::read");
+    {
+        ConnectionLease lease(state->source);
+        QSqlDatabase db = lease.database();
+        for(int index=0;index<state->tables.size() && !state->cancelled.loadAcquire();index++) {
+            if (lease.isValid()) {
+                readTable(state, db, index);
+            } else {
+                Batch batch;
+                batch.index = index;
+                batch.last = true;
+                batch.error = lease.error();
+                push(state, batch);
+            }
+        }
+        push(state, Batch());
+    }
+    postFinished(state);
+}
+
+void TableCopy::readTable(QSharedPointer<State> state, QSqlDatabase &db, int index)
+{
+    TRACE_SCOPE("TableCopy::readTable");
+    QString table = state->tables[index];
+    Batch batch;
+    batch.index = index;
+    // columns and primary key are read before select, native result keeps connection busy until exhausted
+    batch.fields = fields(db, table, db.record(table));
+    QSqlDriver* driver = db.driver();
+    // QSqlQuery of QMYSQL and QPSQL buffers whole result on client, native client streams it.
+    // QODBC fetches rows as they are read
+    bool native = NativeQuery::isAvailable(db) && db.driverName() != DRIVER_ODBC;
+    QString columns = "*";
+    if (native) {
+        // native client decodes decimals to double, exact text is selected instead
+        QStringList names;
+        bool cast = false;
+        for(const Field& field: std::as_const(batch.fields)) {
+            QString name = driver->escapeIdentifier(field.name(), QSqlDriver::FieldName);
+            if (field.type().startsWith("DECIMAL")) {
+                name = QString("CAST(%1 AS %2) AS %1").arg(name, db.driverName() == DRIVER_PSQL ? "TEXT" : "CHAR");
+                cast = true;
+            }
+            names.append(name);
+        }
+        if (cast) {
+            columns = names.join(", ");
+        }
+    }
+    QString query = QString("SELECT %1 FROM %2").arg(columns, driver->escapeIdentifier(table, QSqlDriver::TableName));
+    QString error;
+    QScopedPointer<ResultSource> source;
+    if (native) {
+        ResultSource* result = nullptr;
+        int rowsAffected;
+        if (NativeQuery::exec(db, query, &result, &rowsAffected, error) && !result) {
+            error = "Query returned no result set";
+        }
+        source.reset(result);
+    } else {
+        QSqlQuery q(db);
+        q.setForwardOnly(true);
+        // decimals as strings
+        q.setNumericalPrecisionPolicy(QSql::HighPrecision);
+        if (q.exec(query)) {
+            source.reset(new QueryResultSource(std::move(q)));
+        } else {
+            error = q.lastError().text();
+        }
+    }
+    if (source && source->record().count() != batch.fields.size()) {
+        error = "Columns of table changed";
+        source.reset();
+    }
+    if (!source) {
+        batch.fields.clear();
+        batch.last = true;
+        batch.error = error;
+        push(state, batch);
+        return;
+    }
+    QMap<QString, QMetaType::Type> variant = SqlDataTypes::mapToVariant();
+    QList<QMetaType> types;
+    for(const Field& field: std::as_const(batch.fields)) {
+        types.append(QMetaType(variant.value(field.type(), QMetaType::QString)));
+    }
+    int columns = types.size();
+    while (state->failedTable.loadAcquire() != index) {
+        // rows of one batch, no spill
+        ResultStore store(source->record(), 0);
+        int count = source->fetch(&store, state->batchRows - batch.rows.size());
+        if (count == 0) {
+            break;
+        }
+        for(int r=0;r<count;r++) {
+            QVariantList row = store.row(r);
+            for(int c=0;c<columns;c++) {
+                QVariant& value = row[c];
+                if (value.isNull()) {
+                    // typed null binds to column type
+                    value = QVariant(types[c]);
+                } else if (value.metaType() != types[c]) {
+                    value.convert(types[c]);
+                }
+                batch.bytes += valueSize(value);
+            }
+            batch.rows.append(row);
+        }
+        if (batch.rows.size() >= state->batchRows) {
+            if (!push(state, batch)) {
+                return;
+            }
+            batch = Batch();
+            batch.index = index;
+        }
+    }
+    batch.error = source->lastError();
+    batch.last = true;
+    push(state, batch);
+}
+
+void TableCopy::write(QSharedPointer<State> state)
+{
+    TRACE_SCOPE("TableCopy::write");
+    {
+        ConnectionLease lease(state->target);
+        QSqlDatabase db = lease.database();
+        Batch batch;
+        int index = -1;
+        QStringList columns;
+        qint64 rows = 0;
+        qint64 bytes = 0;
+        QString error;
+        QElapsedTimer time;
+        QElapsedTimer report;
+        while (pop(state, batch) && batch.index > -1) {
+            if (batch.index != index) {
+                index = batch.index;
+                columns.clear();
+                rows = 0;
+                bytes = 0;
+                error = lease.isValid() ? QString() : lease.error();
+                time.start();
+                report.start();
+                postTable(state, index, Running, 0, 0, 0, QString());
+            }
+            QString table = state->tables[index];
+            if (!batch.fields.isEmpty() && error.isEmpty()) {
+                for(const Field& field: std::as_const(batch.fields)) {
+                    columns.append(field.name());
+                }
+                if (state->createTables && db.record(table).isEmpty()) {
+                    TRACE_SCOPE("TableCopy::create");
+                    QSqlQuery q(db);
+                    if (!q.exec(DataStreamer::createTableStatement(db, table, batch.fields, false))) {
+                        error = q.lastError().text();
+                    }
+                }
+            }
+            if (error.isEmpty() && !batch.error.isEmpty()) {
+                error = batch.error;
+            }
+            if (error.isEmpty() && !batch.rows.isEmpty()) {
+                TRACE_SCOPE("TableCopy::insert");
+                if (BulkInsert::insert(db, table, columns, batch.rows, error)) {
+                    rows += batch.rows.size();
+                    bytes += batch.bytes;
+                }
+            }
+            if (!error.isEmpty()) {
+                state->failedTable.storeRelease(index);
+            }
+            if (batch.last) {
+                postTable(state, index, error.isEmpty() ? Done : Failed, rows, bytes, time.elapsed() / 1000.0, error);
+            } else if (report.elapsed() >= progressMs) {
+                postTable(state, index, Running, rows, bytes, time.elapsed() / 1000.0, QString());
+                report.restart();
+            }
+        }
+    }
+    // writer is gone, unblock reader waiting for free slot
+    state->cancelled.storeRelease(1);
+    {
+        QMutexLocker locker(&state->queueMutex);
+        state->notFull.wakeAll();
+    }
+    postFinished(state);
+}
+
+bool TableCopy::push(QSharedPointer<State> state, const Batch &batch)
+{
+    QMutexLocker locker(&state->queueMutex);
+    if (state->queue.size() >= state->queueSize && !state->cancelled.loadAcquire()) {
+        QElapsedTimer time;
+        time.start();
+        while (state->queue.size() >= state->queueSize && !state->cancelled.loadAcquire()) {
+            state->notFull.wait(&state->queueMutex);
+        }
+        state->readerWaitMs.fetchAndAddOrdered(time.elapsed());
+    }
+    if (state->cancelled.loadAcquire()) {
+        return false;
+    }
+    state->queue.enqueue(batch);
+    state->notEmpty.wakeOne();
+    return true;
+}
+
+bool TableCopy::pop(QSharedPointer<State> state, Batch &batch)
+{
+    QMutexLocker locker(&state->queueMutex);
+    if (state->queue.isEmpty() && !state->cancelled.loadAcquire()) {
+        QElapsedTimer time;
+        time.start();
+        while (state->queue.isEmpty() && !state->cancelled.loadAcquire()) {
+            state->notEmpty.wait(&state->queueMutex);
+        }
+        state->writerWaitMs.fetchAndAddOrdered(time.elapsed());
+    }
+    if (state->cancelled.loadAcquire()) {
+        return false;
+    }
+    batch = state->queue.dequeue();
+    state->notFull.wakeOne();
+    return true;
+}
+
+void TableCopy::postTable(QSharedPointer<State> state, int index, Status status, qint64 rows, qint64 bytes,
+                          double seconds, const QString &error)
+{
+    if (!error.isEmpty()) {
+        qDebug() << state->tables.value(index) << error << __FILE__ << __LINE__;
+    }
+    QMutexLocker locker(&state->mutex);
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onTable", Qt::QueuedConnection,
+                                  Q_ARG(int, index), Q_ARG(int, int(status)), Q_ARG(qint64, rows),
+                                  Q_ARG(qint64, bytes), Q_ARG(double, seconds), Q_ARG(QString, error));
+    }
+}
+
+void TableCopy::postFinished(QSharedPointer<State> state)
+{
+    if (state->active.fetchAndAddOrdered(-1) != 1) {
+        return;
+    }
+    QMutexLocker locker(&state->mutex);
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onFinished", Qt::QueuedConnection);
+    }
+}
+
+void TableCopy::onTable(int index, int status, qint64 rows, qint64 bytes, double seconds, QString error)
+{
+    if (index < 0 || index >= mTables.size()) {
+        return;
+    }
+    Table& table = mTables[index];
+    table.status = Status(status);
+    table.rows = rows;
+    table.bytes = bytes;
+    table.seconds = seconds;
+    table.error = error;
+    emit tableChanged(index);
+}
+
+void TableCopy::onFinished()
+{
+    // tables not reached or interrupted by cancel
+    for(int i=0;i<mTables.size();i++) {
+        if (mTables[i].status == Queued || mTables[i].status == Running) {
+            mTables[i].status = Cancelled;
+            emit tableChanged(i);
+        }
+    }
+    setFinished();
+}
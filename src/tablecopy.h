@@ -0,0 +1,73 @@
+#ifndef TABLECOPY_H
+#define TABLECOPY_H
+
+#include "dump.h"
+#include <QSharedPointer>
+#include "field.h"
+
+class QSqlDatabase;
+class QSqlRecord;
+
+// Copies tables from one connection to another without intermediate file. Reader thread
+// streams rows of source (NativeQuery when available) and converts values to column types
+// (SqlDataTypes names, created with DataStreamer::createTableStatement when table is missing),
+// writer thread inserts them with BulkInsert on target. Batches are passed through bounded
+// queue: memory is limited to queueSize batches and copy runs at speed of slower side.
+
+class TableCopy : public Dump
+{
+    Q_OBJECT
+public:
+    TableCopy(const QString& source, const QString& target, QObject* parent = nullptr);
+    ~TableCopy();
+
+    void setCreateTables(bool value);
+    void setBatchRows(int rows);
+    void setQueueSize(int batches);
+
+    void start(const QStringList& tables);
+    void cancel() override;
+
+    QString source() const;
+    QString target() const;
+
+    // time reader waited for free slot in queue (writer is slower) and writer waited for batch (reader is slower)
+    double readerWaitSeconds() const;
+    double writerWaitSeconds() const;
+
+    // columns of select result, primary key taken from source table
+    static QList<Field> fields(QSqlDatabase db, const QString& table, const QSqlRecord& record);
+    // SqlDataTypes name for value type
+    static QString typeName(QMetaType::Type type);
+    // DECIMAL(p,s) for exact numeric column of source driver, length and precision as in QSqlField
+    static QString decimalType(const QString& driverName, int length, int precision);
+
+    static const int progressMs = 200;
+
+protected slots:
+    void onTable(int index, int status, qint64 rows, qint64 bytes, double seconds, QString error);
+    void onFinished();
+
+protected:
+    struct State;
+    struct Batch;
+    static void read(QSharedPointer<State> state);
+    static void readTable(QSharedPointer<State> state, QSqlDatabase& db, int index);
+    static void write(QSharedPointer<State> state);
+    // false when cancelled
+    static bool push(QSharedPointer<State> state, const Batch& batch);
+    static bool pop(QSharedPointer<State> state, Batch& batch);
+    static void postTable(QSharedPointer<State> state, int index, Status status, qint64 rows, qint64 bytes,
+                          double seconds, const QString& error);
+    // last of reader and writer reports finish
+    static void postFinished(QSharedPointer<State> state);
+
+    QSharedPointer<State> mState;
+    QString mSource;
+    QString mTarget;
+    bool mCreateTables;
+    int mBatchRows;
+    int mQueueSize;
+};
+
+#endif // TABLECOPY_H
@@ -0,0 +1,761 @@
+#include "tablediff.h"
+
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QHash>
+#include <QSet>
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlField>
+#include <QSqlIndex>
+#include <QSqlError>
+#include <QDebug>
+
+#include "connectionpool.h"
+#include "drivernames.h"
+#include "trace.h"
+
+struct TableDiff::State {
+    QString connectionName1;
+    QString table1;
+    QString connectionName2;
+    QString table2;
+    int fanOut = 16;
+    int leafRows = 1000;
+    int maxRows = 10000;
+    QAtomicInt cancelled;
+    QAtomicInteger<qint64> fetchedRows;
+    qint64 checksums = 0;
+    Method method = Local;
+    QStringList columns;
+    QList<int> keyColumns;
+    // single integer key is split by value, other keys by row number
+    bool integerKey = false;
+    QList<Row> rows;
+    bool truncated = false;
+    QString error;
+    QElapsedTimer report;
+    QMutex mutex;
+    TableDiff* owner = nullptr;
+};
+
+struct TableDiff::Side {
+    int index = 0;
+    QString connectionName;
+    QString table;
+    QString driverName;
+    QSqlRecord record;
+    QStringList primaryKey;
+    // escaped names
+    QString name;
+    QStringList columns;
+    QStringList keys;
+    // valid while running on side thread
+    QSqlDatabase db;
+    QString error;
+};
+
+struct TableDiff::Checksum {
+    qint64 count = 0;
+    QString hash;
+    // of integer key
+    QVariant min;
+    QVariant max;
+};
+
+namespace {
+
+bool isMysql(const QString& driverName) {
+    return driverName == DRIVER_MYSQL || driverName == DRIVER_MARIADB;
+}
+
+bool isIntegral(int type) {
+    switch (type) {
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::UChar:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void bindRange(QSqlQuery& q, const TableDiff::Range& range) {
+    for(const QVariant& value: range.from) {
+        q.addBindValue(value);
+    }
+    for(const QVariant& value: range.to) {
+        q.addBindValue(value);
+    }
+}
+
+QVariantList valuesAt(const QVariantList& values, const QList<int>& columns) {
+    QVariantList res;
+    for(int column: columns) {
+        res.append(values.value(column));
+    }
+    return res;
+}
+
+QVariantList recordValues(const QSqlQuery& q, int columns) {
+    QVariantList res;
+    res.reserve(columns);
+    for(int c=0;c<columns;c++) {
+        res.append(q.value(c));
+    }
+    return res;
+}
+
+}
+
+TableDiff::TableDiff(const QString &connectionName1, const QString &table1, const QString &connectionName2,
+                     const QString &table2, QObject *parent)
+    : QObject{parent}, mState(new State()), mConnectionName1(connectionName1), mTable1(table1),
+      mConnectionName2(connectionName2), mTable2(table2), mFanOut(16), mLeafRows(1000), mMaxRows(10000),
+      mFinished(false), mMethod(Local), mTruncated(false), mChecksums(0), mFetchedRows(0), mElapsed(0)
+{
+
+}
+
+TableDiff::~TableDiff()
+{
+    mState->cancelled.storeRelease(1);
+    QMutexLocker locker(&mState->mutex);
+    mState->owner = nullptr;
+}
+
+void TableDiff::setFanOut(int ranges)
+{
+    mFanOut = qMax(2, ranges);
+}
+
+void TableDiff::setLeafRows(int rows)
+{
+    mLeafRows = qMax(1, rows);
+}
+
+void TableDiff::setMaxRows(int rows)
+{
+    mMaxRows = qMax(1, rows);
+}
+
+void TableDiff::start()
+{
+    {
+        QMutexLocker locker(&mState->mutex);
+        mState->owner = nullptr;
+    }
+    mState.reset(new State());
+    mState->connectionName1 = mConnectionName1;
+    mState->table1 = mTable1;
+    mState->connectionName2 = mConnectionName2;
+    mState->table2 = mTable2;
+    mState->fanOut = mFanOut;
+    mState->leafRows = mLeafRows;
+    mState->maxRows = mMaxRows;
+    mState->owner = this;
+    mFinished = false;
+    mError.clear();
+    mRows.clear();
+    mTruncated = false;
+    mChecksums = 0;
+    mFetchedRows = 0;
+    mTime.start();
+    QSharedPointer<State> state = mState;
+    ConnectionPool::startWorker([state](){
+        run(state);
+    });
+}
+
+void TableDiff::cancel()
+{
+    mState->cancelled.storeRelease(1);
+}
+
+bool TableDiff::isFinished() const
+{
+    return mFinished;
+}
+
+QString TableDiff::error() const
+{
+    return mError;
+}
+
+TableDiff::Method TableDiff::method() const
+{
+    return mMethod;
+}
+
+QStringList TableDiff::columns() const
+{
+    return mColumns;
+}
+
+QList<int> TableDiff::keyColumns() const
+{
+    return mKeyColumns;
+}
+
+QList<TableDiff::Row> TableDiff::rows() const
+{
+    return mRows;
+}
+
+bool TableDiff::isTruncated() const
+{
+    return mTruncated;
+}
+
+qint64 TableDiff::checksums() const
+{
+    return mChecksums;
+}
+
+qint64 TableDiff::fetchedRows() const
+{
+    return mFetchedRows;
+}
+
+double TableDiff::seconds() const
+{
+    if (!mTime.isValid()) {
+        return 0;
+    }
+    return (mFinished ? mElapsed : mTime.elapsed()) / 1000.0;
+}
+
+QString TableDiff::checksumQuery(Method method, const QString &table, const QStringList &columns,
+                                 const QStringList &keys, const QString &where, bool minMax)
+{
+    QString select;
+    if (method == Crc32) {
+        // CONCAT_WS skips nulls, null flags tell null from empty
+        QStringList nulls;
+        for(const QString& column: columns) {
+            nulls.append(QString("ISNULL(%1)").arg(column));
+        }
+        select = QString("COUNT(*), COALESCE(BIT_XOR(CRC32(CONCAT_WS('#', %1, CONCAT(%2)))), 0)")
+                .arg(columns.join(", "), nulls.join(", "));
+    } else if (method == Md5) {
+        // sum of 64 bit prefixes of row hashes, string_agg would hit 1 GB text limit on large ranges
+        select = QString("COUNT(*), COALESCE(SUM(('x' || left(md5(ROW(%1)::text), 16))::bit(64)::bigint), 0)")
+                .arg(columns.join(", "));
+    } else {
+        select = columns.join(", ");
+    }
+    if (minMax && method != Local) {
+        select += QString(", MIN(%1), MAX(%1)").arg(keys.value(0));
+    }
+    return QString("SELECT %1 FROM %2 WHERE %3").arg(select, table, where);
+}
+
+QString TableDiff::rangeCondition(const QStringList &keys, const Range &range)
+{
+    QString tuple = keys.size() == 1 ? keys[0] : "(" + keys.join(", ") + ")";
+    QStringList placeholders(keys.size(), "?");
+    QString values = keys.size() == 1 ? QString("?") : "(" + placeholders.join(", ") + ")";
+    QStringList conditions;
+    if (!range.from.isEmpty()) {
+        conditions.append(tuple + " >= " + values);
+    }
+    if (!range.to.isEmpty()) {
+        conditions.append(tuple + " < " + values);
+    }
+    return conditions.isEmpty() ? QString("1 = 1") : conditions.join(" AND ");
+}
+
+QString TableDiff::rowText(const QVariantList &values)
+{
+    QString res;
+    for(const QVariant& value: values) {
+        if (value.isNull()) {
+            res.append("N;");
+            continue;
+        }
+        QString text;
+        switch (value.typeId()) {
+        case QMetaType::QByteArray:
+            text = QString::fromLatin1(value.toByteArray().toHex());
+            break;
+        case QMetaType::QDateTime:
+            text = value.toDateTime().toString(Qt::ISODateWithMs);
+            break;
+        case QMetaType::QDate:
+            text = value.toDate().toString(Qt::ISODate);
+            break;
+        case QMetaType::QTime:
+            text = value.toTime().toString(Qt::ISODateWithMs);
+            break;
+        case QMetaType::Float:
+        case QMetaType::Double:
+            text = QString::number(value.toDouble(), 'g', 17);
+            break;
+        case QMetaType::Bool:
+            text = QString::number(value.toInt());
+            break;
+        default:
+            text = value.toString();
+            break;
+        }
+        // length prefix keeps separators in values unambiguous
+        res.append(QString::number(text.size()));
+        res.append(':');
+        res.append(text);
+        res.append(';');
+    }
+    return res;
+}
+
+void TableDiff::run(QSharedPointer<State> state)
+{
+    TRACE_SCOPE("TableDiff::run");
+    QString error;
+    {
+        ConnectionLease lease(state->connectionName1);
+        QList<Side> sides(2);
+        sides[0].connectionName = state->connectionName1;
+        sides[0].table = state->table1;
+        sides[1].index = 1;
+        sides[1].connectionName = state->connectionName2;
+        sides[1].table = state->table2;
+        if (!lease.isValid()) {
+            error = lease.error();
+        } else {
+            sides[0].db = lease.database();
+            compare(state, sides, error);
+            sides[0].db = QSqlDatabase();
+        }
+    }
+    reconcile(state);
+    if (!error.isEmpty()) {
+        qDebug() << error << __FILE__ << __LINE__;
+    }
+    QMutexLocker locker(&state->mutex);
+    state->error = error;
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onFinished", Qt::QueuedConnection);
+    }
+}
+
+bool TableDiff::compare(QSharedPointer<State> state, QList<Side> &sides, QString &error)
+{
+    auto sideErrors = [&]() {
+        QStringList errors;
+        for(const Side& side: std::as_const(sides)) {
+            if (!side.error.isEmpty()) {
+                errors.append(QString("%1: %2").arg(side.connectionName, side.error));
+            }
+        }
+        return errors.join("\n");
+    };
+
+    bool ok = both(sides, [](Side& side) {
+        side.record = side.db.record(side.table);
+        if (side.record.isEmpty()) {
+            side.error = QString("Table %1 not found").arg(side.table);
+            return false;
+        }
+        side.driverName = side.db.driverName();
+        side.name = side.db.driver()->escapeIdentifier(side.table, QSqlDriver::TableName);
+        QSqlIndex primaryKey = side.db.primaryIndex(side.table);
+        for(int i=0;i<primaryKey.count();i++) {
+            side.primaryKey.append(primaryKey.fieldName(i));
+        }
+        return true;
+    });
+    if (!ok) {
+        error = sideErrors();
+        return false;
+    }
+
+    // columns of first table, second table should have them too
+    QStringList columns;
+    for(int c=0;c<sides[0].record.count();c++) {
+        columns.append(sides[0].record.fieldName(c));
+    }
+    QStringList keys = sides[0].primaryKey.isEmpty() ? sides[1].primaryKey : sides[0].primaryKey;
+    if (keys.isEmpty()) {
+        error = QString("Table %1 has no primary key").arg(state->table1);
+        return false;
+    }
+    QList<int> keyColumns;
+    for(const QString& key: std::as_const(keys)) {
+        int column = columns.indexOf(key);
+        if (column < 0) {
+            error = QString("Key column %1 not found in %2").arg(key, state->table1);
+            return false;
+        }
+        keyColumns.append(column);
+    }
+    ok = both(sides, [&](Side& side) {
+        for(const QString& column: std::as_const(columns)) {
+            if (!side.record.contains(column)) {
+                side.error = QString("Column %1 not found in %2").arg(column, side.table);
+                return false;
+            }
+            side.columns.append(side.db.driver()->escapeIdentifier(column, QSqlDriver::FieldName));
+        }
+        for(int column: std::as_const(keyColumns)) {
+            side.keys.append(side.columns[column]);
+        }
+        return true;
+    });
+    if (!ok) {
+        error = sideErrors();
+        return false;
+    }
+
+    Method method = Local;
+    if (sides[0].driverName == sides[1].driverName) {
+        if (isMysql(sides[0].driverName)) {
+            method = Crc32;
+        } else if (sides[0].driverName == DRIVER_PSQL) {
+            method = Md5;
+        }
+    }
+    state->method = method;
+    state->columns = columns;
+    state->keyColumns = keyColumns;
+    state->integerKey = keys.size() == 1 && isIntegral(sides[0].record.field(keys[0]).metaType().id());
+    state->report.start();
+
+    // depth first, pending ranges are at most depth * fanOut
+    QList<Range> ranges = {Range()};
+    while (!ranges.isEmpty()) {
+        if (state->cancelled.loadAcquire()) {
+            error = "Cancelled";
+            return false;
+        }
+        Range range = ranges.takeLast();
+        QList<Checksum> checksums(2);
+        if (!both(sides, [&](Side& side) { return checksum(state, side, range, checksums[side.index]); })) {
+            error = sideErrors();
+            return false;
+        }
+        state->checksums++;
+        if (checksums[0].count == checksums[1].count && checksums[0].hash == checksums[1].hash) {
+            postProgress(state);
+            continue;
+        }
+        QList<Range> subranges;
+        if (qMax(checksums[0].count, checksums[1].count) > state->leafRows
+                && !split(state, sides, range, checksums, subranges)) {
+            error = sideErrors();
+            return false;
+        }
+        if (subranges.size() > 1) {
+            for(int i=subranges.size()-1;i>=0;i--) {
+                ranges.append(subranges[i]);
+            }
+            continue;
+        }
+        QList<QList<QVariantList>> rows(2);
+        if (!both(sides, [&](Side& side) { return fetch(state, side, range, rows[side.index]); })) {
+            error = sideErrors();
+            return false;
+        }
+        diff(state, rows[0], rows[1]);
+        postProgress(state);
+        if (state->truncated) {
+            break;
+        }
+    }
+    return true;
+}
+
+bool TableDiff::both(QList<Side> &sides, const std::function<bool(Side &)> &fn)
+{
+    Side& second = sides[1];
+    bool ok = false;
+    QSemaphore done;
+    ConnectionPool::startWorker([&](){
+        {
+            ConnectionLease lease(second.connectionName);
+            if (!lease.isValid()) {
+                second.error = lease.error();
+            } else {
+                second.db = lease.database();
+                ok = fn(second);
+                second.db = QSqlDatabase();
+            }
+        }
+        done.release();
+    });
+    bool first = fn(sides[0]);
+    done.acquire();
+    return first && ok;
+}
+
+bool TableDiff::checksum(QSharedPointer<State> state, Side &side, const Range &range, Checksum &result)
+{
+    TRACE_SCOPE("TableDiff::checksum");
+    QString where = rangeCondition(side.keys, range);
+    QSqlQuery q(side.db);
+    q.setForwardOnly(true);
+    if (!q.prepare(checksumQuery(state->method, side.name, side.columns, side.keys, where, state->integerKey))) {
+        side.error = q.lastError().text();
+        return false;
+    }
+    bindRange(q, range);
+    if (!q.exec()) {
+        side.error = q.lastError().text();
+        return false;
+    }
+    if (state->method != Local) {
+        if (!q.next()) {
+            side.error = q.lastError().text();
+            return false;
+        }
+        result.count = q.value(0).toLongLong();
+        result.hash = q.value(1).toString();
+        if (state->integerKey) {
+            result.min = q.value(2);
+            result.max = q.value(3);
+        }
+        return true;
+    }
+    // rows are read but not kept
+    quint64 hash = 0;
+    int columns = side.columns.size();
+    int key = state->keyColumns.value(0);
+    while (q.next()) {
+        QVariantList values = recordValues(q, columns);
+        hash ^= qHash(rowText(values), 0);
+        result.count++;
+        if (state->integerKey) {
+            qint64 value = values[key].toLongLong();
+            if (result.min.isNull() || value < result.min.toLongLong()) {
+                result.min = value;
+            }
+            if (result.max.isNull() || value > result.max.toLongLong()) {
+                result.max = value;
+            }
+        }
+    }
+    if (q.lastError().isValid()) {
+        side.error = q.lastError().text();
+        return false;
+    }
+    result.hash = QString::number(hash);
+    return true;
+}
+
+bool TableDiff::split(QSharedPointer<State> state, QList<Side> &sides, const Range &range,
+                      const QList<Checksum> &checksums, QList<Range> &ranges)
+{
+    TRACE_SCOPE("TableDiff::split");
+    int fanOut = state->fanOut;
+    if (state->integerKey) {
+        // equal width value ranges between min and max of both sides
+        bool found = false;
+        qint64 min = 0;
+        qint64 max = 0;
+        for(const Checksum& checksum: checksums) {
+            if (checksum.count == 0 || checksum.min.isNull()) {
+                continue;
+            }
+            min = found ? qMin(min, checksum.min.toLongLong()) : checksum.min.toLongLong();
+            max = found ? qMax(max, checksum.max.toLongLong()) : checksum.max.toLongLong();
+            found = true;
+        }
+        if (!found || max - min < 1) {
+            return true;
+        }
+        qint64 width = (max - min) / fanOut + 1;
+        for(qint64 from = min; from <= max; from += width) {
+            ranges.append({{from}, {qMin(from + width, max + 1)}});
+        }
+        return true;
+    }
+    // boundaries every count / fanOut rows of larger side
+    int larger = checksums[0].count >= checksums[1].count ? 0 : 1;
+    qint64 step = qMax(qint64(1), checksums[larger].count / fanOut);
+    QList<QVariantList> boundaries;
+    bool ok = both(sides, [&](Side& side) {
+        if (side.index != larger) {
+            return true;
+        }
+        QString keys = side.keys.join(", ");
+        QSqlQuery q(side.db);
+        q.setForwardOnly(true);
+        QString query = QString("SELECT %1 FROM (SELECT %1, ROW_NUMBER() OVER (ORDER BY %1) AS mugi_row "
+                                "FROM %2 WHERE %3) b WHERE mugi_row % %4 = 0 ORDER BY mugi_row")
+                .arg(keys, side.name, rangeCondition(side.keys, range)).arg(step);
+        if (!q.prepare(query)) {
+            side.error = q.lastError().text();
+            return false;
+        }
+        bindRange(q, range);
+        if (!q.exec()) {
+            side.error = q.lastError().text();
+            return false;
+        }
+        while (q.next()) {
+            boundaries.append(recordValues(q, side.keys.size()));
+        }
+        return true;
+    });
+    if (!ok) {
+        return false;
+    }
+    QVariantList from = range.from;
+    for(const QVariantList& boundary: std::as_const(boundaries)) {
+        if (boundary == from) {
+            continue;
+        }
+        ranges.append({from, boundary});
+        from = boundary;
+    }
+    if (!ranges.isEmpty()) {
+        ranges.append({from, range.to});
+    }
+    return true;
+}
+
+bool TableDiff::fetch(QSharedPointer<State> state, Side &side, const Range &range, QList<QVariantList> &rows)
+{
+    TRACE_SCOPE("TableDiff::fetch");
+    QSqlQuery q(side.db);
+    q.setForwardOnly(true);
+    if (!q.prepare(checksumQuery(Local, side.name, side.columns, side.keys, rangeCondition(side.keys, range), false))) {
+        side.error = q.lastError().text();
+        return false;
+    }
+    bindRange(q, range);
+    if (!q.exec()) {
+        side.error = q.lastError().text();
+        return false;
+    }
+    int columns = side.columns.size();
+    while (q.next()) {
+        rows.append(recordValues(q, columns));
+    }
+    state->fetchedRows.fetchAndAddOrdered(rows.size());
+    return true;
+}
+
+void TableDiff::diff(QSharedPointer<State> state, const QList<QVariantList> &rows1, const QList<QVariantList> &rows2)
+{
+    // keys are matched by value, not by order, servers may sort text differently
+    QHash<QString, int> index2;
+    for(int i=0;i<rows2.size();i++) {
+        index2.insert(rowText(valuesAt(rows2[i], state->keyColumns)), i);
+    }
+    auto append = [&](const Row& row) {
+        if (state->rows.size() >= state->maxRows) {
+            state->truncated = true;
+            return;
+        }
+        state->rows.append(row);
+    };
+    QSet<int> matched;
+    for(const QVariantList& row1: rows1) {
+        int i = index2.value(rowText(valuesAt(row1, state->keyColumns)), -1);
+        if (i < 0) {
+            append({Removed, row1, QVariantList()});
+            continue;
+        }
+        matched.insert(i);
+        if (rowText(row1) != rowText(rows2[i])) {
+            append({Changed, row1, rows2[i]});
+        }
+    }
+    for(int i=0;i<rows2.size();i++) {
+        if (!matched.contains(i)) {
+            append({Inserted, QVariantList(), rows2[i]});
+        }
+    }
+}
+
+void TableDiff::reconcile(QSharedPointer<State> state)
+{
+    QHash<QString, int> removed;
+    for(int i=0;i<state->rows.size();i++) {
+        const Row& row = state->rows[i];
+        if (row.change == Removed) {
+            removed.insert(rowText(valuesAt(row.values1, state->keyColumns)), i);
+        }
+    }
+    if (removed.isEmpty()) {
+        return;
+    }
+    QSet<int> dropped;
+    for(int i=0;i<state->rows.size();i++) {
+        const Row& row = state->rows[i];
+        if (row.change != Inserted) {
+            continue;
+        }
+        int j = removed.value(rowText(valuesAt(row.values2, state->keyColumns)), -1);
+        if (j < 0) {
+            continue;
+        }
+        Row& other = state->rows[j];
+        if (rowText(other.values1) == rowText(row.values2)) {
+            dropped.insert(j);
+        } else {
+            other.change = Changed;
+            other.values2 = row.values2;
+        }
+        dropped.insert(i);
+    }
+    QList<Row> rows;
+    for(int i=0;i<state->rows.size();i++) {
+        if (!dropped.contains(i)) {
+            rows.append(state->rows[i]);
+        }
+    }
+    state->rows = rows;
+}
+
+void TableDiff::postProgress(QSharedPointer<State> state)
+{
+    if (state->report.elapsed() < progressMs) {
+        return;
+    }
+    state->report.restart();
+    QMutexLocker locker(&state->mutex);
+    if (state->owner) {
+        QMetaObject::invokeMethod(state->owner, "onProgress", Qt::QueuedConnection,
+                                  Q_ARG(qint64, state->checksums), Q_ARG(qint64, state->fetchedRows.loadAcquire()),
+                                  Q_ARG(int, state->rows.size()));
+    }
+}
+
+void TableDiff::onProgress(qint64 checksums, qint64 fetchedRows, int differences)
+{
+    Q_UNUSED(differences);
+    mChecksums = checksums;
+    mFetchedRows = fetchedRows;
+    emit progress();
+}
+
+void TableDiff::onFinished()
+{
+    {
+        QMutexLocker locker(&mState->mutex);
+        mError = mState->error;
+        mMethod = mState->method;
+        mColumns = mState->columns;
+        mKeyColumns = mState->keyColumns;
+        mRows = mState->rows;
+        mTruncated = mState->truncated;
+        mChecksums = mState->checksums;
+        mFetchedRows = mState->fetchedRows.loadAcquire();
+    }
+    mElapsed = mTime.elapsed();
+    mFinished = true;
+    emit finished();
+}
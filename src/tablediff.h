@@ -0,0 +1,132 @@
+#ifndef TABLEDIFF_H
+#define TABLEDIFF_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVariantList>
+#include <QElapsedTimer>
+#include <functional>
+
+// Compares table on two connections without fetching it. Rows are split into primary key
+// ranges, each server computes count and checksum of range (BIT_XOR(CRC32()) on mysql,
+// SUM() of md5 prefixes on postgres), mismatching ranges are split further and only ranges of
+// at most leafRows rows are fetched and compared row by row. Connections with different drivers
+// or without checksum functions (sqlite) hash rows of range locally: same narrowing, but
+// every checked range is read.
+
+class TableDiff : public QObject
+{
+    Q_OBJECT
+public:
+    enum Method {
+        Crc32,
+        Md5,
+        Local
+    };
+
+    enum Change {
+        Changed,
+        // only in first table
+        Removed,
+        // only in second table
+        Inserted
+    };
+
+    struct Row {
+        Change change;
+        QVariantList values1;
+        QVariantList values2;
+    };
+
+    // key range, from is inclusive, to is exclusive, empty bound is unbounded
+    struct Range {
+        QVariantList from;
+        QVariantList to;
+    };
+
+    TableDiff(const QString& connectionName1, const QString& table1,
+              const QString& connectionName2, const QString& table2, QObject* parent = nullptr);
+    ~TableDiff();
+
+    // subranges of mismatching range
+    void setFanOut(int ranges);
+    // ranges with at most this many rows are fetched
+    void setLeafRows(int rows);
+    // comparison stops after this many differences
+    void setMaxRows(int rows);
+
+    void start();
+    void cancel();
+
+    bool isFinished() const;
+    QString error() const;
+    Method method() const;
+    QStringList columns() const;
+    QList<int> keyColumns() const;
+    QList<Row> rows() const;
+    // stopped at maxRows differences
+    bool isTruncated() const;
+    // ranges checksummed on each side
+    qint64 checksums() const;
+    // rows fetched from both sides
+    qint64 fetchedRows() const;
+    double seconds() const;
+
+    // columns, keys and where are escaped, minMax adds MIN and MAX of first key column
+    static QString checksumQuery(Method method, const QString& table, const QStringList& columns,
+                                 const QStringList& keys, const QString& where, bool minMax);
+    // condition with placeholders for from and to values
+    static QString rangeCondition(const QStringList& keys, const Range& range);
+    // unambiguous text of values, used for local checksums and row comparison
+    static QString rowText(const QVariantList& values);
+
+    static const int progressMs = 200;
+
+signals:
+    void progress();
+    void finished();
+
+protected slots:
+    void onProgress(qint64 checksums, qint64 fetchedRows, int differences);
+    void onFinished();
+
+protected:
+    struct State;
+    struct Side;
+    struct Checksum;
+    static void run(QSharedPointer<State> state);
+    static bool compare(QSharedPointer<State> state, QList<Side>& sides, QString& error);
+    // runs fn on both sides at the same time, second side on pooled thread
+    static bool both(QList<Side>& sides, const std::function<bool(Side&)>& fn);
+    static bool checksum(QSharedPointer<State> state, Side& side, const Range& range, Checksum& result);
+    static bool split(QSharedPointer<State> state, QList<Side>& sides, const Range& range, const QList<Checksum>& checksums,
+                      QList<Range>& ranges);
+    static bool fetch(QSharedPointer<State> state, Side& side, const Range& range, QList<QVariantList>& rows);
+    static void diff(QSharedPointer<State> state, const QList<QVariantList>& rows1, const QList<QVariantList>& rows2);
+    // matches rows removed from one range and inserted in another (different key order on servers)
+    static void reconcile(QSharedPointer<State> state);
+    static void postProgress(QSharedPointer<State> state);
+
+    QSharedPointer<State> mState;
+    QString mConnectionName1;
+    QString mTable1;
+    QString mConnectionName2;
+    QString mTable2;
+    int mFanOut;
+    int mLeafRows;
+    int mMaxRows;
+    bool mFinished;
+    QString mError;
+    Method mMethod;
+    QStringList mColumns;
+    QList<int> mKeyColumns;
+    QList<Row> mRows;
+    bool mTruncated;
+    qint64 mChecksums;
+    qint64 mFetchedRows;
+    QElapsedTimer mTime;
+    qint64 mElapsed;
+};
+
+#endif // TABLEDIFF_H
@@ -0,0 +1,40 @@
+#ifndef TESTUTILS_H
+#define TESTUTILS_H
+
+#include <QFile>
+#include <QSignalSpy>
+
+// Fixtures shared by tests
+
+namespace TestUtils {
+
+// returns path or empty string if file cannot be written
+inline QString writeFile(const QString& path, const QByteArray& data) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+    file.write(data);
+    return path;
+}
+
+inline QByteArray readFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+// calls start() and waits for finished() signal of background job, true if job finished in time,
+// signal emitted synchronously by start() is not waited for again
+template<typename Job, typename Start>
+bool waitFinished(Job* job, Start start, int timeout = 30000) {
+    QSignalSpy finished(job, SIGNAL(finished()));
+    start();
+    return (finished.count() > 0 || finished.wait(timeout)) && job->isFinished();
+}
+
+}
+
+#endif // TESTUTILS_H
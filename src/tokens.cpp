@@ -7,6 +7,7 @@
 #include <QSqlField>
 #include <QDebug>
 #include "drivernames.h"
+#include "trace.h"
 #include <algorithm>
 
 QStringList tableFields(QSqlDatabase db, const QString& table) {
@@ -96,6 +97,7 @@ QString odbcType(const QSqlField& , QString& ) {
 
 Tokens::Tokens(QSqlDatabase db)
 {
+    TRACE_SCOPE("Tokens");
     QStringList tableNames = db.tables();
     foreach(const QString& tableName, tableNames) {
         Table table;
@@ -10,8 +10,17 @@
 #include <QDebug>
 #include "toolmysqldumpdialog.h"
 #include <QDesktopServices>
+#include "dumpprocesspool.h"
+#include "nativedump.h"
+#include "parallelrestore.h"
+#include "tablecopy.h"
+#include "toolcopydialog.h"
+#include "dumpwidget.h"
+#include "showandraise.h"
 
 #include <QFile>
+#include <QFileInfo>
+#include <QDir>
 #include <QTextStream>
 
 void dump(const QString& path, const QStringList& lines) {
@@ -96,6 +105,27 @@ static QStringList mysqldump_args(QSqlDatabase db, bool ssl, bool schema, bool d
     return args;
 }
 
+static QString result_dir(const MysqldumpSettings& settings, const QString& connectionName) {
+    QString dateTime = QDateTime::currentDateTime().toString("yyyy-MM-dd_hhmmss");
+    QString resultDir;
+    switch(settings.path) {
+    case MysqldumpSettings::DatabaseName:
+        resultDir = pathJoin({settings.output, connectionName});
+        break;
+    case MysqldumpSettings::DatabaseDatetimeName:
+        resultDir = pathJoin({settings.output, connectionName, dateTime});
+        break;
+    default:
+        qDebug() << "not implemented" << settings.path << __FILE__ << __LINE__;
+        return QString();
+    }
+    QDir dir(resultDir);
+    if (!dir.exists()) {
+        dir.mkpath(resultDir);
+    }
+    return resultDir;
+}
+
 static bool find_mysql(QWidget* widget, bool mysql) {
     Settings* settings = Settings::instance();
     QString path = mysql ? settings->mysqlPath() : settings->mysqldumpPath();
@@ -156,6 +186,26 @@ void Tools::mysql(QSqlDatabase db, QWidget *widget)
         return;
     }
 
+    if (dialog.parallel()) {
+        QStringList files;
+        for(const QString& path: dialog.files()) {
+            if (path.endsWith(".sql", Qt::CaseInsensitive) || path.endsWith(".sql.gz", Qt::CaseInsensitive)) {
+                files.append(path);
+            }
+        }
+        if (files.isEmpty()) {
+            return;
+        }
+        ParallelRestore* restore = new ParallelRestore(db.connectionName());
+        restore->setDeferChecks(dialog.deferChecks());
+        restore->start(files, dialog.jobs(), ParallelRestore::databaseReferences(db));
+        DumpWidget* view = new DumpWidget();
+        view->setAttribute(Qt::WA_DeleteOnClose);
+        view->init(restore, QFileInfo(files[0]).dir().path(), QString("Restore %1").arg(db.connectionName()));
+        showAndRaise(view);
+        return;
+    }
+
     if (!find_mysql(widget, true)) {
         return;
     }
@@ -230,25 +280,12 @@ void Tools::mysqldump(QSqlDatabase db, QWidget *widget)
     MysqldumpSettings settings = dialog.settings();
     QString connectionName = db.connectionName();
     QStringList tables = settings.tables;
-    QString dateTime = QDateTime::currentDateTime().toString("yyyy-MM-dd_hhmmss");
-
-    QString resultDir;
-    switch(settings.path) {
-    case MysqldumpSettings::DatabaseName:
-        resultDir = pathJoin({settings.output, connectionName});
-        break;
-    case MysqldumpSettings::DatabaseDatetimeName:
-        resultDir = pathJoin({settings.output, connectionName, dateTime});
-        break;
-    default:
-        qDebug() << "not implemented" << settings.path << __FILE__ << __LINE__;
-        break;
+    QString resultDir = result_dir(settings, connectionName);
+    if (resultDir.isEmpty()) {
+        return;
     }
 
-    QDir dir(resultDir);
-    if (!dir.exists()) {
-        dir.mkpath(resultDir);
-    }
+    DumpProcessPool* pool = new DumpProcessPool(mysqldump);
 
     if (settings.format == MysqldumpSettings::OneFile) {
 
@@ -262,39 +299,28 @@ void Tools::mysqldump(QSqlDatabase db, QWidget *widget)
         }
 
         QString resultFile = pathJoin({resultDir, name + ".sql"});
-
-        QProgressDialog progress;
-        progress.setMaximum(0);
-        progress.show();
-
         QStringList args = mysqldump_args(db, settings.ssl, settings.schema, settings.data, tables, resultFile);
-        execute(mysqldump, args, QString(), MYSQLDUMP_TIMEOUT, widget);
+        pool->append(name + ".sql", args, resultFile);
 
     } else if (settings.format == MysqldumpSettings::MultipleFiles) {
 
-        QStringList resultFiles;
-
         for(const QString& table: tables) {
-            QString path = pathJoin({resultDir, table + ".sql"});
-            resultFiles.append(path);
+            QString resultFile = pathJoin({resultDir, table + ".sql"});
+            QStringList args = mysqldump_args(db, settings.ssl, settings.schema, settings.data, {table}, resultFile);
+            pool->append(table, args, resultFile);
         }
 
-        QProgressDialog progress;
-        progress.setMaximum(tables.size());
-        progress.show();
-        qApp->processEvents();
-        for(int i=0;i<tables.size();i++) {
-            QStringList args = mysqldump_args(db, settings.ssl, settings.schema, settings.data, tables.mid(i, 1), resultFiles[i]);
-            execute(mysqldump, args, QString(), MYSQLDUMP_TIMEOUT, widget);
-            progress.setValue(i);
-            progress.setLabelText(tables[i]);
-            qApp->processEvents();
-        }
-        progress.close();
     } else {
         qDebug() << "not implemented" << settings.format << __FILE__ << __LINE__;
+        delete pool;
+        return;
     }
 
+    DumpWidget* view = new DumpWidget();
+    view->setAttribute(Qt::WA_DeleteOnClose);
+    view->init(pool, resultDir, QString("Mysqldump %1").arg(connectionName));
+    showAndRaise(view);
+    pool->start(settings.jobs);
 
 #if 0
     QStringList tables = dialog.tables();
@@ -469,3 +495,54 @@ void Tools::mysqldump(QSqlDatabase db, QWidget *widget)
 #endif
 
 }
+
+void Tools::dump(QSqlDatabase db, QWidget *widget)
+{
+    ToolMysqldumpDialog dialog(db, widget);
+    dialog.setNative(true);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    MysqldumpSettings settings = dialog.settings();
+    QString connectionName = db.connectionName();
+    QString resultDir = result_dir(settings, connectionName);
+    if (resultDir.isEmpty()) {
+        return;
+    }
+
+    NativeDump* dump = new NativeDump(connectionName);
+    dump->setFormat(settings.csv ? NativeDump::Csv : NativeDump::Sql);
+    dump->setCompress(settings.compress);
+    dump->setSchema(settings.schema);
+    dump->setData(settings.data);
+
+    DumpWidget* view = new DumpWidget();
+    view->setAttribute(Qt::WA_DeleteOnClose);
+    dump->start(settings.tables, resultDir, settings.jobs);
+    view->init(dump, resultDir, QString("Dump %1").arg(connectionName));
+    showAndRaise(view);
+}
+
+TableCopy* Tools::copy(QSqlDatabase db, const QStringList &targets, QWidget *widget)
+{
+    ToolCopyDialog dialog(db, targets, widget);
+    if (dialog.exec() != QDialog::Accepted) {
+        return nullptr;
+    }
+
+    CopySettings settings = dialog.settings();
+    QString connectionName = db.connectionName();
+
+    TableCopy* copy = new TableCopy(connectionName, settings.target);
+    copy->setCreateTables(settings.createTables);
+    copy->setBatchRows(settings.batchRows);
+
+    DumpWidget* view = new DumpWidget();
+    view->setAttribute(Qt::WA_DeleteOnClose);
+    copy->start(settings.tables);
+    view->init(copy, QString("%1 to %2").arg(connectionName, settings.target),
+               QString("Copy %1 to %2").arg(connectionName, settings.target));
+    showAndRaise(view);
+    return copy;
+}
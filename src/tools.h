@@ -3,12 +3,17 @@
 
 #include <QSqlDatabase>
 class QWidget;
+class TableCopy;
 
 class Tools
 {
 public:
     static void mysql(QSqlDatabase db, QWidget* widget);
     static void mysqldump(QSqlDatabase db, QWidget* widget);
+    // NativeDump of selected tables, any driver
+    static void dump(QSqlDatabase db, QWidget* widget);
+    // TableCopy of selected tables to one of targets, nullptr if dialog is rejected
+    static TableCopy* copy(QSqlDatabase db, const QStringList& targets, QWidget* widget);
 };
 
 #endif // TOOLS_H
@@ -0,0 +1,286 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QTimer>
+#include <vector>
+
+struct Trace::Buffer {
+    int tid = 0;
+    QString name;
+    QMutex mutex;
+    std::vector<Event> events;
+    int next = 0;
+    // open spans, read by watchdog from its own thread
+    std::atomic<const char*> stack[Trace::maxDepth];
+    std::atomic<int> depth{0};
+};
+
+// Gui thread bumps heartbeat from timer, watchdog thread polls it and records
+// "stall" span with gui span stack sampled when heartbeat is late for threshold
+
+class TraceWatchdog : public QThread
+{
+public:
+    TraceWatchdog(Trace::Buffer* gui) : mGui(gui), mBeat(Trace::now()), mStop(false) {
+        mHeartbeat.setInterval(interval());
+        QObject::connect(&mHeartbeat, &QTimer::timeout, [this](){
+            mBeat.store(Trace::now(), std::memory_order_relaxed);
+        });
+    }
+
+    void startWatch() {
+        mBeat.store(Trace::now());
+        mHeartbeat.start();
+        start();
+    }
+
+    void stopWatch() {
+        mStop.store(true);
+        mHeartbeat.stop();
+        wait();
+    }
+
+protected:
+    static int interval() {
+        return qMax(10, Trace::instance()->stallThreshold() / 4);
+    }
+
+    void run() override {
+        qint64 stallStart = -1;
+        QString stack;
+        while (!mStop.load()) {
+            msleep(interval());
+            qint64 beat = mBeat.load(std::memory_order_relaxed);
+            if (stallStart < 0) {
+                if (Trace::now() - beat > qint64(Trace::instance()->stallThreshold()) * 1000) {
+                    stallStart = beat;
+                    stack = Trace::instance()->guiStack().join(" > ");
+                }
+            } else if (beat > stallStart) {
+                Trace::append(mGui, {"stall", 'X', stallStart, beat - stallStart, 0, stack.isEmpty() ? QString("-") : stack});
+                stallStart = -1;
+            }
+        }
+    }
+
+    Trace::Buffer* mGui;
+    QTimer mHeartbeat;
+    std::atomic<qint64> mBeat;
+    std::atomic<bool> mStop;
+};
+
+Trace* Trace::mInstance = nullptr;
+std::atomic<bool> Trace::mEnabled{false};
+
+static thread_local Trace::Buffer* tBuffer = nullptr;
+
+Trace::Trace() : mGuiBuffer(nullptr), mWatchdog(nullptr), mStallThreshold(200)
+{
+
+}
+
+Trace *Trace::instance()
+{
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (!mInstance) {
+        mInstance = new Trace();
+    }
+    return mInstance;
+}
+
+static bool isGuiThread() {
+    QCoreApplication* app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
+void Trace::setEnabled(bool enabled)
+{
+    mEnabled.store(enabled);
+    if (!isGuiThread()) {
+        return;
+    }
+    if (enabled && !mWatchdog) {
+        mGuiBuffer = buffer();
+        mWatchdog = new TraceWatchdog(mGuiBuffer);
+        mWatchdog->startWatch();
+    } else if (!enabled && mWatchdog) {
+        mWatchdog->stopWatch();
+        delete mWatchdog;
+        mWatchdog = nullptr;
+    }
+}
+
+void Trace::clear()
+{
+    QMutexLocker locker(&mMutex);
+    for(Buffer* buffer: std::as_const(mBuffers)) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->events.clear();
+        buffer->next = 0;
+    }
+}
+
+qint64 Trace::now()
+{
+    static QElapsedTimer timer = [](){
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return timer.nsecsElapsed() / 1000;
+}
+
+Trace::Buffer *Trace::buffer()
+{
+    if (tBuffer) {
+        return tBuffer;
+    }
+    Trace* trace = instance();
+    QMutexLocker locker(&trace->mMutex);
+    Buffer* buffer = new Buffer();
+    buffer->tid = trace->mBuffers.size() + 1;
+    if (isGuiThread()) {
+        buffer->name = "gui";
+    } else {
+        QString name = QThread::currentThread()->objectName();
+        buffer->name = QString("%1 %2").arg(name.isEmpty() ? QString("thread") : name).arg(buffer->tid);
+    }
+    // buffers outlive threads so their events can still be saved
+    trace->mBuffers.append(buffer);
+    tBuffer = buffer;
+    return buffer;
+}
+
+void Trace::begin(Buffer *buffer, const char *name)
+{
+    int depth = buffer->depth.load(std::memory_order_relaxed);
+    if (depth < maxDepth) {
+        buffer->stack[depth].store(name, std::memory_order_relaxed);
+    }
+    buffer->depth.store(depth + 1, std::memory_order_release);
+}
+
+void Trace::end(Buffer *buffer, const char *name, qint64 start)
+{
+    buffer->depth.fetch_sub(1, std::memory_order_release);
+    append(buffer, {name, 'X', start, now() - start, 0, QString()});
+}
+
+void Trace::append(Buffer *buffer, const Event &event)
+{
+    QMutexLocker locker(&buffer->mutex);
+    if (buffer->events.size() < size_t(bufferSize)) {
+        buffer->events.push_back(event);
+    } else {
+        buffer->events[buffer->next] = event;
+    }
+    buffer->next = (buffer->next + 1) % bufferSize;
+}
+
+void Trace::counter(const char *name, qint64 value)
+{
+    append(buffer(), {name, 'C', now(), 0, value, QString()});
+}
+
+void Trace::instant(const char *name, const QString &args)
+{
+    append(buffer(), {name, 'i', now(), 0, 0, args});
+}
+
+QStringList Trace::guiStack()
+{
+    QStringList res;
+    Buffer* buffer = mGuiBuffer;
+    if (!buffer) {
+        return res;
+    }
+    int depth = qMin(buffer->depth.load(std::memory_order_acquire), int(maxDepth));
+    for(int i=0;i<depth;i++) {
+        res.append(buffer->stack[i].load(std::memory_order_relaxed));
+    }
+    return res;
+}
+
+void Trace::setStallThreshold(int ms)
+{
+    mStallThreshold.store(ms);
+}
+
+int Trace::stallThreshold() const
+{
+    return mStallThreshold.load();
+}
+
+static QJsonObject toJson(const Trace::Event& event, int tid) {
+    QJsonObject obj;
+    obj["name"] = event.name;
+    obj["ph"] = QString(QChar(event.phase));
+    obj["ts"] = event.ts;
+    obj["pid"] = 1;
+    obj["tid"] = tid;
+    switch (event.phase) {
+    case 'X':
+        obj["dur"] = event.dur;
+        if (!event.args.isEmpty()) {
+            obj["args"] = QJsonObject {{"stack", event.args}};
+        }
+        break;
+    case 'C':
+        obj["args"] = QJsonObject {{"value", event.value}};
+        break;
+    case 'i':
+        obj["s"] = "t";
+        if (!event.args.isEmpty()) {
+            obj["args"] = QJsonObject {{"args", event.args}};
+        }
+        break;
+    }
+    return obj;
+}
+
+QByteArray Trace::toJson()
+{
+    QJsonArray events;
+    QMutexLocker locker(&mMutex);
+    for(Buffer* buffer: std::as_const(mBuffers)) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = 1;
+        meta["tid"] = buffer->tid;
+        meta["args"] = QJsonObject {{"name", buffer->name}};
+        events.append(meta);
+        // oldest first when ring is wrapped
+        int count = int(buffer->events.size());
+        int first = count < bufferSize ? 0 : buffer->next;
+        for(int i=0;i<count;i++) {
+            events.append(::toJson(buffer->events[(first + i) % count], buffer->tid));
+        }
+    }
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool Trace::save(const QString &path, QString &error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    if (file.write(toJson()) < 0) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMutex>
+#include <QList>
+#include <atomic>
+
+// In-process tracing of spans and counters into per-thread ring buffers, exported as
+// Chrome trace-event json (chrome://tracing, ui.perfetto.dev). TRACE_ macros compile to
+// nothing unless built with WITH_TRACE, compiled in they cost one relaxed load while
+// tracing is off. Watchdog records span stack of gui thread when event loop stalls.
+
+class TraceWatchdog;
+
+class Trace
+{
+public:
+    struct Event {
+        const char* name;
+        // X - span, C - counter, i - instant
+        char phase;
+        // microseconds since start
+        qint64 ts;
+        qint64 dur;
+        qint64 value;
+        QString args;
+    };
+
+    struct Buffer;
+
+    static Trace* instance();
+
+    static bool isEnabled() {
+        return mEnabled.load(std::memory_order_relaxed);
+    }
+
+    // starts watchdog when called from gui thread
+    void setEnabled(bool enabled);
+
+    void clear();
+
+    void counter(const char* name, qint64 value);
+    void instant(const char* name, const QString& args = QString());
+
+    QByteArray toJson();
+    bool save(const QString& path, QString& error);
+
+    // names of open spans of gui thread, outermost first
+    QStringList guiStack();
+
+    void setStallThreshold(int ms);
+    int stallThreshold() const;
+
+    static qint64 now();
+
+    // internal, used by TraceScope
+    static Buffer* buffer();
+    static void begin(Buffer* buffer, const char* name);
+    static void end(Buffer* buffer, const char* name, qint64 start);
+    static void append(Buffer* buffer, const Event& event);
+
+    static const int bufferSize = 65536;
+    static const int maxDepth = 32;
+
+protected:
+    Trace();
+    static Trace* mInstance;
+    static std::atomic<bool> mEnabled;
+
+    QMutex mMutex;
+    QList<Buffer*> mBuffers;
+    Buffer* mGuiBuffer;
+    TraceWatchdog* mWatchdog;
+    std::atomic<int> mStallThreshold;
+};
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name) : mName(name), mBuffer(nullptr), mStart(0) {
+        if (Trace::isEnabled()) {
+            mBuffer = Trace::buffer();
+            mStart = Trace::now();
+            Trace::begin(mBuffer, name);
+        }
+    }
+    ~TraceScope() {
+        if (mBuffer) {
+            Trace::end(mBuffer, mName, mStart);
+        }
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+protected:
+    const char* mName;
+    Trace::Buffer* mBuffer;
+    qint64 mStart;
+};
+
+// name must be string literal (pointer is stored)
+
+#ifdef HAVE_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_COUNTER(name, value) do { if (Trace::isEnabled()) { Trace::instance()->counter(name, value); } } while (0)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,101 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include "asyncconnector.h"
+#include "drivernames.h"
+
+class tst_AsyncConnector : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testConnect();
+    void testParallel();
+    void testFailed();
+    void testCancel();
+
+protected:
+    QTemporaryDir mDir;
+    ConnectionParams params(const QString& connectionName, const QString& path) const;
+};
+
+void tst_AsyncConnector::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "init");
+    db.setDatabaseName(mDir.filePath("test.sqlite"));
+    QVERIFY(db.open());
+    QSqlQuery q(db);
+    QVERIFY(q.exec("create table t(id int)"));
+    QVERIFY(q.exec("insert into t values (1), (2), (3)"));
+}
+
+ConnectionParams tst_AsyncConnector::params(const QString &connectionName, const QString &path) const
+{
+    return {connectionName, DRIVER_SQLITE, QString(), QString(), QString(), path, -1};
+}
+
+void tst_AsyncConnector::testConnect()
+{
+    AsyncConnector* connector = AsyncConnector::instance();
+    QSignalSpy connected(connector, SIGNAL(connected(QString,qint64)));
+    connector->connectDatabase(params("test1", mDir.filePath("test.sqlite")), 5);
+    QVERIFY(connector->isPending("test1"));
+    QVERIFY(connected.wait(10000));
+    QCOMPARE(connected[0][0].toString(), QString("test1"));
+    QVERIFY(!connector->isPending("test1"));
+
+    // usable in gui thread
+    QSqlDatabase db = QSqlDatabase::database("test1", false);
+    QVERIFY(db.isOpen());
+    QSqlQuery q(db);
+    QVERIFY(q.exec("select count(*) from t"));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), 3);
+}
+
+void tst_AsyncConnector::testParallel()
+{
+    AsyncConnector* connector = AsyncConnector::instance();
+    QSignalSpy connected(connector, SIGNAL(connected(QString,qint64)));
+    int count = AsyncConnector::maxThreads + 3;
+    for(int i=0;i<count;i++) {
+        connector->connectDatabase(params(QString("parallel%1").arg(i), mDir.filePath("test.sqlite")), 5);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(connected.size(), count, 10000);
+    for(int i=0;i<count;i++) {
+        QVERIFY(QSqlDatabase::database(QString("parallel%1").arg(i), false).isOpen());
+    }
+}
+
+void tst_AsyncConnector::testFailed()
+{
+    AsyncConnector* connector = AsyncConnector::instance();
+    QSignalSpy failed(connector, SIGNAL(failed(QString,QString)));
+    ConnectionParams params = this->params("missing", mDir.filePath("missing/test.sqlite"));
+    connector->connectDatabase(params, 5);
+    QVERIFY(failed.wait(10000));
+    QCOMPARE(failed[0][0].toString(), QString("missing"));
+    QVERIFY(!failed[0][1].toString().isEmpty());
+    QVERIFY(!QSqlDatabase::contains("missing"));
+}
+
+void tst_AsyncConnector::testCancel()
+{
+    AsyncConnector* connector = AsyncConnector::instance();
+    QSignalSpy connected(connector, SIGNAL(connected(QString,qint64)));
+    QSignalSpy failed(connector, SIGNAL(failed(QString,QString)));
+    connector->connectDatabase(params("cancelled", mDir.filePath("test.sqlite")), 5);
+    connector->cancel("cancelled");
+    QCOMPARE(failed.size(), 1);
+    QCOMPARE(failed[0][1].toString(), QString("Cancelled"));
+    QTRY_VERIFY_WITH_TIMEOUT(!connector->isPending("cancelled"), 10000);
+    QCOMPARE(connected.size(), 0);
+    QVERIFY(!QSqlDatabase::contains("cancelled"));
+}
+
+QTEST_MAIN(tst_AsyncConnector)
+#include "tst_asyncconnector.moc"
@@ -0,0 +1,143 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include "connectionpool.h"
+#include "drivernames.h"
+
+class tst_ConnectionPool : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testLease();
+    void testThread();
+    void testRemove();
+    void testDiscard();
+
+protected:
+    QTemporaryDir mDir;
+};
+
+void tst_ConnectionPool::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "pool_test");
+    db.setDatabaseName(mDir.filePath("test.sqlite"));
+    QVERIFY(db.open());
+    QSqlQuery q(db);
+    QVERIFY(q.exec("create table t(id int)"));
+    QVERIFY(q.exec("insert into t values (1), (2), (3)"));
+}
+
+void tst_ConnectionPool::testLease()
+{
+    ConnectionPool* pool = ConnectionPool::instance();
+    QString error;
+    QString first = pool->lease("pool_test", error).connectionName();
+    QCOMPARE(first, QString("pool_test"));
+
+    QString second;
+    {
+        QSqlDatabase db = pool->lease("pool_test", error);
+        QVERIFY2(db.isOpen(), qPrintable(error));
+        second = db.connectionName();
+        QVERIFY(second != first);
+        QSqlQuery q(db);
+        QVERIFY(q.exec("select count(*) from t"));
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), 3);
+    }
+    QCOMPARE(pool->leasedCount("pool_test"), 2);
+
+    pool->release(second);
+    QCOMPARE(pool->leasedCount("pool_test"), 1);
+    {
+        ConnectionLease lease("pool_test");
+        QVERIFY(lease.isValid());
+        // idle clone is reused
+        QCOMPARE(lease.database().connectionName(), second);
+    }
+    QCOMPARE(pool->leasedCount("pool_test"), 1);
+    QCOMPARE(pool->openCount("pool_test"), 2);
+
+    pool->release(first);
+    QCOMPARE(pool->leasedCount("pool_test"), 0);
+
+    QVERIFY(pool->lease("missing", error).connectionName().isEmpty());
+    QVERIFY(!error.isEmpty());
+}
+
+class LeaseThread : public QThread {
+public:
+    void run() override {
+        ConnectionLease lease("pool_test");
+        name = lease.database().connectionName();
+        QSqlQuery q(lease.database());
+        ok = q.exec("select count(*) from t") && q.next() && q.value(0).toInt() == 3;
+    }
+    QString name;
+    bool ok = false;
+};
+
+void tst_ConnectionPool::testThread()
+{
+    // named connection is not handed to other threads
+    LeaseThread thread;
+    thread.start();
+    QVERIFY(thread.wait(10000));
+    QVERIFY(thread.ok);
+    QVERIFY(thread.name != "pool_test");
+    QVERIFY(!thread.name.isEmpty());
+    // closed when thread finished
+    QVERIFY(!QSqlDatabase::contains(thread.name));
+}
+
+void tst_ConnectionPool::testRemove()
+{
+    ConnectionPool* pool = ConnectionPool::instance();
+    QString error;
+    QString first = pool->lease("pool_test", error).connectionName();
+    QString second = pool->lease("pool_test", error).connectionName();
+    pool->release(second);
+    pool->removeConnection("pool_test");
+    QVERIFY(!QSqlDatabase::contains(second));
+    pool->release(first);
+    QCOMPARE(pool->leasedCount("pool_test"), 0);
+}
+
+void tst_ConnectionPool::testDiscard()
+{
+    ConnectionPool* pool = ConnectionPool::instance();
+    QString error;
+    QString first = pool->lease("pool_test", error).connectionName();
+    QString second;
+    {
+        ConnectionLease lease("pool_test");
+        second = lease.database().connectionName();
+        QVERIFY(second != first);
+        lease.discard();
+    }
+    QVERIFY(!QSqlDatabase::contains(second));
+    {
+        QSqlQuery q(QSqlDatabase::database(first));
+        QVERIFY(q.exec("create temp table session_state(id int)"));
+        QVERIFY(q.exec("begin"));
+        QVERIFY(q.exec("insert into t values (4)"));
+    }
+    pool->release(first, true);
+    // named connection is kept and reopened without session state
+    QVERIFY(QSqlDatabase::contains(first));
+    QCOMPARE(pool->lease("pool_test", error).connectionName(), first);
+    QSqlQuery q(QSqlDatabase::database(first));
+    QVERIFY(!q.exec("select * from session_state"));
+    QVERIFY(q.exec("select count(*) from t") && q.next());
+    QCOMPARE(q.value(0).toInt(), 3);
+    q.clear();
+    pool->release(first);
+}
+
+QTEST_MAIN(tst_ConnectionPool)
+#include "tst_connectionpool.moc"
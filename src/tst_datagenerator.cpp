@@ -0,0 +1,213 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QRandomGenerator>
+#include <QSet>
+
+#include "datagenerator.h"
+#include "sqldatatypes.h"
+#include "drivernames.h"
+#include "testutils.h"
+
+class tst_DataGenerator : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testTypes();
+    void testOrder();
+    void testValues();
+    void testGenerate();
+    void testSelfReference();
+    void testAppend();
+
+protected:
+    QTemporaryDir mDir;
+    static qint64 count(const QString& query);
+};
+
+void tst_DataGenerator::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "generate");
+    db.setDatabaseName(mDir.filePath("generate.sqlite"));
+    QVERIFY(db.open());
+    QSqlQuery q(db);
+    QVERIFY(q.exec("create table customer(id integer primary key, name varchar(20) not null, email varchar(64))"));
+    QVERIFY(q.exec("create table product(code varchar(8) primary key, price numeric(6,2), created timestamp)"));
+    QVERIFY(q.exec("create table orders(id integer primary key, customer_id integer references customer(id), "
+                   "product_code varchar(8) not null references product(code), amount double)"));
+    QVERIFY(q.exec("create table node(id integer primary key, parent_id integer references node(id))"));
+    QVERIFY(q.exec("create table item(id integer primary key, name text)"));
+    QVERIFY(q.exec("insert into item values (100, 'existing')"));
+    QVERIFY(q.exec("create table tag(id integer primary key, kind text unique)"));
+}
+
+qint64 tst_DataGenerator::count(const QString &query)
+{
+    QSqlQuery q(QSqlDatabase::database("generate"));
+    if (!q.exec(query) || !q.next()) {
+        return -1;
+    }
+    return q.value(0).toLongLong();
+}
+
+void tst_DataGenerator::testTypes()
+{
+    int size;
+    int scale;
+    QCOMPARE(SqlDataTypes::fromDriverType("varchar(32)", &size), QMetaType::QString);
+    QCOMPARE(size, 32);
+    QCOMPARE(SqlDataTypes::fromDriverType("NUMERIC(10, 2)", &size, &scale), QMetaType::Double);
+    QCOMPARE(size, 10);
+    QCOMPARE(scale, 2);
+    QCOMPARE(SqlDataTypes::fromDriverType("bigint"), QMetaType::LongLong);
+    QCOMPARE(SqlDataTypes::fromDriverType("int(11)"), QMetaType::Int);
+    QCOMPARE(SqlDataTypes::fromDriverType("point"), QMetaType::QString);
+    QCOMPARE(SqlDataTypes::fromDriverType("interval"), QMetaType::QString);
+    QCOMPARE(SqlDataTypes::fromDriverType("timestamp with time zone"), QMetaType::QDateTime);
+    QCOMPARE(SqlDataTypes::fromDriverType("date"), QMetaType::QDate);
+    QCOMPARE(SqlDataTypes::fromDriverType("time"), QMetaType::QTime);
+    QCOMPARE(SqlDataTypes::fromDriverType("bytea"), QMetaType::QByteArray);
+    QCOMPARE(SqlDataTypes::fromDriverType("boolean"), QMetaType::Bool);
+}
+
+void tst_DataGenerator::testOrder()
+{
+    QList<SRelation> relations = {
+        SRelation("fk1", "c", {"b_id"}, "b", {"id"}),
+        SRelation("fk2", "b", {"a_id"}, "a", {"id"}),
+        SRelation("fk3", "a", {"parent_id"}, "a", {"id"}),
+        SRelation("fk4", "x", {"y_id"}, "y", {"id"}),
+        SRelation("fk5", "y", {"x_id"}, "x", {"id"}),
+    };
+    QStringList cyclic;
+    QStringList order = DataGenerator::order({"c", "x", "b", "y", "a", "d"}, relations, &cyclic);
+    QCOMPARE(order, QStringList({"a", "d", "b", "c", "x", "y"}));
+    QCOMPARE(cyclic, QStringList({"x", "y"}));
+}
+
+void tst_DataGenerator::testValues()
+{
+    QList<SColumn> columns = {SColumn("id", "integer"), SColumn("code", "varchar(4)"),
+                              SColumn("day", "date"), SColumn("at", "datetime"),
+                              SColumn("key", "blob"), SColumn("uid", "uuid")};
+    for(const SColumn& column_: columns) {
+        DataGenerator::Column column = DataGenerator::column(column_, true);
+        QSet<QString> values;
+        for(int row=0;row<5000;row++) {
+            QVariant value = DataGenerator::uniqueValue(column, row);
+            QVERIFY(!value.isNull());
+            QString text = value.metaType().id() == QMetaType::QByteArray ? value.toByteArray().toHex() : value.toString();
+            if (column.size > 0) {
+                QVERIFY(text.size() <= column.size);
+            }
+            values.insert(text);
+        }
+        QCOMPARE(values.size(), 5000);
+    }
+
+    QRandomGenerator random(1);
+    DataGenerator::Column price = DataGenerator::column(SColumn("price", "numeric(4,1)"), false);
+    DataGenerator::Column size = DataGenerator::column(SColumn("size", "enum('s','m','l')"), false);
+    DataGenerator::Column name = DataGenerator::column(SColumn("name", "varchar(5)"), false);
+    for(int i=0;i<1000;i++) {
+        double value = DataGenerator::randomValue(price, random).toDouble();
+        QVERIFY(value >= 0 && value < 1000);
+        QVERIFY(QStringList({"s", "m", "l"}).contains(DataGenerator::randomValue(size, random).toString()));
+        QVERIFY(DataGenerator::randomValue(name, random).toString().size() <= 5);
+    }
+}
+
+void tst_DataGenerator::testGenerate()
+{
+    QList<DataGenerator::Table> tables;
+    DataGenerator::Table orders;
+    orders.table = STable("orders", {SColumn("id", "integer", true), SColumn("customer_id", "integer"),
+                                     SColumn("product_code", "varchar(8)", true), SColumn("amount", "double")});
+    orders.unique = QStringList({"id"});
+    orders.rows = 25000;
+    DataGenerator::Table customer;
+    customer.table = STable("customer", {SColumn("id", "integer", true), SColumn("name", "varchar(20)", true),
+                                         SColumn("email", "varchar(64)")});
+    customer.unique = QStringList({"id"});
+    customer.rows = 1500;
+    DataGenerator::Table product;
+    product.table = STable("product", {SColumn("code", "varchar(8)", true), SColumn("price", "numeric(6,2)"),
+                                       SColumn("created", "timestamp")});
+    product.unique = QStringList({"code"});
+    product.rows = 300;
+    tables = {orders, customer, product};
+
+    QList<SRelation> relations = {
+        SRelation("fk_customer", "orders", {"customer_id"}, "customer", {"id"}),
+        SRelation("fk_product", "orders", {"product_code"}, "product", {"code"}),
+    };
+
+    DataGenerator generator("generate");
+    QSignalSpy tableFinished(&generator, SIGNAL(tableFinished(QString)));
+    QVERIFY(TestUtils::waitFinished(&generator, [&](){ generator.start(tables, relations, 4); }, 60000));
+    QVERIFY2(generator.errors().isEmpty(), qPrintable(generator.errors().join("\n")));
+    QCOMPARE(tableFinished.size(), 3);
+    QCOMPARE(tableFinished.last().at(0).toString(), QString("orders"));
+
+    QCOMPARE(count("select count(*) from customer"), 1500);
+    QCOMPARE(count("select count(*) from product"), 300);
+    QCOMPARE(count("select count(*) from orders"), 25000);
+    QCOMPARE(count("select count(distinct id) from orders"), 25000);
+    QCOMPARE(count("select count(*) from customer where name is null"), 0);
+    QCOMPARE(count("select count(*) from product where length(code) > 8"), 0);
+    QCOMPARE(count("select count(*) from orders o left join customer c on c.id = o.customer_id "
+                   "where o.customer_id is not null and c.id is null"), 0);
+    QCOMPARE(count("select count(*) from orders o left join product p on p.code = o.product_code "
+                   "where p.code is null"), 0);
+    QVERIFY(count("select count(distinct customer_id) from orders") > 1000);
+}
+
+void tst_DataGenerator::testSelfReference()
+{
+    DataGenerator::Table node;
+    node.table = STable("node", {SColumn("id", "integer", true), SColumn("parent_id", "integer")});
+    node.unique = QStringList({"id"});
+    node.rows = DataGenerator::chunkSize * 3;
+    QList<SRelation> relations = {
+        SRelation("fk_parent", "node", {"parent_id"}, "node", {"id"}),
+    };
+
+    DataGenerator generator("generate");
+    QVERIFY(TestUtils::waitFinished(&generator, [&](){ generator.start({node}, relations, 4); }, 60000));
+    QVERIFY2(generator.errors().isEmpty(), qPrintable(generator.errors().join("\n")));
+    QCOMPARE(count("select count(*) from node"), qint64(node.rows));
+    // parent is inserted before child or with it
+    QCOMPARE(count("select count(*) from node where parent_id > id"), 0);
+    QCOMPARE(count("select count(*) from node n left join node p on p.id = n.parent_id "
+                   "where n.parent_id is not null and p.id is null"), 0);
+}
+
+void tst_DataGenerator::testAppend()
+{
+    DataGenerator::Table item;
+    item.table = STable("item", {SColumn("id", "integer", true), SColumn("name", "text")});
+    item.unique = QStringList({"id"});
+    item.rows = 10;
+    DataGenerator::Table tag;
+    tag.table = STable("tag", {SColumn("id", "integer", true), SColumn("kind", "enum('a','b','c')")});
+    tag.unique = QStringList({"id", "kind"});
+    tag.rows = 2;
+    for(int i=0;i<2;i++) {
+        DataGenerator generator("generate");
+        QVERIFY(TestUtils::waitFinished(&generator, [&](){ generator.start({item, tag}, {}, 2); }, 60000));
+        QVERIFY2(generator.errors().isEmpty(), qPrintable(generator.errors().join("\n")));
+    }
+    // ids continue after largest one
+    QCOMPARE(count("select count(*) from item"), qint64(21));
+    QCOMPARE(count("select min(id) from item where id > 100"), qint64(101));
+    // enum runs out of distinct values
+    QCOMPARE(count("select count(*) from tag"), qint64(3));
+    QCOMPARE(count("select count(distinct kind) from tag"), qint64(3));
+}
+
+QTEST_MAIN(tst_DataGenerator)
+#include "tst_datagenerator.moc"
@@ -0,0 +1,114 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlQueryModel>
+#include <QSqlRecord>
+#include <QTemporaryDir>
+
+#include "fanoutquery.h"
+#include "drivernames.h"
+#include "testutils.h"
+
+class tst_FanOutQuery : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testPerTarget();
+    void testMerged();
+    void testErrors();
+
+protected:
+    QTemporaryDir mDir;
+    QStringList mNames;
+    void run(FanOutQuery* query, int concurrency);
+};
+
+void tst_FanOutQuery::initTestCase()
+{
+    for(int i=0;i<5;i++) {
+        QString name = QString("shard%1").arg(i);
+        QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, name);
+        db.setDatabaseName(mDir.filePath(name + ".sqlite"));
+        QVERIFY(db.open());
+        QSqlQuery q(db);
+        QVERIFY(q.exec("create table t(id int, name text)"));
+        for(int j=0;j<=i;j++) {
+            QVERIFY(q.exec(QString("insert into t values (%1, 'name %1')").arg(j)));
+        }
+        if (i == 4) {
+            QVERIFY(q.exec("create table u(id int)"));
+        } else {
+            QVERIFY(q.exec("create table u(id int, extra int)"));
+        }
+        mNames.append(name);
+    }
+}
+
+void tst_FanOutQuery::run(FanOutQuery *query, int concurrency)
+{
+    QVERIFY(TestUtils::waitFinished(query, [&](){ query->start(concurrency, false, 0); }, 10000));
+}
+
+void tst_FanOutQuery::testPerTarget()
+{
+    FanOutQuery query(mNames, {"select * from t order by id", "update t set name = name where id = 0"});
+    run(&query, 2);
+    for(int target=0;target<mNames.size();target++) {
+        const FanOutQuery::Result& result = query.result(target);
+        QCOMPARE(result.connectionName, mNames[target]);
+        QCOMPARE(result.errors, QStringList({QString(), QString()}));
+        QCOMPARE(result.rowsAffected[0], target + 1);
+        QCOMPARE(result.rowsAffected[1], 1);
+        QVERIFY(result.timings[0].firstRow >= result.timings[0].exec);
+        QVERIFY(result.timings[0].bytes > 0);
+        QCOMPARE(result.timings[1].firstRow, -1);
+        QSqlQueryModel* model = query.model(target, 0);
+        QVERIFY(model);
+        QCOMPARE(model->rowCount(), target + 1);
+        QCOMPARE(model->data(model->index(target, 1)).toString(), QString("name %1").arg(target));
+        delete model;
+        QVERIFY(!query.model(target, 1));
+    }
+}
+
+void tst_FanOutQuery::testMerged()
+{
+    FanOutQuery query(mNames, {"select * from t", "select * from u"});
+    run(&query, 8);
+
+    QStringList skipped;
+    QSqlQueryModel* model = query.mergedModel(0, &skipped);
+    QVERIFY(model);
+    QVERIFY(skipped.isEmpty());
+    while (model->canFetchMore()) {
+        model->fetchMore();
+    }
+    QCOMPARE(model->rowCount(), 1 + 2 + 3 + 4 + 5);
+    QCOMPARE(model->record().fieldName(0), QString("source"));
+    QCOMPARE(model->record().count(), 3);
+    QCOMPARE(model->data(model->index(0, 0)).toString(), QString("shard0"));
+    QCOMPARE(model->data(model->index(model->rowCount() - 1, 0)).toString(), QString("shard4"));
+    delete model;
+
+    model = query.mergedModel(1, &skipped);
+    QVERIFY(model);
+    QCOMPARE(skipped, QStringList({"shard4"}));
+    delete model;
+}
+
+void tst_FanOutQuery::testErrors()
+{
+    QStringList names = mNames;
+    names.append("missing");
+    FanOutQuery query(names, {"select * from t", "select * from v"});
+    run(&query, 3);
+    QCOMPARE(query.result(0).errors[0], QString());
+    QVERIFY(!query.result(0).errors[1].isEmpty());
+    QVERIFY(!query.result(names.size() - 1).errors[0].isEmpty());
+    QVERIFY(!query.model(names.size() - 1, 0));
+}
+
+QTEST_MAIN(tst_FanOutQuery)
+#include "tst_fanoutquery.moc"
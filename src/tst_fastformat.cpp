@@ -0,0 +1,72 @@
+#include <QTest>
+#include <QDateTime>
+#include <QRegularExpression>
+
+#include "datetimeformatter.h"
+#include "fastformat.h"
+
+class tst_FastFormat : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void testDateTime_data();
+    void testDateTime();
+    void testDouble();
+    void testSingleLine();
+};
+
+void tst_FastFormat::testDateTime_data()
+{
+    QTest::addColumn<QString>("format");
+    QTest::newRow("iso") << "yyyy-MM-dd hh:mm:ss";
+    QTest::newRow("short") << "d.M.yy h:m:s";
+    QTest::newRow("names") << "ddd dddd MMM MMMM";
+    QTest::newRow("ampm") << "hh:mm AP h ap";
+    QTest::newRow("msec") << "ss.zzz ss.z";
+    QTest::newRow("quoted") << "'Date:' yyyy 'o''clock' ''";
+    QTest::newRow("24") << "HH:mm";
+    QTest::newRow("fallback") << "yyy t";
+}
+
+void tst_FastFormat::testDateTime()
+{
+    QFETCH(QString, format);
+    DateTimeFormatter formatter(format);
+    QList<QDateTime> values = {
+        QDateTime(QDate(2024, 2, 29), QTime(0, 5, 7, 120)),
+        QDateTime(QDate(1999, 12, 31), QTime(23, 59, 59, 5)),
+        QDateTime(QDate(2001, 1, 1), QTime(12, 0, 0, 0)),
+    };
+    for(const QDateTime& value: values) {
+        QCOMPARE(formatter.toString(value), value.toString(format));
+        QCOMPARE(formatter.toString(value.date()), value.date().toString(format));
+        QCOMPARE(formatter.toString(value.time()), value.time().toString(format));
+    }
+    QCOMPARE(formatter.toString(QDateTime()), QDateTime().toString(format));
+}
+
+void tst_FastFormat::testDouble()
+{
+    QList<double> values = {0.0, 1.5, -2.25, 0.1, 1e21, 123456789.125, 1.0/3.0};
+    for(double value: values) {
+        QString text = FastFormat::number(value);
+        QCOMPARE(text.toDouble(), value);
+    }
+    QCOMPARE(FastFormat::number(0.1), QString("0.1"));
+}
+
+void tst_FastFormat::testSingleLine()
+{
+    QStringList values = {"", "abc", "a\nb", "a\r\nb", "a\n\r  b\n", "\n\n\tx", "a\n \n b"};
+    for(const QString& value: values) {
+        QString expected = value;
+        expected.replace(QRegularExpression("\\n[\\r]?\\s*")," ");
+        QString actual;
+        FastFormat::appendSingleLine(actual, value);
+        QCOMPARE(actual, expected);
+    }
+}
+
+QTEST_MAIN(tst_FastFormat)
+#include "tst_fastformat.moc"
@@ -0,0 +1,214 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QSignalSpy>
+
+#include "history.h"
+#include "querytiming.h"
+#include "drivernames.h"
+#include "model/queryhistorymodel.h"
+
+class tst_History : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void testAddQuery();
+    void testSearch();
+    void testDate();
+    void testExisting();
+    void testClose();
+    void testFingerprint();
+    void testModel();
+
+protected:
+    QTemporaryDir mDir;
+    static QList<QVariantList> select(const QString& where, const QVariantList& values);
+};
+
+QList<QVariantList> tst_History::select(const QString &where, const QVariantList &values)
+{
+    QSqlQuery q(QSqlDatabase::database("_history"));
+    q.prepare("select rowid, connectionName, query, execMs from query" +
+              (where.isEmpty() ? QString() : " where " + where) + " order by rowid");
+    for(const QVariant& value: values) {
+        q.addBindValue(value);
+    }
+    QList<QVariantList> res;
+    if (!q.exec()) {
+        return res;
+    }
+    while (q.next()) {
+        res.append({q.value(0), q.value(1), q.value(2), q.value(3)});
+    }
+    return res;
+}
+
+void tst_History::testAddQuery()
+{
+    History history(mDir.filePath("add.sqlite"));
+    QueryTiming timing;
+    timing.exec = 12;
+    qint64 id1 = history.addQuery("db1", "select 1");
+    qint64 id2 = history.addQuery("db2", "select 2");
+    QCOMPARE(id2, id1 + 1);
+    history.setQueryTiming(id2, timing);
+    history.flush();
+    QList<QVariantList> rows = select(QString(), {});
+    QCOMPARE(rows.size(), 2);
+    QCOMPARE(rows[0], QVariantList({id1, "db1", "select 1", QVariant()}));
+    QCOMPARE(rows[1][0].toLongLong(), id2);
+    QCOMPARE(rows[1][3].toInt(), 12);
+
+    QSqlQuery q(QSqlDatabase::database("_history"));
+    QVERIFY(q.exec("PRAGMA journal_mode"));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toString(), QString("wal"));
+}
+
+void tst_History::testSearch()
+{
+    History history(mDir.filePath("search.sqlite"));
+    QVERIFY(history.hasFts());
+    history.addQuery("db", "select * from Customers");
+    history.addQuery("db", "select * from orders where name = \"x\"");
+    history.addQuery("db", "update customers set a = 1");
+    history.flush();
+
+    auto find = [&](const QString& text) {
+        QStringList conditions;
+        QVariantList values;
+        history.textCondition(text, conditions, values);
+        return select(conditions.join(" and "), values).size();
+    };
+    QCOMPARE(find("customer"), 2);
+    QCOMPARE(find("stomers set"), 1);
+    QCOMPARE(find("name = \"x\""), 1);
+    QCOMPARE(find("up"), 1);
+    QCOMPARE(find("missing"), 0);
+    QCOMPARE(find(QString()), 3);
+}
+
+void tst_History::testDate()
+{
+    History history(mDir.filePath("date.sqlite"));
+    history.addQuery("db", "select 1");
+    history.flush();
+    QDate today = QDate::currentDate();
+    auto count = [&](const QDate& date1, const QDate& date2) {
+        QStringList conditions;
+        QVariantList values;
+        History::dateCondition(date1, date2, conditions, values);
+        return select(conditions.join(" and "), values).size();
+    };
+    QCOMPARE(count(today, today), 1);
+    QCOMPARE(count(today, QDate()), 1);
+    QCOMPARE(count(today.addDays(1), QDate()), 0);
+    QCOMPARE(count(QDate(), today.addDays(-1)), 0);
+}
+
+void tst_History::testExisting()
+{
+    QString path = mDir.filePath("existing.sqlite");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "existing");
+        db.setDatabaseName(path);
+        QVERIFY(db.open());
+        QSqlQuery q(db);
+        QVERIFY(q.exec("create table query(date datetime, connectionName text, query text)"));
+        QVERIFY(q.exec("insert into query values ('2020-01-01T10:00:00', 'db', 'select * from legacy')"));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("existing");
+
+    History history(path);
+    // existing rows are indexed, ids continue
+    QStringList conditions;
+    QVariantList values;
+    history.textCondition("legacy", conditions, values);
+    QCOMPARE(select(conditions.join(" and "), values).size(), 1);
+    QCOMPARE(history.addQuery("db", "select 2"), 2);
+}
+
+void tst_History::testClose()
+{
+    History history(mDir.filePath("close.sqlite"));
+    history.addQuery("db", "select 1");
+    history.close();
+    QCOMPARE(select(QString(), {}).size(), 1);
+    qint64 id = history.addQuery("db", "select 2");
+    QueryTiming timing;
+    timing.exec = 5;
+    history.setQueryTiming(id, timing);
+    QList<QVariantList> rows = select(QString(), {});
+    QCOMPARE(rows.size(), 2);
+    QCOMPARE(rows[1][3].toInt(), 5);
+}
+
+void tst_History::testFingerprint()
+{
+    History history(mDir.filePath("fingerprint.sqlite"));
+    QueryTiming timing;
+    timing.exec = 10;
+    history.setQueryTiming(history.addQuery("db", "select * from t where id = 1"), timing, true, 1);
+    timing.exec = 30;
+    history.setQueryTiming(history.addQuery("db", "SELECT * FROM t WHERE id=2"), timing, true, 1);
+    history.setQueryTiming(history.addQuery("db", "select * from t where id = 'x'"), timing, false);
+    history.setQueryTiming(history.addQuery("db", "delete from t"), timing, true, -1, 5);
+    qint64 id = history.addQuery("db", "select * from t where id = 3");
+    history.setQueryTiming(id, timing, true);
+    history.setQueryRows(id, 2000);
+    history.flush();
+
+    QSqlQuery q(QSqlDatabase::database("_history"));
+    QVERIFY(q.exec("select fingerprint, count, errors, totalMs, maxMs, rowsReturned, rowsAffected, query "
+                   "from fingerprint order by totalMs desc"));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toString(), QString("select*from t where id=?"));
+    QCOMPARE(q.value(1).toInt(), 4);
+    QCOMPARE(q.value(2).toInt(), 1);
+    QCOMPARE(q.value(3).toInt(), 100);
+    QCOMPARE(q.value(4).toInt(), 30);
+    QCOMPARE(q.value(5).toInt(), 2002);
+    QCOMPARE(q.value(7).toString(), QString("select * from t where id = 3"));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toString(), QString("delete from t"));
+    QCOMPARE(q.value(6).toInt(), 5);
+    QVERIFY(!q.next());
+}
+
+void tst_History::testModel()
+{
+    History history(mDir.filePath("model.sqlite"));
+    for(int i=0;i<1000;i++) {
+        history.addQuery(i % 2 ? "odd" : "even", QString("select %1").arg(i));
+    }
+    history.flush();
+
+    QueryHistoryModel model;
+    QSignalSpy counted(&model, SIGNAL(counted(qint64)));
+    model.setFilter({}, {});
+    QCOMPARE(model.rowCount(), int(QueryHistoryModel::pageSize));
+    QVERIFY(counted.wait());
+    QCOMPARE(model.totalCount(), qint64(1000));
+    QCOMPARE(model.rowCount(), 1000);
+    auto query = [&](int row) {
+        return model.data(model.index(row, QueryHistoryModel::col_query)).toString();
+    };
+    // newest first, pages out of order
+    QCOMPARE(query(900), QString("select 99"));
+    QCOMPARE(query(0), QString("select 999"));
+    QCOMPARE(query(300), QString("select 699"));
+    QCOMPARE(query(999), QString("select 0"));
+    QVERIFY(!model.data(model.index(1000, 0)).isValid());
+
+    model.setFilter({"connectionName=?"}, {"odd"});
+    QVERIFY(counted.wait());
+    QCOMPARE(model.rowCount(), 500);
+    QCOMPARE(query(499), QString("select 1"));
+    QCOMPARE(query(256), QString("select 487"));
+}
+
+QTEST_MAIN(tst_History)
+#include "tst_history.moc"
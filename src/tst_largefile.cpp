@@ -0,0 +1,97 @@
+#include <QTest>
+#include <QTemporaryDir>
+
+#include "largefile.h"
+#include "testutils.h"
+
+class tst_LargeFile : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void testLines();
+    void testState();
+    void testStatementRange();
+
+protected:
+    QTemporaryDir mDir;
+    QString writeFile(const QString& name, const QByteArray& data);
+};
+
+QString tst_LargeFile::writeFile(const QString &name, const QByteArray &data)
+{
+    return TestUtils::writeFile(mDir.filePath(name), data);
+}
+
+void tst_LargeFile::testLines()
+{
+    LargeFile file;
+    QVERIFY(file.open(writeFile("lines.sql", "\xEF\xBB\xBFselect 1;\r\n\nselect '\xC3\xA9';\n")));
+    QCOMPARE(file.lineCount(), qint64(3));
+    QCOMPARE(file.lineOffset(0), qint64(3));
+    QCOMPARE(file.line(0), QString("select 1;"));
+    QCOMPARE(file.line(1), QString());
+    QCOMPARE(file.line(2), QString::fromUtf8("select '\xC3\xA9';"));
+    QCOMPARE(file.line(2, 6), QString("select"));
+    QCOMPARE(file.lineOffset(3), file.size());
+
+    LargeFile empty;
+    QVERIFY(empty.open(writeFile("empty.sql", QByteArray())));
+    QCOMPARE(empty.lineCount(), qint64(0));
+}
+
+void tst_LargeFile::testState()
+{
+    QByteArray data = "select 1;\n/* comment\n";
+    for(int i=0;i<LargeFile::checkpointLines * 3;i++) {
+        data += "comment line;\n";
+    }
+    data += "*/ select 'multi\nline';\n";
+    LargeFile file;
+    QVERIFY(file.open(writeFile("state.sql", data)));
+    qint64 end = file.lineCount() - 2;
+    QCOMPARE(file.state(1, true).context, SqlLexer::Code);
+    QCOMPARE(file.state(2, true).context, SqlLexer::InComment);
+    QCOMPARE(file.state(end, false).context, SqlLexer::InComment);
+    QCOMPARE(file.state(end, true).context, SqlLexer::InComment);
+    QCOMPARE(file.state(end + 1, true).context, SqlLexer::InString);
+    // checkpoints are reused
+    QCOMPARE(file.state(LargeFile::checkpointLines * 2 + 1, false).context, SqlLexer::InComment);
+}
+
+void tst_LargeFile::testStatementRange()
+{
+    QByteArray data = "create table t(id int);\n"
+                      "insert into t values (1);\n"
+                      "-- comment\n"
+                      "insert into t\n"
+                      "values (2); insert into t values (3);\n"
+                      "DELIMITER //\n"
+                      "select 4//\n"
+                      "select 5//\n";
+    LargeFile file;
+    QVERIFY(file.open(writeFile("range.sql", data)));
+    ScriptRunner::Position from;
+    qint64 to = -1;
+
+    // insert 1 and insert 2
+    QVERIFY(file.statementRange(1, 3, from, to));
+    QCOMPARE(from.offset, qint64(data.indexOf("\ninsert into t values (1)")));
+    QCOMPARE(from.delimiter, QString(";"));
+    QCOMPARE(to, qint64(data.indexOf(" insert into t values (3)")));
+
+    // statement starts before selection
+    QVERIFY(file.statementRange(4, 4, from, to));
+    QCOMPARE(from.offset, qint64(data.indexOf(" insert into t values (3)")));
+    QCOMPARE(to, qint64(data.indexOf("\nDELIMITER")));
+
+    QVERIFY(file.statementRange(7, 7, from, to));
+    QCOMPARE(from.offset, qint64(data.indexOf("\nselect 5")));
+    QCOMPARE(from.delimiter, QString("//"));
+    QCOMPARE(to, qint64(data.size()));
+
+    QVERIFY(!file.statementRange(2, 2, from, to));
+}
+
+QTEST_MAIN(tst_LargeFile)
+#include "tst_largefile.moc"
@@ -0,0 +1,116 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QRandomGenerator>
+
+#include "loadtest.h"
+#include "drivernames.h"
+#include "testutils.h"
+
+class tst_LoadTest : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testPercentile();
+    void testExpand();
+    void testIterations();
+    void testDuration();
+    void testErrors();
+
+protected:
+    QTemporaryDir mDir;
+    static void run(LoadTest* test, int concurrency, qint64 iterations, int duration);
+};
+
+void tst_LoadTest::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "load");
+    db.setDatabaseName(mDir.filePath("load.sqlite"));
+    QVERIFY(db.open());
+    QSqlQuery q(db);
+    QVERIFY(q.exec("create table t(id integer primary key, name text)"));
+    QVERIFY(db.transaction());
+    for(int i=0;i<1000;i++) {
+        QVERIFY(q.exec(QString("insert into t values (%1, 'name %1')").arg(i)));
+    }
+    QVERIFY(db.commit());
+}
+
+void tst_LoadTest::run(LoadTest *test, int concurrency, qint64 iterations, int duration)
+{
+    QVERIFY(TestUtils::waitFinished(test, [&](){ test->start(concurrency, iterations, duration); }));
+}
+
+void tst_LoadTest::testPercentile()
+{
+    QList<double> values;
+    for(int i=1;i<=100;i++) {
+        values.append(i);
+    }
+    QCOMPARE(LoadTest::percentile(values, 50), 50.0);
+    QCOMPARE(LoadTest::percentile(values, 95), 95.0);
+    QCOMPARE(LoadTest::percentile(values, 99), 99.0);
+    QCOMPARE(LoadTest::percentile(values, 100), 100.0);
+    QCOMPARE(LoadTest::percentile({7.0}, 99), 7.0);
+    QCOMPARE(LoadTest::percentile({}, 50), 0.0);
+}
+
+void tst_LoadTest::testExpand()
+{
+    QRandomGenerator random(1);
+    QVERIFY(!LoadTest::isTemplate("select * from t where id = 1"));
+    QVERIFY(LoadTest::isTemplate("select * from t where id = ${i}"));
+    QCOMPARE(LoadTest::expand("select ${i}, '${i}'", 42, random), QString("select 42, '42'"));
+    for(int i=0;i<100;i++) {
+        int value = LoadTest::expand("${random:-5:5}", i, random).toInt();
+        QVERIFY(value >= -5 && value <= 5);
+    }
+    QCOMPARE(LoadTest::expand("${random:3:3} ${other}", 0, random), QString("3 ${other}"));
+}
+
+void tst_LoadTest::testIterations()
+{
+    LoadTest test("load", "select * from t where id < 100");
+    QSignalSpy progress(&test, SIGNAL(progress()));
+    run(&test, 4, 500, 0);
+    LoadTest::Result result = test.result();
+    QCOMPARE(result.iterations, 500);
+    QCOMPARE(result.errors, 0);
+    QCOMPARE(result.concurrency, 4);
+    QVERIFY(progress.size() > 0);
+    QVERIFY(result.min <= result.p50);
+    QVERIFY(result.p50 <= result.p95);
+    QVERIFY(result.p95 <= result.p99);
+    QVERIFY(result.p99 <= result.max);
+    QVERIFY(result.throughput() > 0);
+
+    LoadTest templated("load", "select name from t where id = ${random:0:999}");
+    run(&templated, 2, 200, 0);
+    QCOMPARE(templated.result().iterations, 200);
+}
+
+void tst_LoadTest::testDuration()
+{
+    LoadTest test("load", "select count(*) from t");
+    run(&test, 2, 0, 300);
+    LoadTest::Result result = test.result();
+    QVERIFY(result.iterations > 0);
+    QVERIFY(result.seconds >= 0.3);
+    QVERIFY(result.seconds < 10);
+}
+
+void tst_LoadTest::testErrors()
+{
+    LoadTest test("load", "select * from missing");
+    run(&test, 2, 10, 0);
+    QCOMPARE(test.result().iterations, 0);
+    QCOMPARE(test.errorCount(), 10);
+    QVERIFY(!test.lastError().isEmpty());
+}
+
+QTEST_MAIN(tst_LoadTest)
+#include "tst_loadtest.moc"
@@ -0,0 +1,207 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+
+#include "nativedump.h"
+#include "gzipfile.h"
+#include "sqllexer.h"
+#include "drivernames.h"
+#include "testutils.h"
+
+class tst_NativeDump : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testCrc32();
+    void testGzip();
+    void testSql();
+    void testCompressed();
+    void testCsv();
+    void testMissing();
+    void testSequenceStatement();
+
+protected:
+    QTemporaryDir mDir;
+    static void run(NativeDump* dump, const QStringList& tables, const QString& dir, int jobs);
+    static int restore(const QString& connectionName, const QString& text);
+};
+
+void tst_NativeDump::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "dump");
+    db.setDatabaseName(mDir.filePath("dump.sqlite"));
+    QVERIFY(db.open());
+    QSqlQuery q(db);
+    QVERIFY(q.exec("create table t1(id integer primary key, name text, value real)"));
+    QVERIFY(q.exec("create table t2(id integer primary key, t1 integer, note text)"));
+    QVERIFY(db.transaction());
+    for(int i=0;i<2500;i++) {
+        QVERIFY(q.exec(QString("insert into t1 values (%1, 'name %1', %1.5)").arg(i)));
+    }
+    QVERIFY(q.exec("insert into t2 values (1, 1, 'quote '' and, comma')"));
+    QVERIFY(q.exec("insert into t2 values (2, 2, null)"));
+    QVERIFY(db.commit());
+
+    QSqlDatabase restored = QSqlDatabase::addDatabase(DRIVER_SQLITE, "restored");
+    restored.setDatabaseName(mDir.filePath("restored.sqlite"));
+    QVERIFY(restored.open());
+}
+
+void tst_NativeDump::run(NativeDump *dump, const QStringList &tables, const QString &dir, int jobs)
+{
+    QDir().mkpath(dir);
+    QVERIFY(TestUtils::waitFinished(dump, [&](){ dump->start(tables, dir, jobs); }));
+}
+
+int tst_NativeDump::restore(const QString &connectionName, const QString &text)
+{
+    QSqlQuery q(QSqlDatabase::database(connectionName));
+    int count = 0;
+    for(const QString& statement: SqlSplitter::split(text)) {
+        if (!q.exec(statement)) {
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+void tst_NativeDump::testCrc32()
+{
+    QCOMPARE(GzipFile::crc32("123456789", 9), 0xCBF43926u);
+    QCOMPARE(GzipFile::crc32("", 0), 0u);
+}
+
+void tst_NativeDump::testGzip()
+{
+    QByteArray data;
+    for(int i=0;i<200000;i++) {
+        data.append(QString("line %1\n").arg(i).toUtf8());
+    }
+    QVERIFY(data.size() > GzipFile::blockSize);
+
+    QString path = mDir.filePath("data.gz");
+    GzipFile file(path);
+    QVERIFY(file.open());
+    for(int i=0;i<data.size();i+=100000) {
+        QVERIFY(file.write(data.mid(i, 100000)));
+    }
+    QVERIFY(file.close());
+    QVERIFY(GzipFile::isGzip(path));
+    QVERIFY(QFileInfo(path).size() < data.size());
+    QString error;
+    QCOMPARE(GzipFile::read(path, error), data);
+    QVERIFY(error.isEmpty());
+
+    QString empty = mDir.filePath("empty.gz");
+    GzipFile emptyFile(empty);
+    QVERIFY(emptyFile.open());
+    QVERIFY(emptyFile.close());
+    QVERIFY(GzipFile::isGzip(empty));
+    QCOMPARE(GzipFile::read(empty, error), QByteArray());
+    QVERIFY(error.isEmpty());
+
+    QVERIFY(!GzipFile::isGzip(mDir.filePath("dump.sqlite")));
+    GzipFile::read(mDir.filePath("dump.sqlite"), error);
+    QVERIFY(!error.isEmpty());
+}
+
+void tst_NativeDump::testSql()
+{
+    NativeDump dump("dump");
+    dump.setInsertRows(100);
+    QSignalSpy changed(&dump, SIGNAL(tableChanged(int)));
+    QString dir = mDir.filePath("sql");
+    run(&dump, {"t1", "t2"}, dir, 2);
+    QCOMPARE(dump.count(), 2);
+    QCOMPARE(dump.count(Dump::Done), 2);
+    QCOMPARE(dump.table(0).rows, qint64(2500));
+    QCOMPARE(dump.table(1).rows, qint64(2));
+    QVERIFY(dump.table(0).bytes > 0);
+    QVERIFY(changed.size() >= 4);
+    // sqlite has no shared snapshot for several connections
+    QVERIFY(!dump.isConsistent());
+
+    QString t1 = QString::fromUtf8(TestUtils::readFile(QDir(dir).filePath("t1.sql")));
+    QVERIFY(t1.contains("create table t1", Qt::CaseInsensitive));
+    // 2500 rows in inserts of 100 rows, drop and create
+    QCOMPARE(restore("restored", t1), 27);
+    QCOMPARE(restore("restored", QString::fromUtf8(TestUtils::readFile(QDir(dir).filePath("t2.sql")))), 3);
+
+    QSqlQuery q(QSqlDatabase::database("restored"));
+    QVERIFY(q.exec("select count(*), sum(value) from t1") && q.next());
+    QCOMPARE(q.value(0).toInt(), 2500);
+    QCOMPARE(q.value(1).toDouble(), 2500 * 2499 / 2 + 2500 * 0.5);
+    QVERIFY(q.exec("select note from t2 order by id") && q.next());
+    QCOMPARE(q.value(0).toString(), QString("quote ' and, comma"));
+    QVERIFY(q.next());
+    QVERIFY(q.value(0).isNull());
+
+    NativeDump single("dump");
+    run(&single, {"t1", "t2"}, mDir.filePath("single"), 1);
+    QCOMPARE(single.count(Dump::Done), 2);
+    QVERIFY(single.isConsistent());
+}
+
+void tst_NativeDump::testCompressed()
+{
+    NativeDump dump("dump");
+    dump.setCompress(true);
+    dump.setSchema(false);
+    QString dir = mDir.filePath("gz");
+    run(&dump, {"t1"}, dir, 4);
+    QCOMPARE(dump.count(Dump::Done), 1);
+    QString path = QDir(dir).filePath("t1.sql.gz");
+    QCOMPARE(dump.table(0).path, path);
+    QVERIFY(GzipFile::isGzip(path));
+    QString error;
+    QString text = QString::fromUtf8(GzipFile::read(path, error));
+    QVERIFY(error.isEmpty());
+    QVERIFY(!text.contains("create table", Qt::CaseInsensitive));
+    QCOMPARE(SqlSplitter::split(text).size(), 3);
+}
+
+void tst_NativeDump::testCsv()
+{
+    NativeDump dump("dump");
+    dump.setFormat(NativeDump::Csv);
+    QString dir = mDir.filePath("csv");
+    run(&dump, {"t1", "t2"}, dir, 2);
+    QCOMPARE(dump.count(Dump::Done), 2);
+    QList<QByteArray> t1 = TestUtils::readFile(QDir(dir).filePath("t1.csv")).split('\n');
+    // header, rows, empty after last newline
+    QCOMPARE(t1.size(), 2502);
+    QCOMPARE(t1[0], QByteArray("id,name,value"));
+    QCOMPARE(t1[1], QByteArray("0,name 0,0.5"));
+    QCOMPARE(TestUtils::readFile(QDir(dir).filePath("t2.csv")),
+             QByteArray("id,t1,note\n1,1,\"quote ' and, comma\"\n2,2,\n"));
+}
+
+void tst_NativeDump::testMissing()
+{
+    NativeDump dump("dump");
+    QString dir = mDir.filePath("missing");
+    run(&dump, {"t2", "missing"}, dir, 2);
+    QCOMPARE(dump.table(0).status, Dump::Done);
+    QCOMPARE(dump.table(1).status, Dump::Failed);
+    QVERIFY(!dump.table(1).error.isEmpty());
+    QVERIFY(!QFile::exists(QDir(dir).filePath("missing.sql")));
+}
+
+void tst_NativeDump::testSequenceStatement()
+{
+    QSqlDatabase db = QSqlDatabase::database("dump");
+    QCOMPARE(NativeDump::sequenceStatement(db, "t1", "id"),
+             QString("SELECT setval(pg_get_serial_sequence('\"t1\"', 'id'), "
+                     "COALESCE((SELECT MAX(\"id\") FROM \"t1\"), 0) + 1, false)"));
+}
+
+QTEST_MAIN(tst_NativeDump)
+#include "tst_nativedump.moc"
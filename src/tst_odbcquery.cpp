@@ -0,0 +1,130 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTemporaryDir>
+
+#include "odbcquery.h"
+#include "resultsource.h"
+#include "resultstore.h"
+#include "drivernames.h"
+
+// Runs against SQLite3 ODBC driver (unixODBC + sqliteodbc) or MUGI_TEST_ODBC connection string
+
+class tst_OdbcQuery : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testInsert();
+    void testSelect();
+    void testLongColumns();
+    void cleanupTestCase();
+
+protected:
+    QTemporaryDir mDir;
+    QSqlDatabase mDb;
+    void readAll(ResultSource* source, ResultStore* store);
+};
+
+void tst_OdbcQuery::initTestCase()
+{
+    QString connectionString = qEnvironmentVariable("MUGI_TEST_ODBC");
+    if (connectionString.isEmpty()) {
+        connectionString = QString("DRIVER={SQLite3};Database=%1").arg(mDir.filePath("test.db"));
+    }
+    mDb = QSqlDatabase::addDatabase(DRIVER_ODBC, "odbc_test");
+    mDb.setDatabaseName(connectionString);
+    if (!mDb.open()) {
+        QSKIP(qPrintable(mDb.lastError().text()));
+    }
+    QSqlQuery q(mDb);
+    q.exec("drop table odbc_test");
+    QVERIFY2(q.exec("create table odbc_test(id integer, value double precision, name varchar(32), dt timestamp, notes text)"),
+             qPrintable(q.lastError().text()));
+}
+
+void tst_OdbcQuery::cleanupTestCase()
+{
+    if (mDb.isOpen()) {
+        QSqlQuery q(mDb);
+        q.exec("drop table odbc_test");
+        mDb.close();
+    }
+}
+
+void tst_OdbcQuery::readAll(ResultSource *source, ResultStore *store)
+{
+    while (source->fetch(store, ResultStore::chunkRows) > 0) {
+
+    }
+}
+
+void tst_OdbcQuery::testInsert()
+{
+    QList<QVariantList> rows;
+    int count = OdbcQuery::paramsetSize * 2 + 11;
+    for(int i=0;i<count;i++) {
+        rows.append({i, i / 4.0, i % 3 == 0 ? QVariant(QMetaType(QMetaType::QString)) : QVariant(QString("name %1").arg(i)),
+                     QDateTime(QDate(2021, 3, 1), QTime(8, 0)).addSecs(i), QString(i % 50, QChar('x'))});
+    }
+    QString error;
+    QVERIFY2(OdbcQuery::insert(mDb, "insert into odbc_test(id, value, name, dt, notes) values (?, ?, ?, ?, ?)", rows, error),
+             qPrintable(error));
+
+    QSqlQuery q(mDb);
+    QVERIFY(q.exec("select count(*), sum(id) from odbc_test"));
+    QVERIFY(q.next());
+    QCOMPARE(q.value(0).toInt(), count);
+    QCOMPARE(q.value(1).toLongLong(), qlonglong(count) * (count - 1) / 2);
+}
+
+void tst_OdbcQuery::testSelect()
+{
+    QString query = "select id, value, name, dt from odbc_test order by id";
+    ResultSource* source;
+    int rowsAffected;
+    QString error;
+    QVERIFY2(OdbcQuery::exec(mDb, query, &source, &rowsAffected, error), qPrintable(error));
+    QVERIFY(source);
+    ResultStore store(source->record(), qint64(64) * 1024 * 1024);
+    readAll(source, &store);
+    delete source;
+
+    QSqlQuery expected(mDb);
+    expected.setForwardOnly(true);
+    QVERIFY(expected.exec(query));
+    int row = 0;
+    while (expected.next()) {
+        for(int column=0;column<4;column++) {
+            QVariant actual = store.value(row, column);
+            QVariant value = expected.value(column);
+            QCOMPARE(actual.isNull(), value.isNull());
+            QCOMPARE(actual.toString(), value.toString());
+        }
+        row++;
+    }
+    QCOMPARE(store.rowCount(), row);
+    QVERIFY(row > 0);
+}
+
+void tst_OdbcQuery::testLongColumns()
+{
+    QString query = "select id, notes from odbc_test order by id";
+    ResultSource* source;
+    int rowsAffected;
+    QString error;
+    QVERIFY2(OdbcQuery::exec(mDb, query, &source, &rowsAffected, error), qPrintable(error));
+    QVERIFY(source);
+    ResultStore store(source->record(), qint64(64) * 1024 * 1024);
+    readAll(source, &store);
+    delete source;
+    QVERIFY(store.rowCount() > 0);
+    for(int row=0;row<store.rowCount();row+=97) {
+        QCOMPARE(store.value(row, 1).toString(), QString(store.value(row, 0).toInt() % 50, QChar('x')));
+    }
+}
+
+QTEST_MAIN(tst_OdbcQuery)
+#include "tst_odbcquery.moc"
@@ -0,0 +1,114 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include "parallelrestore.h"
+#include "gzipfile.h"
+#include "drivernames.h"
+#include "testutils.h"
+
+class tst_ParallelRestore : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testTableName();
+    void testTextReferences();
+    void testOrder();
+    void testDatabaseReferences();
+
+protected:
+    QTemporaryDir mDir;
+    QString writeScript(const QString& name, const QByteArray& data);
+};
+
+void tst_ParallelRestore::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "restore");
+    db.setDatabaseName(mDir.filePath("restore.sqlite"));
+    QVERIFY(db.open());
+}
+
+QString tst_ParallelRestore::writeScript(const QString &name, const QByteArray &data)
+{
+    return TestUtils::writeFile(mDir.filePath(name), data);
+}
+
+void tst_ParallelRestore::testTableName()
+{
+    QCOMPARE(ParallelRestore::tableName("/tmp/dump/orders.sql"), QString("orders"));
+    QCOMPARE(ParallelRestore::tableName("/tmp/dump/orders.sql.gz"), QString("orders"));
+    QCOMPARE(ParallelRestore::tableName("orders.SQL"), QString("orders"));
+}
+
+void tst_ParallelRestore::testTextReferences()
+{
+    QString text = "create table c(id int, p int references `parent`(id), "
+                   "foreign key (x) references s.\"Other\"(id), "
+                   "note text default 'references fake(id)'); -- references comment(id)\n"
+                   "create table d(p int references parent(id))";
+    QCOMPARE(ParallelRestore::textReferences(text), QStringList({"parent", "other"}));
+    QCOMPARE(ParallelRestore::textReferences("create table t(id int)"), QStringList());
+}
+
+void tst_ParallelRestore::testOrder()
+{
+    QString parent = writeScript("parent.sql",
+                                 "create table parent(id integer primary key, name text);\n"
+                                 "insert into parent values (1, 'a');\n"
+                                 "insert into parent values (2, 'b');\n"
+                                 "create index parent_name on parent(name);\n");
+    QString child = writeScript("child.sql",
+                                "create table child(id integer primary key, parent integer references parent(id));\n"
+                                "insert into child values (1, 1);\n");
+    QString grandchild = mDir.filePath("grandchild.sql.gz");
+    GzipFile file(grandchild);
+    QVERIFY(file.open());
+    QVERIFY(file.write("create table grandchild(id integer, child integer, foreign key (child) references \"child\"(id));\n"
+                       "insert into grandchild values (1, 1);\n"));
+    QVERIFY(file.close());
+
+    ParallelRestore restore("restore");
+    QStringList started;
+    QStringList done;
+    connect(&restore, &Dump::tableChanged, this, [&](int index){
+        Dump::Table table = restore.table(index);
+        if (table.status == Dump::Running && !started.contains(table.name)) {
+            started.append(table.name);
+        } else if (table.status == Dump::Done) {
+            done.append(table.name);
+        }
+    });
+    QVERIFY(TestUtils::waitFinished(&restore, [&](){ restore.start({grandchild, child, parent}, 3); }));
+
+    QCOMPARE(restore.references(0), QStringList({"child"}));
+    QCOMPARE(restore.references(1), QStringList({"parent"}));
+    QCOMPARE(restore.references(2), QStringList());
+    QCOMPARE(started, QStringList({"parent", "child", "grandchild"}));
+    QCOMPARE(done, QStringList({"parent", "child", "grandchild"}));
+    QCOMPARE(restore.count(Dump::Done), 3);
+    QCOMPARE(restore.table(0).rows, qint64(2));
+    QCOMPARE(restore.table(1).rows, qint64(2));
+    QCOMPARE(restore.table(2).rows, qint64(4));
+    QCOMPARE(restore.rows(), qint64(8));
+    QCOMPARE(restore.table(0).bytes, restore.table(0).totalBytes);
+
+    QSqlQuery q(QSqlDatabase::database("restore"));
+    QVERIFY(q.exec("select count(*) from grandchild") && q.next());
+    QCOMPARE(q.value(0).toInt(), 1);
+    QVERIFY(q.exec("select count(*) from sqlite_master where type = 'index' and name = 'parent_name'") && q.next());
+    QCOMPARE(q.value(0).toInt(), 1);
+}
+
+void tst_ParallelRestore::testDatabaseReferences()
+{
+    QMap<QString, QStringList> references = ParallelRestore::databaseReferences(QSqlDatabase::database("restore"));
+    QCOMPARE(references.value("child"), QStringList({"parent"}));
+    QCOMPARE(references.value("grandchild"), QStringList({"child"}));
+    QVERIFY(!references.contains("parent"));
+}
+
+QTEST_MAIN(tst_ParallelRestore)
+#include "tst_parallelrestore.moc"
@@ -0,0 +1,105 @@
+#include <QTest>
+#include <QSqlField>
+#include <QSqlQueryModel>
+#include <QAbstractTableModel>
+#include <QTemporaryDir>
+#include <QDateTime>
+
+#include "resultsnapshot.h"
+
+class MockModel : public QAbstractTableModel {
+public:
+    MockModel(int rows) : mRows(rows) {}
+    int rowCount(const QModelIndex & = QModelIndex()) const override {
+        return mRows;
+    }
+    int columnCount(const QModelIndex & = QModelIndex()) const override {
+        return 3;
+    }
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override {
+        if (role != Qt::DisplayRole && role != Qt::EditRole) {
+            return QVariant();
+        }
+        int row = index.row();
+        switch (index.column()) {
+        case 0: return row;
+        case 1: return row % 5 == 0 ? QVariant(QMetaType(QMetaType::QString)) : QVariant(QString("name %1").arg(row));
+        case 2: return QDateTime(QDate(2020, 1, 1), QTime(12, 0)).addSecs(row);
+        }
+        return QVariant();
+    }
+    int mRows;
+};
+
+static QSqlRecord mockRecord()
+{
+    QSqlRecord record;
+    record.append(QSqlField("id", QMetaType(QMetaType::Int)));
+    record.append(QSqlField("name", QMetaType(QMetaType::QString)));
+    record.append(QSqlField("created", QMetaType(QMetaType::QDateTime)));
+    return record;
+}
+
+class tst_ResultSnapshot : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void testRoundTrip_data();
+    void testRoundTrip();
+    void testNotSnapshot();
+};
+
+void tst_ResultSnapshot::testRoundTrip_data()
+{
+    QTest::addColumn<bool>("compress");
+    QTest::addColumn<int>("rows");
+    QTest::newRow("plain") << false << ResultSnapshot::blockRows * 2 + 3;
+    QTest::newRow("compressed") << true << ResultSnapshot::blockRows * 2 + 3;
+    QTest::newRow("empty") << false << 0;
+}
+
+void tst_ResultSnapshot::testRoundTrip()
+{
+    QFETCH(bool, compress);
+    QFETCH(int, rows);
+
+    QTemporaryDir dir;
+    QString path = dir.filePath("test.mqsnap");
+    MockModel source(rows);
+    QString error;
+    QVERIFY(ResultSnapshot::save(&source, mockRecord(), path, compress, error));
+
+    QSqlQueryModel* model = ResultSnapshot::open(path, error);
+    QVERIFY2(model, qPrintable(error));
+    QCOMPARE(model->rowCount(), rows);
+    QCOMPARE(model->columnCount(), 3);
+    QCOMPARE(model->record().fieldName(1), QString("name"));
+    for(int row=0;row<rows;row+=113) {
+        for(int column=0;column<3;column++) {
+            QModelIndex index = source.index(row, column);
+            QCOMPARE(model->data(model->index(row, column)), source.data(index));
+        }
+    }
+    if (rows > 0) {
+        QVERIFY(model->data(model->index(5, 1)).isNull());
+    }
+    delete model;
+}
+
+void tst_ResultSnapshot::testNotSnapshot()
+{
+    QTemporaryDir dir;
+    QString path = dir.filePath("test.csv");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("a,b,c\n1,2,3\n4,5,6\n");
+    file.close();
+    QString error;
+    QSqlQueryModel* model = ResultSnapshot::open(path, error);
+    QVERIFY(model == nullptr);
+    QVERIFY(!error.isEmpty());
+}
+
+QTEST_MAIN(tst_ResultSnapshot)
+#include "tst_resultsnapshot.moc"
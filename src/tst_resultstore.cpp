@@ -0,0 +1,64 @@
+#include <QTest>
+#include <QSqlField>
+#include <QDateTime>
+
+#include "resultstore.h"
+
+static QSqlRecord mockRecord()
+{
+    QSqlRecord record;
+    record.append(QSqlField("id", QMetaType(QMetaType::Int)));
+    record.append(QSqlField("name", QMetaType(QMetaType::QString)));
+    record.append(QSqlField("value", QMetaType(QMetaType::Double)));
+    record.append(QSqlField("created", QMetaType(QMetaType::QDate)));
+    return record;
+}
+
+static QVariantList mockRow(int i)
+{
+    QVariant name = i % 7 == 0 ? QVariant(QMetaType(QMetaType::QString)) : QVariant(QString("name %1").arg(i));
+    return {i, name, i * 0.5, QDate(2020, 1, 1).addDays(i)};
+}
+
+class tst_ResultStore : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void testInMemory();
+    void testSpill();
+};
+
+void tst_ResultStore::testInMemory()
+{
+    ResultStore store(mockRecord(), 0);
+    int count = ResultStore::chunkRows * 3 + 10;
+    for(int i=0;i<count;i++) {
+        store.append(mockRow(i));
+    }
+    QCOMPARE(store.rowCount(), count);
+    QCOMPARE(store.isSpilled(), false);
+    QCOMPARE(store.row(count - 1), mockRow(count - 1));
+}
+
+void tst_ResultStore::testSpill()
+{
+    ResultStore store(mockRecord(), 64 * 1024);
+    int count = ResultStore::chunkRows * 10 + 10;
+    for(int i=0;i<count;i++) {
+        store.append(mockRow(i));
+    }
+    QCOMPARE(store.rowCount(), count);
+    QVERIFY(store.isSpilled());
+    QVERIFY(store.memoryBytes() < ResultStore::chunkRows * 1024);
+    for(int i=0;i<count;i+=97) {
+        QCOMPARE(store.row(i), mockRow(i));
+    }
+    QVariant name = store.value(7, 1);
+    QVERIFY(name.isNull());
+    QCOMPARE(name.typeId(), int(QMetaType::QString));
+    QCOMPARE(store.value(count - 1, 3).toDate(), QDate(2020, 1, 1).addDays(count - 1));
+}
+
+QTEST_MAIN(tst_ResultStore)
+#include "tst_resultstore.moc"
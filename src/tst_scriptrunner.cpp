@@ -0,0 +1,249 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include "scriptrunner.h"
+#include "gzipfile.h"
+#include "drivernames.h"
+#include "testutils.h"
+
+class tst_ScriptRunner : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testFile();
+    void testStopOnError();
+    void testDdlEndsBatch();
+    void testContinueOnError();
+    void testDelimiter();
+    void testRange();
+    void testGzipDeferIndexes();
+    void testGzipResume();
+
+protected:
+    QTemporaryDir mDir;
+    QString writeScript(const QString& name, const QByteArray& data);
+    static void run(ScriptRunner* runner, const QString& path, const ScriptRunner::Position& from = ScriptRunner::Position(),
+                    qint64 to = -1);
+    static int count(const QString& table);
+};
+
+void tst_ScriptRunner::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "script");
+    db.setDatabaseName(mDir.filePath("script.sqlite"));
+    QVERIFY(db.open());
+}
+
+QString tst_ScriptRunner::writeScript(const QString &name, const QByteArray &data)
+{
+    return TestUtils::writeFile(mDir.filePath(name), data);
+}
+
+void tst_ScriptRunner::run(ScriptRunner *runner, const QString &path, const ScriptRunner::Position &from, qint64 to)
+{
+    QVERIFY(TestUtils::waitFinished(runner, [&](){ runner->startFile(path, from, to); }));
+}
+
+int tst_ScriptRunner::count(const QString &table)
+{
+    QSqlQuery q(QSqlDatabase::database("script"));
+    if (!q.exec(QString("select count(*) from %1").arg(table)) || !q.next()) {
+        return -1;
+    }
+    return q.value(0).toInt();
+}
+
+void tst_ScriptRunner::testFile()
+{
+    QByteArray data = "\xEF\xBB\xBF-- generated\ncreate table t(id integer primary key, name text);\n";
+    for(int i=0;i<2500;i++) {
+        data += QString("insert into t values (%1, 'name; %1');\n").arg(i).toUtf8();
+    }
+    QString path = writeScript("t.sql", data);
+    ScriptRunner runner("script");
+    runner.setBatchSize(1000);
+    run(&runner, path);
+    QVERIFY(!runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(2501));
+    QCOMPARE(runner.errors(), qint64(0));
+    QCOMPARE(runner.bytes(), qint64(data.size()));
+    QCOMPARE(runner.resumePosition().offset, qint64(data.size()));
+    QCOMPARE(count("t"), 2500);
+}
+
+void tst_ScriptRunner::testStopOnError()
+{
+    QByteArray data = "create table e(id integer primary key);\n"
+                      "insert into e values (1);\n"
+                      "insert into e values (1);\n"
+                      "insert into e values (2);\n";
+    QString path = writeScript("e.sql", data);
+    ScriptRunner runner("script");
+    runner.setBatchSize(10);
+    run(&runner, path);
+    QVERIFY(runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(2));
+    QCOMPARE(runner.errors(), qint64(1));
+    QCOMPARE(runner.failedStatement(), QString("insert into e values (1)"));
+    QVERIFY(!runner.lastError().isEmpty());
+    // statements before failed one are committed
+    QCOMPARE(count("e"), 1);
+    // statement begins right after previous delimiter
+    QCOMPARE(runner.resumePosition().offset, qint64(data.lastIndexOf("\ninsert into e values (1)")));
+    QCOMPARE(runner.skipPosition().offset, qint64(data.indexOf("\ninsert into e values (2)")));
+
+    run(&runner, path, runner.resumePosition());
+    QVERIFY(runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(0));
+
+    run(&runner, path, runner.skipPosition());
+    QVERIFY(!runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(1));
+    QCOMPARE(count("e"), 2);
+}
+
+void tst_ScriptRunner::testDdlEndsBatch()
+{
+    QByteArray data = "create table d(id integer primary key);\n"
+                      "insert into d values (1);\n"
+                      "create table d2(id integer);\n"
+                      "insert into d values (2);\n"
+                      "insert into d values (2);\n";
+    QString path = writeScript("d.sql", data);
+    ScriptRunner runner("script");
+    runner.setBatchSize(100);
+    run(&runner, path);
+    QVERIFY(runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(4));
+    // only insert after create table is replayed
+    QCOMPARE(count("d"), 2);
+    QCOMPARE(count("d2"), 0);
+    QCOMPARE(runner.resumePosition().offset, qint64(data.lastIndexOf("\ninsert into d values (2)")));
+}
+
+void tst_ScriptRunner::testContinueOnError()
+{
+    QString path = writeScript("c.sql", "create table c(id integer primary key);\n"
+                                        "insert into c values (1);\n"
+                                        "insert into missing values (1);\n"
+                                        "insert into c values (2);\n");
+    ScriptRunner runner("script");
+    runner.setStopOnError(false);
+    QSignalSpy errors(&runner, SIGNAL(error(QString,QString)));
+    run(&runner, path);
+    QVERIFY(!runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(3));
+    QCOMPARE(runner.errors(), qint64(1));
+    QCOMPARE(errors.size(), 1);
+    QCOMPARE(count("c"), 2);
+}
+
+void tst_ScriptRunner::testDelimiter()
+{
+    QString path = writeScript("d.sql", "create table a(id integer);\n"
+                                        "create table b(id integer);\n"
+                                        "DELIMITER //\n"
+                                        "create trigger a_insert after insert on a begin insert into b values (new.id); end//\n"
+                                        "DELIMITER ;\n"
+                                        "insert into a values (1);\n"
+                                        "insert into a values (2);\n");
+    ScriptRunner runner("script");
+    runner.setBatchSize(1);
+    run(&runner, path);
+    QVERIFY(!runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(5));
+    QCOMPARE(count("b"), 2);
+    QCOMPARE(runner.resumePosition().delimiter, QString(";"));
+}
+
+void tst_ScriptRunner::testRange()
+{
+    QByteArray data = "create table r(id integer);\n"
+                      "insert into r values (1);\n"
+                      "insert into r values (2);\n"
+                      "insert into r values (3);\n";
+    QString path = writeScript("r.sql", data);
+    ScriptRunner runner("script");
+    run(&runner, path, ScriptRunner::Position(), data.indexOf("\ninsert"));
+    QVERIFY(!runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(1));
+    QCOMPARE(count("r"), 0);
+
+    qint64 from = data.indexOf("\ninsert into r values (2)");
+    qint64 to = data.indexOf("\ninsert into r values (3)");
+    run(&runner, path, {from, ";"}, to);
+    QVERIFY(!runner.isFailed());
+    QCOMPARE(runner.statements(), qint64(1));
+    QCOMPARE(runner.totalBytes(), to);
+    QCOMPARE(runner.resumePosition().offset, to);
+    QCOMPARE(count("r"), 1);
+}
+
+void tst_ScriptRunner::testGzipDeferIndexes()
+{
+    // index on column added later fails unless deferred
+    QByteArray data = "create table g(id integer);\n"
+                      "create index g_name on g(name);\n"
+                      "alter table g add column name text;\n"
+                      "insert into g values (1, 'a');\n"
+                      "insert into g values (2, 'b');\n";
+    QString path = mDir.filePath("g.sql.gz");
+    GzipFile file(path);
+    QVERIFY(file.open());
+    QVERIFY(file.write(data));
+    QVERIFY(file.close());
+
+    ScriptRunner runner("script");
+    runner.setInitStatements({"PRAGMA foreign_keys = OFF", "not a statement"});
+    runner.setDeferIndexes(true);
+    run(&runner, path);
+    QVERIFY(!runner.isFailed());
+    QCOMPARE(runner.errors(), qint64(0));
+    QCOMPARE(runner.statements(), qint64(5));
+    QCOMPARE(runner.totalBytes(), qint64(data.size()));
+    QCOMPARE(runner.resumePosition().offset, qint64(data.size()));
+    QCOMPARE(count("g"), 2);
+    QSqlQuery q(QSqlDatabase::database("script"));
+    QVERIFY(q.exec("select count(*) from sqlite_master where type = 'index' and name = 'g_name'") && q.next());
+    QCOMPARE(q.value(0).toInt(), 1);
+}
+
+void tst_ScriptRunner::testGzipResume()
+{
+    // spans several gzip members and splitter blocks
+    QByteArray data = "create table gr(id integer primary key, name text);\n";
+    QString padding(100, 'x');
+    qint64 half = 0;
+    for(int i=0;i<60000;i++) {
+        if (i == 30000) {
+            half = data.size();
+        }
+        data += QString("insert into gr values (%1, '%2');\n").arg(i).arg(padding).toUtf8();
+    }
+    QVERIFY(data.size() > ScriptRunner::blockSize + GzipFile::blockSize);
+    QString path = mDir.filePath("gr.sql.gz");
+    GzipFile file(path);
+    QVERIFY(file.open());
+    QVERIFY(file.write(data));
+    QVERIFY(file.close());
+
+    ScriptRunner first("script");
+    run(&first, path, ScriptRunner::Position(), half);
+    QVERIFY(!first.isFailed());
+    QCOMPARE(first.resumePosition().offset, half);
+    QCOMPARE(count("gr"), 30000);
+
+    ScriptRunner second("script");
+    run(&second, path, first.resumePosition());
+    QVERIFY(!second.isFailed());
+    QCOMPARE(second.statements(), qint64(30000));
+    QCOMPARE(second.resumePosition().offset, qint64(data.size()));
+    QCOMPARE(count("gr"), 60000);
+}
+
+QTEST_MAIN(tst_ScriptRunner)
+#include "tst_scriptrunner.moc"
@@ -0,0 +1,145 @@
+#include <QTest>
+
+#include "sqllexer.h"
+
+class tst_SqlLexer : public QObject {
+    Q_OBJECT
+private slots:
+    void tokens();
+    void pieces();
+    void split();
+    void split_data();
+    void splitLines();
+    void offsets();
+};
+
+void tst_SqlLexer::tokens()
+{
+    QString text = "select 'a''b', \"x\" -- c\n/* d */ 1.5e+3;";
+    SqlLexer::State state;
+    QList<SqlLexer::Token> tokens = SqlLexer::tokens(text, &state);
+    QList<SqlLexer::TokenType> types;
+    QStringList values;
+    for(const SqlLexer::Token& token: std::as_const(tokens)) {
+        types.append(token.type);
+        values.append(text.mid(token.pos, token.size));
+    }
+    QList<SqlLexer::TokenType> expected = {
+        SqlLexer::Word, SqlLexer::Whitespace, SqlLexer::String, SqlLexer::Operator, SqlLexer::Whitespace,
+        SqlLexer::QuotedIdentifier, SqlLexer::Whitespace, SqlLexer::Comment, SqlLexer::Whitespace,
+        SqlLexer::Comment, SqlLexer::Whitespace, SqlLexer::Number, SqlLexer::Delimiter
+    };
+    QCOMPARE(types, expected);
+    QCOMPARE(values[2], QString("'a''b'"));
+    QCOMPARE(values[7], QString("-- c"));
+    QCOMPARE(values[11], QString("1.5e+3"));
+    QVERIFY(state == SqlLexer::State());
+}
+
+void tst_SqlLexer::pieces()
+{
+    SqlLexer::State state;
+    QList<SqlLexer::Token> tokens = SqlLexer::tokens(u"select 'abc\n", &state);
+    QCOMPARE(tokens.last().type, SqlLexer::String);
+    QCOMPARE(state.context, SqlLexer::InString);
+    tokens = SqlLexer::tokens(u"def' /* a /* b\n", &state);
+    QCOMPARE(tokens.first().type, SqlLexer::String);
+    QCOMPARE(tokens.first().size, 4);
+    QCOMPARE(state.context, SqlLexer::InComment);
+    QCOMPARE(state.depth, 2);
+    tokens = SqlLexer::tokens(u"*/ c */ $q$ x\n", &state);
+    QCOMPARE(tokens.first().type, SqlLexer::Comment);
+    QCOMPARE(state.context, SqlLexer::InDollarString);
+    QCOMPARE(state.tag, QString("$q$"));
+    tokens = SqlLexer::tokens(u"$q$;", &state);
+    QCOMPARE(tokens.first().type, SqlLexer::String);
+    QCOMPARE(tokens.last().type, SqlLexer::Delimiter);
+    QVERIFY(state == SqlLexer::State());
+}
+
+void tst_SqlLexer::split_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QStringList>("statements");
+
+    QTest::newRow("simple") << "select 1; select 2;" << QStringList{"select 1", "select 2"};
+    QTest::newRow("no delimiter at end") << "select 1;\nselect 2\n" << QStringList{"select 1", "select 2"};
+    QTest::newRow("comments") << "-- first\nselect 1; -- done\n/* end */" << QStringList{"select 1"};
+    QTest::newRow("strings") << "select ';', \";\", `;`; select 2" << QStringList{"select ';', \";\", `;`", "select 2"};
+    QTest::newRow("escape") << "select 'a\\';b'; select 2" << QStringList{"select 'a\\';b'", "select 2"};
+    QTest::newRow("nested comment") << "select /* a /* b; */ c; */ 1; select 2"
+                                    << QStringList{"select /* a /* b; */ c; */ 1", "select 2"};
+    QTest::newRow("dollar") << "create function f() returns int as $body$ select 1; $body$ language sql; select $1"
+                            << QStringList{"create function f() returns int as $body$ select 1; $body$ language sql", "select $1"};
+    QTest::newRow("delimiter") << "DELIMITER //\ncreate procedure p() begin select 1; end//\nDELIMITER ;\nselect 2;"
+                               << QStringList{"create procedure p() begin select 1; end", "select 2"};
+    QTest::newRow("delimiter in statement") << "select delimiter from t;" << QStringList{"select delimiter from t"};
+}
+
+void tst_SqlLexer::split()
+{
+    QFETCH(QString, text);
+    QFETCH(QStringList, statements);
+    QCOMPARE(SqlSplitter::split(text), statements);
+}
+
+void tst_SqlLexer::splitLines()
+{
+    QString text = "insert into t values ('a\nb;c');\n/* x\ny; */ select 1;\nDELIMITER $$\nselect $q$\n;$q$$$\nDELIMITER ;\nselect 3";
+    SqlSplitter whole;
+    QList<SqlSplitter::Statement> expected;
+    whole.append(text, expected);
+    whole.finish(expected);
+    QCOMPARE(expected.size(), 4);
+
+    SqlSplitter splitter;
+    QList<SqlSplitter::Statement> statements;
+    qsizetype pos = 0;
+    while (pos < text.size()) {
+        qsizetype end = text.indexOf('\n', pos);
+        end = end < 0 ? text.size() : end + 1;
+        splitter.append(QStringView(text).mid(pos, end - pos), statements);
+        pos = end;
+    }
+    splitter.finish(statements);
+    QCOMPARE(statements.size(), expected.size());
+    for(int i=0;i<statements.size();i++) {
+        QCOMPARE(statements[i].text, expected[i].text);
+        QCOMPARE(statements[i].begin, expected[i].begin);
+        QCOMPARE(statements[i].end, expected[i].end);
+        QCOMPARE(statements[i].delimiter, expected[i].delimiter);
+    }
+    QCOMPARE(statements[1].text, QString("select 1"));
+    QCOMPARE(statements[2].text, QString("select $q$\n;$q$"));
+    QCOMPARE(statements[2].delimiter, QString(";"));
+    QCOMPARE(statements[3].text, QString("select 3"));
+    QCOMPARE(statements[3].delimiter, QString("$$"));
+    QCOMPARE(splitter.delimiter(), QString(";"));
+}
+
+void tst_SqlLexer::offsets()
+{
+    QString text = QString::fromUtf8("select '\xC3\xA9';\nselect 2;");
+    SqlSplitter splitter;
+    QList<SqlSplitter::Statement> statements;
+    splitter.append(text, statements);
+    splitter.finish(statements);
+    QCOMPARE(statements.size(), 2);
+    QCOMPARE(statements[0].begin, qint64(0));
+    QCOMPARE(statements[0].end, qint64(12));
+    QCOMPARE(statements[1].begin, qint64(12));
+    QCOMPARE(statements[1].end, qint64(22));
+    QCOMPARE(splitter.offset(), qint64(text.toUtf8().size()));
+    QCOMPARE(SqlSplitter::utf8Size(QString::fromUtf8("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80")), qint64(10));
+
+    // resumed splitter reports offsets in file
+    SqlSplitter resumed(12);
+    statements.clear();
+    resumed.append(QStringView(text).mid(11), statements);
+    QCOMPARE(statements.size(), 1);
+    QCOMPARE(statements[0].begin, qint64(12));
+    QCOMPARE(statements[0].end, qint64(22));
+}
+
+QTEST_MAIN(tst_SqlLexer)
+#include "tst_sqllexer.moc"
@@ -13,6 +13,12 @@ private slots:
 
     void splitQueries();
     void splitQueries_data();
+
+    void fingerprint();
+    void fingerprint_data();
+
+    void queryEffect();
+    void queryEffect_data();
 };
 
 void tst_SqlParse::colorQueries1() {
@@ -141,6 +147,10 @@ void tst_SqlParse::splitQueries_data()
     QTest::newRow("12") << "foo/*bar*/;baz" << QStringList{"foo/*bar*/","baz"};
     QTest::newRow("13") << "foo--/*bar\n;*/baz" << QStringList{"foo--/*bar\n","*/baz"};
     QTest::newRow("14") << "foo'/*bar';*/baz" << QStringList{"foo'/*bar'","*/baz"};
+    QTest::newRow("quoted") << "foo\"b;r\";`b;z`" << QStringList{"foo\"b;r\"","`b;z`"};
+    QTest::newRow("nested") << "foo/*a/*b;*/c;*/;bar" << QStringList{"foo/*a/*b;*/c;*/","bar"};
+    QTest::newRow("dollar") << "foo $$a;b$$;bar" << QStringList{"foo $$a;b$$","bar"};
+    QTest::newRow("delimiter") << "delimiter //\nfoo;bar//\ndelimiter ;\nbaz" << QStringList{"\nfoo;bar","\nbaz"};
 }
 
 void tst_SqlParse::splitQueries()
@@ -151,7 +161,55 @@ void tst_SqlParse::splitQueries()
     QCOMPARE(actual, expected);
 }
 
+void tst_SqlParse::fingerprint_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("literals") << "SELECT *  FROM t WHERE id = 10 AND name='x'" << "select*from t where id=? and name=?";
+    QTest::newRow("spaces") << "select * from t where id=11\n and name = 'it''s'" << "select*from t where id=? and name=?";
+    QTest::newRow("identifiers") << "select c1, t2.c_3 from t2" << "select c1,t2.c_3 from t2";
+    QTest::newRow("numbers") << "select 1.5e3, 0x1F, -2" << "select ?,?,-?";
+    QTest::newRow("in") << "select * from t where id in (1, 2, 3)" << "select*from t where id in(?+)";
+    QTest::newRow("in1") << "select * from t where id in (7)" << "select*from t where id in(?+)";
+    QTest::newRow("values") << "insert into t values (1,'a'), (2,'b');" << "insert into t values(?+)";
+    QTest::newRow("comments") << "select /* all */ a -- note\nfrom t" << "select a from t";
+}
+
+void tst_SqlParse::fingerprint()
+{
+    QFETCH(QString, query);
+    QFETCH(QString, expected);
+    QCOMPARE(SqlParse::fingerprint(query), expected);
+}
+
+void tst_SqlParse::queryEffect_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<int>("type");
+    QTest::addColumn<QString>("table");
+    QTest::addColumn<QString>("oldName");
+
+    QTest::newRow("create") << "create table foo(id int)" << int(QueryEffect::Create) << "foo" << "";
+    QTest::newRow("create upper") << "CREATE TEMPORARY TABLE IF NOT EXISTS `foo` (id int)" << int(QueryEffect::Create) << "foo" << "";
+    QTest::newRow("drop") << "-- cleanup\ndrop table if exists db.foo" << int(QueryEffect::Drop) << "db.foo" << "";
+    QTest::newRow("alter") << "alter table foo add column bar int" << int(QueryEffect::Alter) << "foo" << "";
+    QTest::newRow("rename") << "rename table foo to bar" << int(QueryEffect::Rename) << "bar" << "foo";
+    QTest::newRow("string") << "select 'create table foo'" << int(QueryEffect::None) << "" << "";
+    QTest::newRow("comment") << "/* drop table foo */ select 1" << int(QueryEffect::None) << "" << "";
+}
 
+void tst_SqlParse::queryEffect()
+{
+    QFETCH(QString, query);
+    QFETCH(int, type);
+    QFETCH(QString, table);
+    QFETCH(QString, oldName);
+    QueryEffect effect = SqlParse::queryEffect(query);
+    QCOMPARE(int(effect.type), type);
+    QCOMPARE(effect.table, table);
+    QCOMPARE(effect.oldName, oldName);
+}
 
 QTEST_MAIN(tst_SqlParse)
 #include "tst_sqlparse.moc"
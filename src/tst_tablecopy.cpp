@@ -0,0 +1,159 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTemporaryDir>
+
+#include "tablecopy.h"
+#include "sqldatatypes.h"
+#include "drivernames.h"
+#include "testutils.h"
+
+class tst_TableCopy : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testTypeName();
+    void testDecimalType();
+    void testFields();
+    void testCopy();
+    void testMissing();
+    void testConflict();
+
+protected:
+    QTemporaryDir mDir;
+    static void run(TableCopy* copy, const QStringList& tables);
+};
+
+void tst_TableCopy::initTestCase()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, "source");
+    db.setDatabaseName(mDir.filePath("source.sqlite"));
+    QVERIFY(db.open());
+    QSqlQuery q(db);
+    QVERIFY(q.exec("create table t1(id integer primary key, name text, value real, data blob)"));
+    QVERIFY(q.exec("create table t2(code text primary key, note text)"));
+    QVERIFY(db.transaction());
+    for(int i=0;i<2500;i++) {
+        QVERIFY(q.exec(QString("insert into t1 values (%1, 'name %1', %1.5, x'0102')").arg(i)));
+    }
+    QVERIFY(q.exec("insert into t1 values (5000000000, null, null, null)"));
+    QVERIFY(q.exec("insert into t2 values ('a', 'quote '' and, comma')"));
+    QVERIFY(db.commit());
+
+    QSqlDatabase target = QSqlDatabase::addDatabase(DRIVER_SQLITE, "target");
+    target.setDatabaseName(mDir.filePath("target.sqlite"));
+    QVERIFY(target.open());
+}
+
+void tst_TableCopy::run(TableCopy *copy, const QStringList &tables)
+{
+    QVERIFY(TestUtils::waitFinished(copy, [&](){ copy->start(tables); }));
+}
+
+void tst_TableCopy::testTypeName()
+{
+    QCOMPARE(TableCopy::typeName(QMetaType::Bool), QString("INT"));
+    QCOMPARE(TableCopy::typeName(QMetaType::UInt), QString("BIGINT"));
+    QCOMPARE(TableCopy::typeName(QMetaType::LongLong), QString("BIGINT"));
+    QCOMPARE(TableCopy::typeName(QMetaType::Float), QString("DOUBLE"));
+    QCOMPARE(TableCopy::typeName(QMetaType::QDateTime), QString("DATETIME"));
+    QCOMPARE(TableCopy::typeName(QMetaType::QByteArray), QString("BLOB"));
+    QCOMPARE(TableCopy::typeName(QMetaType::QUuid), QString("TEXT"));
+    // every name has driver type
+    QStringList names = SqlDataTypes::names();
+    QMap<QString, QMetaType::Type> variant = SqlDataTypes::mapToVariant();
+    const QStringList drivers = {DRIVER_MYSQL, DRIVER_PSQL, DRIVER_SQLITE};
+    for(const QString& driver: drivers) {
+        QMap<QMetaType::Type, QString> specific = SqlDataTypes::mapToDriver(driver);
+        for(const QString& name: names) {
+            QVERIFY2(!specific.value(variant.value(name)).isEmpty(), qPrintable(driver + " " + name));
+        }
+    }
+}
+
+void tst_TableCopy::testDecimalType()
+{
+    // result and table field of QPSQL
+    QCOMPARE(TableCopy::decimalType(DRIVER_PSQL, 10, 2), QString("DECIMAL(10,2)"));
+    QCOMPARE(TableCopy::decimalType(DRIVER_PSQL, (10 << 16) | 2, -1), QString("DECIMAL(10,2)"));
+    // display length of DECIMAL(10,2)
+    QCOMPARE(TableCopy::decimalType(DRIVER_MYSQL, 12, 2), QString("DECIMAL(11,2)"));
+    QCOMPARE(TableCopy::decimalType(DRIVER_MYSQL, 11, 0), QString("DECIMAL(11,0)"));
+    // unconstrained numeric
+    QCOMPARE(TableCopy::decimalType(DRIVER_PSQL, -1, -1), QString("DECIMAL(65,30)"));
+    QCOMPARE(TableCopy::decimalType(DRIVER_PSQL, 100, 40), QString("DECIMAL(65,30)"));
+}
+
+void tst_TableCopy::testFields()
+{
+    QSqlDatabase db = QSqlDatabase::database("source");
+    // sqlite integer is 64 bit
+    QCOMPARE(TableCopy::fields(db, "t1", db.record("t1")).value(0).type(), QString("BIGINT"));
+    QList<Field> fields = TableCopy::fields(db, "t2", db.record("t2"));
+    QCOMPARE(fields.size(), 2);
+    QCOMPARE(fields[0].name(), QString("code"));
+    QVERIFY(fields[0].primaryKey());
+    // indexed text has length
+    QCOMPARE(fields[0].size(), 255);
+    QVERIFY(!fields[1].primaryKey());
+    QCOMPARE(fields[1].size(), -1);
+}
+
+void tst_TableCopy::testCopy()
+{
+    TableCopy copy("source", "target");
+    copy.setBatchRows(100);
+    copy.setQueueSize(2);
+    run(&copy, {"t1", "t2"});
+    QCOMPARE(copy.count(Dump::Done), 2);
+    QCOMPARE(copy.table(0).rows, qint64(2501));
+    QCOMPARE(copy.table(1).rows, qint64(1));
+    QVERIFY(copy.table(0).bytes > 0);
+    QVERIFY(copy.readerWaitSeconds() >= 0);
+
+    QSqlQuery q(QSqlDatabase::database("target"));
+    QVERIFY(q.exec("select count(*), sum(value), count(data) from t1 where id < 2500") && q.next());
+    QCOMPARE(q.value(0).toInt(), 2500);
+    QCOMPARE(q.value(1).toDouble(), 2500 * 2499 / 2 + 2500 * 0.5);
+    QCOMPARE(q.value(2).toInt(), 2500);
+    QVERIFY(q.exec("select name, value, data from t1 where id = 5000000000") && q.next());
+    QVERIFY(q.value(0).isNull());
+    QVERIFY(q.value(1).isNull());
+    QVERIFY(q.value(2).isNull());
+    QVERIFY(q.exec("select data from t1 where id = 1") && q.next());
+    QCOMPARE(q.value(0).toByteArray(), QByteArray("\x01\x02"));
+    QVERIFY(q.exec("select note from t2 where code = 'a'") && q.next());
+    QCOMPARE(q.value(0).toString(), QString("quote ' and, comma"));
+}
+
+void tst_TableCopy::testMissing()
+{
+    QSqlDatabase target = QSqlDatabase::addDatabase(DRIVER_SQLITE, "target2");
+    target.setDatabaseName(mDir.filePath("target2.sqlite"));
+    QVERIFY(target.open());
+    TableCopy copy("source", "target2");
+    run(&copy, {"missing", "t2"});
+    QCOMPARE(copy.table(0).status, Dump::Failed);
+    QVERIFY(!copy.table(0).error.isEmpty());
+    QCOMPARE(copy.table(1).status, Dump::Done);
+    QVERIFY(!target.record("missing").count());
+}
+
+void tst_TableCopy::testConflict()
+{
+    // t2 exists on target with the same primary key
+    TableCopy copy("source", "target");
+    run(&copy, {"t2"});
+    QCOMPARE(copy.table(0).status, Dump::Failed);
+    QVERIFY(!copy.table(0).error.isEmpty());
+    QCOMPARE(copy.table(0).rows, qint64(0));
+    QSqlQuery q(QSqlDatabase::database("target"));
+    QVERIFY(q.exec("select count(*) from t2") && q.next());
+    QCOMPARE(q.value(0).toInt(), 1);
+}
+
+QTEST_MAIN(tst_TableCopy)
+#include "tst_tablecopy.moc"
@@ -0,0 +1,162 @@
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include "tablediff.h"
+#include "drivernames.h"
+#include "testutils.h"
+
+class tst_TableDiff : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void initTestCase();
+    void testChecksumQuery();
+    void testRangeCondition();
+    void testRowText();
+    void testEqual();
+    void testIntegerKey();
+    void testTextKey();
+    void testMaxRows();
+    void testNoKey();
+
+protected:
+    QTemporaryDir mDir;
+    static void run(TableDiff* diff);
+};
+
+void tst_TableDiff::initTestCase()
+{
+    const QStringList names = {"db1", "db2"};
+    for(const QString& name: names) {
+        QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER_SQLITE, name);
+        db.setDatabaseName(mDir.filePath(name + ".sqlite"));
+        QVERIFY(db.open());
+        QSqlQuery q(db);
+        QVERIFY(q.exec("create table t1(id integer primary key, name text, value real)"));
+        QVERIFY(q.exec("create table t2(code text primary key, note text)"));
+        QVERIFY(q.exec("create table t3(name text)"));
+        QVERIFY(db.transaction());
+        for(int i=0;i<10000;i++) {
+            QVERIFY(q.exec(QString("insert into t1 values (%1, 'name %1', %1.5)").arg(i)));
+        }
+        for(int i=0;i<3000;i++) {
+            QVERIFY(q.exec(QString("insert into t2 values ('code %1', null)").arg(i)));
+        }
+        QVERIFY(db.commit());
+    }
+    QSqlQuery q(QSqlDatabase::database("db2"));
+    QVERIFY(q.exec("update t1 set name = 'changed' where id = 1234"));
+    QVERIFY(q.exec("delete from t1 where id = 5678"));
+    QVERIFY(q.exec("insert into t1 values (20000, 'new', null)"));
+    QVERIFY(q.exec("update t2 set note = '' where code = 'code 2000'"));
+}
+
+void tst_TableDiff::run(TableDiff *diff)
+{
+    QVERIFY(TestUtils::waitFinished(diff, [&](){ diff->start(); }));
+}
+
+void tst_TableDiff::testChecksumQuery()
+{
+    QCOMPARE(TableDiff::checksumQuery(TableDiff::Crc32, "`t`", {"`a`", "`b`"}, {"`a`"}, "1 = 1", true),
+             QString("SELECT COUNT(*), COALESCE(BIT_XOR(CRC32(CONCAT_WS('#', `a`, `b`, CONCAT(ISNULL(`a`), ISNULL(`b`))))), 0), "
+                     "MIN(`a`), MAX(`a`) FROM `t` WHERE 1 = 1"));
+    QCOMPARE(TableDiff::checksumQuery(TableDiff::Md5, "\"t\"", {"\"a\"", "\"b\""}, {"\"a\""}, "\"a\" >= ?", false),
+             QString("SELECT COUNT(*), COALESCE(SUM(('x' || left(md5(ROW(\"a\", \"b\")::text), 16))::bit(64)::bigint), 0) "
+                     "FROM \"t\" WHERE \"a\" >= ?"));
+    QCOMPARE(TableDiff::checksumQuery(TableDiff::Local, "t", {"a", "b"}, {"a"}, "1 = 1", true),
+             QString("SELECT a, b FROM t WHERE 1 = 1"));
+}
+
+void tst_TableDiff::testRangeCondition()
+{
+    QCOMPARE(TableDiff::rangeCondition({"a"}, TableDiff::Range()), QString("1 = 1"));
+    QCOMPARE(TableDiff::rangeCondition({"a"}, {{1}, {10}}), QString("a >= ? AND a < ?"));
+    QCOMPARE(TableDiff::rangeCondition({"a", "b"}, {{}, {1, 2}}), QString("(a, b) < (?, ?)"));
+}
+
+void tst_TableDiff::testRowText()
+{
+    // null, empty and separators are distinct
+    QVERIFY(TableDiff::rowText({QVariant()}) != TableDiff::rowText({QString("")}));
+    QVERIFY(TableDiff::rowText({"a;", "b"}) != TableDiff::rowText({"a", ";b"}));
+    QCOMPARE(TableDiff::rowText({1, QByteArray("\x01")}), QString("1:1;2:01;"));
+}
+
+void tst_TableDiff::testEqual()
+{
+    TableDiff diff("db1", "t1", "db1", "t1");
+    run(&diff);
+    QVERIFY(diff.error().isEmpty());
+    QCOMPARE(diff.method(), TableDiff::Local);
+    QCOMPARE(diff.rows().size(), 0);
+    QCOMPARE(diff.checksums(), qint64(1));
+    QCOMPARE(diff.fetchedRows(), qint64(0));
+}
+
+void tst_TableDiff::testIntegerKey()
+{
+    TableDiff diff("db1", "t1", "db2", "t1");
+    diff.setFanOut(4);
+    diff.setLeafRows(100);
+    run(&diff);
+    QVERIFY(diff.error().isEmpty());
+    QCOMPARE(diff.columns(), QStringList({"id", "name", "value"}));
+    QCOMPARE(diff.keyColumns(), QList<int>({0}));
+    QList<TableDiff::Row> rows = diff.rows();
+    QCOMPARE(rows.size(), 3);
+    QMap<qint64, TableDiff::Row> byKey;
+    for(const TableDiff::Row& row: rows) {
+        byKey.insert((row.change == TableDiff::Inserted ? row.values2 : row.values1).value(0).toLongLong(), row);
+    }
+    QCOMPARE(byKey.value(1234).change, TableDiff::Changed);
+    QCOMPARE(byKey.value(1234).values2.value(1).toString(), QString("changed"));
+    QCOMPARE(byKey.value(5678).change, TableDiff::Removed);
+    QCOMPARE(byKey.value(20000).change, TableDiff::Inserted);
+    // only mismatching leaves are fetched
+    QVERIFY(diff.fetchedRows() > 0);
+    QVERIFY(diff.fetchedRows() < 2000);
+    QVERIFY(diff.checksums() > 1);
+}
+
+void tst_TableDiff::testTextKey()
+{
+    TableDiff diff("db1", "t2", "db2", "t2");
+    diff.setFanOut(4);
+    diff.setLeafRows(100);
+    run(&diff);
+    QVERIFY(diff.error().isEmpty());
+    QList<TableDiff::Row> rows = diff.rows();
+    QCOMPARE(rows.size(), 1);
+    QCOMPARE(rows[0].change, TableDiff::Changed);
+    QCOMPARE(rows[0].values1.value(0).toString(), QString("code 2000"));
+    QVERIFY(rows[0].values1.value(1).isNull());
+    QCOMPARE(rows[0].values2.value(1).toString(), QString(""));
+    QVERIFY(diff.fetchedRows() < 1000);
+}
+
+void tst_TableDiff::testMaxRows()
+{
+    TableDiff diff("db1", "t1", "db2", "t1");
+    diff.setMaxRows(1);
+    run(&diff);
+    QVERIFY(diff.error().isEmpty());
+    QCOMPARE(diff.rows().size(), 1);
+    QVERIFY(diff.isTruncated());
+}
+
+void tst_TableDiff::testNoKey()
+{
+    TableDiff diff("db1", "t3", "db2", "t3");
+    run(&diff);
+    QVERIFY(!diff.error().isEmpty());
+    TableDiff missing("db1", "missing", "db2", "t1");
+    run(&missing);
+    QVERIFY(!missing.error().isEmpty());
+}
+
+QTEST_MAIN(tst_TableDiff)
+#include "tst_tablediff.moc"
@@ -0,0 +1,151 @@
+#include <QTest>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTemporaryDir>
+
+#include "trace.h"
+
+class tst_Trace : public QObject {
+    Q_OBJECT
+public:
+
+private slots:
+    void init();
+    void cleanup();
+    void testDisabled();
+    void testSpans();
+    void testCounter();
+    void testThreads();
+    void testStall();
+    void testSave();
+
+protected:
+    QJsonArray events(const QString& name);
+};
+
+void tst_Trace::init()
+{
+    Trace::instance()->clear();
+}
+
+void tst_Trace::cleanup()
+{
+    Trace::instance()->setEnabled(false);
+}
+
+QJsonArray tst_Trace::events(const QString &name)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(Trace::instance()->toJson());
+    const QJsonArray events = doc.object()["traceEvents"].toArray();
+    QJsonArray res;
+    for(const QJsonValue& event: events) {
+        if (event.toObject()["name"].toString() == name) {
+            res.append(event);
+        }
+    }
+    return res;
+}
+
+void tst_Trace::testDisabled()
+{
+    {
+        TRACE_SCOPE("disabled");
+        TRACE_COUNTER("disabled", 1);
+    }
+    QCOMPARE(events("disabled").size(), 0);
+}
+
+void tst_Trace::testSpans()
+{
+    Trace::instance()->setEnabled(true);
+    {
+        TRACE_SCOPE("outer");
+        {
+            TRACE_SCOPE("inner");
+            QCOMPARE(Trace::instance()->guiStack(), QStringList({"outer", "inner"}));
+            QThread::msleep(2);
+        }
+    }
+    QCOMPARE(Trace::instance()->guiStack(), QStringList());
+    QJsonArray outer = events("outer");
+    QJsonArray inner = events("inner");
+    QCOMPARE(outer.size(), 1);
+    QCOMPARE(inner.size(), 1);
+    QJsonObject o = outer[0].toObject();
+    QJsonObject i = inner[0].toObject();
+    QCOMPARE(o["ph"].toString(), QString("X"));
+    QVERIFY(i["dur"].toInteger() >= 2000);
+    QVERIFY(o["ts"].toInteger() <= i["ts"].toInteger());
+    QVERIFY(o["ts"].toInteger() + o["dur"].toInteger() >= i["ts"].toInteger() + i["dur"].toInteger());
+}
+
+void tst_Trace::testCounter()
+{
+    Trace::instance()->setEnabled(true);
+    TRACE_COUNTER("rows", 10);
+    TRACE_COUNTER("rows", 20);
+    QJsonArray rows = events("rows");
+    QCOMPARE(rows.size(), 2);
+    QCOMPARE(rows[0].toObject()["ph"].toString(), QString("C"));
+    QCOMPARE(rows[1].toObject()["args"].toObject()["value"].toInteger(), 20);
+}
+
+void tst_Trace::testThreads()
+{
+    Trace::instance()->setEnabled(true);
+    QThread* thread = QThread::create([](){
+        for(int i=0;i<Trace::bufferSize + 10;i++) {
+            TRACE_SCOPE("worker");
+        }
+    });
+    thread->start();
+    QVERIFY(thread->wait(10000));
+    delete thread;
+    // ring keeps last bufferSize events
+    QJsonArray worker = events("worker");
+    QCOMPARE(worker.size(), int(Trace::bufferSize));
+    QVERIFY(worker[0].toObject()["tid"].toInt() != 0);
+    for(int i=1;i<worker.size();i++) {
+        QVERIFY(worker[i - 1].toObject()["ts"].toInteger() <= worker[i].toObject()["ts"].toInteger());
+    }
+}
+
+void tst_Trace::testStall()
+{
+    Trace::instance()->setStallThreshold(100);
+    Trace::instance()->setEnabled(true);
+    QTest::qWait(50);
+    {
+        TRACE_SCOPE("blocking");
+        QThread::msleep(400);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(events("stall").size(), 1, 5000);
+    QJsonObject stall = events("stall")[0].toObject();
+    QCOMPARE(stall["args"].toObject()["stack"].toString(), QString("blocking"));
+    QVERIFY(stall["dur"].toInteger() >= 300000);
+}
+
+void tst_Trace::testSave()
+{
+    Trace::instance()->setEnabled(true);
+    {
+        TRACE_SCOPE("saved");
+    }
+    QTemporaryDir dir;
+    QString path = dir.filePath("trace.json");
+    QString error;
+    QVERIFY(Trace::instance()->save(path, error));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    QCOMPARE(parseError.error, QJsonParseError::NoError);
+    QVERIFY(doc.object()["traceEvents"].toArray().size() > 0);
+    QVERIFY(!Trace::instance()->save(dir.filePath("missing/trace.json"), error));
+    QVERIFY(!error.isEmpty());
+}
+
+QTEST_MAIN(tst_Trace)
+#include "tst_trace.moc"
@@ -0,0 +1,167 @@
+#include "valuecodec.h"
+
+#include <QDataStream>
+#include <QDateTime>
+
+namespace {
+
+enum Tag {
+    TagNull = 0,
+    TagInt,
+    TagUInt,
+    TagLongLong,
+    TagULongLong,
+    TagDouble,
+    TagBool,
+    TagString,
+    TagByteArray,
+    TagDate,
+    TagTime,
+    TagDateTime,
+    TagVariant
+};
+
+}
+
+namespace ValueCodec {
+
+void write(QDataStream &stream, const QVariant &value)
+{
+    if (value.isNull()) {
+        // keep type for typed nulls
+        stream << quint8(TagNull) << qint32(value.typeId());
+        return;
+    }
+    switch (value.typeId()) {
+    case QMetaType::Int:
+    case QMetaType::Short:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+        stream << quint8(TagInt) << qint32(value.toInt());
+        break;
+    case QMetaType::UInt:
+    case QMetaType::UShort:
+    case QMetaType::UChar:
+        stream << quint8(TagUInt) << quint32(value.toUInt());
+        break;
+    case QMetaType::LongLong:
+    case QMetaType::Long:
+        stream << quint8(TagLongLong) << qint64(value.toLongLong());
+        break;
+    case QMetaType::ULongLong:
+    case QMetaType::ULong:
+        stream << quint8(TagULongLong) << quint64(value.toULongLong());
+        break;
+    case QMetaType::Double:
+    case QMetaType::Float:
+        stream << quint8(TagDouble) << value.toDouble();
+        break;
+    case QMetaType::Bool:
+        stream << quint8(TagBool) << quint8(value.toBool() ? 1 : 0);
+        break;
+    case QMetaType::QString:
+        stream << quint8(TagString) << value.toString().toUtf8();
+        break;
+    case QMetaType::QByteArray:
+        stream << quint8(TagByteArray) << value.toByteArray();
+        break;
+    case QMetaType::QDate:
+        stream << quint8(TagDate) << qint64(value.toDate().toJulianDay());
+        break;
+    case QMetaType::QTime:
+        stream << quint8(TagTime) << qint32(value.toTime().msecsSinceStartOfDay());
+        break;
+    case QMetaType::QDateTime:
+        stream << quint8(TagDateTime) << value.toDateTime();
+        break;
+    default:
+        stream << quint8(TagVariant) << value;
+        break;
+    }
+}
+
+QVariant read(QDataStream &stream)
+{
+    quint8 tag;
+    stream >> tag;
+    switch (tag) {
+    case TagNull: {
+        qint32 type;
+        stream >> type;
+        return QVariant(QMetaType(type));
+    }
+    case TagInt: {
+        qint32 v;
+        stream >> v;
+        return QVariant(int(v));
+    }
+    case TagUInt: {
+        quint32 v;
+        stream >> v;
+        return QVariant(uint(v));
+    }
+    case TagLongLong: {
+        qint64 v;
+        stream >> v;
+        return QVariant(qlonglong(v));
+    }
+    case TagULongLong: {
+        quint64 v;
+        stream >> v;
+        return QVariant(qulonglong(v));
+    }
+    case TagDouble: {
+        double v;
+        stream >> v;
+        return QVariant(v);
+    }
+    case TagBool: {
+        quint8 v;
+        stream >> v;
+        return QVariant(v != 0);
+    }
+    case TagString: {
+        QByteArray v;
+        stream >> v;
+        return QVariant(QString::fromUtf8(v));
+    }
+    case TagByteArray: {
+        QByteArray v;
+        stream >> v;
+        return QVariant(v);
+    }
+    case TagDate: {
+        qint64 v;
+        stream >> v;
+        return QVariant(QDate::fromJulianDay(v));
+    }
+    case TagTime: {
+        qint32 v;
+        stream >> v;
+        return QVariant(QTime::fromMSecsSinceStartOfDay(v));
+    }
+    case TagDateTime: {
+        QDateTime v;
+        stream >> v;
+        return QVariant(v);
+    }
+    case TagVariant: {
+        QVariant v;
+        stream >> v;
+        return v;
+    }
+    }
+    stream.setStatus(QDataStream::ReadCorruptData);
+    return QVariant();
+}
+
+qint64 memorySize(const QVariant &value)
+{
+    switch (value.typeId()) {
+    case QMetaType::QString: return sizeof(QVariant) + value.toString().size() * 2;
+    case QMetaType::QByteArray: return sizeof(QVariant) + value.toByteArray().size();
+    }
+    return sizeof(QVariant);
+}
+
+}
@@ -0,0 +1,21 @@
+#ifndef VALUECODEC_H
+#define VALUECODEC_H
+
+#include <QVariant>
+class QDataStream;
+
+// Compact binary encoding for result values: one tag byte followed by payload,
+// strings are stored as utf8, dates as julian days, times as msecs.
+
+namespace ValueCodec {
+
+void write(QDataStream& stream, const QVariant& value);
+
+QVariant read(QDataStream& stream);
+
+// approximate memory used by value
+qint64 memorySize(const QVariant& value);
+
+}
+
+#endif // VALUECODEC_H
@@ -31,7 +31,12 @@ QStringList CheckableView::checked() const
     return mModel->checked();
 }
 
-static void setChecked(QAbstractItemModel* model, Qt::CheckState state) {
+void CheckableView::setChecked(const QStringList &items)
+{
+    mModel->setChecked(items);
+}
+
+static void setCheckState(QAbstractItemModel* model, Qt::CheckState state) {
     for(int row=0;row<model->rowCount();row++) {
         auto index = model->index(row, 0);
         model->setData(index, state, Qt::CheckStateRole);
@@ -40,12 +45,12 @@ static void setChecked(QAbstractItemModel* model, Qt::CheckState state) {
 
 void CheckableView::on_checkAll_clicked()
 {
-    setChecked(mProxyModel, Qt::Checked);
+    setCheckState(mProxyModel, Qt::Checked);
 }
 
 void CheckableView::on_uncheckAll_clicked()
 {
-    setChecked(mProxyModel, Qt::Unchecked);
+    setCheckState(mProxyModel, Qt::Unchecked);
 }
 
 void CheckableView::on_filter_textChanged(const QString &text)
@@ -22,6 +22,8 @@ public:
 
     QStringList checked() const;
 
+    void setChecked(const QStringList& items);
+
 public slots:
     void on_checkAll_clicked();
     void on_uncheckAll_clicked();
@@ -28,11 +28,21 @@ QString CompareTableItemWidget::database() const
     return ui->database->currentText();
 }
 
+void CompareTableItemWidget::setDatabase(const QString &connectionName)
+{
+    ui->database->setCurrentText(connectionName);
+}
+
 QString CompareTableItemWidget::table() const
 {
     return ui->table->text();
 }
 
+void CompareTableItemWidget::setTable(const QString &table)
+{
+    ui->table->setText(table);
+}
+
 
 
 void CompareTableItemWidget::on_database_currentIndexChanged(int index)
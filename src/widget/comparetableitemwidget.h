@@ -18,8 +18,10 @@ public:
     void init(const QStringList& connectionNames);
 
     QString database() const;
+    void setDatabase(const QString& connectionName);
 
     QString table() const;
+    void setTable(const QString& table);
 
 private slots:
     void on_database_currentIndexChanged(int index);
@@ -1,12 +1,17 @@
 #include "comparetablewidget.h"
 #include "ui_comparetablewidget.h"
 
+#include <QStandardItemModel>
+#include "tablediff.h"
 
 CompareTableWidget::CompareTableWidget(QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::CompareTableWidget)
+    ui(new Ui::CompareTableWidget),
+    mDiff(nullptr),
+    mModel(new QStandardItemModel(this))
 {
     ui->setupUi(this);
+    ui->tableView->setModel(mModel);
 }
 
 CompareTableWidget::~CompareTableWidget()
@@ -14,6 +19,26 @@ CompareTableWidget::~CompareTableWidget()
     delete ui;
 }
 
+void CompareTableWidget::init(const QStringList &connectionNames)
+{
+    ui->source1->init(connectionNames);
+    ui->source2->init(connectionNames);
+}
+
+void CompareTableWidget::setTables(const QString &database1, const QString &table1,
+                                   const QString &database2, const QString &table2)
+{
+    ui->source1->setDatabase(database1);
+    ui->source1->setTable(table1);
+    ui->source2->setDatabase(database2);
+    ui->source2->setTable(table2);
+}
+
+void CompareTableWidget::compare()
+{
+    on_compare_clicked();
+}
+
 void CompareTableWidget::on_compare_clicked()
 {
     QString database1 = ui->source1->database();
@@ -21,6 +46,80 @@ void CompareTableWidget::on_compare_clicked()
     QString database2 = ui->source2->database();
     QString table2 = ui->source2->table();
 
+    if (mDiff) {
+        mDiff->cancel();
+        mDiff->disconnect(this);
+        mDiff->deleteLater();
+    }
+    mModel->clear();
+    ui->status->setText("Comparing...");
+    ui->compare->setEnabled(false);
+
+    mDiff = new TableDiff(database1, table1, database2, table2, this);
+    connect(mDiff, SIGNAL(progress()), this, SLOT(onProgress()));
+    connect(mDiff, SIGNAL(finished()), this, SLOT(onFinished()));
+    mDiff->start();
+}
+
+void CompareTableWidget::onProgress()
+{
+    ui->status->setText(QString("Comparing... %1 checksums, %2 rows fetched")
+                        .arg(mDiff->checksums()).arg(mDiff->fetchedRows()));
+}
+
+void CompareTableWidget::onFinished()
+{
+    ui->compare->setEnabled(true);
+    if (!mDiff->error().isEmpty()) {
+        ui->status->setText(mDiff->error());
+        emit finished();
+        return;
+    }
+
+    static const QMap<TableDiff::Method, QString> methods = {
+        {TableDiff::Crc32, "crc32"},
+        {TableDiff::Md5, "md5"},
+        {TableDiff::Local, "local"},
+    };
+
+    QList<TableDiff::Row> rows = mDiff->rows();
+    QString status = QString("%1 differences, %2 checksums (%3), %4 rows fetched, %5 s")
+            .arg(rows.size()).arg(mDiff->checksums()).arg(methods.value(mDiff->method()))
+            .arg(mDiff->fetchedRows()).arg(mDiff->seconds(), 0, 'f', 1);
+    if (mDiff->isTruncated()) {
+        status += ", stopped at limit";
+    }
+    ui->status->setText(status);
+
+    mModel->setHorizontalHeaderLabels(QStringList {""} + mDiff->columns());
+
+    auto append = [&](const QString& marker, const QVariantList& values, const QVariantList& other) {
+        QList<QStandardItem*> items = {new QStandardItem(marker)};
+        for(int c=0;c<values.size();c++) {
+            QStandardItem* item = new QStandardItem(values[c].isNull() ? QString("NULL") : values[c].toString());
+            if (!other.isEmpty() && TableDiff::rowText({values[c]}) != TableDiff::rowText({other.value(c)})) {
+                item->setBackground(QColor("#ffe0a0"));
+            }
+            items.append(item);
+        }
+        mModel->appendRow(items);
+    };
 
+    for(const TableDiff::Row& row: std::as_const(rows)) {
+        switch (row.change) {
+        case TableDiff::Removed:
+            append("-", row.values1, QVariantList());
+            break;
+        case TableDiff::Inserted:
+            append("+", row.values2, QVariantList());
+            break;
+        case TableDiff::Changed:
+            append("<", row.values1, row.values2);
+            append(">", row.values2, row.values1);
+            break;
+        }
+    }
+    ui->tableView->resizeColumnsToContents();
+    emit finished();
 }
 
@@ -7,6 +7,9 @@ namespace Ui {
 class CompareTableWidget;
 }
 
+class TableDiff;
+class QStandardItemModel;
+
 class CompareTableWidget : public QWidget
 {
     Q_OBJECT
@@ -15,11 +18,25 @@ public:
     explicit CompareTableWidget(QWidget *parent = nullptr);
     ~CompareTableWidget();
 
+    void init(const QStringList& connectionNames);
+
+    void setTables(const QString& database1, const QString& table1,
+                   const QString& database2, const QString& table2);
+
+    void compare();
+
+signals:
+    void finished();
+
 private slots:
     void on_compare_clicked();
+    void onProgress();
+    void onFinished();
 
 private:
     Ui::CompareTableWidget *ui;
+    TableDiff* mDiff;
+    QStandardItemModel* mModel;
 };
 
 #endif // COMPARETABLEWIDGET_H
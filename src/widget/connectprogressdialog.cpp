@@ -0,0 +1,126 @@
+#include "connectprogressdialog.h"
+#include "ui_connectprogressdialog.h"
+
+#include <QSqlDatabase>
+#include <QTimer>
+
+ConnectProgressDialog::ConnectProgressDialog(QWidget *parent) :
+    QDialog(parent),
+    mTimer(new QTimer(this)),
+    mErrors(0),
+    ui(new Ui::ConnectProgressDialog)
+{
+    ui->setupUi(this);
+    ui->connections->setColumnWidth(col_connectionName, 160);
+    ui->connections->setColumnWidth(col_status, 260);
+
+    mTimer->setInterval(1000);
+    connect(mTimer,SIGNAL(timeout()),this,SLOT(onUpdateTime()));
+
+    AsyncConnector* connector = AsyncConnector::instance();
+    connect(connector,SIGNAL(connected(QString,qint64)),this,SLOT(onConnected(QString,qint64)));
+    connect(connector,SIGNAL(failed(QString,QString)),this,SLOT(onFailed(QString,QString)));
+}
+
+ConnectProgressDialog::~ConnectProgressDialog()
+{
+    delete ui;
+}
+
+void ConnectProgressDialog::connectDatabases(const QList<ConnectionParams> &connections, int timeout)
+{
+    if (mPending.isEmpty()) {
+        ui->connections->clear();
+        mErrors = 0;
+    }
+    AsyncConnector* connector = AsyncConnector::instance();
+    for(const ConnectionParams& params: connections) {
+        QString connectionName = params.connectionName;
+        QTreeWidgetItem* item = this->item(connectionName);
+        if (!item) {
+            item = new QTreeWidgetItem(ui->connections, {connectionName});
+        }
+        if (QSqlDatabase::contains(connectionName) || connector->isPending(connectionName)) {
+            setStatus(connectionName, "Already connected", -1);
+            continue;
+        }
+        mPending[connectionName] = params;
+        mElapsed[connectionName].start();
+        setStatus(connectionName, "Connecting", 0);
+        connector->connectDatabase(params, timeout);
+    }
+    if (!mPending.isEmpty()) {
+        mTimer->start();
+    }
+}
+
+QTreeWidgetItem *ConnectProgressDialog::item(const QString &connectionName) const
+{
+    for(int i=0;i<ui->connections->topLevelItemCount();i++) {
+        QTreeWidgetItem* item = ui->connections->topLevelItem(i);
+        if (item->text(col_connectionName) == connectionName) {
+            return item;
+        }
+    }
+    return nullptr;
+}
+
+void ConnectProgressDialog::setStatus(const QString &connectionName, const QString &status, qint64 elapsed)
+{
+    QTreeWidgetItem* item = this->item(connectionName);
+    if (!item) {
+        return;
+    }
+    item->setText(col_status, status);
+    item->setToolTip(col_status, status);
+    item->setText(col_time, elapsed < 0 ? QString() : QString::number(elapsed / 1000.0, 'f', 1));
+}
+
+void ConnectProgressDialog::finish(const QString &connectionName)
+{
+    mPending.remove(connectionName);
+    mElapsed.remove(connectionName);
+    if (!mPending.isEmpty()) {
+        return;
+    }
+    mTimer->stop();
+    if (mErrors == 0) {
+        close();
+    }
+}
+
+void ConnectProgressDialog::onConnected(QString connectionName, qint64 elapsed)
+{
+    if (!mPending.contains(connectionName)) {
+        return;
+    }
+    ConnectionParams params = mPending[connectionName];
+    setStatus(connectionName, "Connected", elapsed);
+    finish(connectionName);
+    emit connected(params);
+}
+
+void ConnectProgressDialog::onFailed(QString connectionName, QString error)
+{
+    if (!mPending.contains(connectionName)) {
+        return;
+    }
+    setStatus(connectionName, error, mElapsed[connectionName].elapsed());
+    mErrors++;
+    finish(connectionName);
+}
+
+void ConnectProgressDialog::onUpdateTime()
+{
+    for(auto it = mElapsed.begin(); it != mElapsed.end(); it++) {
+        setStatus(it.key(), "Connecting", it.value().elapsed());
+    }
+}
+
+void ConnectProgressDialog::on_cancel_clicked()
+{
+    const QStringList names = mPending.keys();
+    for(const QString& connectionName: names) {
+        AsyncConnector::instance()->cancel(connectionName);
+    }
+}
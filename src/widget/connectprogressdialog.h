@@ -0,0 +1,59 @@
+#ifndef CONNECTPROGRESSDIALOG_H
+#define CONNECTPROGRESSDIALOG_H
+
+#include <QDialog>
+#include <QMap>
+#include <QElapsedTimer>
+#include "asyncconnector.h"
+
+namespace Ui {
+class ConnectProgressDialog;
+}
+
+class QTimer;
+class QTreeWidgetItem;
+
+// Progress of connections opened in parallel (restored from history),
+// connected() is emitted for each connection as soon as it's ready
+
+class ConnectProgressDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    enum cols {
+        col_connectionName,
+        col_status,
+        col_time
+    };
+
+    explicit ConnectProgressDialog(QWidget *parent = nullptr);
+    ~ConnectProgressDialog();
+
+    // timeout in seconds
+    void connectDatabases(const QList<ConnectionParams>& connections, int timeout);
+
+signals:
+    void connected(ConnectionParams params);
+
+protected slots:
+    void onConnected(QString connectionName, qint64 elapsed);
+    void onFailed(QString connectionName, QString error);
+    void onUpdateTime();
+    void on_cancel_clicked();
+
+protected:
+    QTreeWidgetItem* item(const QString& connectionName) const;
+    void setStatus(const QString& connectionName, const QString& status, qint64 elapsed);
+    void finish(const QString& connectionName);
+
+    QMap<QString, ConnectionParams> mPending;
+    QMap<QString, QElapsedTimer> mElapsed;
+    QTimer* mTimer;
+    int mErrors;
+
+private:
+    Ui::ConnectProgressDialog *ui;
+};
+
+#endif // CONNECTPROGRESSDIALOG_H
@@ -15,6 +15,7 @@
 #include <QThread>
 #include <QFileDialog>
 #include "accessuri.h"
+#include <QPushButton>
 
 namespace {
 
@@ -32,10 +33,19 @@ QStringList availableSqlDrivers() {
 
 DatabaseConnectDialog::DatabaseConnectDialog(bool showHistory, QWidget *parent) :
     QDialog(parent),
-    ui(new Ui::DatabaseConnectDialog)
+    ui(new Ui::DatabaseConnectDialog),
+    mTimer(new QTimer(this))
 {
     ui->setupUi(this);
 
+    ui->status->hide();
+    mTimer->setInterval(1000);
+    connect(mTimer,SIGNAL(timeout()),this,SLOT(onConnectingTimeout()));
+
+    AsyncConnector* connector = AsyncConnector::instance();
+    connect(connector,SIGNAL(connected(QString,qint64)),this,SLOT(onConnected(QString,qint64)));
+    connect(connector,SIGNAL(failed(QString,QString)),this,SLOT(onFailed(QString,QString)));
+
     ui->driver->addItems(availableSqlDrivers());
 
     this->adjustSize();
@@ -109,30 +119,82 @@ void DatabaseConnectDialog::accept()
         return;
     }
 
-    QString driver = ui->driver->currentText();
+    if (AsyncConnector::instance()->isPending(connectionName)) {
+        QMessageBox::critical(this,"Error",QString("Name %1 is still connecting").arg(connectionName));
+        return;
+    }
 
-    QSqlDatabase db = QSqlDatabase::addDatabase(driver,connectionName);
+    setConnecting(true);
+    AsyncConnector::instance()->connectDatabase(params(), Settings::instance()->connectTimeout());
+}
 
-    db.setHostName(host());
-    db.setUserName(user());
-    db.setPassword(password());
-    db.setDatabaseName(database());
-    if (port() > -1) {
-        db.setPort(port());
+void DatabaseConnectDialog::reject()
+{
+    if (!mConnecting.isEmpty()) {
+        QString connectionName = mConnecting;
+        setConnecting(false);
+        AsyncConnector::instance()->cancel(connectionName);
+        return;
     }
+    QDialog::reject();
+}
 
-    if (!db.open()) {
-        QString error = db.lastError().text();
-        QMessageBox::critical(this,"Error",error);
-        QSqlDatabase::removeDatabase(connectionName);
-        return;
+void DatabaseConnectDialog::setConnecting(bool connecting)
+{
+    mConnecting = connecting ? connectionName() : QString();
+    QList<QWidget*> widgets = {ui->connectionName, ui->driver, ui->host, ui->user, ui->password,
+                               ui->database, ui->port, ui->pick, ui->history};
+    for(QWidget* widget: widgets) {
+        widget->setEnabled(!connecting);
+    }
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(!connecting);
+    if (connecting) {
+        mElapsed.start();
+        mTimer->start();
+        onConnectingTimeout();
+        ui->status->show();
+    } else {
+        mTimer->stop();
+        ui->status->hide();
     }
+}
 
-    Settings::instance()->setSavePasswords(ui->savePassword->isChecked());
+void DatabaseConnectDialog::onConnectingTimeout()
+{
+    QString host = ui->host->text().isEmpty() ? ui->database->text() : ui->host->text();
+    ui->status->setText(QString("Connecting to %1... %2 s").arg(host).arg(mElapsed.elapsed() / 1000));
+}
 
+void DatabaseConnectDialog::onConnected(QString connectionName, qint64 elapsed)
+{
+    Q_UNUSED(elapsed);
+    if (connectionName != mConnecting) {
+        return;
+    }
+    setConnecting(false);
+    Settings::instance()->setSavePasswords(ui->savePassword->isChecked());
     QDialog::accept();
 }
 
+void DatabaseConnectDialog::onFailed(QString connectionName, QString error)
+{
+    if (connectionName != mConnecting) {
+        return;
+    }
+    setConnecting(false);
+    QMessageBox::critical(this,"Error",error);
+}
+
+ConnectionParams DatabaseConnectDialog::params()
+{
+    return {connectionName(), driver(), host(), user(), password(), database(), port()};
+}
+
+QList<ConnectionParams> DatabaseConnectDialog::restore() const
+{
+    return mRestore;
+}
+
 void DatabaseConnectDialog::on_history_clicked()
 {
     DatabaseHistoryDialog dialog;
@@ -144,6 +206,14 @@ void DatabaseConnectDialog::on_history_clicked()
 
     //qDebug() << "AddDatabaseDialog::on_history_clicked()" << QThread::currentThreadId();
 
+    QList<ConnectionParams> selected = dialog.selectedConnections();
+    if (selected.size() > 1) {
+        mRestore = selected;
+        Automation::instance()->afterDialog(&dialog);
+        QDialog::accept();
+        return;
+    }
+
     ui->connectionName->setText(dialog.connectionName());
     ui->driver->setCurrentIndex(ui->driver->findText(dialog.driver()));
     ui->host->setText(dialog.host());
@@ -2,6 +2,9 @@
 #define ADDDATABASEDIALOG_H
 
 #include <QDialog>
+#include <QElapsedTimer>
+#include "asyncconnector.h"
+class QTimer;
 
 namespace Ui {
 class DatabaseConnectDialog;
@@ -23,9 +26,14 @@ public:
     QString database();
     int port();
 
+    ConnectionParams params();
+
+    // connections selected in history to open in parallel
+    QList<ConnectionParams> restore() const;
 
 public slots:
     void accept();
+    void reject();
 
 private slots:
     void on_history_clicked();
@@ -38,8 +46,17 @@ private slots:
 
     void on_driver_currentTextChanged(const QString &arg1);
 
+    void onConnected(QString connectionName, qint64 elapsed);
+    void onFailed(QString connectionName, QString error);
+    void onConnectingTimeout();
+
 private:
     Ui::DatabaseConnectDialog *ui;
+    void setConnecting(bool connecting);
+    QString mConnecting;
+    QElapsedTimer mElapsed;
+    QTimer* mTimer;
+    QList<ConnectionParams> mRestore;
 };
 
 #endif // ADDDATABASEDIALOG_H
@@ -5,6 +5,7 @@
 #include <QVariant>
 #include <QSqlQuery>
 #include <QDate>
+#include <QSet>
 
 #include "richheaderview/richheaderview.h"
 
@@ -72,6 +73,8 @@ DatabaseHistoryDialog::DatabaseHistoryDialog(QWidget *parent) :
     ui->tableView->setModel(model);
 
     ui->tableView->setHorizontalHeader(view);
+    ui->tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
 
     onUpdateQuery();
 }
@@ -172,6 +175,29 @@ void DatabaseHistoryDialog::select(const QString &connectionName)
     }
 }
 
+QList<ConnectionParams> DatabaseHistoryDialog::selectedConnections() const
+{
+    QAbstractItemModel* m = ui->tableView->model();
+    QModelIndexList rows = ui->tableView->selectionModel()->selectedRows();
+    std::sort(rows.begin(), rows.end());
+    QList<ConnectionParams> res;
+    QSet<QString> names;
+    for(const QModelIndex& index: std::as_const(rows)) {
+        auto value = [=](int column) {
+            return m->data(m->index(index.row(), column));
+        };
+        QString connectionName = value(col_connectionName).toString();
+        if (names.contains(connectionName)) {
+            continue;
+        }
+        names.insert(connectionName);
+        res.append({connectionName, value(col_driver).toString(), value(col_host).toString(),
+                    value(col_user).toString(), value(col_password).toString(),
+                    value(col_database).toString(), value(col_port).isNull() ? -1 : value(col_port).toInt()});
+    }
+    return res;
+}
+
 QVariant DatabaseHistoryDialog::data(int column) const
 {
     QAbstractItemModel* m = ui->tableView->model();
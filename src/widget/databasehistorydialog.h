@@ -2,6 +2,7 @@
 #define DATABASEHISTORYDIALOG_H
 
 #include <QDialog>
+#include "asyncconnector.h"
 
 namespace Ui {
 class DatabaseHistoryDialog;
@@ -45,6 +46,9 @@ public:
 
     void select(const QString& connectionName);
 
+    // unique by connection name
+    QList<ConnectionParams> selectedConnections() const;
+
 public slots:
     void onUpdateQuery();
 
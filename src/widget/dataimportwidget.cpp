@@ -28,6 +28,9 @@
 #include "modelappender.h"
 #include "tablebuttons/tablebuttons.h"
 #include "clipboardutil.h"
+#include "bulkinsert.h"
+#include <QSqlQuery>
+#include <QSqlError>
 
 namespace  {
 
@@ -823,6 +826,51 @@ void DataImportWidget::on_copyQuery_clicked()
     emit appendQuery(queries(false));
 }
 
+void DataImportWidget::on_insertData_clicked()
+{
+    DataImportModel* model = dataModel();
+    if (!model) {
+        return;
+    }
+
+    int minYear = ui->minYear->value(-1);
+    if (minYear == -1) {
+        return;
+    }
+
+    bool newTable = this->newTable();
+    if (!newTable && DataFormat::value(ui->format) != DataFormat::SqlInsert) {
+        Error::show(this, "Only inserts can be executed, use Copy for updates");
+        return;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QString table = tableName();
+    QList<Field> fields = this->fields();
+
+    if (newTable) {
+        QStringList schemaQueries;
+        schemaQueries.append(DataStreamer::createTableStatement(db,table,fields,false));
+        schemaQueries.append(DataStreamer::createIndexStatements(db,table,fields));
+        for(const QString& query: std::as_const(schemaQueries)) {
+            QSqlQuery q(db);
+            if (!q.exec(query)) {
+                Error::show(this, q.lastError().text());
+                return;
+            }
+        }
+    }
+
+    QStringList columns;
+    QList<QVariantList> rows;
+    DataStreamer::insertValues(model, fields, minYear, ui->inLocal->isChecked(), ui->outUtc->isChecked(), locale(), &columns, &rows);
+
+    QString error;
+    if (!BulkInsert::insert(db, table, columns, rows, error)) {
+        Error::show(this, error);
+    }
+}
+
 void DataImportWidget::on_abc_clicked()
 {
     if (ui->optionExistingTable->isChecked()) {
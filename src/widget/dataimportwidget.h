@@ -105,6 +105,7 @@ protected:
 private slots:
     void on_clearData_clicked();
     void on_copyQuery_clicked();
+    void on_insertData_clicked();
     void on_abc_clicked();
     void on_format_currentIndexChanged(int index);
     void on_guessTypes_clicked();
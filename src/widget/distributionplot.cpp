@@ -137,6 +137,12 @@ void DistributionPlot::setModel(QAbstractItemModel *model)
     updateSeries();
 }
 
+void DistributionPlot::refresh()
+{
+    updateDataset();
+    updateSeries();
+}
+
 void DistributionPlot::onDataChanged(QModelIndex,QModelIndex,QVector<int>) {
     DistributionPlotModel* model = qobject_cast<DistributionPlotModel*>(ui->table->model());
     QList<DistributionPlotItem> items = model->items(modelHeader());
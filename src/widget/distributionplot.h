@@ -30,6 +30,9 @@ public:
     void setManualRange(double vmin, double vmax);
 
     void setHistogramTableColumnPrec(int column, int prec);
+public slots:
+    // model data changed
+    void refresh();
 protected:
     void init();
     QStringList modelHeader() const;
@@ -0,0 +1,134 @@
+#include "dumpwidget.h"
+#include "ui_dumpwidget.h"
+
+#include <QDesktopServices>
+#include <QUrl>
+#include <QDir>
+#include <QFileInfo>
+
+#include "dump.h"
+#include "nativedump.h"
+#include "tablecopy.h"
+
+namespace {
+
+enum Column {
+    ColumnTable,
+    ColumnStatus,
+    ColumnRows,
+    ColumnSize,
+    ColumnSeconds,
+    ColumnError,
+    ColumnCount
+};
+
+}
+
+DumpWidget::DumpWidget(QWidget *parent) :
+    QWidget(parent),
+    ui(new Ui::DumpWidget),
+    mDump(nullptr)
+{
+    ui->setupUi(this);
+    ui->tables->setColumnCount(ColumnCount);
+}
+
+DumpWidget::~DumpWidget()
+{
+    delete ui;
+}
+
+void DumpWidget::init(Dump *dump, const QString &dir, const QString &title)
+{
+    mDump = dump;
+    mDump->setParent(this);
+    mDir = dir;
+    setWindowTitle(title);
+    ui->source->setText(QDir::toNativeSeparators(dir));
+    // TableCopy has no files
+    ui->open->setVisible(QFileInfo(dir).isDir());
+    ui->tables->setHorizontalHeaderLabels({"Table", "Status", dump->rowsName(), "MB", "Seconds", "Error"});
+    ui->tables->setRowCount(dump->count());
+    for(int row=0;row<dump->count();row++) {
+        for(int column=0;column<ColumnCount;column++) {
+            QTableWidgetItem* item = new QTableWidgetItem();
+            item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+            if (column == ColumnRows || column == ColumnSize || column == ColumnSeconds) {
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            }
+            ui->tables->setItem(row, column, item);
+        }
+        onTableChanged(row);
+    }
+    connect(mDump, SIGNAL(tableChanged(int)), this, SLOT(onTableChanged(int)));
+    connect(mDump, SIGNAL(finished()), this, SLOT(onFinished()));
+    ui->cancel->setEnabled(!mDump->isFinished());
+    updateStatus();
+}
+
+void DumpWidget::on_cancel_clicked()
+{
+    if (mDump) {
+        mDump->cancel();
+    }
+}
+
+void DumpWidget::on_open_clicked()
+{
+    QDesktopServices::openUrl(QUrl::fromLocalFile(mDir));
+}
+
+void DumpWidget::onTableChanged(int index)
+{
+    Dump::Table table = mDump->table(index);
+    ui->tables->item(index, ColumnTable)->setText(table.name);
+    QString status = Dump::statusName(table.status);
+    if (table.status == Dump::Running && table.totalBytes > 0) {
+        status += QString(" %1%").arg(table.bytes * 100 / table.totalBytes);
+    }
+    ui->tables->item(index, ColumnStatus)->setText(status);
+    ui->tables->item(index, ColumnRows)->setText(table.rows < 0 ? QString() : QString::number(table.rows));
+    ui->tables->item(index, ColumnSize)->setText(QString::number(table.bytes / 1024.0 / 1024.0, 'f', 1));
+    ui->tables->item(index, ColumnSeconds)->setText(QString::number(table.seconds, 'f', 1));
+    ui->tables->item(index, ColumnError)->setText(table.error.split("\n").first());
+    ui->tables->item(index, ColumnError)->setToolTip(table.error);
+    updateStatus();
+}
+
+void DumpWidget::onFinished()
+{
+    ui->cancel->setEnabled(false);
+    ui->tables->resizeColumnsToContents();
+    updateStatus();
+}
+
+void DumpWidget::updateStatus()
+{
+    double seconds = mDump->seconds();
+    double mb = mDump->bytes() / 1024.0 / 1024.0;
+    QString status = QString("%1 of %2 tables done, %3 running, %4 failed, %5 MB in %6 s")
+            .arg(mDump->count(Dump::Done))
+            .arg(mDump->count())
+            .arg(mDump->count(Dump::Running))
+            .arg(mDump->count(Dump::Failed))
+            .arg(mb, 0, 'f', 1)
+            .arg(seconds, 0, 'f', 1);
+    if (seconds > 0) {
+        status += QString(", %1 MB/s, %2 %3/s").arg(mb / seconds, 0, 'f', 1)
+                .arg(mDump->rows() / seconds, 0, 'f', 0).arg(mDump->rowsName().toLower());
+    }
+    if (mDump->isFinished()) {
+        status += ", finished";
+        NativeDump* native = qobject_cast<NativeDump*>(mDump);
+        if (native && mDump->count() > 1) {
+            status += native->isConsistent() ? ", one snapshot" : ", separate snapshots";
+        }
+    }
+    TableCopy* copy = qobject_cast<TableCopy*>(mDump);
+    if (copy) {
+        // reader waits when writer is slower and vice versa
+        status += QString(", reader waited %1 s, writer waited %2 s")
+                .arg(copy->readerWaitSeconds(), 0, 'f', 1).arg(copy->writerWaitSeconds(), 0, 'f', 1);
+    }
+    ui->status->setText(status);
+}
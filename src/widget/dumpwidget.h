@@ -0,0 +1,38 @@
+#ifndef DUMPWIDGET_H
+#define DUMPWIDGET_H
+
+#include <QWidget>
+
+namespace Ui {
+class DumpWidget;
+}
+
+class Dump;
+
+// Shows per table progress of running dump, dump is owned by widget
+
+class DumpWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DumpWidget(QWidget *parent = nullptr);
+    ~DumpWidget();
+
+    void init(Dump* dump, const QString& dir, const QString& title);
+
+protected slots:
+    void on_cancel_clicked();
+    void on_open_clicked();
+    void onTableChanged(int index);
+    void onFinished();
+
+protected:
+    void updateStatus();
+
+    Ui::DumpWidget *ui;
+    Dump* mDump;
+    QString mDir;
+};
+
+#endif // DUMPWIDGET_H
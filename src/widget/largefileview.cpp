@@ -0,0 +1,263 @@
+#include "largefileview.h"
+
+#include <QPainter>
+#include <QScrollBar>
+#include <QFontDatabase>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <climits>
+#include "trace.h"
+
+namespace {
+
+// cached line states are dropped after that
+const int maxStates = 10000;
+
+}
+
+LargeFileView::LargeFileView(QWidget *parent)
+    : QAbstractScrollArea{parent}, mAnchor(-1), mCursor(-1), mMaxWidth(0)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    viewport()->setCursor(Qt::IBeamCursor);
+    setFocusPolicy(Qt::StrongFocus);
+}
+
+bool LargeFileView::open(const QString &path)
+{
+    mStates.clear();
+    mAnchor = -1;
+    mCursor = -1;
+    mMaxWidth = 0;
+    bool ok = mFile.open(path);
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    viewport()->update();
+    emit selectionChanged();
+    return ok;
+}
+
+LargeFile *LargeFileView::file()
+{
+    return &mFile;
+}
+
+void LargeFileView::setKeywords(const QStringList &keywords)
+{
+    mKeywords.clear();
+    for(const QString& keyword: keywords) {
+        for(const QString& word: keyword.split(" ")) {
+            mKeywords.insert(word.toLower());
+        }
+    }
+    viewport()->update();
+}
+
+qint64 LargeFileView::selectionFirst() const
+{
+    return qMin(mAnchor, mCursor);
+}
+
+qint64 LargeFileView::selectionLast() const
+{
+    return qMax(mAnchor, mCursor);
+}
+
+void LargeFileView::selectLines(qint64 first, qint64 last)
+{
+    mAnchor = first;
+    mCursor = last;
+    viewport()->update();
+    emit selectionChanged();
+}
+
+void LargeFileView::scrollToLine(qint64 line)
+{
+    // scrollbar range is int, lines above it are not reachable in files with more than 2^31 lines
+    verticalScrollBar()->setValue(int(qMin(line, qint64(INT_MAX))));
+}
+
+int LargeFileView::lineHeight() const
+{
+    return fontMetrics().height();
+}
+
+int LargeFileView::visibleLines() const
+{
+    return viewport()->height() / lineHeight() + 1;
+}
+
+int LargeFileView::gutterWidth() const
+{
+    return fontMetrics().horizontalAdvance(QString::number(mFile.lineCount())) + 8;
+}
+
+void LargeFileView::updateScrollBars()
+{
+    qint64 lines = mFile.lineCount();
+    int page = qMax(1, visibleLines() - 1);
+    verticalScrollBar()->setRange(0, int(qMin(qMax(qint64(0), lines - page), qint64(INT_MAX))));
+    verticalScrollBar()->setPageStep(page);
+    verticalScrollBar()->setSingleStep(1);
+    int width = viewport()->width() - gutterWidth();
+    horizontalScrollBar()->setRange(0, qMax(0, mMaxWidth - width));
+    horizontalScrollBar()->setPageStep(width);
+    horizontalScrollBar()->setSingleStep(fontMetrics().horizontalAdvance('x') * 4);
+}
+
+void LargeFileView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+SqlLexer::State LargeFileView::lineState(qint64 line)
+{
+    auto it = mStates.constFind(line);
+    if (it != mStates.constEnd()) {
+        return it.value();
+    }
+    auto previous = mStates.constFind(line - 1);
+    SqlLexer::State state;
+    if (previous != mStates.constEnd()) {
+        state = previous.value();
+        mFile.lexLine(line - 1, &state);
+    } else {
+        state = mFile.state(line, false);
+    }
+    if (mStates.size() > maxStates) {
+        mStates.clear();
+    }
+    mStates[line] = state;
+    return state;
+}
+
+QColor LargeFileView::tokenColor(const QString &text, const SqlLexer::Token &token, SqlLexer::Context context) const
+{
+    switch (token.type) {
+    case SqlLexer::String:
+        return Qt::darkGreen;
+    case SqlLexer::Comment:
+        return context == SqlLexer::Code && text[token.pos] == '-' ? Qt::gray : Qt::darkGray;
+    case SqlLexer::Delimiter:
+        return Qt::darkRed;
+    case SqlLexer::DelimiterCommand:
+        return Qt::darkBlue;
+    case SqlLexer::Word:
+        if (mKeywords.contains(text.mid(token.pos, token.size).toLower())) {
+            return Qt::darkBlue;
+        }
+        break;
+    default:
+        break;
+    }
+    return palette().color(QPalette::Text);
+}
+
+void LargeFileView::paintEvent(QPaintEvent *)
+{
+    TRACE_SCOPE("LargeFileView::paintEvent");
+    QPainter painter(viewport());
+    painter.setFont(font());
+    int height = lineHeight();
+    int ascent = fontMetrics().ascent();
+    int gutter = gutterWidth();
+    int scrollX = horizontalScrollBar()->value();
+    qint64 first = verticalScrollBar()->value();
+    qint64 last = qMin(mFile.lineCount(), first + visibleLines());
+    int maxWidth = mMaxWidth;
+    QColor selection = palette().color(QPalette::Highlight).lighter(170);
+
+    for(qint64 line=first;line<last;line++) {
+        int y = int(line - first) * height;
+        if (mAnchor > -1 && line >= selectionFirst() && line <= selectionLast()) {
+            painter.fillRect(0, y, viewport()->width(), height, selection);
+        }
+        painter.setClipRect(gutter, y, viewport()->width() - gutter, height);
+        SqlLexer::State state = lineState(line);
+        QString text = mFile.line(line, maxLineBytes);
+        SqlLexer lexer(text, &state);
+        SqlLexer::Token token;
+        SqlLexer::Context context = state.context;
+        int x = gutter - scrollX;
+        while (lexer.next(token)) {
+            QString part = text.mid(token.pos, token.size);
+            int width = fontMetrics().horizontalAdvance(part);
+            if (x + width > gutter && x < viewport()->width()) {
+                painter.setPen(tokenColor(text, token, context));
+                painter.drawText(x, y + ascent, part);
+            }
+            x += width;
+            context = state.context;
+        }
+        maxWidth = qMax(maxWidth, x + scrollX - gutter);
+        painter.setClipping(false);
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(QRect(0, y, gutter - 4, height), Qt::AlignRight | Qt::AlignVCenter, QString::number(line + 1));
+    }
+    if (maxWidth > mMaxWidth) {
+        mMaxWidth = maxWidth;
+        updateScrollBars();
+    }
+}
+
+qint64 LargeFileView::lineAt(const QPoint &pos) const
+{
+    qint64 line = verticalScrollBar()->value() + pos.y() / lineHeight();
+    return qBound(qint64(0), line, mFile.lineCount() - 1);
+}
+
+void LargeFileView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || mFile.lineCount() == 0) {
+        return;
+    }
+    qint64 line = lineAt(event->pos());
+    if (!(event->modifiers() & Qt::ShiftModifier) || mAnchor < 0) {
+        mAnchor = line;
+    }
+    mCursor = line;
+    viewport()->update();
+    emit selectionChanged();
+}
+
+void LargeFileView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton) || mAnchor < 0) {
+        return;
+    }
+    qint64 line = lineAt(event->pos());
+    if (line != mCursor) {
+        mCursor = line;
+        viewport()->update();
+        emit selectionChanged();
+    }
+}
+
+void LargeFileView::keyPressEvent(QKeyEvent *event)
+{
+    QScrollBar* bar = verticalScrollBar();
+    switch (event->key()) {
+    case Qt::Key_Up:
+        bar->triggerAction(QAbstractSlider::SliderSingleStepSub);
+        break;
+    case Qt::Key_Down:
+        bar->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+        break;
+    case Qt::Key_PageUp:
+        bar->triggerAction(QAbstractSlider::SliderPageStepSub);
+        break;
+    case Qt::Key_PageDown:
+        bar->triggerAction(QAbstractSlider::SliderPageStepAdd);
+        break;
+    case Qt::Key_Home:
+        bar->triggerAction(QAbstractSlider::SliderToMinimum);
+        break;
+    case Qt::Key_End:
+        bar->triggerAction(QAbstractSlider::SliderToMaximum);
+        break;
+    default:
+        QAbstractScrollArea::keyPressEvent(event);
+        break;
+    }
+}
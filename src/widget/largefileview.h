@@ -0,0 +1,60 @@
+#ifndef LARGEFILEVIEW_H
+#define LARGEFILEVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QHash>
+#include <QSet>
+#include "largefile.h"
+
+// Read-only view of LargeFile, only visible lines are decoded and highlighted.
+// Selection is by whole lines.
+
+class LargeFileView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit LargeFileView(QWidget *parent = nullptr);
+
+    bool open(const QString& path);
+    LargeFile* file();
+
+    void setKeywords(const QStringList& keywords);
+
+    // -1 if nothing selected
+    qint64 selectionFirst() const;
+    qint64 selectionLast() const;
+    void selectLines(qint64 first, qint64 last);
+
+    void scrollToLine(qint64 line);
+
+    // long lines are cut in view
+    static const int maxLineBytes = 4096;
+
+signals:
+    void selectionChanged();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+    void updateScrollBars();
+    int lineHeight() const;
+    int visibleLines() const;
+    qint64 lineAt(const QPoint& pos) const;
+    int gutterWidth() const;
+    SqlLexer::State lineState(qint64 line);
+    QColor tokenColor(const QString& text, const SqlLexer::Token& token, SqlLexer::Context context) const;
+
+    LargeFile mFile;
+    QSet<QString> mKeywords;
+    // state at start of recently shown lines
+    QHash<qint64, SqlLexer::State> mStates;
+    qint64 mAnchor;
+    qint64 mCursor;
+    int mMaxWidth;
+};
+
+#endif // LARGEFILEVIEW_H
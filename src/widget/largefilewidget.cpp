@@ -0,0 +1,86 @@
+#include "largefilewidget.h"
+#include "ui_largefilewidget.h"
+
+#include <QMessageBox>
+#include <QFileInfo>
+#include <QDir>
+#include <QApplication>
+#include <climits>
+#include "scriptrunnerwidget.h"
+#include "showandraise.h"
+
+LargeFileWidget::LargeFileWidget(QWidget *parent) :
+    QWidget(parent),
+    ui(new Ui::LargeFileWidget)
+{
+    ui->setupUi(this);
+    connect(ui->view, SIGNAL(selectionChanged()), this, SLOT(onSelectionChanged()));
+    onSelectionChanged();
+}
+
+LargeFileWidget::~LargeFileWidget()
+{
+    delete ui;
+}
+
+bool LargeFileWidget::init(const QString &connectionName, const QString &path, const QStringList &keywords)
+{
+    mConnectionName = connectionName;
+    ui->view->setKeywords(keywords);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = ui->view->open(path);
+    QApplication::restoreOverrideCursor();
+    if (!ok) {
+        QMessageBox::critical(this, "Error", ui->view->file()->errorString());
+        return false;
+    }
+    LargeFile* file = ui->view->file();
+    ui->path->setText(QString("%1 (%2 MB, %3 lines)").arg(QDir::toNativeSeparators(path))
+                      .arg(file->size() / 1024.0 / 1024.0, 0, 'f', 1)
+                      .arg(file->lineCount()));
+    ui->line->setMaximum(int(qMin(file->lineCount(), qint64(INT_MAX))));
+    setWindowTitle(QString("%1 %2").arg(QFileInfo(path).fileName()).arg(connectionName));
+    return true;
+}
+
+void LargeFileWidget::on_go_clicked()
+{
+    ui->view->scrollToLine(ui->line->value() - 1);
+    ui->view->setFocus();
+}
+
+void LargeFileWidget::onSelectionChanged()
+{
+    qint64 first = ui->view->selectionFirst();
+    qint64 last = ui->view->selectionLast();
+    ui->execute->setEnabled(first > -1);
+    if (first < 0) {
+        ui->selection->setText("Select lines with mouse, shift+click to extend");
+        return;
+    }
+    ui->selection->setText(QString("Lines %1-%2 selected").arg(first + 1).arg(last + 1));
+}
+
+void LargeFileWidget::on_execute_clicked()
+{
+    qint64 first = ui->view->selectionFirst();
+    qint64 last = ui->view->selectionLast();
+    if (first < 0 || mConnectionName.isEmpty()) {
+        return;
+    }
+    LargeFile* file = ui->view->file();
+    ScriptRunner::Position from;
+    qint64 to = -1;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = file->statementRange(first, last, from, to);
+    QApplication::restoreOverrideCursor();
+    if (!ok) {
+        QMessageBox::information(this, "Execute", "No statement starts in selected lines");
+        return;
+    }
+    ScriptRunnerWidget* widget = new ScriptRunnerWidget();
+    widget->setAttribute(Qt::WA_DeleteOnClose);
+    widget->initFile(mConnectionName, file->path());
+    widget->setRange(from, to);
+    showAndRaise(widget);
+}
@@ -0,0 +1,33 @@
+#ifndef LARGEFILEWIDGET_H
+#define LARGEFILEWIDGET_H
+
+#include <QWidget>
+
+namespace Ui {
+class LargeFileWidget;
+}
+
+// Shows sql file too large for editor, selected statements are executed by
+// ScriptRunnerWidget directly from file
+
+class LargeFileWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LargeFileWidget(QWidget *parent = nullptr);
+    ~LargeFileWidget();
+
+    bool init(const QString& connectionName, const QString& path, const QStringList& keywords);
+
+protected slots:
+    void on_go_clicked();
+    void on_execute_clicked();
+    void onSelectionChanged();
+
+protected:
+    Ui::LargeFileWidget *ui;
+    QString mConnectionName;
+};
+
+#endif // LARGEFILEWIDGET_H
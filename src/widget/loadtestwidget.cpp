@@ -0,0 +1,153 @@
+#include "loadtestwidget.h"
+#include "ui_loadtestwidget.h"
+
+#include <QStandardItemModel>
+#include <QTimer>
+#include <QHeaderView>
+#include "loadtest.h"
+#include "history.h"
+#include "distributionplotmodel.h"
+#include "rowvaluesetter.h"
+
+namespace {
+
+// histogram is approximate after that, percentiles are computed on all samples
+const int maxPlotted = 100000;
+
+}
+
+LoadTestWidget::LoadTestWidget(QWidget *parent) :
+    QWidget(parent),
+    ui(new Ui::LoadTestWidget),
+    mLoadTest(nullptr),
+    mLatencies(new QStandardItemModel(0, 1, this)),
+    mRuns(new QStandardItemModel(this)),
+    mRefresh(new QTimer(this)),
+    mPlotted(0)
+{
+    ui->setupUi(this);
+    mLatencies->setHorizontalHeaderLabels({"latency ms"});
+    ui->plot->setModel(mLatencies);
+    RowValueNotEmptySetter s(ui->plot->tableModel(), 0);
+    s(DistributionPlotModel::col_v, "latency ms");
+    ui->runs->setModel(mRuns);
+    ui->runs->horizontalHeader()->setStretchLastSection(true);
+    mRefresh->setInterval(500);
+    connect(mRefresh, SIGNAL(timeout()), this, SLOT(onRefresh()));
+}
+
+LoadTestWidget::~LoadTestWidget()
+{
+    delete ui;
+}
+
+void LoadTestWidget::init(const QString &connectionName, const QString &query)
+{
+    mConnectionName = connectionName;
+    ui->query->setPlainText(query);
+    setWindowTitle(QString("Load test %1").arg(connectionName));
+    updateRuns();
+}
+
+void LoadTestWidget::on_start_clicked()
+{
+    QString query = ui->query->toPlainText().trimmed();
+    if (query.isEmpty() || mConnectionName.isEmpty()) {
+        return;
+    }
+    if (mLoadTest) {
+        mLoadTest->deleteLater();
+    }
+    mLatencies->removeRows(0, mLatencies->rowCount());
+    mPlotted = 0;
+    mLoadTest = new LoadTest(mConnectionName, query, this);
+    connect(mLoadTest, SIGNAL(progress()), this, SLOT(onProgress()));
+    connect(mLoadTest, SIGNAL(finished()), this, SLOT(onFinished()));
+    ui->start->setEnabled(false);
+    ui->stop->setEnabled(true);
+    mLoadTest->start(ui->concurrency->value(), ui->iterations->value(), ui->duration->value() * 1000);
+    mRefresh->start();
+}
+
+void LoadTestWidget::on_stop_clicked()
+{
+    if (mLoadTest) {
+        mLoadTest->cancel();
+    }
+}
+
+void LoadTestWidget::onProgress()
+{
+    if (!mRefresh->isActive()) {
+        mRefresh->start();
+    }
+}
+
+void LoadTestWidget::onRefresh()
+{
+    if (!mLoadTest) {
+        return;
+    }
+    const QList<double>& latencies = mLoadTest->latencies();
+    int count = qMin(int(latencies.size()), maxPlotted);
+    if (count > mPlotted) {
+        mLatencies->insertRows(mPlotted, count - mPlotted);
+        for(int row=mPlotted;row<count;row++) {
+            mLatencies->setData(mLatencies->index(row, 0), latencies[row]);
+        }
+        mPlotted = count;
+        ui->plot->refresh();
+    }
+    updateStatus();
+    if (mLoadTest->isFinished()) {
+        mRefresh->stop();
+    }
+}
+
+void LoadTestWidget::updateStatus()
+{
+    LoadTest::Result result = mLoadTest->result();
+    QString status = QString("%1 executions in %2 s, %3/s, p50 %4 ms, p95 %5 ms, p99 %6 ms, max %7 ms")
+            .arg(result.iterations)
+            .arg(result.seconds, 0, 'f', 1)
+            .arg(result.throughput(), 0, 'f', 1)
+            .arg(result.p50, 0, 'f', 2)
+            .arg(result.p95, 0, 'f', 2)
+            .arg(result.p99, 0, 'f', 2)
+            .arg(result.max, 0, 'f', 2);
+    if (result.errors > 0) {
+        status += QString(", %1 errors: %2").arg(result.errors).arg(mLoadTest->lastError());
+    }
+    ui->status->setText(status);
+}
+
+void LoadTestWidget::onFinished()
+{
+    onRefresh();
+    ui->start->setEnabled(true);
+    ui->stop->setEnabled(false);
+    LoadTest::Result result = mLoadTest->result();
+    if (result.iterations > 0) {
+        History::instance()->addLoadTest(result);
+    }
+    updateRuns();
+}
+
+void LoadTestWidget::updateRuns()
+{
+    QList<LoadTest::Result> results = History::instance()->loadTests(mConnectionName);
+    mRuns->clear();
+    mRuns->setHorizontalHeaderLabels({"date", "connections", "executions", "errors", "per second",
+                                      "p50 ms", "p95 ms", "p99 ms", "max ms", "query"});
+    mRuns->setRowCount(results.size());
+    for(int row=0;row<results.size();row++) {
+        const LoadTest::Result& result = results[row];
+        QVariantList values = {result.started, result.concurrency, result.iterations, result.errors,
+                               qRound(result.throughput() * 10) / 10.0, result.p50, result.p95,
+                               result.p99, result.max, result.query.simplified()};
+        for(int column=0;column<values.size();column++) {
+            mRuns->setData(mRuns->index(row, column), values[column]);
+        }
+    }
+    ui->runs->resizeColumnsToContents();
+}
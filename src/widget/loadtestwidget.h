@@ -0,0 +1,46 @@
+#ifndef LOADTESTWIDGET_H
+#define LOADTESTWIDGET_H
+
+#include <QWidget>
+class LoadTest;
+class QStandardItemModel;
+class QTimer;
+
+namespace Ui {
+class LoadTestWidget;
+}
+
+// Runs query under load and shows latency histogram while it runs, finished runs
+// are saved to history and listed below for comparison
+
+class LoadTestWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LoadTestWidget(QWidget *parent = nullptr);
+    ~LoadTestWidget();
+
+    void init(const QString& connectionName, const QString& query);
+
+protected slots:
+    void on_start_clicked();
+    void on_stop_clicked();
+    void onProgress();
+    void onFinished();
+    void onRefresh();
+
+protected:
+    void updateStatus();
+    void updateRuns();
+
+    Ui::LoadTestWidget *ui;
+    QString mConnectionName;
+    LoadTest* mLoadTest;
+    QStandardItemModel* mLatencies;
+    QStandardItemModel* mRuns;
+    QTimer* mRefresh;
+    int mPlotted;
+};
+
+#endif // LOADTESTWIDGET_H
@@ -17,6 +17,8 @@ class RelationsModel;
 class QSqlQueryModel;
 class Schema2TreeProxyModel;
 class Schema2TreeModel;
+class ConnectProgressDialog;
+struct ConnectionParams;
 
 #include "tokens.h"
 
@@ -44,6 +46,7 @@ public:
     void pushTokens(const QString &connectionName);
 
     void databaseConnect(bool showHistory = false);
+    void connectDatabases(const QList<ConnectionParams>& connections);
 
     QString connectionName() const;
     QSqlDatabase database() const;
@@ -61,6 +64,7 @@ protected:
     QMap<QString,Tokens> mTokens;
     JoinHelperWidgets* mJoinHelpers;
     DataImportWidgets* mDataImport;
+    ConnectProgressDialog* mConnectProgress;
 
     QString mQuery;
 
@@ -68,6 +72,11 @@ protected:
 
     void copySelected(CopyFormat fmt);
 
+    void addConnection(const ConnectionParams& params);
+
+    // executes queries on connections selected in tab concurrently
+    void queryTargets(SessionTab* tab, const QStringList& queries);
+
     int lastTabIndex(const QString &connectionName);
     void selectDatabase(const QString &connectionName);
     void updateSchemaModel();
@@ -91,6 +100,8 @@ protected slots:
     void on_queryHistory_triggered();
     void on_queryHelp_triggered();
     void on_queryJoin_triggered();
+    void on_queryLoadTest_triggered();
+    void on_queryExecuteScript_triggered();
     void on_queryExecute_triggered();
 
 
@@ -121,9 +132,17 @@ protected slots:
     void on_dataSave_triggered();
     void on_dataImport_triggered();
     void on_dataCompare_triggered();
+    void on_dataCompareSnapshot_triggered();
+    void on_dataSaveSnapshot_triggered();
+    void on_dataOpenSnapshot_triggered();
 
     void on_toolsMysql_triggered();
     void on_toolsMysqldump_triggered();
+    void on_toolsDump_triggered();
+
+    void on_toolsCopy_triggered();
+    void on_toolsScript_triggered();
+    void on_toolsLargeFile_triggered();
 
     //void on_codePython_triggered();
     void on_codePandas_triggered();
@@ -131,6 +150,8 @@ protected slots:
     void on_schemaEdit_triggered();
 
     void on_toolsJoin_triggered();
+    void on_toolsTrace_triggered(bool checked);
+    void on_toolsTraceSave_triggered();
 
     friend class Automation;
 
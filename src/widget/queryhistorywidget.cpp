@@ -6,6 +6,7 @@
 #include <QDebug>
 #include "copyeventfilter.h"
 #include "model/queryhistorymodel.h"
+#include "model/fingerprintstatmodel.h"
 #include <QClipboard>
 #include "richheaderview/richheaderview.h"
 #include "widget/datetimerangewidget.h"
@@ -18,27 +19,19 @@
 #include <algorithm>
 #include "query_exec.h"
 #include "daterangewidget.h"
-
-// todo: optimize
-template <typename T>
-static QList<T> uniq(const QList<T>& values) {
-    QList<T> res;
-    for(const T& value: values) {
-        if (!res.contains(value)) {
-            res.append(value);
-        }
-    }
-    return res;
-}
+#include "history.h"
 
 static QList<int> partialySelectedRows(QItemSelectionModel* selectionModel) {
-    QModelIndexList indexes = selectionModel->selectedIndexes();
+    // select all is one range, not rows * columns indexes
     QList<int> rows;
-    foreach (const QModelIndex& index, indexes) {
-        rows << index.row();
+    const QItemSelection selection = selectionModel->selection();
+    for(const QItemSelectionRange& range: selection) {
+        for(int row=range.top();row<=range.bottom();row++) {
+            rows << row;
+        }
     }
-    rows = uniq(rows);
     std::sort(rows.begin(),rows.end());
+    rows.erase(std::unique(rows.begin(),rows.end()),rows.end());
     return rows;
 }
 
@@ -51,20 +44,30 @@ QueryHistoryWidget::QueryHistoryWidget(QWidget *parent) :
 
     QueryHistoryModel* model = new QueryHistoryModel(this);
     ui->tableView->setModel(model);
+    connect(model,&QueryHistoryModel::counted,[=](qint64 count){
+        ui->count->setText(QString("%1 queries").arg(count));
+    });
 
     ui->tableView->setColumnWidth(0,160);
 
-    CopyEventFilter* filter = new CopyEventFilter(this);
-    filter->setView(ui->tableView);
+    ui->statsView->setModel(new FingerprintStatModel(this));
 
-    connect(filter,&CopyEventFilter::copy,[=](){
+    auto copy = [=](){
         QStringList queries = selectedQueries();
         if (queries.isEmpty()) {
             return;
         }
         QClipboard *clipboard = QApplication::clipboard();
         clipboard->setText(queries.join(";\n"));
-    });
+    };
+
+    CopyEventFilter* filter = new CopyEventFilter(this);
+    filter->setView(ui->tableView);
+    connect(filter,&CopyEventFilter::copy,copy);
+
+    CopyEventFilter* statsFilter = new CopyEventFilter(this);
+    statsFilter->setView(ui->statsView);
+    connect(statsFilter,&CopyEventFilter::copy,copy);
 
     RichHeaderView* view = new RichHeaderView(Qt::Horizontal, ui->tableView);
 
@@ -81,13 +84,13 @@ QueryHistoryWidget::QueryHistoryWidget(QWidget *parent) :
     QLineEdit* queryEdit = new QLineEdit(view->viewport());
     QComboBox* connectionNameEdit = new QComboBox(view->viewport());
 
-    CallOnce* once = new CallOnce("updateQuery", 500);
+    // typing and spinning dates requery once after edits settle
+    CallOnce* once = new CallOnce("updateQuery", 300, this);
     connect(queryEdit,SIGNAL(textChanged(QString)),once,SLOT(onPost()));
+    connect(dateEdit,SIGNAL(changed(int,int,QDate,QDate)),once,SLOT(onPost()));
+    connect(connectionNameEdit,SIGNAL(currentIndexChanged(int)),once,SLOT(onPost()));
     connect(once,SIGNAL(call()),this,SLOT(onUpdateQuery()));
 
-    connect(dateEdit,SIGNAL(changed(int,int,QDate,QDate)),this,SLOT(onUpdateQuery()));
-    connect(connectionNameEdit,SIGNAL(currentIndexChanged(int)),this,SLOT(onUpdateQuery()));
-
     /*DateTimeRangeWidgetManager* manager = new DateTimeRangeWidgetManager(this);
     manager->init(dateEdit);*/
 
@@ -131,12 +134,26 @@ QueryHistoryWidget::~QueryHistoryWidget()
     delete ui;
 }
 
+QTableView* QueryHistoryWidget::currentView() const {
+    return ui->pages->currentWidget() == ui->statsPage ? ui->statsView : ui->tableView;
+}
+
+int QueryHistoryWidget::queryColumn() const {
+    return currentView() == ui->statsView ? FingerprintStatModel::col_query : QueryHistoryModel::col_query;
+}
+
+int QueryHistoryWidget::connectionNameColumn() const {
+    return currentView() == ui->statsView ? FingerprintStatModel::col_connectionName : QueryHistoryModel::col_connectionName;
+}
+
 QStringList QueryHistoryWidget::selectedQueries() const {
-    QList<int> rows = partialySelectedRows(ui->tableView->selectionModel());
+    QTableView* view = currentView();
+    QList<int> rows = partialySelectedRows(view->selectionModel());
     QStringList queries;
-    QAbstractItemModel* model = ui->tableView->model();
+    QAbstractItemModel* model = view->model();
+    int column = queryColumn();
     foreach (int row, rows) {
-        queries << model->data(model->index(row,QueryHistoryModel::col_query)).toString();
+        queries << model->data(model->index(row,column)).toString();
     }
     return queries;
 }
@@ -148,12 +165,46 @@ void QueryHistoryWidget::on_tableView_doubleClicked(QModelIndex index) {
     emit appendQuery(connectionName,query);
 }
 
+void QueryHistoryWidget::on_statsView_doubleClicked(QModelIndex index) {
+    QAbstractItemModel* m = ui->statsView->model();
+    QString connectionName = m->data(m->index(index.row(),FingerprintStatModel::col_connectionName)).toString();
+    QString query = m->data(m->index(index.row(),FingerprintStatModel::col_query)).toString();
+    emit appendQuery(connectionName,query);
+}
+
+void QueryHistoryWidget::on_view_currentIndexChanged(int index)
+{
+    if (index == 0) {
+        ui->pages->setCurrentWidget(ui->historyPage);
+        onUpdateQuery();
+    } else {
+        ui->pages->setCurrentWidget(ui->statsPage);
+        ui->count->clear();
+        updateStats();
+    }
+}
+
+void QueryHistoryWidget::updateStats()
+{
+    FingerprintStatModel* model = qobject_cast<FingerprintStatModel*>(ui->statsView->model());
+    if (!model) {
+        return;
+    }
+    History::instance()->flush();
+    // view items follow FingerprintStatModel::Order after history
+    model->select(static_cast<FingerprintStatModel::Order>(ui->view->currentIndex() - 1));
+    ui->statsView->resizeColumnsToContents();
+    ui->statsView->setColumnWidth(FingerprintStatModel::col_fingerprint,
+                                  qMin(ui->statsView->columnWidth(FingerprintStatModel::col_fingerprint), width() / 3));
+}
+
 void QueryHistoryWidget::refresh(const QString& connectionName)
 {
     QComboBox* comboBox = connectionNameEdit();
     if (!comboBox) {
         return;
     }
+    History::instance()->flush();
     QSqlDatabase db = QSqlDatabase::database("_history");
     QSqlQuery q(db);
     q.prepare("select distinct connectionName from query");
@@ -172,12 +223,16 @@ void QueryHistoryWidget::refresh(const QString& connectionName)
 
 void QueryHistoryWidget::on_refresh_clicked()
 {
+    if (currentView() == ui->statsView) {
+        updateStats();
+        return;
+    }
     refresh(connectionNameEdit()->currentText());
 }
 
 void QueryHistoryWidget::on_copy_clicked()
 {
-    QModelIndex index = ui->tableView->currentIndex();
+    QModelIndex index = currentView()->currentIndex();
     if (!index.isValid()) {
         return;
     }
@@ -185,18 +240,11 @@ void QueryHistoryWidget::on_copy_clicked()
     if (queries.isEmpty()) {
         return;
     }
-    QAbstractItemModel* model = ui->tableView->model();
-    QString connectionName = model->data(model->index(index.row(),QueryHistoryModel::col_connectionName)).toString();
+    QAbstractItemModel* model = currentView()->model();
+    QString connectionName = model->data(model->index(index.row(),connectionNameColumn())).toString();
     emit appendQuery(connectionName,queries.join(";\n"));
 }
 
-static QString like(const QString& value) {
-    if (value.isEmpty()) {
-        return QString();
-    }
-    return "%" + value + "%";
-}
-
 #include <QFontMetrics>
 
 void QueryHistoryWidget::onUpdateQuery() {
@@ -205,12 +253,12 @@ void QueryHistoryWidget::onUpdateQuery() {
         return;
     }
 
-    QSqlDatabase db = QSqlDatabase::database("_history");
-    QString query = like(queryEdit()->text());
+    History* history = History::instance();
+    // queries are written in background
+    history->flush();
 
     DateRangeWidget* dateEdit = this->dateEdit();
 
-
     DateRangeWidget::Mode mode = dateEdit->mode();
 
     QString connectionName = connectionNameEdit()->currentText();
@@ -220,40 +268,25 @@ void QueryHistoryWidget::onUpdateQuery() {
 
     if (mode == DateRangeWidget::All) {
         // do nothing
-        //qDebug() << "All";
     } else if (mode == DateRangeWidget::NDays) {
-        QDate date = QDate::currentDate().addDays(-dateEdit->days());
-        conditions.append("date(date) > ?");
-        values.append(date);
-        //qDebug() << "NDays" << date;
+        History::dateCondition(QDate::currentDate().addDays(-dateEdit->days() + 1), QDate(), conditions, values);
     } else if (mode == DateRangeWidget::Range) {
-        conditions.append("date(date) between ? and ?");
-        values.append(dateEdit->date1());
-        values.append(dateEdit->date2());
-        //qDebug() << "Range" << dateEdit->date1() << dateEdit->date2();
+        History::dateCondition(dateEdit->date1(), dateEdit->date2(), conditions, values);
     }
 
     if (connectionName != "any") {
         conditions.append("connectionName=?");
         values.append(connectionName);
     }
-    if (!query.isEmpty()) {
-        conditions.append("query like ?");
-        values.append(query);
-    }
+    history->textCondition(queryEdit()->text(), conditions, values);
 
-    QSqlQuery q(db);
-    q.prepare("select * from query where " + conditions.join(" and ") + " order by date desc");
-    for(const QVariant& value: values) {
-        q.addBindValue(value);
-    }
-    QUERY_EXEC(q);
-    QSqlQueryModel* model = qobject_cast<QSqlQueryModel*>(ui->tableView->model());
+    QueryHistoryModel* model = qobject_cast<QueryHistoryModel*>(ui->tableView->model());
     if (!model) {
         qDebug() << "not model";
         return;
     }
-    model->setQuery(q);
+    ui->count->setText("counting...");
+    model->setFilter(conditions, values);
 
     QFontMetrics m(dateEdit->font());
     int width = m.horizontalAdvance("0000-00-00") * 3;
@@ -14,6 +14,7 @@ class DateTimeRangeWidget;
 class QComboBox;
 class QLineEdit;
 class DateRangeWidget;
+class QTableView;
 
 class QueryHistoryWidget : public QWidget
 {
@@ -40,9 +41,16 @@ private slots:
     void on_refresh_clicked();
     void on_copy_clicked();
     void on_tableView_doubleClicked(QModelIndex index);
+    void on_statsView_doubleClicked(QModelIndex index);
+    void on_view_currentIndexChanged(int index);
     void onUpdateQuery();
 
 private:
+    QTableView* currentView() const;
+    int queryColumn() const;
+    int connectionNameColumn() const;
+    void updateStats();
+
     Ui::QueryHistoryWidget *ui;
     QSqlQuery mQuery;
 };
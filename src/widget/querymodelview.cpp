@@ -15,6 +15,7 @@
 #include "clipboard.h"
 #include "clipboardutil.h"
 #include "hexitemdelegate.h"
+#include "trace.h"
 
 namespace {
 
@@ -23,6 +24,7 @@ void resizeColumnsToContents(QTableView* view, int maxWidth) {
     if (!model) {
         return;
     }
+    TRACE_SCOPE("resizeColumnsToContents");
     view->resizeColumnsToContents();
     for(int c=0; c<model->columnCount(); c++) {
         if (view->columnWidth(c) > maxWidth)
@@ -47,6 +49,10 @@ QItemSelectionModel* QueryModelView::selectionModel() const {
     return ui->table->selectionModel();
 }
 
+QTableView* QueryModelView::tableView() const {
+    return ui->table;
+}
+
 QueryModelView::QueryModelView(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::QueryModelView),
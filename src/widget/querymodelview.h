@@ -10,6 +10,7 @@ class XYPlot;
 class HexItemDelegate;
 class ItemDelegate;
 class QAbstractItemDelegate;
+class QTableView;
 
 namespace Ui {
 class QueryModelView;
@@ -38,6 +39,7 @@ public:
     QAbstractItemModel* model() const;
 
     QItemSelectionModel *selectionModel() const;
+    QTableView* tableView() const;
     XYPlot *xyPlot() const;
     DistributionPlot *distributionPlot() const;
 public slots:
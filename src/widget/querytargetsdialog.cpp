@@ -0,0 +1,34 @@
+#include "querytargetsdialog.h"
+#include "ui_querytargetsdialog.h"
+
+QueryTargetsDialog::QueryTargetsDialog(const QStringList &connectionNames, const QStringList &targets,
+                                       int concurrency, bool merge, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::QueryTargetsDialog)
+{
+    ui->setupUi(this);
+    ui->targets->append(connectionNames);
+    ui->targets->setChecked(targets);
+    ui->concurrency->setValue(concurrency);
+    ui->merge->setChecked(merge);
+}
+
+QueryTargetsDialog::~QueryTargetsDialog()
+{
+    delete ui;
+}
+
+QStringList QueryTargetsDialog::targets() const
+{
+    return ui->targets->checked();
+}
+
+int QueryTargetsDialog::concurrency() const
+{
+    return ui->concurrency->value();
+}
+
+bool QueryTargetsDialog::merge() const
+{
+    return ui->merge->isChecked();
+}
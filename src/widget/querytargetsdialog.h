@@ -0,0 +1,27 @@
+#ifndef QUERYTARGETSDIALOG_H
+#define QUERYTARGETSDIALOG_H
+
+#include <QDialog>
+
+namespace Ui {
+class QueryTargetsDialog;
+}
+
+class QueryTargetsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    QueryTargetsDialog(const QStringList& connectionNames, const QStringList& targets,
+                       int concurrency, bool merge, QWidget *parent = nullptr);
+    ~QueryTargetsDialog();
+
+    QStringList targets() const;
+    int concurrency() const;
+    bool merge() const;
+
+private:
+    Ui::QueryTargetsDialog *ui;
+};
+
+#endif // QUERYTARGETSDIALOG_H
@@ -160,6 +160,15 @@ QString SaveDataDialog::filePath() const
     return QDir(ui->outputDir->text()).filePath(ui->outputName->text());
 }
 
+void SaveDataDialog::setFile(DataFormat::Format format, const QString &path)
+{
+    ui->output->setCurrentIndex(OutputType::File);
+    ui->format->setCurrentIndex(format);
+    QFileInfo fileInfo(path);
+    ui->outputDir->setText(QDir::toNativeSeparators(fileInfo.dir().absolutePath()));
+    ui->outputName->setText(fileInfo.fileName());
+}
+
 void SaveDataDialog::on_table_textChanged(const QString& table)
 {
     ui->columns->setTable(table);
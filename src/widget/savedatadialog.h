@@ -49,6 +49,9 @@ public:
 
     QString filePath() const;
 
+    // output to file, used by automation
+    void setFile(DataFormat::Format format, const QString& path);
+
 public slots:
 
     void accept();
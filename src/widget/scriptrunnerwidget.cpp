@@ -0,0 +1,154 @@
+#include "scriptrunnerwidget.h"
+#include "ui_scriptrunnerwidget.h"
+
+#include <QFileInfo>
+#include <QDir>
+
+ScriptRunnerWidget::ScriptRunnerWidget(QWidget *parent) :
+    QWidget(parent),
+    ui(new Ui::ScriptRunnerWidget),
+    mTo(-1),
+    mRunner(nullptr)
+{
+    ui->setupUi(this);
+    updateButtons(false);
+}
+
+ScriptRunnerWidget::~ScriptRunnerWidget()
+{
+    delete ui;
+}
+
+void ScriptRunnerWidget::initFile(const QString &connectionName, const QString &path)
+{
+    mConnectionName = connectionName;
+    mPath = path;
+    mText.clear();
+    mFrom = ScriptRunner::Position();
+    mTo = -1;
+    QFileInfo info(path);
+    ui->source->setText(QString("%1 (%2 MB)").arg(QDir::toNativeSeparators(path))
+                        .arg(info.size() / 1024.0 / 1024.0, 0, 'f', 1));
+    setWindowTitle(QString("Execute %1 %2").arg(info.fileName()).arg(connectionName));
+}
+
+void ScriptRunnerWidget::initText(const QString &connectionName, const QString &text)
+{
+    mConnectionName = connectionName;
+    mPath.clear();
+    mText = text;
+    mFrom = ScriptRunner::Position();
+    mTo = -1;
+    ui->source->setText(QString("Query text (%1 characters)").arg(text.size()));
+    setWindowTitle(QString("Execute script %1").arg(connectionName));
+}
+
+void ScriptRunnerWidget::setRange(const ScriptRunner::Position &from, qint64 to)
+{
+    mFrom = from;
+    mTo = to;
+    ui->source->setText(ui->source->text() + QString(", bytes %1-%2").arg(from.offset).arg(to));
+}
+
+void ScriptRunnerWidget::start(const ScriptRunner::Position &from)
+{
+    if (mConnectionName.isEmpty() || (mPath.isEmpty() && mText.isEmpty())) {
+        return;
+    }
+    if (mRunner) {
+        mRunner->deleteLater();
+    }
+    mRunner = new ScriptRunner(mConnectionName, this);
+    mRunner->setBatchSize(ui->batch->value());
+    mRunner->setStopOnError(ui->stopOnError->isChecked());
+    connect(mRunner, SIGNAL(progress()), this, SLOT(onProgress()));
+    connect(mRunner, SIGNAL(error(QString,QString)), this, SLOT(onError(QString,QString)));
+    connect(mRunner, SIGNAL(finished()), this, SLOT(onFinished()));
+    updateButtons(true);
+    if (mPath.isEmpty()) {
+        mRunner->startText(mText, from);
+    } else {
+        mRunner->startFile(mPath, from, mTo);
+    }
+    updateStatus();
+}
+
+void ScriptRunnerWidget::on_start_clicked()
+{
+    ui->errors->clear();
+    start(mFrom);
+}
+
+void ScriptRunnerWidget::on_stop_clicked()
+{
+    if (mRunner) {
+        mRunner->cancel();
+    }
+}
+
+void ScriptRunnerWidget::on_retry_clicked()
+{
+    if (mRunner) {
+        start(mRunner->resumePosition());
+    }
+}
+
+void ScriptRunnerWidget::on_skip_clicked()
+{
+    if (mRunner) {
+        start(mRunner->skipPosition());
+    }
+}
+
+void ScriptRunnerWidget::onProgress()
+{
+    updateStatus();
+}
+
+void ScriptRunnerWidget::onError(QString statement, QString error)
+{
+    ui->errors->appendPlainText(QString("%1\n%2\n").arg(error).arg(statement));
+}
+
+void ScriptRunnerWidget::onFinished()
+{
+    updateStatus();
+    updateButtons(false);
+}
+
+void ScriptRunnerWidget::updateStatus()
+{
+    qint64 total = mRunner->totalBytes() - mFrom.offset;
+    qint64 bytes = mRunner->bytes() - mFrom.offset;
+    ui->progress->setValue(total > 0 ? int(bytes * 1000 / total) : 0);
+    double seconds = mRunner->seconds();
+    double mb = bytes / 1024.0 / 1024.0;
+    QString status = QString("%1 statements, %2 errors, %3 MB in %4 s")
+            .arg(mRunner->statements())
+            .arg(mRunner->errors())
+            .arg(mb, 0, 'f', 1)
+            .arg(seconds, 0, 'f', 1);
+    if (seconds > 0) {
+        status += QString(", %1 MB/s, %2 statements/s")
+                .arg(mb / seconds, 0, 'f', 1)
+                .arg(mRunner->statements() / seconds, 0, 'f', 0);
+    }
+    if (mRunner->isFinished()) {
+        status += mRunner->isFailed() ? ", stopped at error" : ", finished";
+    }
+    ui->status->setText(status);
+}
+
+void ScriptRunnerWidget::updateButtons(bool running)
+{
+    bool failed = !running && mRunner && mRunner->isFailed();
+    // stopped or failed before end
+    bool resumable = !running && mRunner && mRunner->isFinished()
+            && mRunner->resumePosition().offset < mRunner->totalBytes();
+    ui->start->setEnabled(!running);
+    ui->stop->setEnabled(running);
+    ui->retry->setEnabled(resumable);
+    ui->skip->setEnabled(failed && !mRunner->failedStatement().isEmpty());
+    ui->batch->setEnabled(!running);
+    ui->stopOnError->setEnabled(!running);
+}
@@ -0,0 +1,50 @@
+#ifndef SCRIPTRUNNERWIDGET_H
+#define SCRIPTRUNNERWIDGET_H
+
+#include <QWidget>
+#include "scriptrunner.h"
+
+namespace Ui {
+class ScriptRunnerWidget;
+}
+
+// Executes sql script file or text and shows progress, on error script can be
+// resumed from failed statement or from statement after it
+
+class ScriptRunnerWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ScriptRunnerWidget(QWidget *parent = nullptr);
+    ~ScriptRunnerWidget();
+
+    void initFile(const QString& connectionName, const QString& path);
+    void initText(const QString& connectionName, const QString& text);
+    // part of file to execute, to is byte offset (-1 - end of file)
+    void setRange(const ScriptRunner::Position& from, qint64 to);
+
+protected slots:
+    void on_start_clicked();
+    void on_stop_clicked();
+    void on_retry_clicked();
+    void on_skip_clicked();
+    void onProgress();
+    void onError(QString statement, QString error);
+    void onFinished();
+
+protected:
+    void start(const ScriptRunner::Position& from);
+    void updateStatus();
+    void updateButtons(bool running);
+
+    Ui::ScriptRunnerWidget *ui;
+    QString mConnectionName;
+    QString mPath;
+    QString mText;
+    ScriptRunner::Position mFrom;
+    qint64 mTo;
+    ScriptRunner* mRunner;
+};
+
+#endif // SCRIPTRUNNERWIDGET_H
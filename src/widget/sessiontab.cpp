@@ -18,6 +18,7 @@
 #include <QCompleter>
 #include <QClipboard>
 #include "tokens.h"
+#include "trace.h"
 #include "highlighter.h"
 #include "querymodelview.h"
 
@@ -25,7 +26,14 @@
 #include "clipboard.h"
 #include <QSharedPointer>
 #include "error.h"
+#include "connectionpool.h"
 #include "copyeventfilter.h"
+#include "fanoutquery.h"
+#include "automation.h"
+#include "sqlparse.h"
+#include <QTextCursor>
+#include <QTextDocumentFragment>
+#include <QElapsedTimer>
 
 namespace {
 
@@ -65,9 +73,12 @@ QStringList unquote(const QStringList& items) {
 
 SessionTab::SessionTab(const QString &connectionName, const QString name, QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::SessionTab), mConnectionName(connectionName), mName(name), mFirstQuery(true)
+    ui(new Ui::SessionTab), mConnectionName(connectionName), mName(name), mFirstQuery(true),
+    mConcurrency(8), mMerge(false), mFanOut(nullptr)
 {
     ui->setupUi(this);
+    // shown while query runs on targets
+    ui->cancel->hide();
     cleanTabs();
     connect(ui->query,SIGNAL(submit()),this,SLOT(on_execute_clicked()));
 
@@ -100,6 +111,10 @@ SessionTab::~SessionTab()
 {
     qDebug() << "~SessionTab";
     delete ui;
+    if (!mLease.isEmpty()) {
+        // user queries may leave open transaction, USE, SET or temporary tables behind
+        ConnectionPool::instance()->release(mLease, true);
+    }
 }
 
 QString SessionTab::connectionName() const
@@ -107,6 +122,22 @@ QString SessionTab::connectionName() const
     return mConnectionName;
 }
 
+QSqlDatabase SessionTab::database()
+{
+    if (!mLease.isEmpty() && QSqlDatabase::contains(mLease)) {
+        return QSqlDatabase::database(mLease);
+    }
+    QString error;
+    QSqlDatabase db = ConnectionPool::instance()->lease(mConnectionName, error);
+    if (!db.isValid()) {
+        qDebug() << "SessionTab::database" << error;
+        mLease.clear();
+        return QSqlDatabase::database(mConnectionName);
+    }
+    mLease = db.connectionName();
+    return db;
+}
+
 QString SessionTab::name() const
 {
     return mName;
@@ -127,17 +158,30 @@ QueryModelView* SessionTab::tab(int index, bool* insert) {
 }
 
 
-void SessionTab::setResult(const QStringList& queries, const QStringList errors, const QList<QSqlQueryModel *> models, const QList<int> &perf, const QList<int> &rowsAffected)
+void SessionTab::setResult(const QStringList& queries, const QStringList errors, const QList<QSqlQueryModel *> models, const QList<QueryTiming> &timings, const QList<int> &rowsAffected,
+                           const QStringList& targets, const QStringList& titles)
 {
+    TRACE_SCOPE("SessionTab::setResult");
+    mTimings = timings;
+    bool measureLayout = models.size() == mTimings.size();
+    QElapsedTimer time;
+
     int i = 0;
-    foreach(QSqlQueryModel * model, models) {
+    for(int m=0;m<models.size();m++) {
+        QSqlQueryModel* model = models[m];
         if (model) {
             bool insert = false;
             QueryModelView* view = tab(i,&insert);
+            time.start();
             view->setModel(model);
-            QString title = QString("res %1").arg(i + 1);
+            if (measureLayout) {
+                mTimings[m].layout = int(time.elapsed());
+            }
+            QString title = titles.isEmpty() ? QString("res %1").arg(i + 1) : titles[m];
             if (insert) {
                 ui->resultTabs->insertTab(ui->resultTabs->count() - 1, view, title);
+            } else {
+                ui->resultTabs->setTabText(i, title);
             }
             i++;
         }
@@ -166,12 +210,15 @@ void SessionTab::setResult(const QStringList& queries, const QStringList errors,
     }
 
     StatView* view = statView();
-    QueriesStatModel* model = new QueriesStatModel(queries, errors,perf,rowsAffected,view);
+    QueriesStatModel* model = new QueriesStatModel(queries, errors,mTimings,rowsAffected,view,targets);
     deleteLaterModel(view);
     view->setModel(model);
 
-    int columnWidth = (this->width() - 60 - view->horizontalHeader()->defaultSectionSize() * (model->hasErrors() ? 2 : 3)) / (model->hasErrors() ? 2 : 1);
-    view->setColumnWidth(0,columnWidth);
+    // target and timing columns have default width
+    int queryColumn = targets.isEmpty() ? 0 : 1;
+    int sectionSize = view->horizontalHeader()->defaultSectionSize();
+    int columnWidth = (this->width() - 60 - sectionSize * (8 + queryColumn)) / (model->hasErrors() ? 2 : 1);
+    view->setColumnWidth(queryColumn,qMax(columnWidth, sectionSize * 2));
 
     if (mFirstQuery) {
         SplitterUtil::setRatio(ui->splitter,{1,5});
@@ -181,6 +228,101 @@ void SessionTab::setResult(const QStringList& queries, const QStringList errors,
 }
 
 
+QList<QueryTiming> SessionTab::timings() const
+{
+    return mTimings;
+}
+
+void SessionTab::setResult(FanOutQuery *query)
+{
+    QStringList names = query->connectionNames();
+    QStringList queries_ = query->queries();
+
+    QStringList queries;
+    QStringList errors;
+    QList<QueryTiming> timings;
+    QList<int> rowsAffected;
+    QStringList targets;
+    QList<QSqlQueryModel*> models;
+    QStringList titles;
+    QElapsedTimer time;
+
+    for(int target=0;target<names.size();target++) {
+        const FanOutQuery::Result& result = query->result(target);
+        for(int i=0;i<queries_.size();i++) {
+            targets << names[target];
+            queries << queries_[i];
+            errors << result.errors.value(i);
+            QueryTiming timing = result.timings.value(i);
+            rowsAffected << result.rowsAffected.value(i, -1);
+            if (!mMerge) {
+                time.start();
+                models << query->model(target, i);
+                timing.model = int(time.elapsed());
+                titles << QString("%1 res %2").arg(names[target]).arg(i + 1);
+            }
+            timings << timing;
+        }
+    }
+
+    if (mMerge) {
+        for(int i=0;i<queries_.size();i++) {
+            QStringList skipped;
+            models << query->mergedModel(i, &skipped);
+            titles << QString("res %1").arg(i + 1);
+            for(const QString& name: std::as_const(skipped)) {
+                errors[names.indexOf(name) * queries_.size() + i] = "Columns differ from other targets, not merged";
+            }
+        }
+    }
+
+    setResult(queries, errors, models, timings, rowsAffected, targets, titles);
+}
+
+QStringList SessionTab::targets() const
+{
+    return mTargets;
+}
+
+int SessionTab::concurrency() const
+{
+    return mConcurrency;
+}
+
+bool SessionTab::mergeTargets() const
+{
+    return mMerge;
+}
+
+void SessionTab::setTargets(const QStringList &targets, int concurrency, bool merge)
+{
+    mTargets = targets;
+    mConcurrency = concurrency;
+    mMerge = merge;
+    ui->targets->setText(targets.isEmpty() ? QString("targets") : QString("targets (%1)").arg(targets.size()));
+}
+
+FanOutQuery *SessionTab::fanOut() const
+{
+    return mFanOut;
+}
+
+void SessionTab::setFanOut(FanOutQuery *query)
+{
+    mFanOut = query;
+    ui->cancel->setVisible(query != nullptr);
+    ui->cancel->setEnabled(true);
+    if (!query) {
+        ui->execute->setText("execute");
+        return;
+    }
+    int count = query->connectionNames().size();
+    ui->execute->setText(QString("0/%1").arg(count));
+    connect(query, &FanOutQuery::targetFinished, this, [=](){
+        ui->execute->setText(QString("%1/%2").arg(query->finishedCount()).arg(count));
+    });
+}
+
 void SessionTab::setTokens(const Tokens &tokens)
 {
     ui->query->setTokens(tokens);
@@ -209,6 +351,29 @@ QString SessionTab::query() const
     return ui->query->toPlainText();
 }
 
+QString SessionTab::currentStatement() const
+{
+    QTextCursor cursor = ui->query->textCursor();
+    if (cursor.hasSelection()) {
+        return cursor.selection().toPlainText().trimmed();
+    }
+    QStringList queries = SqlParse::splitQueries(query());
+    QString last;
+    int begin = 0;
+    for(const QString& query: std::as_const(queries)) {
+        int end = begin + query.size();
+        if (!query.trimmed().isEmpty()) {
+            last = query.trimmed();
+            if (cursor.position() <= end) {
+                return last;
+            }
+        }
+        // separator
+        begin = end + 1;
+    }
+    return last;
+}
+
 void SessionTab::focusQuery()
 {
     ui->query->setFocus();
@@ -232,6 +397,7 @@ void SessionTab::fetchAll() {
     if (!model) {
         return;
     }
+    TRACE_SCOPE("SessionTab::fetchAll");
     while (model->canFetchMore()) {
         model->fetchMore();
     }
@@ -257,10 +423,11 @@ void SessionTab::saveData()
 
     fetchAll();
 
-    QSqlDatabase db = QSqlDatabase::database(mConnectionName);
+    QSqlDatabase db = database();
 
     SaveDataDialog dialog(db,model,ui->query->tokens(),this);
     dialog.init();
+    Automation::instance()->beforeDialog(&dialog);
     if (dialog.exec() != QDialog::Accepted) {
         return;
     }
@@ -349,6 +516,20 @@ void SessionTab::on_history_clicked()
     emit showQueryHistory();
 }
 
+void SessionTab::on_targets_clicked()
+{
+    emit selectTargets();
+}
+
+void SessionTab::on_cancel_clicked()
+{
+    if (!mFanOut) {
+        return;
+    }
+    mFanOut->cancel();
+    ui->cancel->setEnabled(false);
+}
+
 void SessionTab::quoteQuery() {
     TextEdit* edit = ui->query;
     edit->setPlainText(quote(query().split("\n")).join("\n"));
@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include "enums.h"
+#include "querytiming.h"
 
 namespace Ui {
 class SessionTab;
@@ -17,6 +18,8 @@ class QTextDocument;
 class Tokens;
 class StatView;
 class QueryModelView;
+class QSqlDatabase;
+class FanOutQuery;
 
 
 class SessionTab : public QWidget
@@ -30,7 +33,29 @@ public:
     QString connectionName() const;
     QString name() const;
 
-    void setResult(const QStringList &queries, const QStringList errors, const QList<QSqlQueryModel*> models, const QList<int>& perf, const QList<int>& rowsAffected);
+    // connection leased from pool for this session
+    QSqlDatabase database();
+
+    // targets - connection of each query when executed on several connections, titles - tab title of each model
+    // layout time is measured when models correspond to timings
+    void setResult(const QStringList &queries, const QStringList errors, const QList<QSqlQueryModel*> models, const QList<QueryTiming>& timings, const QList<int>& rowsAffected,
+                   const QStringList& targets = QStringList(), const QStringList& titles = QStringList());
+
+    // timings of last result with layout time
+    QList<QueryTiming> timings() const;
+
+    // results of finished query on several connections, per target tabs or merged
+    void setResult(FanOutQuery* query);
+
+    // connections to execute query on, empty - session connection only
+    QStringList targets() const;
+    int concurrency() const;
+    bool mergeTargets() const;
+    void setTargets(const QStringList& targets, int concurrency, bool merge);
+
+    // running query on several connections
+    FanOutQuery* fanOut() const;
+    void setFanOut(FanOutQuery* query);
 
     void setTokens(const Tokens& token);
 
@@ -40,6 +65,9 @@ public:
 
     QString query() const;
 
+    // selected text or statement under cursor
+    QString currentStatement() const;
+
     void focusQuery();
 
     QSqlQueryModel *currentModel();
@@ -67,6 +95,7 @@ signals:
     void query(QString);
     void showQueryHistory();
     void appendQuery(QString);
+    void selectTargets();
     
 protected:
 
@@ -74,14 +103,22 @@ protected:
 
     Ui::SessionTab *ui;
     QString mConnectionName;
+    QString mLease;
     QString mName;
     bool mFirstQuery;
     QList<QueryModelView*> mTabs;
+    QStringList mTargets;
+    int mConcurrency;
+    bool mMerge;
+    FanOutQuery* mFanOut;
+    QList<QueryTiming> mTimings;
 
 
 public slots:
     void on_execute_clicked();
     void on_history_clicked();
+    void on_targets_clicked();
+    void on_cancel_clicked();
 protected slots:
     void on_resultTabs_currentChanged(int);
 };
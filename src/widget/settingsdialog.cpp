@@ -39,6 +39,10 @@ void initOption(QCheckBox* checkbox, bool value) {
     checkbox->setChecked(value);
 }
 
+void initOption(QSpinBox* spinBox, int value) {
+    spinBox->setValue(value);
+}
+
 void initOption(QRadioButton* yes, QRadioButton* no, bool value) {
     if (value) {
         yes->setChecked(true);
@@ -70,6 +74,12 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
     initOption(ui->realOverrideForCsv, s->realOverrideForCsv());
     initOption(ui->realUseLocale, s->realUseLocale());
     initOption(ui->dateTimeUseLocale, ui->dateTimeUseSpecial, s->dateTimeUseLocale());
+    initOption(ui->largeValuePrefix, s->largeValuePrefix());
+    initOption(ui->largeValueCacheSize, s->largeValueCacheSize());
+    initOption(ui->resultSpillThreshold, s->resultSpillThreshold());
+    initOption(ui->snapshotCompress, s->snapshotCompress());
+    initOption(ui->nativeResults, s->nativeResults());
+    initOption(ui->connectTimeout, s->connectTimeout());
 
     setDateTimeEnabled(!ui->dateTimeUseLocale->isChecked());
     setRealEnabled(ui->realUseLocale->isChecked());
@@ -97,6 +107,10 @@ void saveOption(Settings *s, QLineEdit* edit, const std::function<void(Settings
     fn(s,edit->text());
 }
 
+void saveOption(Settings *s, QSpinBox* spinBox, const std::function<void(Settings *, int)> &fn) {
+    fn(s,spinBox->value());
+}
+
 // (.*) m(.*);$
 // saveOption(s, ui->\2, &Settings::set\2);
 
@@ -127,6 +141,12 @@ void SettingsDialog::accept()
     saveOption(s, ui->dateFormat, &Settings::setDateFormat);
     saveOption(s, ui->timeFormat, &Settings::setTimeFormat);
     saveOption(s, ui->dateTimeUseLocale, &Settings::setDateTimeUseLocale);
+    saveOption(s, ui->largeValuePrefix, &Settings::setLargeValuePrefix);
+    saveOption(s, ui->largeValueCacheSize, &Settings::setLargeValueCacheSize);
+    saveOption(s, ui->resultSpillThreshold, &Settings::setResultSpillThreshold);
+    saveOption(s, ui->snapshotCompress, &Settings::setSnapshotCompress);
+    saveOption(s, ui->nativeResults, &Settings::setNativeResults);
+    saveOption(s, ui->connectTimeout, &Settings::setConnectTimeout);
 
     QDialog::accept();
 }
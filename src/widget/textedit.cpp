@@ -12,6 +12,7 @@
 #include "tokens.h"
 
 #include "highlighter.h"
+#include "sqllexer.h"
 #include "queryparser.h"
 #include <QStyle>
 #include "completer.h"
@@ -161,8 +162,6 @@ void TextEdit::focusInEvent(QFocusEvent *e)
 }
 
 static Completer::Context determineContext(const QTextCursor& cur) {
-    QRegularExpression rxWord("([a-z]+)", QRegularExpression::CaseInsensitiveOption);
-
     static QHash<QString, Completer::Context> contexts = {
         {"from",Completer::From},
         {"select",Completer::Select},
@@ -176,29 +175,27 @@ static Completer::Context determineContext(const QTextCursor& cur) {
         {"column", Completer::Column},
         };
 
-    auto curCopy = cur;
-    while (true) {
-        if (!curCopy.movePosition(QTextCursor::PreviousWord, QTextCursor::KeepAnchor)) {
-            return Completer::Undefined;
-        }
-        if (curCopy.selectedText().contains(";")) {
-            qDebug() << "went too far" << curCopy.selectedText();
-            return Completer::Undefined;
-        }
-
-        auto m = rxWord.match(curCopy.selectedText());
-        if (m.hasMatch()) {
-            QString word = m.captured(1).toLower();
-            if (contexts.contains(word)) {
-                qDebug() << "contexts.contains(word)" << word;
-                return contexts[word];
-            } else {
-                qDebug() << "!contexts.contains(word)" << word;
+    // words before cursor back to start of statement, each block is lexed
+    // from state saved by highlighter so strings and comments are skipped
+    QTextBlock block = cur.block();
+    QString text = block.text().left(cur.positionInBlock());
+    while (block.isValid()) {
+        SqlLexer::State state = Highlighter::blockState(block);
+        QList<SqlLexer::Token> tokens = SqlLexer::tokens(text, &state);
+        for(qsizetype i=tokens.size()-1;i>=0;i--) {
+            const SqlLexer::Token& token = tokens[i];
+            if (token.type == SqlLexer::Delimiter || token.type == SqlLexer::DelimiterCommand) {
+                return Completer::Undefined;
+            }
+            if (token.type == SqlLexer::Word) {
+                auto it = contexts.constFind(text.mid(token.pos, token.size).toLower());
+                if (it != contexts.constEnd()) {
+                    return it.value();
+                }
             }
-        } else {
-            qDebug() << "!m.hasMatch()" << curCopy.selectedText();
         }
-        qDebug() << curCopy.selectedText();
+        block = block.previous();
+        text = block.text();
     }
     return Completer::Undefined;
 }
@@ -0,0 +1,46 @@
+#include "toolcopydialog.h"
+#include "ui_toolcopydialog.h"
+
+#include <QMessageBox>
+
+ToolCopyDialog::ToolCopyDialog(QSqlDatabase db, const QStringList &targets, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ToolCopyDialog)
+{
+    ui->setupUi(this);
+    ui->tables->append(db.tables());
+    for(const QString& target: targets) {
+        if (target != db.connectionName()) {
+            ui->target->addItem(target);
+        }
+    }
+    setWindowTitle(QString("Copy tables from %1").arg(db.connectionName()));
+}
+
+ToolCopyDialog::~ToolCopyDialog()
+{
+    delete ui;
+}
+
+CopySettings ToolCopyDialog::settings() const
+{
+    CopySettings res;
+    res.target = ui->target->currentText();
+    res.tables = ui->tables->checked();
+    res.createTables = ui->createTables->isChecked();
+    res.batchRows = ui->batchRows->value();
+    return res;
+}
+
+void ToolCopyDialog::accept()
+{
+    if (ui->target->currentText().isEmpty()) {
+        QMessageBox::critical(this, QString(), "No target connection");
+        return;
+    }
+    if (ui->tables->checked().isEmpty()) {
+        QMessageBox::critical(this, QString(), "No tables selected");
+        return;
+    }
+    QDialog::accept();
+}
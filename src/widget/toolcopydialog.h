@@ -0,0 +1,40 @@
+#ifndef TOOLCOPYDIALOG_H
+#define TOOLCOPYDIALOG_H
+
+#include <QDialog>
+#include <QSqlDatabase>
+
+namespace Ui {
+class ToolCopyDialog;
+}
+
+class CopySettings {
+public:
+    QString target;
+    QStringList tables;
+    // create missing tables on target
+    bool createTables;
+    int batchRows;
+};
+
+// Tables of source connection and target connection for TableCopy
+
+class ToolCopyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ToolCopyDialog(QSqlDatabase db, const QStringList& targets, QWidget *parent = nullptr);
+    ~ToolCopyDialog();
+
+    CopySettings settings() const;
+
+protected:
+    Ui::ToolCopyDialog *ui;
+
+    // QDialog interface
+public slots:
+    void accept();
+};
+
+#endif // TOOLCOPYDIALOG_H
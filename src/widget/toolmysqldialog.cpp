@@ -5,6 +5,7 @@
 #include <QDirIterator>
 #include <QDebug>
 #include <QTimer>
+#include <QThread>
 #include "settings.h"
 
 ToolMysqlDialog::ToolMysqlDialog(QWidget *parent) :
@@ -16,6 +17,7 @@ ToolMysqlDialog::ToolMysqlDialog(QWidget *parent) :
     ui->files->setModel(mFiles);
 
     mDir = Settings::instance()->homePath();
+    ui->jobs->setValue(qBound(1, QThread::idealThreadCount(), 8));
 }
 
 ToolMysqlDialog::~ToolMysqlDialog()
@@ -33,6 +35,21 @@ bool ToolMysqlDialog::ssl() const
     return ui->ssl->isChecked();
 }
 
+bool ToolMysqlDialog::parallel() const
+{
+    return ui->parallel->isChecked();
+}
+
+int ToolMysqlDialog::jobs() const
+{
+    return ui->jobs->value();
+}
+
+bool ToolMysqlDialog::deferChecks() const
+{
+    return ui->deferChecks->isChecked();
+}
+
 static QStringList toNativeSeparators(const QStringList& names) {
     QStringList res;
     for(const QString& name: std::as_const(names)) {
@@ -20,6 +20,11 @@ public:
     QStringList files() const;
     bool ssl() const;
 
+    // ParallelRestore instead of mysql client
+    bool parallel() const;
+    int jobs() const;
+    bool deferChecks() const;
+
 protected:
     QStringListModel* mFiles;
 
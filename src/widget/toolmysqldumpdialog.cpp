@@ -9,6 +9,7 @@
 #include "model/checkablemodel.h"
 #include "settings.h"
 #include <QMessageBox>
+#include <QThread>
 
 // todo selected tables / all tables
 
@@ -43,7 +44,9 @@ ToolMysqldumpDialog::ToolMysqldumpDialog(QSqlDatabase db, QWidget *parent) :
 
     ui->output->setText(Settings::instance()->homePath());
     ui->output->setMode(LineSelect::ModeDir);
+    ui->jobs->setValue(qBound(1, QThread::idealThreadCount(), 8));
 
+    setNative(false);
 }
 
 ToolMysqldumpDialog::~ToolMysqldumpDialog()
@@ -53,6 +56,16 @@ ToolMysqldumpDialog::~ToolMysqldumpDialog()
 
 
 
+void ToolMysqldumpDialog::setNative(bool native)
+{
+    ui->tab->setVisible(!native);
+    ui->groupBox->setVisible(!native);
+    // native dump writes file per table
+    ui->groupBox_4->setVisible(!native);
+    ui->fileGroup->setVisible(native);
+    setWindowTitle(native ? "Dump" : "Mysqldump");
+}
+
 MysqldumpSettings ToolMysqldumpDialog::settings() const
 {
     MysqldumpSettings res;
@@ -64,6 +77,9 @@ MysqldumpSettings ToolMysqldumpDialog::settings() const
     res.data = ui->data->isChecked();
     res.ssl = ui->ssl->isChecked();
     res.tab = ui->tab->isChecked();
+    res.jobs = ui->jobs->value();
+    res.csv = ui->csv->isChecked();
+    res.compress = ui->compress->isChecked();
     return res;
 }
 
@@ -29,6 +29,11 @@ public:
     bool data;
     bool ssl;
     bool tab;
+    // tables dumped at the same time
+    int jobs;
+    // NativeDump options
+    bool csv;
+    bool compress;
 };
 
 class ToolMysqldumpDialog : public QDialog
@@ -41,6 +46,9 @@ public:
 
     MysqldumpSettings settings() const;
 
+    // options of NativeDump instead of mysqldump
+    void setNative(bool native);
+
 #if 0
     QString output() const;
 
@@ -9,6 +9,11 @@
 #include "modelcolumn.h"
 #include "fieldnames.h"
 #include <QSqlRecord>
+#include "storesqlresult.h"
+#include "connectionpool.h"
+#include "resultsnapshot.h"
+#include "error.h"
+#include <QFileDialog>
 
 XJoinItemWidget::XJoinItemWidget(QWidget *parent) :
     QWidget(parent),
@@ -25,22 +30,46 @@ XJoinItemWidget::~XJoinItemWidget()
 
 void XJoinItemWidget::on_execute_clicked()
 {
-    QSqlDatabase db = QSqlDatabase::database(ui->connection->currentText());
+    ConnectionLease lease(ui->connection->currentText());
+    QSqlDatabase db = lease.isValid() ? lease.database() : QSqlDatabase::database(ui->connection->currentText());
+    StoreSqlResult::fetchPending(db.driver());
     QSqlQuery q(db);
+    q.setForwardOnly(true);
     QString query = ui->query->toPlainText();
     if (!q.exec(query)) {
 
     } else {
         QSqlQueryModel* model = new QSqlQueryModel(this);
-        model->setQuery(std::move(q));
-        ui->result->setModel(model);
-
-        QStringList names = fieldNames(model->record());
-        auto* delegate = new ItemDelegateWithCompleter(names, ui->columns);
-        ui->columns->setItemDelegate(delegate);
+        model->setQuery(StoreSqlResult::query(std::move(q), StoreSqlResult::spillThreshold()));
+        setModel(model);
+    }
+}
 
-        emit queryExecuted();
+void XJoinItemWidget::on_openSnapshot_clicked()
+{
+    QString path = QFileDialog::getOpenFileName(this, QString(), QString(), ResultSnapshot::fileFilter());
+    if (path.isEmpty()) {
+        return;
+    }
+    QString error;
+    QSqlQueryModel* model = ResultSnapshot::open(path, error, this);
+    if (!model) {
+        Error::show(this, error);
+        return;
     }
+    ui->query->clear();
+    setModel(model);
+}
+
+void XJoinItemWidget::setModel(QSqlQueryModel *model)
+{
+    ui->result->setModel(model);
+
+    QStringList names = fieldNames(model->record());
+    auto* delegate = new ItemDelegateWithCompleter(names, ui->columns);
+    ui->columns->setItemDelegate(delegate);
+
+    emit queryExecuted();
 }
 
 void XJoinItemWidget::init(const QStringList &connectionNames)
@@ -32,8 +32,10 @@ signals:
 
 private slots:
     void on_execute_clicked();
+    void on_openSnapshot_clicked();
 
 private:
+    void setModel(QSqlQueryModel* model);
     Ui::XJoinItemWidget *ui;
 };
 